@@ -16,10 +16,11 @@
 #cmakedefine HAVE_GSO
 #cmakedefine HAVE_RECVMMSG
 #cmakedefine DISABLE_INT_TIMER
-#cmakedefine RATE_LIMITING
 #cmakedefine AUTH_IS_OPTIONAL
 #cmakedefine SUPP_INVPDU_ALERT
 #cmakedefine SUPP_INVPDU_WARN
 #cmakedefine ADD_HEADER_CSUM
+#cmakedefine ADD_CYCLE_COUNTERS
+#cmakedefine ADD_USDT_PROBES
 
 #endif /* CONFIG_H */
@@ -90,6 +90,7 @@
 #include <net/if.h>
 #include <netinet/in.h>
 #include <sys/epoll.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #ifdef AUTH_KEY_ENABLE
@@ -105,8 +106,19 @@
 #include "udpst_protocol.h"
 #include "udpst.h"
 #include "udpst_control.h"
+#include "udpst_cpu.h"
+#include "udpst_cycles.h"
 #include "udpst_data.h"
+#include "udpst_export.h"
+#include "udpst_histo.h"
+#include "udpst_rss.h"
 #include "udpst_srates.h"
+#include "udpst_wcache.h"
+#include "udpst_jsonw.h"
+#include "udpst_intf.h"
+#include "udpst_metrics.h"
+#include "udpst_shmstats.h"
+#include "udpst_psconn.h"
 #ifndef __linux__
 #include "../udpst_alt2.h"
 #endif
@@ -123,6 +135,7 @@ int read_keyfile(int);
 int server_finish(int);
 int json_finish(void);
 int proc_pstats_file(int, BOOL);
+void proc_pstats_init(int);
 int proc_pstats_max(int);
 int proc_pstats_rec(int);
 
@@ -140,9 +153,9 @@ static volatile sig_atomic_t sig_alrm = 0;    // Interrupt indicator
 static volatile sig_atomic_t sig_exit = 0;    // Interrupt indicator
 struct epoll_event epoll_events[MAX_EPOLL_EVENTS];
 char *boolText[]    = {"Disabled", "Enabled"};
-char *rateAdjAlgo[] = {"B", "C"}; // Aligned to CHTA_RA_ALGO_x
+char *rateAdjAlgo[] = {"B", "C", "D"}; // Aligned to CHTA_RA_ALGO_x
 //
-cJSON *json_top = NULL, *json_output = NULL, *json_siArray = NULL;
+cJSON *json_top = NULL, *json_output = NULL;
 char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
 
 //----------------------------------------------------------------------------
@@ -158,8 +171,12 @@ int main(int argc, char **argv) {
         struct itimerval itime;
         struct sigaction saction;
         struct stat statbuf;
+        struct timespec tspecvar;
         struct perfStatsMaximums *psM = &repo.psMaximums;
         struct perfStatsAverages *psA = &repo.psAverages;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cycready, cyc;
+#endif
 
         //
         // Sanity check that rate adjustment algorithm identifiers align with protocol
@@ -265,9 +282,6 @@ int main(int argc, char **argv) {
                 else
                         var += sprintf(&scratch[var], ", Protocol Ver: %d", PROTOCOL_VER); // Client is always the latest
                 var += sprintf(&scratch[var], ", Built: " __DATE__ " " __TIME__);
-#ifdef RATE_LIMITING
-                var += sprintf(&scratch[var], ", Rate Limiting via '-B mbps'");
-#endif // RATE_LIMITING
                 scratch[var++] = '\n';
                 var            = write(outputfd, scratch, var);
                 //
@@ -306,6 +320,12 @@ int main(int argc, char **argv) {
 #ifdef HAVE_RECVMMSG
                 var += sprintf(&scratch[var], " RecvMMsg()+Trunc");
 #endif // HAVE_RECVMMSG
+                if (conf.busyPollUsec > 0) {
+                        var += sprintf(&scratch[var], " BusyPoll(%dus)", conf.busyPollUsec);
+#ifdef EPIOCSPARAMS
+                        var += sprintf(&scratch[var], "+EPoll");
+#endif // EPIOCSPARAMS
+                }
                 scratch[var++] = '\n';
                 var            = write(outputfd, scratch, var);
         } else {
@@ -352,6 +372,16 @@ int main(int argc, char **argv) {
                 return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
         }
 
+        //
+        // Set starting sending rate from warm-start cache if available
+        //
+        if (conf.wcacheFile != NULL && !repo.isServer) {
+                if ((var = wcache_start(outputfd)) > 0) {
+                        var = write(outputfd, scratch, var);
+                        return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                }
+        }
+
         //
         // Display resulting sending rate table if requested and exit
         //
@@ -431,6 +461,24 @@ int main(int argc, char **argv) {
                 var = write(outputfd, scratch, var);
                 return STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
         }
+#ifdef EPIOCSPARAMS
+        //
+        // Enable epoll busy-polling to pair with socket busy-poll mode (where supported by the kernel)
+        //
+        if (conf.busyPollUsec > 0) {
+                struct epoll_params epparams;
+
+                memset(&epparams, 0, sizeof(epparams));
+                epparams.busy_poll_usecs  = (uint32_t) conf.busyPollUsec;
+                epparams.busy_poll_budget = BUSY_POLL_BUDGET;
+                epparams.prefer_busy_poll = 1;
+                if (ioctl(repo.epollFD, EPIOCSPARAMS, &epparams) < 0) { // Not fatal (e.g., ENOTTY with older kernel)
+                        var = sprintf(scratch, "WARNING: Epoll busy-poll disabled, unable to set parameters: %s\n",
+                                      strerror(errno));
+                        var = write(outputfd, scratch, var);
+                }
+        }
+#endif // EPIOCSPARAMS
 
         //
         // Set standard FDs as non-blocking
@@ -483,7 +531,10 @@ int main(int argc, char **argv) {
                 send_proc(monConn, scratch, var);
                 if (conf.debug) {
                         for (i = 0; i < repo.keyCount; i++) {
-                                var = sprintf(scratch, "  %3d,%s\n", repo.key[i].id, repo.key[i].key);
+                                var = sprintf(scratch, "  %3d,%s", repo.key[i].id, repo.key[i].key);
+                                if (repo.key[i].maxBandwidth > 0)
+                                        var += sprintf(&scratch[var], ",%d", repo.key[i].maxBandwidth);
+                                scratch[var++] = '\n';
                                 send_proc(monConn, scratch, var);
                         }
                 }
@@ -505,6 +556,36 @@ int main(int argc, char **argv) {
                 }
         }
 
+        //
+        // If specified, open statistics of local interface(s)
+        //
+        if (appstatus == STATUS_ERROR && *conf.intfName != '\0') {
+                if ((var = intf_open()) != 0) {
+                        send_proc(errConn, scratch, var);
+                        appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                        if (!repo.isServer && conf.jsonOutput) {
+                                tspeccpy(&conn[errConn].endTime, &repo.systemClock); // Schedule immediate exit
+                        } else {
+                                sig_exit = TRUE;
+                        }
+                }
+        }
+
+        //
+        // If specified, obtain RSS configuration of interface for test port selection
+        //
+        if (appstatus == STATUS_ERROR && *conf.rssIntf != '\0') {
+                if ((var = rss_init(conf.rssIntf)) != 0) {
+                        send_proc(errConn, scratch, var);
+                        appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                        if (!repo.isServer && conf.jsonOutput) {
+                                tspeccpy(&conn[errConn].endTime, &repo.systemClock); // Schedule immediate exit
+                        } else {
+                                sig_exit = TRUE;
+                        }
+                }
+        }
+
         //
         // If server, create a connection for control port to process inbound setup requests,
         // else create connections for client testing and send setup requests to server(s)
@@ -515,13 +596,30 @@ int main(int argc, char **argv) {
                                 appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
                                 sig_exit  = TRUE;
                         } else {
-                                if (conf.psFile != NULL) { // Initialize performance statistics
+                                if (conf.psFile != NULL) { // Initialize performance statistics file
                                         if ((var = proc_pstats_file(i, TRUE)) > 0) {
                                                 send_proc(errConn, scratch, var);
                                                 appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
                                                 sig_exit  = TRUE;
                                         }
                                 }
+                                if (!sig_exit && conf.metricsAddr != NULL) { // Initialize metrics endpoint
+                                        if ((var = metrics_init()) > 0) {
+                                                send_proc(errConn, scratch, var);
+                                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                                sig_exit  = TRUE;
+                                        }
+                                }
+                                if (!sig_exit && conf.shmStats) { // Initialize shared-memory statistics segment
+                                        if ((var = shmstats_init(i)) > 0) {
+                                                send_proc(errConn, scratch, var);
+                                                appstatus = STATUS_INIT_ERRBASE + ERROR_INIT_GENERIC;
+                                                sig_exit  = TRUE;
+                                        }
+                                }
+                                if (!sig_exit && (conf.psFile != NULL || conf.metricsAddr != NULL || conf.shmStats)) {
+                                        proc_pstats_init(i); // Start performance statistics collection
+                                }
                                 if (!sig_exit && conf.verbose) {
                                         var = sprintf(scratch, "[%d]Awaiting setup requests on %s:%d\n", i, conn[i].locAddr,
                                                       conn[i].locPort);
@@ -558,6 +656,10 @@ int main(int argc, char **argv) {
         // Primary control loop
         //
         repo.idleConnIndex = repo.maxConnIndex; // Save idle connection index
+#ifdef ADD_CYCLE_COUNTERS
+        cycles_init();
+#endif
+        cpu_init();
         while (!sig_exit) {
 #ifdef DISABLE_INT_TIMER
                 sig_alrm = 1; // Simulate expiry of system interval timer
@@ -574,7 +676,8 @@ int main(int argc, char **argv) {
                 // Process FD(s)
                 //
                 if (readyfds > 0) {
-                        if (conf.psFile != NULL) { // Update performance statistics
+                        CYC_START(cycready);
+                        if (repo.psActive) { // Update performance statistics
                                 psA->fdReadyCount++;
                                 psA->fdReadyTotal += (unsigned int) readyfds;
                                 if ((unsigned int) readyfds > psM->fdReadySize)
@@ -611,6 +714,7 @@ int main(int argc, char **argv) {
                                         //
                                         if (fdpass == 0) {
                                                 conn[i].dataReady = TRUE;
+                                                CYC_STOP(CYC_DISPATCH, cycready);
                                         } else if (!conn[i].dataReady) {
                                                 continue; // Nothing to do for this connection
                                         }
@@ -623,6 +727,8 @@ int main(int argc, char **argv) {
                                         //
                                         // Execute primary and secondary actions
                                         //
+                                        if (conf.psConn)
+                                                tspeccpy(&tspecvar, &repo.systemClock);
                                         secstatus = 0;
                                         pristatus = (conn[i].priAction)(i);
                                         if (pristatus > 0) {
@@ -631,6 +737,10 @@ int main(int argc, char **argv) {
                                         } else if (pristatus == 0) {
                                                 conn[i].dataReady = FALSE; // Indicate all data has been read from this connection
                                         }
+                                        if (conf.psConn && conn[i].testType != TEST_TYPE_UNK) {
+                                                clock_gettime(CLOCK_REALTIME, &repo.systemClock);
+                                                psconn_busy(i, &tspecvar); // Event processing time of connection
+                                        }
 
                                         //
                                         // Check for close/cleanup request
@@ -651,7 +761,7 @@ int main(int argc, char **argv) {
                 // Process timers
                 //
                 if (sig_alrm > 0) {
-                        if (conf.psFile != NULL) { // Update performance statistics
+                        if (repo.psActive) { // Update performance statistics
                                 if ((var = (int) sig_alrm) > 1) {
                                         psA->timCoalesceCount++;
                                         psA->timCoalesceTotal += (unsigned int) var;
@@ -672,6 +782,7 @@ int main(int argc, char **argv) {
                         //
                         // Check each connection for timer expiry
                         //
+                        CYC_START(cyc);
                         for (i = 0; i <= repo.maxConnIndex; i++) {
                                 //
                                 // Check connection end time first
@@ -687,6 +798,15 @@ int main(int argc, char **argv) {
                                                         }
                                                 } else {
                                                         if (i == aggConn) {
+#ifdef ADD_CYCLE_COUNTERS
+                                                                if (conf.verbose) // Before console is closed with aggregate
+                                                                        cycles_dump(monConn);
+#endif
+                                                                if (conf.wcacheFile != NULL &&
+                                                                    repo.endTimeStatus <= STATUS_WARNMAX) {
+                                                                        if ((var = wcache_update()) > 0)
+                                                                                send_proc(errConn, scratch, var);
+                                                                }
                                                                 if (conf.jsonOutput) {
                                                                         appstatus = json_finish(); // Finalize JSON processing
                                                                 } else {
@@ -718,6 +838,8 @@ int main(int argc, char **argv) {
                                 // Process timer action routines using elapsed time
                                 //
                                 var2 = 0;
+                                if (conf.psConn)
+                                        tspeccpy(&tspecvar, &repo.systemClock);
                                 if (tspecisset(&conn[i].timer1Thresh)) {
                                         if (tspeccmp(&repo.systemClock, &conn[i].timer1Thresh, >)) {
                                                 (conn[i].timer1Action)(i);
@@ -738,8 +860,11 @@ int main(int argc, char **argv) {
                                 }
                                 if (var2 > 0) { // Update local copy of system time clock if work was done
                                         clock_gettime(CLOCK_REALTIME, &repo.systemClock);
+                                        if (conf.psConn && conn[i].testType != TEST_TYPE_UNK)
+                                                psconn_busy(i, &tspecvar);
                                 }
                         }
+                        CYC_STOP(CYC_TIMERSCAN, cyc);
 
                         //
                         // Adjust system interval timer (if needed) based on server connection count
@@ -765,9 +890,22 @@ int main(int argc, char **argv) {
                                 }
                         }
 #endif
+                        //
+                        // Release any incoming CPU pinning once server is idle
+                        //
+                        if (repo.isServer && repo.maxConnIndex <= repo.idleConnIndex)
+                                restore_affinity();
                 }
         }
 
+#ifdef ADD_CYCLE_COUNTERS
+        //
+        // Output hot-path stage timing of server (since last performance statistics record)
+        //
+        if (conf.verbose && repo.isServer)
+                cycles_dump(monConn);
+#endif
+
         //
         // Close files and epoll FD
         //
@@ -775,10 +913,17 @@ int main(int argc, char **argv) {
                 close(logfilefd);
         if (repo.epollFD >= 0)
                 close(repo.epollFD);
-        if (repo.intfFD >= 0)
-                close(repo.intfFD);
-        if (repo.intfFDAlt >= 0)
-                close(repo.intfFDAlt);
+        intf_close();
+
+        //
+        // Release any output (export) rings still attached and stop writer thread once drained
+        //
+        for (i = 0; i <= repo.maxConnIndex; i++) {
+                if (conn[i].exportRing != NULL)
+                        export_close(i);
+        }
+        export_shutdown();
+        shmstats_close();
 
         //
         // Cleanup and free memory
@@ -787,6 +932,9 @@ int main(int argc, char **argv) {
         free(repo.sndBuffer);
         free(repo.defBuffer);
         free(repo.randData);
+        free(repo.testSum[0].histo);
+        free(repo.testSum[1].histo);
+        free(repo.txSched);
         free(repo.sndBufRand);
         free(conn);
         if (repo.psBuffer != NULL)
@@ -841,7 +989,7 @@ void signal_exit(int signal) {
 //
 int proc_parameters(int argc, char **argv, int fd) {
         int i, j, var, value;
-        char *lbuf, *optstring = "ud46C:x1evsf:jTDXSO:B:ri:oRa:y:K:m:G:nI:t:P:p:A:b:L:U:F:c:h:q:E:Ml:k:?";
+        char *lbuf, *optstring = "ud46C:x1evsf:jTDXSO:B:Y:ri:oHRa:y:K:m:G:J:VnI:t:P:p:A:gw:N:W:b:L:U:F:c:h:q:E:Ml:k:Z:zQ:?";
 
         //
         // Clear configuration and global repository data
@@ -863,6 +1011,9 @@ int proc_parameters(int argc, char **argv, int fd) {
                 case 'd':
                         conf.dsTesting = TRUE;
                         break;
+                case 'H':
+                        conf.delayUsec = TRUE; // Needed below for threshold defaults and limits
+                        break;
                 case 'p':
                         value = atoi(optarg);
                         if ((var = param_error(value, MIN_CONTROL_PORT, MAX_CONTROL_PORT)) > 0) {
@@ -972,12 +1123,22 @@ int proc_parameters(int argc, char **argv, int fd) {
         conf.subIntPeriod   = DEF_SUBINT_PERIOD;
         conf.sockSndBuf     = DEF_SOCKET_BUF;
         conf.sockRcvBuf     = DEF_SOCKET_BUF;
-        conf.lowThresh      = DEF_LOW_THRESH;
-        conf.upperThresh    = DEF_UPPER_THRESH;
+        conf.busyPollUsec   = DEF_BUSY_POLL;
+        if (!conf.delayUsec) {
+                conf.lowThresh   = DEF_LOW_THRESH;
+                conf.upperThresh = DEF_UPPER_THRESH;
+        } else {
+                conf.lowThresh   = DEF_LOW_THRESH_US;
+                conf.upperThresh = DEF_UPPER_THRESH_US;
+        }
         conf.trialInt       = DEF_TRIAL_INT;
         conf.slowAdjThresh  = DEF_SLOW_ADJ_TH;
         conf.highSpeedDelta = DEF_HS_DELTA;
         conf.seqErrThresh   = DEF_SEQ_ERR_TH;
+        conf.convCount      = DEF_CONV_COUNT;
+        conf.convTol        = DEF_CONV_TOL;
+        conf.ecnCeThresh    = DEF_ECN_CE_THRESH;
+        conf.rateLimit      = DEF_RATE_LIMIT;
         conf.logFileMax     = DEF_LOGFILE_MAX * 1000;
         //
         // Continue to initialize non-zero repository data
@@ -986,7 +1147,6 @@ int proc_parameters(int argc, char **argv, int fd) {
         repo.maxConnIndex  = -1;           // No connections allocated
         repo.endTimeStatus = STATUS_ERROR; // Default to unspecified error, require explicit success
         repo.intfFD        = -1;           // No file descriptor
-        repo.intfFDAlt     = -1;           // No file descriptor
         repo.keyIndex      = -1;           // No key index (used when client)
 
         //
@@ -1074,6 +1234,9 @@ int proc_parameters(int argc, char **argv, int fd) {
                         } else if (strcasecmp(optarg, "jsonf") == 0) {
                                 conf.jsonOutput    = TRUE;
                                 conf.jsonFormatted = TRUE;
+                        } else if (strcasecmp(optarg, "ndjson") == 0) {
+                                conf.jsonOutput = TRUE;
+                                conf.jsonStream = TRUE;
                         } else {
                                 var = sprintf(scratch, "ERROR: '%s' is not a valid output format\n", optarg);
                                 var = write(fd, scratch, var);
@@ -1101,10 +1264,14 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 var = write(fd, scratch, var);
                                 return ERROR_CONF_GENERIC;
                         }
-                        lbuf = optarg;
-                        if (*lbuf == '+') {
-                                lbuf++;
-                                conf.outputFileAll = TRUE; // Export metadata for all load PDUs
+                        for (lbuf = optarg;; lbuf++) {
+                                if (*lbuf == OUTPUT_ALL_PREFIX) {
+                                        conf.outputFileAll = TRUE; // Export metadata for all load PDUs
+                                } else if (*lbuf == OUTPUT_BIN_PREFIX) {
+                                        conf.outputFileBin = TRUE; // Export metadata as binary records
+                                } else {
+                                        break;
+                                }
                         }
                         conf.outputFile = lbuf;
                         break;
@@ -1121,6 +1288,19 @@ int proc_parameters(int argc, char **argv, int fd) {
                         }
                         conf.maxBandwidth = value; // Zero value allowed but is same as default of not specified
                         break;
+                case 'Y':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Rate ceiling only set by server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_RATE_LIMIT, MAX_RATE_LIMIT)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.rateLimit = value;
+                        break;
                 case 'r':
                         conf.showLossRatio = TRUE;
                         break;
@@ -1151,6 +1331,13 @@ int proc_parameters(int argc, char **argv, int fd) {
                         }
                         conf.useOwDelVar = !DEF_USE_OWDELVAR; // Not the default
                         break;
+                case 'H':
+                        if (repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Microsecond delay variation thresholds only set by client\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        break; // Already set during initial parsing
                 case 'R':
                         if (repo.isServer) {
                                 var = sprintf(scratch, "ERROR: Option to ignore Out-of-Order/Duplicates only set by client\n");
@@ -1217,8 +1404,32 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 var = write(fd, scratch, var);
                                 return ERROR_CONF_GENERIC;
                         }
+                        if (*optarg == STATS_CONN_PREFIX) {
+                                conf.psConn = TRUE;
+                                optarg++;
+                        }
                         conf.psFile = optarg;
                         break;
+                case 'J':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Metrics endpoint only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        if (*optarg == STATS_CONN_PREFIX) {
+                                conf.psConn = TRUE;
+                                optarg++;
+                        }
+                        conf.metricsAddr = optarg;
+                        break;
+                case 'V':
+                        if (!repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Shared-memory statistics only valid when server\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.shmStats = TRUE;
+                        break;
                 case 'n':
                         conf.seqNumAdjust = !DEF_SEQNUM_ADJ; // Not the default
                         break;
@@ -1279,6 +1490,66 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 return ERROR_CONF_GENERIC;
                         }
                         break;
+                case 'g':
+                        if (repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Continuous sending rates only set by client\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.srContinuous = TRUE;
+                        break;
+                case 'w':
+                        if (repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Convergence stop only set by client\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        if ((lbuf = strchr(optarg, '-')) != NULL)
+                                *lbuf = '\0';
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_CONV_COUNT, MAX_CONV_COUNT)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.convCount = value;
+                        if (lbuf != NULL) {
+                                value = atoi(++lbuf);
+                                if ((var = param_error(value, MIN_CONV_TOL, MAX_CONV_TOL)) > 0) {
+                                        var = write(fd, scratch, var);
+                                        return ERROR_CONF_GENERIC;
+                                }
+                                conf.convTol = value;
+                        }
+                        break;
+                case 'N':
+                        if (repo.isServer) {
+                                var = sprintf(scratch, "ERROR: ECN CE-marked congestion threshold only set by client\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_ECN_CE_THRESH, MAX_ECN_CE_THRESH)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+#ifndef HAVE_RECVMMSG
+                        if (!conf.usTesting) { // Received DSCP+ECN byte only obtained via recvmmsg() path
+                                var = sprintf(scratch, "ERROR: ECN CE-marked congestion threshold requires recvmmsg() "
+                                                       "for downstream testing\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+#endif
+                        conf.ecnCeThresh = value;
+                        break;
+                case 'W':
+                        if (repo.isServer) {
+                                var = sprintf(scratch, "ERROR: Warm-start cache only used by client\n");
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.wcacheFile = optarg;
+                        break;
                 case 'b':
                         value = atoi(optarg);
                         if ((var = param_error(value, MIN_SOCKET_BUF, MAX_SOCKET_BUF)) > 0) {
@@ -1287,6 +1558,33 @@ int proc_parameters(int argc, char **argv, int fd) {
                         }
                         conf.sockSndBuf = conf.sockRcvBuf = value;
                         break;
+                case 'Z':
+#if defined(SO_BUSY_POLL) && defined(SO_PREFER_BUSY_POLL) && defined(SO_BUSY_POLL_BUDGET)
+                        value = atoi(optarg);
+                        if ((var = param_error(value, MIN_BUSY_POLL, MAX_BUSY_POLL)) > 0) {
+                                var = write(fd, scratch, var);
+                                return ERROR_CONF_GENERIC;
+                        }
+                        conf.busyPollUsec = value;
+#else
+                        var = sprintf(scratch, "ERROR: Busy-poll socket options not supported by this build\n");
+                        var = write(fd, scratch, var);
+                        return ERROR_CONF_GENERIC;
+#endif
+                        break;
+                case 'z':
+#ifdef SO_INCOMING_CPU
+                        conf.cpuAffinity = TRUE;
+#else
+                        var = sprintf(scratch, "ERROR: Incoming CPU socket option not supported by this build\n");
+                        var = write(fd, scratch, var);
+                        return ERROR_CONF_GENERIC;
+#endif
+                        break;
+                case 'Q':
+                        strncpy(conf.rssIntf, optarg, IFNAMSIZ + 1);
+                        conf.rssIntf[IFNAMSIZ] = '\0';
+                        break;
                 case 'L':
                         if (repo.isServer) {
                                 var = sprintf(scratch, "ERROR: Low delay variation threshold only set by client\n");
@@ -1294,7 +1592,11 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 return ERROR_CONF_GENERIC;
                         }
                         value = atoi(optarg);
-                        if ((var = param_error(value, MIN_LOW_THRESH, MAX_LOW_THRESH)) > 0) {
+                        if (conf.delayUsec)
+                                var = param_error(value, MIN_LOW_THRESH_US, MAX_LOW_THRESH_US);
+                        else
+                                var = param_error(value, MIN_LOW_THRESH, MAX_LOW_THRESH);
+                        if (var > 0) {
                                 var = write(fd, scratch, var);
                                 return ERROR_CONF_GENERIC;
                         }
@@ -1307,7 +1609,11 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 return ERROR_CONF_GENERIC;
                         }
                         value = atoi(optarg);
-                        if ((var = param_error(value, MIN_UPPER_THRESH, MAX_UPPER_THRESH)) > 0) {
+                        if (conf.delayUsec)
+                                var = param_error(value, MIN_UPPER_THRESH_US, MAX_UPPER_THRESH_US);
+                        else
+                                var = param_error(value, MIN_UPPER_THRESH, MAX_UPPER_THRESH);
+                        if (var > 0) {
                                 var = write(fd, scratch, var);
                                 return ERROR_CONF_GENERIC;
                         }
@@ -1320,6 +1626,10 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 return ERROR_CONF_GENERIC;
                         }
                         value = atoi(optarg);
+                        if (value == 0) {
+                                conf.trialAdapt = TRUE; // Initial value remains default
+                                break;
+                        }
                         if ((var = param_error(value, MIN_TRIAL_INT, MAX_TRIAL_INT)) > 0) {
                                 var = write(fd, scratch, var);
                                 return ERROR_CONF_GENERIC;
@@ -1371,8 +1681,13 @@ int proc_parameters(int argc, char **argv, int fd) {
                                 var = write(fd, scratch, var);
                                 return ERROR_CONF_GENERIC;
                         }
-                        strncpy(conf.intfName, optarg, IFNAMSIZ + 1);
-                        conf.intfName[IFNAMSIZ] = '\0';
+                        lbuf = optarg;
+                        if (*lbuf == INTF_QUEUE_PREFIX) {
+                                lbuf++;
+                                conf.intfQueues = TRUE; // Add per-queue statistics via ethtool
+                        }
+                        strncpy(conf.intfName, lbuf, INTF_LIST_SIZE - 1);
+                        conf.intfName[INTF_LIST_SIZE - 1] = '\0';
                         break;
                 case 'M':
                         if (repo.isServer) {
@@ -1420,44 +1735,62 @@ int proc_parameters(int argc, char **argv, int fd) {
                         var = write(fd, scratch, var);
                         var = sprintf(scratch, "       -v           Enable verbose output messaging\n"
                                                "       -s           Summary/Max output only (no sub-interval output)\n"
-                                               "       -f format    JSON output (json, jsonb [brief], jsonf [formatted])\n"
+                                               "       -f format    JSON output (json, jsonb [brief], jsonf [formatted], ndjson)\n"
                                                "(j)    -j           Disable jumbo datagram sizes above 1 Gbps\n"
                                                "       -T           Use datagram sizes for traditional (1500 byte) MTU\n"
                                                "       -D           Enable debug output messaging (requires '-v')\n"
                                                "(m)    -X           Randomize datagram payload (else zeroes)\n"
                                                "       -S           Show server sending rate table and exit\n"
-                                               "(o)    -O [+]file   Output (export) file of received load metadata\n"
+                                               "(o)    -O [+^]file  Output (export) file of received load metadata\n"
                                                "       -B mbps      Max bandwidth required by client OR available to server\n"
-                                               "       -r           Display loss ratio instead of delivered percentage\n"
+                                               "(s)    -Y mbps      Rate ceiling per connection [Default Off, 0 = '-B']\n");
+                        var = write(fd, scratch, var);
+                        var = sprintf(scratch, "       -r           Display loss ratio instead of delivered percentage\n"
                                                "(c,b)  -i [-]count  Display bimodal maxima (specify initial sub-intervals)\n"
                                                "(c)    -o           Use One-Way Delay instead of RTT for delay variation\n"
-                                               "(c)    -R           Include Out-of-Order/Duplicate datagrams\n");
+                                               "(c)    -H           Delay variation thresholds (-L/-U) in microseconds\n"
+                                               "(c)    -R           Include Out-of-Order/Duplicate datagrams\n"
+                                               "       -a key       Authentication key (%d characters max)\n"
+                                               "(c)    -y keyid     Key ID used with authentication key [Default %d]\n"
+                                               "       -K file      Key file containing authentication keys\n"
+                                               "(m,v)  -m value     Packet marking octet (DSCP+ECN) [Default %d]\n",
+                                               AUTH_KEY_SIZE, DEF_KEY_ID, DEF_DSCPECN_BYTE);
                         var = write(fd, scratch, var);
                         var = sprintf(scratch,
-                                      "       -a key       Authentication key (%d characters max)\n"
-                                      "(c)    -y keyid     Key ID used with authentication key [Default %d]\n"
-                                      "       -K file      Key file containing authentication keys\n"
-                                      "(m,v)  -m value     Packet marking octet (DSCP+ECN) [Default %d]\n"
-                                      "(s)    -G file      Periodic server performance statistics (JSON)\n"
+                                      "(s)    -G [%c]file   Periodic server performance statistics (JSON)\n"
+                                      "(s)    -J [%c]endpt  Metrics endpoint, [host:]port or /path (OpenMetrics)\n"
+                                      "                    ('%c' prefix adds per-connection statistics to either)\n"
+                                      "(s)    -V           Publish statistics segment (/dev/shm) for udpst-stat\n"
                                       "       -n           No adjustment to sequence numbers from backpressure\n"
                                       "(m,i)  -I [%c]index  Index of sending rate (see '-S') [Default %c0 = <Auto>]\n"
                                       "(m)    -t time      Test interval time in seconds [Default %d, Max %d]\n"
                                       "(c)    -P period    Sub-interval period in ms [Default %d]\n"
                                       "       -p port      Default port number used for control [Default %d]\n"
-                                      "(c)    -A algo      Rate adjustment algorithm (%s - %s) [Default %s]\n"
-                                      "       -b buffer    Socket buffer request size (SO_SNDBUF/SO_RCVBUF)\n",
-                                      AUTH_KEY_SIZE, DEF_KEY_ID, DEF_DSCPECN_BYTE, SRIDX_ISSTART_PREFIX, SRIDX_ISSTART_PREFIX,
-                                      DEF_TESTINT_TIME, MAX_TESTINT_TIME, DEF_SUBINT_PERIOD, DEF_CONTROL_PORT,
-                                      rateAdjAlgo[CHTA_RA_ALGO_MIN], rateAdjAlgo[CHTA_RA_ALGO_MAX], rateAdjAlgo[DEF_RA_ALGO]);
+                                      "(c)    -A algo      Rate adjustment algorithm (%s - %s) [Default %s]\n",
+                                      STATS_CONN_PREFIX, STATS_CONN_PREFIX, STATS_CONN_PREFIX, SRIDX_ISSTART_PREFIX,
+                                      SRIDX_ISSTART_PREFIX, DEF_TESTINT_TIME, MAX_TESTINT_TIME, DEF_SUBINT_PERIOD,
+                                      DEF_CONTROL_PORT, rateAdjAlgo[CHTA_RA_ALGO_MIN], rateAdjAlgo[CHTA_RA_ALGO_MAX],
+                                      rateAdjAlgo[DEF_RA_ALGO]);
+                        var = write(fd, scratch, var);
+                        var = sprintf(scratch,
+                                      "       -b buffer    Socket buffer request size (SO_SNDBUF/SO_RCVBUF)\n"
+                                      "(c)    -g           Continuous (table-free) sending rates, no fixed rows\n"
+                                      "(c)    -w cnt[-tol] Stop early when max holds cnt sub-intervals [Default %d%%]\n"
+                                      "(c)    -N percent   ECN CE-marked percent treated as congestion [Default Off]\n"
+                                      "(c)    -W file      Warm-start cache file (start below recent maximums)\n"
+                                      "       -Z usec      Busy-poll receive time (SO_BUSY_POLL) [Default %d = Off]\n"
+                                      "       -z           Pin process to CPU of incoming traffic (SO_INCOMING_CPU)\n"
+                                      "       -Q intf      RSS-aware test port selection via hash config of intf\n",
+                                      DEF_CONV_TOL, DEF_BUSY_POLL);
                         var = write(fd, scratch, var);
                         var = sprintf(scratch,
-                                      "(c)    -L delvar    Low delay variation threshold in ms [Default %d]\n"
-                                      "(c)    -U delvar    Upper delay variation threshold in ms [Default %d]\n"
-                                      "(c)    -F interval  Status feedback/trial interval in ms [Default %d]\n"
+                                      "(c)    -L delvar    Low delay variation threshold in ms (us w/-H) [Default %d]\n"
+                                      "(c)    -U delvar    Upper delay variation threshold in ms (us w/-H) [Default %d]\n"
+                                      "(c)    -F interval  Status feedback/trial interval in ms [Default %d, 0 = Auto]\n"
                                       "(c)    -c thresh    Congestion slow adjustment threshold [Default %d]\n"
                                       "(c)    -h delta     High-speed (row adjustment) delta [Default %d]\n"
                                       "(c)    -q seqerr    Sequence error threshold [Default %d]\n"
-                                      "(c)    -E intf      Show local interface traffic rate (ex. eth0)\n"
+                                      "(c)    -E [+]intf   Show local interface traffic rate (ex. eth0) (n)\n"
                                       "(c)    -M           Use local interface rate to determine maximum\n"
                                       "(s)    -l logfile   Log file name when executing as daemon\n"
                                       "(s)    -k logsize   Log file maximum size in KBytes [Default %d]\n\n"
@@ -1478,9 +1811,12 @@ int proc_parameters(int argc, char **argv, int fd) {
                                       "      requests that exceed server maximum are automatically coerced down.\n"
                                       "(v) = Values can be specified as decimal (0 - 255) or hex (0x00 - 0xff).\n"
                                       "(i) = Static OR starting (with '%c' prefix) sending rate index.\n"
-                                      "(o) = Prefix '+' exports all metadata (not just RTT entries).\n"
-                                      "(b) = Prefix '-' suppresses rate adjustments during initial mode.\n",
-                                      SRIDX_ISSTART_PREFIX);
+                                      "(o) = Prefix '%c' exports all metadata (not just RTT entries). Prefix '%c'\n"
+                                      "      uses binary records (convert to CSV via 'udpst-convert').\n"
+                                      "(b) = Prefix '-' suppresses rate adjustments during initial mode.\n"
+                                      "(n) = Comma separated list (up to %d) is summed. Prefix '%c' adds queues.\n",
+                                      SRIDX_ISSTART_PREFIX, OUTPUT_ALL_PREFIX, OUTPUT_BIN_PREFIX, MAX_INTF_COUNT,
+                                      INTF_QUEUE_PREFIX);
                         var = write(fd, scratch, var);
                         return ERROR_CONF_GENERIC;
                 }
@@ -1534,6 +1870,19 @@ int proc_parameters(int argc, char **argv, int fd) {
                 var = write(fd, scratch, var);
                 return ERROR_CONF_GENERIC;
         }
+        if (conf.convCount >= (conf.testIntTime * MSECINSEC) / conf.subIntPeriod) {
+                var = sprintf(scratch, "ERROR: Convergence count must be less than total sub-intervals\n");
+                var = write(fd, scratch, var);
+                return ERROR_CONF_GENERIC;
+        }
+        if (conf.convCount > 0 && conf.bimodalCount > 0) {
+                var = sprintf(scratch, "ERROR: Convergence stop not available with bimodal maxima\n");
+                var = write(fd, scratch, var);
+                return ERROR_CONF_GENERIC;
+        }
+        if (conf.ecnCeThresh > 0 && (conf.dscpEcn & ECN_MASK) == ECN_NOTECT) {
+                conf.dscpEcn |= ECN_ECT1; // Unless specified, mark load traffic as ECN-capable (L4S)
+        }
         if (conf.intfForMax && *conf.intfName == '\0') {
                 var = sprintf(scratch, "ERROR: Maximum from local interface requires local interface option\n");
                 var = write(fd, scratch, var);
@@ -1583,7 +1932,7 @@ int read_keyfile(int fd) {
         int i, var, value, line, status = -1;
         FILE *f;
         char *lbuffer, localbuffer[STRING_SIZE];
-        char *tokens[KEY_ENTRY_FIELDS], *endptr, *saveptr = NULL;
+        char *tokens[KEY_ENTRY_MAXFIELDS], *endptr, *saveptr = NULL;
 
         //
         // Open file
@@ -1614,10 +1963,10 @@ int read_keyfile(int fd) {
 
                 //
                 // Break CSV line into tokens and check field count (ignore all tabs and spaces)
-                // Expecting: <keyid>,<key> [#<comment>]
+                // Expecting: <keyid>,<key>[,<maxmbps>] [#<comment>]
                 //
                 lbuffer = localbuffer;
-                for (i = 0; i < KEY_ENTRY_FIELDS; i++) {
+                for (i = 0; i < KEY_ENTRY_MAXFIELDS; i++) {
                         if ((tokens[i] = strtok_r(lbuffer, ", \t", &saveptr)) == NULL)
                                 break;
                         lbuffer = NULL;
@@ -1630,6 +1979,8 @@ int read_keyfile(int fd) {
                         status = ERROR_CONF_KEYFILE;
                         break;
                 }
+                if (i < KEY_ENTRY_MAXFIELDS)
+                        tokens[KEY_ENTRY_FIELDS] = NULL; // No rate ceiling
 
                 //
                 // Validate attributes of key entry
@@ -1665,6 +2016,17 @@ int read_keyfile(int fd) {
                         status = ERROR_CONF_KEYFILE;
                         break;
                 }
+                var = 0;
+                if (tokens[KEY_ENTRY_FIELDS] != NULL) {
+                        endptr = NULL;
+                        var    = (int) strtol(tokens[KEY_ENTRY_FIELDS], &endptr, 0);
+                        if (*endptr != '\0' || var < MIN_RATE_LIMIT || var > MAX_RATE_LIMIT) {
+                                var    = sprintf(scratch, "ERROR: Key file entry has invalid rate ceiling (line %d)\n", line);
+                                var    = write(fd, scratch, var);
+                                status = ERROR_CONF_KEYFILE;
+                                break;
+                        }
+                }
                 if (repo.keyCount >= MAX_KEY_ENTRIES) {
                         var    = sprintf(scratch, "ERROR: Key file entry count exceeds maximum (line %d)\n", line);
                         var    = write(fd, scratch, var);
@@ -1675,8 +2037,9 @@ int read_keyfile(int fd) {
                 //
                 // Store key entry
                 //
-                i              = repo.keyCount++;
-                repo.key[i].id = value;
+                i                        = repo.keyCount++;
+                repo.key[i].id           = value;
+                repo.key[i].maxBandwidth = var;
                 strncpy(repo.key[i].key, tokens[1], AUTH_KEY_SIZE + 1);
                 repo.key[i].key[AUTH_KEY_SIZE] = '\0';
 
@@ -1759,7 +2122,7 @@ int server_finish(int connindex) {
 //
 int json_finish() {
         int var;
-        char *json_string = NULL;
+        char *json_string = NULL, *splice;
 
         //
         // Add final items to output object and add it to top-level object
@@ -1788,10 +2151,19 @@ int json_finish() {
         //
         // NOTE: When stdout is not redirected to a file, JSON may appear clipped due to non-blocking console writes
         //
+        // NOTE: Spooled sub-interval results are output in place of their placeholder instead of being kept in memory
+        //
         json_string     = cJSON_PrintBuffered(json_top, 32768, conf.jsonFormatted); // Size covers likely default test options
-        var             = strlen(json_string);
         conf.jsonOutput = FALSE; // IMPORTANT: Disable JSON formatting prior to final send_proc() call
-        send_proc(errConn, json_string, var);
+        if ((splice = strstr(json_string, JSONW_SPLICE)) != NULL) {
+                send_proc(errConn, json_string, (int) (splice - json_string));
+                jsonw_spool_send(errConn);
+                splice += strlen(JSONW_SPLICE);
+        } else {
+                splice = json_string;
+        }
+        var = strlen(splice);
+        send_proc(errConn, splice, var);
         send_proc(errConn, "\n", 1);
         //
         free(json_string);
@@ -1806,11 +2178,11 @@ int json_finish() {
 // Populate scratch buffer and return length on error
 //
 int proc_pstats_file(int connindex, BOOL init) {
-        register struct connection *c = &conn[connindex];
         time_t ttime;
-        struct timespec tspecvar;
         char fname[STRING_SIZE];
 
+        (void) (connindex);
+
         //
         // Set next file write expiry time
         //
@@ -1856,29 +2228,12 @@ int proc_pstats_file(int connindex, BOOL init) {
                 //
                 repo.psFileTime -= getuniform(0, STATS_FILE_INT - STATS_RECORD_INT);
                 //
-                // Start interval timer for processing global maximums
-                //
-                tspecvar.tv_sec  = 0;
-                tspecvar.tv_nsec = STATS_GMAX_TIMER * NSECINMSEC;
-                tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
-                c->timer1Action = &proc_pstats_max;
-                //
-                // Start interval timer for processing records
-                //
-                tspecvar.tv_sec  = STATS_RECORD_INT;
-                tspecvar.tv_nsec = 0;
-                tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
-                c->timer2Action = &proc_pstats_rec;
-                //
-                // Save time for initial record
-                //
-                tspeccpy(&repo.psRecordTime, &repo.systemClock);
-                //
                 // Allocate JSON output buffer
                 //
-                repo.psBuffer  = malloc(STATS_BUFFER_SIZE);
-                repo.psBufSize = 0;
-                *repo.psBuffer = '\0';
+                repo.psBuffer   = malloc(STATS_BUFFER_SIZE);
+                repo.psBufSize  = 0;
+                repo.psBufAlloc = STATS_BUFFER_SIZE;
+                *repo.psBuffer  = '\0';
 
                 return 0;
         }
@@ -1900,6 +2255,34 @@ int proc_pstats_file(int connindex, BOOL init) {
 }
 //----------------------------------------------------------------------------
 //
+// Start performance statistics collection (for file and/or metrics endpoint)
+//
+void proc_pstats_init(int connindex) {
+        register struct connection *c = &conn[connindex];
+        struct timespec tspecvar;
+
+        repo.psActive = TRUE;
+        //
+        // Start interval timer for processing global maximums
+        //
+        tspecvar.tv_sec  = 0;
+        tspecvar.tv_nsec = STATS_GMAX_TIMER * NSECINMSEC;
+        tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
+        c->timer1Action = &proc_pstats_max;
+        //
+        // Start interval timer for processing records
+        //
+        tspecvar.tv_sec  = STATS_RECORD_INT;
+        tspecvar.tv_nsec = 0;
+        tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
+        c->timer2Action = &proc_pstats_rec;
+        //
+        // Save time for initial record
+        //
+        tspeccpy(&repo.psRecordTime, &repo.systemClock);
+}
+//----------------------------------------------------------------------------
+//
 // Process performance statistics for global maximums
 //
 int proc_pstats_max(int connindex) {
@@ -1925,6 +2308,12 @@ int proc_pstats_max(int connindex) {
         if ((unsigned int) repo.dsBandwidth > psM->dsBandwidth)
                 psM->dsBandwidth = (unsigned int) repo.dsBandwidth;
 
+        //
+        // Publish counters and current usage to shared-memory statistics segment
+        //
+        if (conf.shmStats)
+                shmstats_global();
+
         return 0;
 }
 //----------------------------------------------------------------------------
@@ -1936,7 +2325,7 @@ int proc_pstats_max(int connindex) {
 //
 int proc_pstats_rec(int connindex) {
         register struct connection *c = &conn[connindex];
-        int i, var;
+        int i, j, var;
         BOOL bvar;
         double dvar, delta;
         struct timespec tspecvar;
@@ -1952,6 +2341,28 @@ int proc_pstats_rec(int connindex) {
         tspecvar.tv_nsec = 0;
         tspecplus(&repo.systemClock, &tspecvar, &c->timer2Thresh);
 
+        //
+        // Save maximums and averages of this record for metrics endpoint, and only reset them if there is no file
+        //
+        if (conf.metricsAddr != NULL)
+                metrics_record();
+        if (conf.shmStats)
+                shmstats_record();
+#ifdef ADD_CYCLE_COUNTERS
+        if (conf.verbose && conf.debug)
+                cycles_dump(monConn);
+        if (conf.psFile == NULL)
+                cycles_reset();
+#endif
+        if (conf.psFile == NULL) {
+                if (repo.txSched != NULL)
+                        memset(repo.txSched, 0, sizeof(struct txSchedSet));
+                memset(&repo.psMaximums, 0, sizeof(struct perfStatsMaximums));
+                memset(&repo.psAverages, 0, sizeof(struct perfStatsAverages));
+                tspeccpy(&repo.psRecordTime, &repo.systemClock);
+                return 0;
+        }
+
         //
         // Do initialization on first record
         //
@@ -1978,6 +2389,8 @@ int proc_pstats_rec(int connindex) {
                 bvar = TRUE;
 #endif
                 i += sprintf(&repo.psBuffer[i], "\"gso_enabled\": %s,\n", booltext[bvar]);
+                i += sprintf(&repo.psBuffer[i], "\"busy_poll_usec\": %d,\n", conf.busyPollUsec);
+                i += sprintf(&repo.psBuffer[i], "\"cpu_affinity\": %s,\n", booltext[conf.cpuAffinity]);
                 i += sprintf(&repo.psBuffer[i], "\"max_connections\": %d,\n", conf.maxConnections - repo.idleConnIndex - 1);
                 i += sprintf(&repo.psBuffer[i], "\"max_bandwidth\": %d,\n", conf.maxBandwidth);
 
@@ -2112,10 +2525,46 @@ int proc_pstats_rec(int connindex) {
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"loc_traffic_stop_rate\": %.2f,\n", dvar);
         dvar = ((double) psA->remTrafficStop * MSECINSEC) / delta;
         i += sprintf(&repo.psBuffer[i], "\t\t\t\"rem_traffic_stop_rate\": %.2f\n", dvar);
+        //----------------------------------------------------------------------
+        i += sprintf(&repo.psBuffer[i], "\t\t},\n\t\t\"locality\": {\n");
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_cpu_sample_count\": %u,\n", psA->rxCpuSamples);
+        dvar = 0;
+        if (psA->rxCpuSamples > 0)
+                dvar = (double) psA->rxCpuLocal / (double) psA->rxCpuSamples;
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_cpu_local_ratio\": %.2f,\n", dvar);
+        i += sprintf(&repo.psBuffer[i], "\t\t\t\"rx_cpus\": [");
+        for (j = 0, var = 0; j < MAX_RXCPU_COUNT; j++) {
+                if (psA->rxCpuSamplesPer[j] == 0)
+                        continue;
+                dvar = (double) psA->rxCpuLocalPer[j] / (double) psA->rxCpuSamplesPer[j];
+                i += sprintf(&repo.psBuffer[i], "%s\n\t\t\t\t{\"cpu\": %d, \"sample_count\": %u, \"local_ratio\": %.2f}",
+                             (var++ > 0) ? "," : "", j, psA->rxCpuSamplesPer[j], dvar);
+        }
+        i += sprintf(&repo.psBuffer[i], "%s]\n", (var > 0) ? "\n\t\t\t" : "");
         i += sprintf(&repo.psBuffer[i], "\t\t}\n");
         //
         i += sprintf(&repo.psBuffer[i], "\t},\n");
+        i += cpu_json(&repo.psBuffer[i], psA->txBytes + psA->rxBytes); // CPU cost for this record
         memset(&repo.psAverages, 0, sizeof(struct perfStatsAverages));
+        i += histo_txsched_json(&repo.psBuffer[i]); // Transmit schedule accuracy for this record
+#ifdef ADD_CYCLE_COUNTERS
+        i += cycles_json(&repo.psBuffer[i]); // Hot-path stage timing for this record
+#endif
+
+        //
+        // Add per-connection and per-client statistics for this record (growing buffer as needed)
+        //
+        if (conf.psConn) {
+                var = i + psconn_size() + (2 * STATS_RECORD_SIZE); // Rest of record and end of file
+                if (var > repo.psBufAlloc) {
+                        if ((pvar = realloc(repo.psBuffer, var)) != NULL) {
+                                repo.psBuffer   = pvar;
+                                repo.psBufAlloc = var;
+                        }
+                }
+                if (var <= repo.psBufAlloc)
+                        i += psconn_record(&repo.psBuffer[i], delta);
+        }
 
         //
         // Add end time info for this record
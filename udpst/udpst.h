@@ -74,11 +74,19 @@
 //
 // Performance statistics
 //
-#define STATS_RECORD_INT  10  // Record interval (sec)
-#define STATS_FILE_INT    300 // File interval (sec)
-#define STATS_BUFFER_SIZE (((STATS_FILE_INT / STATS_RECORD_INT) + 1) * 2048)
-#define STATS_GMAX_TIMER  500 // Timer for global maximums (ms)
-#define STATS_SCHEMA_VER  1.0 // Schema version of file and record format
+#define STATS_RECORD_INT  10     // Record interval (sec)
+#define STATS_FILE_INT    300    // File interval (sec)
+#ifdef ADD_CYCLE_COUNTERS
+#define STATS_RECORD_SIZE 10240  // Buffer space per record (and for end of file)
+#else
+#define STATS_RECORD_SIZE 8192   // Buffer space per record (and for end of file)
+#endif
+#define STATS_BUFFER_SIZE (((STATS_FILE_INT / STATS_RECORD_INT) + 1) * STATS_RECORD_SIZE)
+#define STATS_GMAX_TIMER  500    // Timer for global maximums (ms)
+#define STATS_SCHEMA_VER  1.4    // Schema version of file and record format
+#define STATS_CONN_PREFIX '+'    // Prefix of '-G'/'-J' value enabling per-connection statistics
+#define STATS_CONN_SIZE   2048   // Buffer space per connection and client in record
+#define STATS_CONN_CLOSED 256    // Max connections closed during a record that are retained for it
 //
 // General status and status base values for warning and error ranges (ErrorStatus)
 //   See udpst_protocol.h for CHSR_CRSP_XXXX and CHTA_CRSP_XXXX values
@@ -133,13 +141,24 @@
 #define DEF_MC_COUNT         1              // Multi-connection test count
 #define MIN_MC_COUNT         1              //
 #define MAX_MC_COUNT         24             //
+#define MAX_INTF_COUNT       4              // Maximum local interfaces (statistics)
+#define MAX_RXCPU_COUNT      64             // Maximum incoming CPUs with per-CPU locality (statistics)
+#define INTF_LIST_SIZE       ((IFNAMSIZ + 1) * MAX_INTF_COUNT)
 #define DEF_DSCPECN_BYTE     0              // DSCP+ECN byte for testing
 #define MIN_DSCPECN_BYTE     0              //
 #define MAX_DSCPECN_BYTE     UINT8_MAX      //
+#define ECN_MASK             0x03           // ECN bits of DSCP+ECN byte
+#define ECN_NOTECT           0x00           // Not ECN-capable transport
+#define ECN_ECT1             0x01           // ECN-capable transport (1), L4S
+#define ECN_ECT0             0x02           // ECN-capable transport (0)
+#define ECN_CE               0x03           // Congestion experienced
 #define DEF_SRINDEX_CONF     CHTA_SRIDX_DEF // Sending rate index, <Auto> = UINT16_MAX
 #define MIN_SRINDEX_CONF     0              //
 #define MAX_SRINDEX_CONF     (MAX_SENDING_RATES - 1)
 #define SRIDX_ISSTART_PREFIX '@'        // Prefix char for sending rate starting point
+#define OUTPUT_ALL_PREFIX    '+'        // Prefix char for output (export) of all metadata
+#define OUTPUT_BIN_PREFIX    '^'        // Prefix char for binary output (export) file
+#define INTF_QUEUE_PREFIX    '+'        // Prefix char for per-queue local interface statistics
 #define DEF_TESTINT_TIME     10         // Test interval time (sec)
 #define MIN_TESTINT_TIME     5          //
 #define MAX_TESTINT_TIME     3600       //
@@ -155,12 +174,22 @@
 #define DEF_SOCKET_BUF       1024000        // Socket buffer to request
 #define MIN_SOCKET_BUF       0              // (0 = System default/minimum)
 #define MAX_SOCKET_BUF       16777216       //
+#define DEF_BUSY_POLL        0              // Busy-poll receive time (us)
+#define MIN_BUSY_POLL        0              // (0 = Disabled, interrupt driven)
+#define MAX_BUSY_POLL        1000           //
+#define BUSY_POLL_BUDGET     64             // Busy-poll budget (packets per poll)
 #define DEF_LOW_THRESH       30             // Low delay variation threshold (ms)
 #define MIN_LOW_THRESH       1              //
 #define MAX_LOW_THRESH       10000          //
 #define DEF_UPPER_THRESH     90             // Upper delay variation threshold (ms)
 #define MIN_UPPER_THRESH     1              //
 #define MAX_UPPER_THRESH     10000          //
+#define DEF_LOW_THRESH_US    300            // Low delay variation threshold (us)
+#define MIN_LOW_THRESH_US    1              // (when thresholds are in usec)
+#define MAX_LOW_THRESH_US    UINT16_MAX     //
+#define DEF_UPPER_THRESH_US  900            // Upper delay variation threshold (us)
+#define MIN_UPPER_THRESH_US  1              // (when thresholds are in usec)
+#define MAX_UPPER_THRESH_US  UINT16_MAX     //
 #define DEF_TRIAL_INT        50             // Status feedback/trial interval (ms)
 #define MIN_TRIAL_INT        5              //
 #define MAX_TRIAL_INT        250            //
@@ -180,6 +209,18 @@
 #define MAX_CLIENT_BW        INT16_MAX      // (MSb for direction [CHSR_USDIR_BIT])
 #define MAX_SERVER_BW        100000         //
 #define DEF_RA_ALGO          CHTA_RA_ALGO_B // Default rate adjustment algorithm
+#define DEF_CONV_COUNT       0              // Convergence stop sub-interval count
+#define MIN_CONV_COUNT       2              // (0 = Disabled, run full test interval)
+#define MAX_CONV_COUNT       UINT8_MAX      //
+#define DEF_CONV_TOL         5              // Convergence stop tolerance (%)
+#define MIN_CONV_TOL         1              //
+#define MAX_CONV_TOL         50             //
+#define DEF_ECN_CE_THRESH    0              // ECN CE-marked congestion threshold (%)
+#define MIN_ECN_CE_THRESH    1              // (0 = Disabled, CE marks ignored)
+#define MAX_ECN_CE_THRESH    100            //
+#define DEF_RATE_LIMIT       -1             // Per-connection rate ceiling (Mbps)
+#define MIN_RATE_LIMIT       0              // (-1 = Off, 0 = Bandwidth of setup request)
+#define MAX_RATE_LIMIT       MAX_SERVER_BW  //
 #define DEF_KEY_ID           0              // Key ID
 #define MIN_KEY_ID           0              //
 #define MAX_KEY_ID           UINT8_MAX      //
@@ -191,6 +232,8 @@
 #define MAX_SENDING_RATES 1153              // Max rows in sending rate table
 #define BASE_SEND_TIMER1  MIN_INTERVAL_USEC // Base send timer, transmitter 1 (us)
 #define BASE_SEND_TIMER2  1000              // Base send timer, transmitter 2 (us)
+#define CRATE_HS_PCT      2                 // Continuous rate increase per index above HS threshold (%)
+#define TBUCKET_DEPTH     2000              // Rate ceiling token bucket depth (us at ceiling rate)
 #define MAX_L3_PACKET     1250              // Max desired L3 packet size
 #define MAX_JL3_PACKET    9000              // Max desired jumbo L3 packet
 #define MAX_TL3_PACKET    1500              // Max desired traditional L3 packet
@@ -222,6 +265,7 @@
 #define RCV_BUFFER_SIZE DEF_BUFFER_SIZE
 #define RCV_HEADER_SIZE ((((sizeof(struct loadHdr) - 1) / 4) + 1) * 4) // Enforce 32-bit boundary
 #define RECVMMSG_SIZE   256
+#define ECN_CMSG_SIZE   (CMSG_SPACE(sizeof(int))) // Ancillary data for received TOS/TCLASS
 
 //----------------------------------------------------------------------------
 //
@@ -242,7 +286,9 @@
 //
 // Rate Adjustment Algorithms
 //
-#define RETRY_THRESH_ALGOC 5 // AlgoC: Initial retry threshold
+#define RETRY_THRESH_ALGOC 5   // AlgoC: Initial retry threshold
+#define GROWTH_ALGOD       1.1 // AlgoD: Sending rate growth per expansion step
+#define DELAY_RISE_ALGOD   2   // AlgoD: Delay increase (ms) over a step indicating rate above capacity
 
 //----------------------------------------------------------------------------
 // Data structures
@@ -267,15 +313,19 @@ struct configuration {
         BOOL jsonOutput;                 // JSON Output format
         BOOL jsonBrief;                  // JSON Output should be minimized
         BOOL jsonFormatted;              // JSON Output should be formatted
+        BOOL jsonStream;                 // JSON sub-intervals also output live (NDJSON)
         BOOL jumboStatus;                // Enable/disable jumbo datagram sizes
         BOOL traditionalMTU;             // Traditional (1500 byte) MTU
         BOOL debug;                      // Enable debug messaging
         BOOL randPayload;                // Payload randomization
         int rateAdjAlgo;                 // Rate adjustment algorithm
+        BOOL srContinuous;               // Continuous (table-free) sending rates
+        BOOL trialAdapt;                 // RTT-adaptive trial interval
         BOOL showSendingRates;           // Display sending rate table parameters
         BOOL showLossRatio;              // Display loss ratio
         int bimodalCount;                // Bimodal initial sub-interval count
         BOOL useOwDelVar;                // Use one-way delay instead of RTT
+        BOOL delayUsec;                  // Delay variation thresholds in usec
         BOOL ignoreOooDup;               // Ignore Out-of-Order/Duplicate datagrams
         BOOL seqNumAdjust;               // Adjust seq. numbers from backpressure
         char authKey[AUTH_KEY_SIZE + 4]; // Authentication key (from command-line)
@@ -285,11 +335,17 @@ struct configuration {
         int srIndexConf;                 // Configured sending rate index
         BOOL srIndexIsStart;             // Configured SR index is starting point
         int srAdjSuppCount;              // Sending rate adj. suppression count
+        int convCount;                   // Convergence stop sub-interval count
+        int convTol;                     // Convergence stop tolerance (%)
+        int ecnCeThresh;                 // ECN CE-marked congestion threshold (%)
         int testIntTime;                 // Test interval time (sec)
         int subIntPeriod;                // Sub-interval period (ms)
         int controlPort;                 // Control port number for setup requests
         int sockSndBuf;                  // Socket send buffer size
         int sockRcvBuf;                  // Socket receive buffer size
+        int busyPollUsec;                // Busy-poll receive time (us)
+        BOOL cpuAffinity;                // Pin process to incoming CPU
+        char rssIntf[IFNAMSIZ + 4];      // Interface for RSS-aware port selection
         int lowThresh;                   // Low delay variation threshold
         int upperThresh;                 // Upper delay variation threshold
         int trialInt;                    // Status feedback/trial interval (ms)
@@ -297,22 +353,31 @@ struct configuration {
         int highSpeedDelta;              // High-speed row adjustment delta
         int seqErrThresh;                // Sequence error threshold
         int maxBandwidth;                // Required OR available bandwidth
+        int rateLimit;                   // Per-connection rate ceiling (Mbps)
         BOOL intfForMax;                 // Local interface used for maximum
-        char intfName[IFNAMSIZ + 4];     // Local interface for supplemental data
+        char intfName[INTF_LIST_SIZE];   // Local interface(s) for supplemental data
+        BOOL intfQueues;                 // Per-queue local interface statistics
         int logFileMax;                  // Maximum log file size
         char *logFile;                   // Name of log file
         char *outputFile;                // Name of output (export) file
         BOOL outputFileAll;              // Output (export) all metadata
+        BOOL outputFileBin;              // Output (export) binary records
         char *psFile;                    // Name of performance statistics file
+        char *metricsAddr;               // Metrics endpoint ([host:]port or UNIX socket path)
+        BOOL shmStats;                   // Publish shared-memory statistics segment
+        BOOL psConn;                     // Per-connection performance statistics
+        char *wcacheFile;                // Name of warm-start cache file
 };
 //----------------------------------------------------------------------------
 //
 // Repository of global variables and structures
 //
-#define KEY_ENTRY_FIELDS 2
+#define KEY_ENTRY_FIELDS    2 // Required fields
+#define KEY_ENTRY_MAXFIELDS 3 // Including optional rate ceiling
 struct keyEntry {
         int id;                      // Key ID
         char key[AUTH_KEY_SIZE + 4]; // Key string
+        int maxBandwidth;            // Rate ceiling (Mbps, 0 = none)
 };
 struct serverId {
         char *name;                 // Server hostname or IP address
@@ -320,20 +385,21 @@ struct serverId {
         int port;                   // Server control port number
 };
 struct testSummary {
-        unsigned int rxDatagrams;   // Total rx datagrams
-        unsigned int seqErrLoss;    // Loss sum
-        unsigned int seqErrOoo;     // Out-of-Order sum
-        unsigned int seqErrDup;     // Duplicate sum
-        unsigned int delayVarMin;   // Delay variation minimum
-        unsigned int delayVarMax;   // Delay variation maximum
-        unsigned int delayVarSum;   // Delay variation sum
-        unsigned int rttVarMinimum; // RTT variation minimum
-        unsigned int rttVarMaximum; // RTT variation maximum
-        unsigned int rttVarSum;     // RTT variation sum
-        unsigned int rttVarCnt;     // RTT variation count
-        double rateSumL3;           // Rate sum at L3
-        double rateSumIntf;         // Rate sum of local interface
-        unsigned int sampleCount;   // Sample count
+        unsigned long long rxDatagrams; // Total rx datagrams (64 bits)
+        unsigned long long seqErrLoss;  // Loss sum (64 bits)
+        unsigned long long seqErrOoo;   // Out-of-Order sum (64 bits)
+        unsigned long long seqErrDup;   // Duplicate sum (64 bits)
+        unsigned int delayVarMin;       // Delay variation minimum
+        unsigned int delayVarMax;       // Delay variation maximum
+        unsigned long long delayVarSum; // Delay variation sum (64 bits)
+        unsigned int rttVarMinimum;     // RTT variation minimum
+        unsigned int rttVarMaximum;     // RTT variation maximum
+        unsigned long long rttVarSum;   // RTT variation sum (64 bits)
+        unsigned int rttVarCnt;         // RTT variation count
+        double rateSumL3;               // Rate sum at L3
+        double rateSumIntf;             // Rate sum of local interface
+        unsigned int sampleCount;       // Sample count
+        struct histogram *histo;        // Delay/RTT variation histograms (HISTO_TYPES)
 };
 struct perfStatsMaximums {
         unsigned int connCount;       // Connection count
@@ -346,32 +412,36 @@ struct perfStatsMaximums {
         unsigned int timCoalesceSize; // Timer coalesce size
 };
 struct perfStatsAverages {
-        unsigned long long qdBytes;    // Queued transmit bytes (64 bits)
-        unsigned long long txBytes;    // Transmitted bytes (64 bits)
-        unsigned long long rxBytes;    // Received bytes (64 bits)
-        unsigned int qdDatagrams;      // Queued transmit datagrams
-        unsigned int txDatagrams;      // Transmitted datagrams
-        unsigned int rxDatagrams;      // Received datagrams
-        unsigned int txSeqErrLoss;     // Transmitted loss
-        unsigned int txSeqErrOooDup;   // Transmitted out-of-order + duplicates
-        unsigned int rxSeqErrLoss;     // Received loss
-        unsigned int rxSeqErrOooDup;   // Received out-of-order + duplicates
-        unsigned int txOverrunCount;   // Queued transmit overrun indications
-        unsigned int txOverrunTotal;   // Queued transmit overrun total count
-        unsigned int txBurstCount;     // Transmitted bursts
-        unsigned int txBurstTotal;     // Transmitted burst total count
-        unsigned int rxBurstCount;     // Received bursts
-        unsigned int rxBurstTotal;     // Received burst total count
-        unsigned int fdReadyCount;     // FD ready indications
-        unsigned int fdReadyTotal;     // FD ready total count
-        unsigned int timCoalesceCount; // Timer coalesce count
-        unsigned int timCoalesceTotal; // Timer coalesce total
-        unsigned int txStatusMsgs;     // Transmitted status messages
-        unsigned int rxStatusMsgs;     // Received status messages
-        unsigned int locStatusLoss;    // Local status messages lost
-        unsigned int remStatusLoss;    // Remote status messages lost
-        unsigned int locTrafficStop;   // Local traffic stop indications
-        unsigned int remTrafficStop;   // Remote traffic stop indications
+        unsigned long long qdBytes;                    // Queued transmit bytes (64 bits)
+        unsigned long long txBytes;                    // Transmitted bytes (64 bits)
+        unsigned long long rxBytes;                    // Received bytes (64 bits)
+        unsigned long long qdDatagrams;                // Queued transmit datagrams (64 bits)
+        unsigned long long txDatagrams;                // Transmitted datagrams (64 bits)
+        unsigned long long rxDatagrams;                // Received datagrams (64 bits)
+        unsigned long long txSeqErrLoss;               // Transmitted loss (64 bits)
+        unsigned long long txSeqErrOooDup;             // Transmitted out-of-order + duplicates (64 bits)
+        unsigned long long rxSeqErrLoss;               // Received loss (64 bits)
+        unsigned long long rxSeqErrOooDup;             // Received out-of-order + duplicates (64 bits)
+        unsigned int txOverrunCount;                   // Queued transmit overrun indications
+        unsigned int txOverrunTotal;                   // Queued transmit overrun total count
+        unsigned int txBurstCount;                     // Transmitted bursts
+        unsigned int txBurstTotal;                     // Transmitted burst total count
+        unsigned int rxBurstCount;                     // Received bursts
+        unsigned int rxBurstTotal;                     // Received burst total count
+        unsigned int fdReadyCount;                     // FD ready indications
+        unsigned int fdReadyTotal;                     // FD ready total count
+        unsigned int timCoalesceCount;                 // Timer coalesce count
+        unsigned int timCoalesceTotal;                 // Timer coalesce total
+        unsigned int txStatusMsgs;                     // Transmitted status messages
+        unsigned int rxStatusMsgs;                     // Received status messages
+        unsigned int locStatusLoss;                    // Local status messages lost
+        unsigned int remStatusLoss;                    // Remote status messages lost
+        unsigned int locTrafficStop;                   // Local traffic stop indications
+        unsigned int remTrafficStop;                   // Remote traffic stop indications
+        unsigned int rxCpuSamples;                     // Incoming CPU samples
+        unsigned int rxCpuLocal;                       // Incoming CPU samples local to process
+        unsigned int rxCpuSamplesPer[MAX_RXCPU_COUNT]; // Incoming CPU samples (per incoming CPU)
+        unsigned int rxCpuLocalPer[MAX_RXCPU_COUNT];   // Incoming CPU samples local to process (per incoming CPU)
 };
 struct perfStatsCounters {
         unsigned int setupRequestCnt;     // Setup request count
@@ -399,6 +469,38 @@ struct perfStatsCounters {
         unsigned int statusInvalidFormat; // Invalid status msg format
         unsigned int statusInvalidChksum; // Invalid status msg checksum
 };
+struct perfStatsConn {
+        unsigned long long qdBytes;     // Queued transmit bytes (64 bits)
+        unsigned long long qdDatagrams; // Queued transmit datagrams (64 bits)
+        unsigned long long txBytes;     // Transmitted bytes (64 bits)
+        unsigned long long txDatagrams; // Transmitted datagrams (64 bits)
+        unsigned long long rxBytes;     // Received bytes (64 bits)
+        unsigned long long rxDatagrams; // Received datagrams (64 bits)
+        unsigned long long busyTime;    // Processing time of connection events (ns)
+        unsigned int txOverrunCount;    // Queued transmit overrun indications
+        unsigned int txOverrunTotal;    // Queued transmit overrun total count
+        unsigned int txBurstCount;      // Transmitted bursts
+        unsigned int txBurstTotal;      // Transmitted burst total count
+        unsigned int rxBurstCount;      // Received bursts
+        unsigned int rxBurstTotal;      // Received burst total count
+        unsigned int locStatusLoss;     // Local status messages lost
+        unsigned int remStatusLoss;     // Remote status messages lost
+        unsigned int locTrafficStop;    // Local traffic stop indications
+        unsigned int remTrafficStop;    // Remote traffic stop indications
+        // The following are per record (all above are cumulative)
+        unsigned int txBurstSize;    // Transmit burst size maximum
+        unsigned int rxBurstSize;    // Receive burst size maximum
+        unsigned int srIndexUpdates; // Sending rate index updates
+        int srIndexFirst;            // Sending rate index of first update
+        int srIndexMin;              // Sending rate index minimum
+        int srIndexMax;              // Sending rate index maximum
+};
+struct sysCallCounters {
+        unsigned long long txCalls;  // Send syscalls issued (64 bits)
+        unsigned long long txDgrams; // Messages accepted by send syscalls (64 bits)
+        unsigned long long rxCalls;  // Receive syscalls issued (64 bits)
+        unsigned long long rxDgrams; // Messages returned by receive syscalls (64 bits)
+};
 struct repository {
         struct timespec systemClock;          // Clock reference (CLOCK_REALTIME)
         struct timespec startTime;            // Process start time
@@ -408,12 +510,14 @@ struct repository {
         int mcIdent;                          // Multi-connection identifier
         struct sendingRate *sendingRates;     // Sending rate table (array)
         int maxSendingRates;                  // Size (rows) of sending rate table
+        int maxContIndex;                     // Max index of continuous sending rates
         char *sndBuffer;                      // Send buffer for load PDUs
         char *defBuffer;                      // Default buffer for general I/O
         char *randData;                       // Randomized seed data
         char *sndBufRand;                     // Send buffer for randomized load PDUs
         char *rcvDataPtr;                     // Received data pointer for load PDUs
         int rcvDataSize;                      // Received data size in default buffer
+        int rcvEcn;                           // Received ECN codepoint of load PDU
         struct sockaddr_storage remSas;       // Remote IP sockaddr storage
         socklen_t remSasLen;                  // Remote IP sockaddr storage length
         BOOL isServer;                        // Execute as server
@@ -426,20 +530,19 @@ struct repository {
         int endTimeStatus;                    // Exit status when end time expires
         int actConnCount;                     // Active testing connection count
         int sisConnCount;                     // Sub-interval stats connection count
+        int convConnCount;                    // Connections stopped early on convergence
         BOOL testHdrDone;                     // Test header creation complete
         double siAggRateL3;                   // Sub-interval L3 aggregate rate
         double siAggRateL2;                   // Sub-interval L2 aggregate rate
         double siAggRateL1;                   // Sub-interval L1 aggregate rate
         double siAggRateL0;                   // Sub-interval L1+VLAN aggregate rate
         struct testSummary testSum[2];        // Test summary statistics (bimodal)
-        int intfFD;                           // File descriptor to read interface data
-        int intfFDAlt;                        // Interface FD (alternate direction)
-        unsigned long long intfBytes;         // Last byte counter of interface data
-        unsigned long long intfBytesAlt;      // Interface data (alternate direction)
+        int intfFD;                           // Netlink socket to obtain interface data
         struct timespec intfTime;             // Sample time of interface data
         struct timespec timeOfMax[2];         // Time of maximums (bimodal)
         char *psBuffer;                       // Performance statistics output buffer
         int psBufSize;                        // Performance statistics buffer size
+        int psBufAlloc;                       // Performance statistics buffer allocation
         FILE *psFilePtr;                      // Performance statistics file pointer
         time_t psFileTime;                    // Performance statistics file time (sec)
         struct timespec psRecordTime;         // Performance statistics record time
@@ -447,8 +550,12 @@ struct repository {
         struct perfStatsCounters psCounters;  // Performance statistics (Counters)
         struct perfStatsMaximums psMaximums;  // Performance statistics (Maximums)
         struct perfStatsAverages psAverages;  // Performance statistics (Averages)
+        BOOL psActive;                        // Performance statistics collection active
+        struct txSchedSet *txSched;           // Transmit schedule accuracy (see udpst_histo.h)
+        struct sysCallCounters sysCalls;      // Send/receive syscall counters (see udpst_cpu.h)
         int actConnections[2];                // Active testing connections (bimodal)
         struct subIntStats sisMax[2];         // Sub-interval maximum stats (bimodal)
+        unsigned long long delayVarSumMax[2]; // Sub-interval maximum delay variation sum (bimodal)
         double rateMaxL3[2];                  // L3 rate maximums (bimodal)
         double rateMaxL2[2];                  // L2 rate maximums (bimodal)
         double rateMaxL1[2];                  // L1 rate maximums (bimodal)
@@ -463,6 +570,31 @@ struct repository {
 };
 //----------------------------------------------------------------------------
 //
+// Rate adjustment algorithm private state (per connection)
+//
+struct raStateC {
+        int retryCount;  // Waiting timer till next multiplicative retry
+        int retryThresh; // Threshold for multiplicative retry
+        BOOL update;     // Indicates when max send rate was updated
+};
+#define RA_PHASE_EXPAND 0
+#define RA_PHASE_BISECT 1
+#define RA_PHASE_TRACK  2
+struct raStateD {
+        int phase;       // Search phase
+        int lower;       // Highest index without congestion
+        int upper;       // Lowest index above capacity (-1 = none)
+        int delay;       // Delay at last decision (ms)
+        int congCount;   // Consecutive congested trials
+        int settle;      // Trials remaining before next decision
+        BOOL congSubInt; // Congestion or delay seen during sub-interval
+};
+union raState {
+        struct raStateC c; // Algorithm C
+        struct raStateD d; // Algorithm D
+};
+//----------------------------------------------------------------------------
+//
 // Data structure representing a connection to a device, file, socket, etc.
 //
 struct connection {
@@ -472,7 +604,8 @@ struct connection {
 #define T_CONSOLE  2
 #define T_LOG      3
 #define T_NULL     4
-#define T_MAXTYPES 5
+#define T_METRICS  5
+#define T_MAXTYPES 6
         int type;       // Connection type
         int subType;    // Connection subtype
         BOOL connected; // Socket was connected
@@ -498,37 +631,67 @@ struct connection {
         char remAddr[INET6_ADDR_STRLEN]; // Remote IP address as string
         int remPort;                     // Remote port
         FILE *outputFPtr;                // Output file pointer
+        struct exportRing *exportRing;   // Output ring (binary export)
+        struct histoSet *histo;          // Delay/RTT variation histograms
+        char *metricsBuf;                // Metrics endpoint response buffer
+        int metricsLen;                  // Metrics endpoint response length
+        int metricsSent;                 // Metrics endpoint response offset sent
+        struct perfStatsConn psConn;     // Per-connection performance statistics
+        struct perfStatsConn psConnRec;  // Per-connection performance statistics at last record
+        int incomingCpu;                 // Incoming CPU of receive traffic
+        int rssQueue;                    // RSS queue selected for receive traffic
         //
-        int srIndex;                 // Sending rate index
-        struct sendingRate srStruct; // Sending rate structure
-        int srAdjSuppCount;          // Sending rate adj. suppression count
-        unsigned int lpduSeqNo;      // Load PDU sequence number
-        unsigned int spduSeqNo;      // Status PDU sequence number
-        int spduSeqErr;              // Status PDU sequence error count
+        int srIndex;                  // Sending rate index
+        struct sendingRate srStruct;  // Sending rate structure (synthesized if server)
+        int srStructIndex;            // Index of synthesized sending rate structure
+        BOOL srContinuous;            // Continuous (table-free) sending rates
+        int srAdjSuppCount;           // Sending rate adj. suppression count
+        unsigned long long lpduSeqNo; // Load PDU sequence number (64 bits, extended from wire)
+        unsigned int spduSeqNo;       // Status PDU sequence number
+        int spduSeqErr;               // Status PDU sequence error count
         //
         int protocolVer; // Protocol version
         int mcIndex;     // Multi-connection index
         int mcCount;     // Multi-connection count
         int mcIdent;     // Multi-connection identifier
         //
-        int maxBandwidth;    // Required bandwidth
-        int lowThresh;       // Low delay variation threshold
-        int upperThresh;     // Upper delay variation threshold
-        int slowAdjThresh;   // Slow rate adjustment threshold
-        int slowAdjCount;    // Slow rate adjustment counter
-        int trialInt;        // Status feedback/trial interval (ms)
-        int testIntTime;     // Test interval time (sec)
-        int subIntPeriod;    // Sub-interval period (ms)
-        int srIndexConf;     // Configured sending rate index
-        BOOL srIndexIsStart; // Configured SR index is starting point
-        int highSpeedDelta;  // High-speed row adjustment delta
-        int seqErrThresh;    // Sequence error threshold
-        BOOL randPayload;    // Payload randomization
-        int rateAdjAlgo;     // Rate adjustment algorithm
+        int maxBandwidth;     // Required bandwidth
+        int lowThresh;        // Low delay variation threshold
+        int upperThresh;      // Upper delay variation threshold
+        int slowAdjThresh;    // Slow rate adjustment threshold
+        int slowAdjCount;     // Slow rate adjustment counter
+        int trialInt;         // Status feedback/trial interval (ms)
+        int trialIntConf;     // Configured (initial) trial interval
+        BOOL trialAdapt;      // RTT-adaptive trial interval
+        int testIntTime;      // Test interval time (sec)
+        int subIntPeriod;     // Sub-interval period (ms)
+        int srIndexConf;      // Configured sending rate index
+        BOOL srIndexIsStart;  // Configured SR index is starting point
+        int highSpeedDelta;   // High-speed row adjustment delta
+        int seqErrThresh;     // Sequence error threshold
+        int seqErrThreshConf; // Configured sequence error threshold
+        BOOL randPayload;     // Payload randomization
+        int rateAdjAlgo;      // Rate adjustment algorithm
+        //
+        union raState raState;      // Rate adjustment algorithm private state
+        unsigned int raSubIntSeqNo; // Sub-interval of last algorithm update
+        //
+        int convCount;                // Convergence stop sub-interval count
+        int convTol;                  // Convergence stop tolerance (%)
+        int convHeld;                 // Sub-intervals maximum has held
+        int convSrMin;                // Min sending rate index while held
+        int convSrMax;                // Max sending rate index while held
+        double convMaxRate;           // Maximum sub-interval rate (Mbps)
+        unsigned int convSubIntSeqNo; // Sub-interval of last convergence check
+        BOOL convStopped;             // Test stopped early on convergence
         //
-        int algoCRetryCount;  // AlgoC: Waiting timer till next multiplicative retry
-        int algoCRetryThresh; // AlgoC: Threshold for multiplicative retry
-        BOOL algoCUpdate;     // AlgoC: Indicates when max send rate was updated
+        int ecnCeThresh; // ECN CE-marked congestion threshold (%)
+        BOOL ecnRecv;    // ECN codepoints received via cmsg
+        //
+        int rateLimit;          // Rate ceiling (Mbps, 0 = none)
+        int rateLimitIndex;     // Sending rate index limit for rate ceiling
+        long long tbTokens;     // Rate ceiling token bucket level (bytes)
+        struct timespec tbTime; // Rate ceiling token bucket update time
         //
         int authMode;                            // Authentication mode
         unsigned char clientKey[SHA256_KEY_LEN]; // Client key via KDF
@@ -544,6 +707,10 @@ struct connection {
         struct timespec timer3Thresh; // Third timer threshold
         int (*timer3Action)(int);     // Third action upon expiry
         //
+        struct timespec txLastTime[2]; // Last burst send time (per transmitter)
+        unsigned int txLastGap[2];     // Last achieved inter-burst gap (us, 0 = none)
+        unsigned int txLastInt[2];     // Intended gap to next burst (us)
+        //
         struct timespec subIntClock; // Sub-interval clock
         unsigned int accumTime;      // Accumulated time
         unsigned int subIntSeqNo;    // Sub-interval sequence number
@@ -553,29 +720,41 @@ struct connection {
         //
 #define LPDU_HISTORY_SIZE 32 // Size must be power of 2
 #define LPDU_HISTORY_MASK (LPDU_HISTORY_SIZE - 1)
-        unsigned int lpduHistBuf[LPDU_HISTORY_SIZE]; // History buffer of last seq numbers
-        unsigned int lpduHistIdx;                    // History buffer index of next seq number
-        BOOL ignoreOooDup;                           // Ignore Out-of-Order/Duplicate datagrams
-        unsigned int seqErrLoss;                     // Loss sum
-        unsigned int seqErrOoo;                      // Out-of-Order sum
-        unsigned int seqErrDup;                      // Duplicate sum
+        unsigned long long lpduHistBuf[LPDU_HISTORY_SIZE]; // History buffer of last seq numbers
+        unsigned int lpduHistIdx;                          // History buffer index of next seq number
+        BOOL ignoreOooDup;                                 // Ignore Out-of-Order/Duplicate datagrams
+        unsigned int seqErrLoss;                           // Loss sum
+        unsigned int seqErrOoo;                            // Out-of-Order sum
+        unsigned int seqErrDup;                            // Duplicate sum
+        //
+        BOOL useOwDelVar;                  // Use one-way delay instead of RTT
+        int clockDeltaMin;                 // Clock delta minimum
+        unsigned int delayVarMin;          // Delay variation minimum
+        unsigned int delayVarMax;          // Delay variation maximum
+        unsigned long long delayVarSum;    // Delay variation sum (64 bits)
+        unsigned int delayVarCnt;          // Delay variation count
+        unsigned long long sisDelayVarSum; // Sub-interval delay variation sum (64 bits, active)
+        unsigned long long sisDelayVarSav; // Sub-interval delay variation sum (64 bits, saved)
+        unsigned int rttMinimum;           // Minimum round-trip time
+        unsigned int rttVarSample;         // Last RTT variation sample
+        unsigned long long rttVarSum;      // RTT variation sum (64 bits)
+        unsigned int rttVarCnt;            // RTT variation count
+        BOOL delayMinUpd;                  // Delay minimum(s) updated
         //
-        BOOL useOwDelVar;          // Use one-way delay instead of RTT
-        int clockDeltaMin;         // Clock delta minimum
-        unsigned int delayVarMin;  // Delay variation minimum
-        unsigned int delayVarMax;  // Delay variation maximum
-        unsigned int delayVarSum;  // Delay variation sum
-        unsigned int delayVarCnt;  // Delay variation count
-        unsigned int rttMinimum;   // Minimum round-trip time
-        unsigned int rttVarSample; // Last RTT variation sample
-        unsigned int rttVarSum;    // RTT variation sum
-        unsigned int rttVarCnt;    // RTT variation count
-        BOOL delayMinUpd;          // Delay minimum(s) updated
+        BOOL delayUsec;                   // Delay variation thresholds in usec
+        long long clockDeltaMinUs;        // Clock delta minimum (us)
+        unsigned int delayVarMinUs;       // Delay variation minimum (us)
+        unsigned int delayVarMaxUs;       // Delay variation maximum (us)
+        unsigned long long delayVarSumUs; // Delay variation sum (us)
+        unsigned int rttMinimumUs;        // Minimum round-trip time (us)
+        unsigned int rttVarSampleUs;      // Last RTT variation sample (us)
         //
         struct timespec trialIntClock; // Trial interval clock
         unsigned int tiDeltaTime;      // Trial interval delta time
         unsigned int tiRxDatagrams;    // Trial interval receive datagrams
-        unsigned int tiRxBytes;        // Trial interval receive bytes
+        unsigned long long tiRxBytes;  // Trial interval receive bytes (64 bits)
+        unsigned int tiRxEct;          // Trial interval receive ECT (incl. CE)
+        unsigned int tiRxCe;           // Trial interval receive CE-marked
         //
         int infoCount;             // Info message count
         int warningCount;          // Warning message count
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_analyze.c
+ *
+ * This file contains a standalone utility to analyze a binary output (export)
+ * archive file of received load metadata. The archive is memory-mapped and its
+ * columns are scanned directly to produce loss run, reordering, delay
+ * percentile and per-window rate statistics.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+//
+#include "udpst_common.h"
+#include "udpst_export.h"
+#include "udpst_archive.h"
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+#define DEF_WINDOW     1000    // Rate window (ms)
+#define MIN_WINDOW     10      //
+#define MAX_WINDOW     60000   //
+#define L3DG_OVERHEAD  (8 + 20) // UDP + IPv4 (see udpst.h)
+#define IPV6_ADDSIZE   20       // IPv6 additional size (over IPv4)
+#define RUN_BUCKETS    5        // Loss run length buckets (1, 2-3, 4-7, 8-15, 16+)
+#define PCTL_COUNT     6        // Percentiles reported
+static const double pctlValue[PCTL_COUNT] = {50.0, 90.0, 95.0, 99.0, 99.9, 100.0};
+static const char *pctlText[PCTL_COUNT]   = {"P50", "P90", "P95", "P99", "P99.9", "Max"};
+static const char *runText[RUN_BUCKETS]   = {"1", "2-3", "4-7", "8-15", "16+"};
+//
+struct window {
+        uint64_t datagrams; // Received datagrams
+        uint64_t bytes;     // Received L3 bytes
+};
+struct analysis {
+        uint64_t records;                // Records scanned
+        int64_t seqMin;                  // Minimum sequence number (unwrapped)
+        int64_t seqMax;                  // Maximum sequence number (unwrapped)
+        int64_t *seq;                    // Sequence numbers (unwrapped to 64 bits)
+        uint64_t unique;                 // Unique sequence numbers
+        uint64_t duplicates;             // Duplicate datagrams
+        uint64_t lost;                   // Lost datagrams
+        uint64_t lossRuns;               // Loss runs (consecutive lost datagrams)
+        uint64_t lossRunMax;             // Longest loss run
+        uint64_t runBucket[RUN_BUCKETS]; // Loss run length histogram
+        uint64_t reordered;              // Datagrams below running maximum
+        uint64_t reorderMax;             // Largest reorder extent
+        uint64_t reorderSum;             // Sum of reorder extents
+        int64_t *owd;                    // One-way delay samples (us)
+        uint32_t *rtt;                   // RTT samples (ms)
+        uint64_t rttCount;               // RTT sample count
+        struct window *win;              // Rate windows
+        uint64_t winCount;               // Rate windows used
+        uint64_t winMax;                 // Rate windows allocated
+};
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void unwrap_seqno(struct archive *, struct analysis *);
+int scan_archive(struct archive *, struct analysis *, uint64_t *, int, uint64_t);
+void scan_bitmap(struct analysis *, uint64_t *, uint64_t);
+int64_t select_kth(int64_t *, uint64_t, uint64_t);
+void output_pctl(char *, int64_t *, uint64_t, double);
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Analyze binary output (export) archive file
+//
+int main(int argc, char **argv) {
+        int i, overhead = L3DG_OVERHEAD, window = DEF_WINDOW;
+        BOOL summary = FALSE;
+        uint64_t n, span, *bitmap;
+        int64_t *rtt;
+        struct archive ar;
+        struct analysis an;
+        struct window *w;
+
+        while ((i = getopt(argc, argv, "w:6s")) != -1) {
+                switch (i) {
+                case 'w':
+                        window = atoi(optarg);
+                        if (window < MIN_WINDOW || window > MAX_WINDOW) {
+                                fprintf(stderr, "ERROR: Window <%d> out-of-range (%d-%d)\n", window, MIN_WINDOW, MAX_WINDOW);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case '6':
+                        overhead = L3DG_OVERHEAD + IPV6_ADDSIZE;
+                        break;
+                case 's':
+                        summary = TRUE;
+                        break;
+                default:
+                        fprintf(stderr, "Usage: %s [-w window] [-6] [-s] binfile\n", argv[0]);
+                        fprintf(stderr, "    -w window   Rate window in ms [Default %d]\n", DEF_WINDOW);
+                        fprintf(stderr, "    -6          Rates include IPv6 (instead of IPv4) overhead\n");
+                        fprintf(stderr, "    -s          Summary only (no per-window rates)\n");
+                        return EXIT_FAILURE;
+                }
+        }
+        if (optind != argc - 1) {
+                fprintf(stderr, "Usage: %s [-w window] [-6] [-s] binfile\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+        if (archive_open(&ar, argv[optind]) < 0)
+                return EXIT_FAILURE;
+        printf("Archive: %s, Chunks: %llu, Records: %llu, Ring Overflow: %u\n", argv[optind], (unsigned long long) ar.chunks,
+               (unsigned long long) ar.records, ar.eh->overflow);
+        if (ar.records == 0) {
+                archive_close(&ar);
+                return EXIT_SUCCESS;
+        }
+
+        //
+        // Allocate sample arrays, then find sequence range (needed to size received bitmap)
+        //
+        memset(&an, 0, sizeof(an));
+        an.owd = malloc(ar.records * sizeof(int64_t));
+        an.rtt = malloc(ar.records * sizeof(uint32_t));
+        an.seq = malloc(ar.records * sizeof(int64_t));
+        if (an.owd == NULL || an.rtt == NULL || an.seq == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation failure for samples\n");
+                archive_close(&ar);
+                return EXIT_FAILURE;
+        }
+        unwrap_seqno(&ar, &an);
+        span = (uint64_t) (an.seqMax - an.seqMin) + 1;
+        if ((bitmap = calloc((span + 63) / 64, sizeof(uint64_t))) == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation failure for sequence bitmap\n");
+                archive_close(&ar);
+                return EXIT_FAILURE;
+        }
+
+        //
+        // Scan all chunks, then derive loss runs from bitmap
+        //
+        if (scan_archive(&ar, &an, bitmap, overhead, (uint64_t) window * NSECINMSEC) < 0) {
+                archive_close(&ar);
+                return EXIT_FAILURE;
+        }
+        scan_bitmap(&an, bitmap, span);
+        free(bitmap);
+
+        //
+        // Output sequence based results
+        //
+        printf("Sequence Range: %lld-%lld, Received: %llu, Unique: %llu, Duplicates: %llu\n", (long long) an.seqMin,
+               (long long) an.seqMax, (unsigned long long) an.records, (unsigned long long) an.unique,
+               (unsigned long long) an.duplicates);
+        printf("Loss: %llu (Ratio %.2E), Runs: %llu, Longest Run: %llu, Run Lengths", (unsigned long long) an.lost,
+               (double) an.lost / (double) span, (unsigned long long) an.lossRuns, (unsigned long long) an.lossRunMax);
+        for (i = 0; i < RUN_BUCKETS; i++)
+                printf(" [%s]: %llu", runText[i], (unsigned long long) an.runBucket[i]);
+        printf("\nReordered: %llu, Max Extent: %llu, Avg Extent: %.2f\n", (unsigned long long) an.reordered,
+               (unsigned long long) an.reorderMax, an.reordered > 0 ? (double) an.reorderSum / (double) an.reordered : 0.0);
+
+        //
+        // Output delay percentiles (one-way delay as variation above minimum)
+        //
+        output_pctl("One-Way Delay Variation(ms)", an.owd, an.records, 1000.0);
+        if (an.rttCount > 0) {
+                rtt = (int64_t *) an.owd; // Reuse one-way delay samples array (no longer needed)
+                for (n = 0; n < an.rttCount; n++)
+                        rtt[n] = an.rtt[n];
+                output_pctl("Round-Trip Time Variation(ms)", rtt, an.rttCount, 1.0);
+        }
+
+        //
+        // Output per-window rates
+        //
+        if (!summary) {
+                for (n = 0, w = an.win; n < an.winCount; n++, w++) {
+                        printf("Window[%llu](sec): %.3f, Datagrams: %llu, Mbps(L3/IP): %.2f\n", (unsigned long long) n + 1,
+                               (double) ((n + 1) * window) / MSECINSEC, (unsigned long long) w->datagrams,
+                               ((double) w->bytes * 8.0) / ((double) window * 1000.0));
+                }
+        }
+        free(an.win);
+        free(an.owd);
+        free(an.rtt);
+        free(an.seq);
+        archive_close(&ar);
+        return EXIT_SUCCESS;
+}
+//----------------------------------------------------------------------------
+//
+// Extend the 32-bit sequence numbers of all records to 64 bits and find their range
+//
+// NOTE: Each is extended relative to the previous record (serial number arithmetic, as done by the load receiver),
+// so that a wrap during a long high-rate test is neither seen as a huge range nor as reordering
+//
+void unwrap_seqno(struct archive *ar, struct analysis *an) {
+        uint32_t j;
+        uint64_t n, k = 0;
+        int64_t prev = 0;
+
+        for (n = 0; n < ar->chunks; n++) {
+                struct exportChunk *ec = archive_chunk(ar, n);
+                uint32_t *seqno        = ARCHIVE_COL(ec, EXPCOL_SEQNO, uint32_t);
+
+                for (j = 0; j < ec->records; j++, k++) {
+                        if (k == 0) {
+                                prev       = (int64_t) seqno[j];
+                                an->seqMin = prev;
+                                an->seqMax = prev;
+                        } else {
+                                prev += (int64_t) (int32_t) (seqno[j] - (uint32_t) prev);
+                        }
+                        an->seq[k] = prev;
+                        if (prev < an->seqMin)
+                                an->seqMin = prev;
+                        else if (prev > an->seqMax)
+                                an->seqMax = prev;
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Scan columns of each chunk for delay samples, reordering, duplicates and window rates
+//
+// Output error to stderr and return -1 on failure
+//
+int scan_archive(struct archive *ar, struct analysis *an, uint64_t *bitmap, int overhead, uint64_t window) {
+        uint32_t j;
+        int64_t runmax = 0;
+        uint64_t n, k, bit, mask, rxbase = 0;
+        struct window *w;
+
+        for (n = 0; n < ar->chunks; n++) {
+                struct exportChunk *ec = archive_chunk(ar, n);
+                int64_t *seqno         = &an->seq[an->records];
+                uint16_t *payload      = ARCHIVE_COL(ec, EXPCOL_PAYLOAD, uint16_t);
+                uint8_t *flags         = ARCHIVE_COL(ec, EXPCOL_FLAGS, uint8_t);
+                uint64_t *srctx        = ARCHIVE_COL(ec, EXPCOL_SRCTX, uint64_t);
+                uint64_t *dstrx        = ARCHIVE_COL(ec, EXPCOL_DSTRX, uint64_t);
+                uint32_t *rtt          = ARCHIVE_COL(ec, EXPCOL_RTT, uint32_t);
+                int64_t *owd           = &an->owd[an->records];
+
+                //
+                // One-way delay in us (vectorized)
+                //
+                for (j = 0; j < ec->records; j++)
+                        owd[j] = ((int64_t) dstrx[j] - (int64_t) srctx[j]) / NSECINUSEC;
+
+                //
+                // RTT samples
+                //
+                for (j = 0; j < ec->records; j++) {
+                        if (flags[j] & EXPREC_RTT)
+                                an->rtt[an->rttCount++] = rtt[j];
+                }
+
+                //
+                // Reordering (relative to running maximum) and duplicates (via received bitmap)
+                //
+                for (j = 0; j < ec->records; j++) {
+                        if (an->records + j == 0) {
+                                runmax = seqno[j];
+                        } else if (seqno[j] < runmax) {
+                                an->reordered++;
+                                an->reorderSum += (uint64_t) (runmax - seqno[j]);
+                                if ((uint64_t) (runmax - seqno[j]) > an->reorderMax)
+                                        an->reorderMax = (uint64_t) (runmax - seqno[j]);
+                        } else {
+                                runmax = seqno[j];
+                        }
+                        bit  = (uint64_t) (seqno[j] - an->seqMin);
+                        mask = (uint64_t) 1 << (bit & 63);
+                        if (bitmap[bit >> 6] & mask) {
+                                an->duplicates++;
+                        } else {
+                                bitmap[bit >> 6] |= mask;
+                                an->unique++;
+                        }
+                }
+
+                //
+                // Window rates (based on receive time relative to first datagram)
+                //
+                if (an->records == 0 && ec->records > 0)
+                        rxbase = dstrx[0];
+                for (j = 0; j < ec->records; j++) {
+                        k = (dstrx[j] > rxbase) ? (dstrx[j] - rxbase) / window : 0;
+                        if (k >= an->winMax) {
+                                an->winMax = (k + 1) * 2;
+                                if ((w = realloc(an->win, an->winMax * sizeof(struct window))) == NULL) {
+                                        fprintf(stderr, "ERROR: Memory allocation failure for rate windows\n");
+                                        return -1;
+                                }
+                                memset(&w[an->winCount], 0, (an->winMax - an->winCount) * sizeof(struct window));
+                                an->win = w;
+                        }
+                        if (k >= an->winCount)
+                                an->winCount = k + 1;
+                        an->win[k].datagrams++;
+                        an->win[k].bytes += (uint64_t) payload[j] + (uint64_t) overhead;
+                }
+                an->records += ec->records;
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Count lost datagrams and loss runs from received bitmap (skipping complete words)
+//
+void scan_bitmap(struct analysis *an, uint64_t *bitmap, uint64_t span) {
+        int b;
+        uint64_t i, words, bits, run = 0;
+
+        words = (span + 63) / 64;
+        for (i = 0; i < words; i++) {
+                bits = bitmap[i];
+                if (i == words - 1 && (span & 63) != 0)
+                        bits |= ~(((uint64_t) 1 << (span & 63)) - 1); // Treat bits beyond range as received
+                if (bits == UINT64_MAX && run == 0)
+                        continue;
+                for (b = 0; b < 64; b++) {
+                        if (bits & ((uint64_t) 1 << b)) {
+                                if (run > 0) {
+                                        an->lossRuns++;
+                                        an->runBucket[run >= 16 ? 4 : (run >= 8 ? 3 : (run >= 4 ? 2 : (run >= 2 ? 1 : 0)))]++;
+                                        if (run > an->lossRunMax)
+                                                an->lossRunMax = run;
+                                        an->lost += run;
+                                        run = 0;
+                                }
+                        } else {
+                                run++;
+                        }
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Select k-th smallest sample (partially reorders array)
+//
+int64_t select_kth(int64_t *a, uint64_t n, uint64_t k) {
+        uint64_t lo = 0, hi = n - 1, i, j;
+        int64_t pivot, tmp;
+
+        while (lo < hi) {
+                pivot = a[lo + (hi - lo) / 2];
+                i     = lo;
+                j     = hi;
+                while (i <= j) {
+                        while (a[i] < pivot)
+                                i++;
+                        while (a[j] > pivot)
+                                j--;
+                        if (i <= j) {
+                                tmp  = a[i];
+                                a[i] = a[j];
+                                a[j] = tmp;
+                                i++;
+                                if (j == 0)
+                                        break;
+                                j--;
+                        }
+                }
+                if (k <= j)
+                        hi = j;
+                else if (k >= i)
+                        lo = i;
+                else
+                        break;
+        }
+        return a[k];
+}
+//----------------------------------------------------------------------------
+//
+// Output minimum and percentiles of samples (relative to minimum)
+//
+void output_pctl(char *label, int64_t *samples, uint64_t count, double divisor) {
+        int i;
+        uint64_t n, k;
+        int64_t min;
+
+        for (n = 0, min = INT64_MAX; n < count; n++) // Min reduction (vectorized)
+                min = (samples[n] < min) ? samples[n] : min;
+        printf("%s Samples: %llu, Minimum: %.3f", label, (unsigned long long) count, (double) min / divisor);
+        for (i = 0; i < PCTL_COUNT; i++) {
+                k = (uint64_t) ((pctlValue[i] / 100.0) * (double) (count - 1) + 0.5);
+                printf(", %s: %.3f", pctlText[i], (double) (select_kth(samples, count, k) - min) / divisor);
+        }
+        printf("\n");
+}
+//----------------------------------------------------------------------------
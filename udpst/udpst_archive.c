@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_archive.c
+ *
+ * This file maps a binary output (export) archive file and provides access to
+ * its columnar chunks for the standalone conversion and analysis utilities.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+//
+#include "udpst_common.h"
+#include "udpst_export.h"
+#include "udpst_archive.h"
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+BOOL archive_valid(struct archive *, uint64_t);
+int archive_walk(struct archive *);
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Map archive file, validate header and obtain chunk index
+//
+// Output error to stderr and return -1 on failure
+//
+int archive_open(struct archive *ar, char *fname) {
+        uint64_t i;
+        struct stat st;
+        struct exportHeader *eh;
+
+        memset(ar, 0, sizeof(struct archive));
+        if ((ar->fd = open(fname, O_RDONLY)) < 0 || fstat(ar->fd, &st) < 0) {
+                fprintf(stderr, "OPEN ERROR: <%s> %s\n", fname, strerror(errno));
+                if (ar->fd >= 0)
+                        close(ar->fd);
+                return -1;
+        }
+        ar->size = (size_t) st.st_size;
+        if (ar->size < sizeof(struct exportHeader)) {
+                fprintf(stderr, "ERROR: <%s> is not a binary output (export) file\n", fname);
+                close(ar->fd);
+                return -1;
+        }
+        if ((ar->base = mmap(NULL, ar->size, PROT_READ, MAP_SHARED, ar->fd, 0)) == MAP_FAILED) {
+                fprintf(stderr, "MMAP ERROR: <%s> %s\n", fname, strerror(errno));
+                close(ar->fd);
+                return -1;
+        }
+        madvise(ar->base, ar->size, MADV_SEQUENTIAL);
+
+        //
+        // Validate header
+        //
+        ar->eh = eh = (struct exportHeader *) ar->base;
+        if (memcmp(eh->magic, EXPORT_MAGIC, sizeof(eh->magic)) != 0) {
+                fprintf(stderr, "ERROR: <%s> is not a binary output (export) file\n", fname);
+                archive_close(ar);
+                return -1;
+        }
+        if (eh->byteOrder != EXPORT_BYTE_ORDER) {
+                fprintf(stderr, "ERROR: File byte order does not match local system\n");
+                archive_close(ar);
+                return -1;
+        }
+        if (eh->version != EXPORT_VERSION || eh->columns != EXPCOL_MAX) {
+                fprintf(stderr, "ERROR: Unsupported file version (%u) or column count (%u)\n", eh->version, eh->columns);
+                archive_close(ar);
+                return -1;
+        }
+
+        //
+        // Use index if file was closed normally, else walk chunks
+        //
+        if (eh->indexOffset != 0 && eh->chunks > 0 && eh->indexOffset <= ar->size &&
+            eh->chunks <= (ar->size - eh->indexOffset) / sizeof(struct exportIndex)) {
+                ar->index  = (struct exportIndex *) (ar->base + eh->indexOffset);
+                ar->chunks = eh->chunks;
+                for (i = 0; i < ar->chunks; i++) {
+                        if (!archive_valid(ar, ar->index[i].offset)) {
+                                fprintf(stderr, "ERROR: Invalid chunk index entry (%llu)\n", (unsigned long long) i);
+                                archive_close(ar);
+                                return -1;
+                        }
+                        ar->records += ar->index[i].records;
+                }
+        } else if (archive_walk(ar) < 0) {
+                archive_close(ar);
+                return -1;
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Validate chunk at file offset
+//
+BOOL archive_valid(struct archive *ar, uint64_t offset) {
+        int i;
+        static const int colsize[EXPCOL_MAX] = EXPCOL_SIZES;
+        struct exportChunk *ec;
+
+        if (offset % EXPORT_ALIGN != 0 || offset + sizeof(struct exportChunk) > ar->size)
+                return FALSE;
+        ec = (struct exportChunk *) (ar->base + offset);
+        if (ec->chunkId != EXPCHUNK_ID || ec->columns != EXPCOL_MAX || ec->chunkSize > ar->size - offset)
+                return FALSE;
+        for (i = 0; i < EXPCOL_MAX; i++) {
+                if (ec->colOffset[i] % EXPORT_ALIGN != 0 ||
+                    (uint64_t) ec->colOffset[i] + ((uint64_t) ec->records * colsize[i]) > ec->chunkSize)
+                        return FALSE;
+        }
+        return TRUE;
+}
+//----------------------------------------------------------------------------
+//
+// Build index by walking chunks sequentially (file not closed normally)
+//
+int archive_walk(struct archive *ar) {
+        uint64_t offset, max = 0;
+        struct exportChunk *ec;
+        struct exportIndex *ei;
+
+        for (offset = sizeof(struct exportHeader); archive_valid(ar, offset); offset += ec->chunkSize) {
+                ec = (struct exportChunk *) (ar->base + offset);
+                if (ar->chunks >= max) {
+                        max = (max == 0) ? 64 : max * 2;
+                        if ((ei = realloc(ar->index, max * sizeof(struct exportIndex))) == NULL) {
+                                fprintf(stderr, "ERROR: Memory allocation failure for chunk index\n");
+                                return -1;
+                        }
+                        ar->index      = ei;
+                        ar->indexAlloc = TRUE;
+                }
+                ei           = &ar->index[ar->chunks++];
+                ei->offset   = offset;
+                ei->records  = ec->records;
+                ei->reserved = 0;
+                ar->records += ec->records;
+        }
+        fprintf(stderr, "WARNING: File was not closed normally (recovered %llu chunks)\n",
+                (unsigned long long) ar->chunks);
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain chunk by index
+//
+struct exportChunk *archive_chunk(struct archive *ar, uint64_t n) {
+        if (n >= ar->chunks)
+                return NULL;
+        return (struct exportChunk *) (ar->base + ar->index[n].offset);
+}
+//----------------------------------------------------------------------------
+//
+// Unmap and close archive
+//
+void archive_close(struct archive *ar) {
+        if (ar->indexAlloc)
+                free(ar->index);
+        if (ar->base != NULL && ar->base != MAP_FAILED)
+                munmap(ar->base, ar->size);
+        if (ar->fd >= 0)
+                close(ar->fd);
+        memset(ar, 0, sizeof(struct archive));
+        ar->fd = -1;
+}
+//----------------------------------------------------------------------------
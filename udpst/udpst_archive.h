@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_archive.h
+ *
+ * This file contains the definitions and external function prototypes used by
+ * the standalone utilities that read binary output (export) archive files.
+ *
+ */
+
+#ifndef UDPST_ARCHIVE_H
+#define UDPST_ARCHIVE_H
+
+//----------------------------------------------------------------------------
+//
+// Memory-mapped archive
+//
+struct archive {
+        int fd;                    // File descriptor
+        size_t size;               // File size
+        unsigned char *base;       // Mapped file
+        struct exportHeader *eh;   // File header
+        uint64_t chunks;           // Chunks available
+        uint64_t records;          // Records available
+        struct exportIndex *index; // Chunk index (from file or walked)
+        BOOL indexAlloc;           // Index allocated (not mapped)
+};
+//
+// Access column array of chunk
+//
+#define ARCHIVE_COL(ec, col, type) ((type *) ((unsigned char *) (ec) + (ec)->colOffset[col]))
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int archive_open(struct archive *, char *);
+extern struct exportChunk *archive_chunk(struct archive *, uint64_t);
+extern void archive_close(struct archive *);
+
+#endif /* UDPST_ARCHIVE_H */
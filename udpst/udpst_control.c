@@ -108,7 +108,16 @@
 #include "udpst_protocol.h"
 #include "udpst.h"
 #include "udpst_control.h"
+#include "udpst_cpu.h"
 #include "udpst_data.h"
+#include "udpst_export.h"
+#include "udpst_histo.h"
+#include "udpst_probe.h"
+#include "udpst_psconn.h"
+#include "udpst_rss.h"
+#include "udpst_ralgo.h"
+#include "udpst_shmstats.h"
+#include "udpst_srates.h"
 #ifndef __linux__
 #include "../udpst_control_alt2.h"
 #endif
@@ -120,6 +129,10 @@
 int timeout_testinit(int);
 int service_actreq(int);
 int service_actresp(int);
+int sock_options(int, int);
+void sock_busypoll(int);
+int sock_recvecn(int);
+int sock_rebind(int, int);
 int sock_connect(int);
 int connected(int);
 int open_outputfile(int);
@@ -148,14 +161,15 @@ extern cJSON *json_top, *json_output;
 //
 // Global data
 //
-#define SRAUTO_TEXT "<Auto>"
-#define OWD_TEXT    "OWD"
-#define RTT_TEXT    "RTT"
-#define ZERO_TEXT   "zeroes"
-#define RAND_TEXT   "random"
+#define SRAUTO_TEXT   "<Auto>"
+#define SRCONT_SUFFIX "/Cont"
+#define OWD_TEXT      "OWD"
+#define RTT_TEXT      "RTT"
+#define ZERO_TEXT     "zeroes"
+#define RAND_TEXT     "random"
 #define TESTHDR_LINE                                                                                                     \
-        "%s%s Test Int(sec): %d, DelayVar Thresh(ms): %d-%d [%s], Trial Int(ms): %d, Ignore OoO/Dup: %s, Payload: %s,\n" \
-        "  ID: %d, SR Index: %s, Cong. Thresh: %d, HS Delta: %d, SeqErr Thresh: %d, Algo: %s, Conn: %d, DSCP+ECN: %d%s\n"
+        "%s%s Test Int(sec): %d, DelayVar Thresh(%s): %d-%d [%s], Trial Int(ms): %d%s, Ignore OoO/Dup: %s, Payload: %s,\n" \
+        "  ID: %d, SR Index: %s, Cong. Thresh: %d, HS Delta: %d, SeqErr Thresh: %d, Algo: %s, Conn: %d, DSCP+ECN: %d%s%s\n"
 
 //----------------------------------------------------------------------------
 // Function definitions
@@ -188,6 +202,16 @@ void init_conn(int connindex, BOOL cleanup) {
                 }
                 if (c->outputFPtr != NULL)
                         fclose(c->outputFPtr);
+                if (c->exportRing != NULL)
+                        export_close(connindex);
+                if (c->histo != NULL)
+                        histo_free(connindex);
+                if (c->metricsBuf != NULL)
+                        free(c->metricsBuf);
+                if (conf.shmStats)
+                        shmstats_clear(connindex);
+                if (conf.psConn && conf.psFile != NULL && c->type == T_UDP && c->testType != TEST_TYPE_UNK)
+                        psconn_close(connindex);
         }
 
         //
@@ -198,12 +222,15 @@ void init_conn(int connindex, BOOL cleanup) {
         //
         // Initialize non-zero values
         //
-        c->fd           = -1;
-        c->priAction    = &null_action;
-        c->secAction    = &null_action;
-        c->timer1Action = &null_action;
-        c->timer2Action = &null_action;
-        c->timer3Action = &null_action;
+        c->fd            = -1;
+        c->incomingCpu   = -1;
+        c->rssQueue      = -1;
+        c->srStructIndex = -1;
+        c->priAction     = &null_action;
+        c->secAction     = &null_action;
+        c->timer1Action  = &null_action;
+        c->timer2Action  = &null_action;
+        c->timer3Action  = &null_action;
 
         return;
 }
@@ -224,9 +251,9 @@ int null_action(int connindex) {
 //
 int send_setupreq(int connindex, int mcIndex, int serverIndex) {
         register struct connection *c = &conn[connindex], *a;
-        int i, fd, var;
+        int var;
         struct timespec tspecvar;
-        char addrstr[INET6_ADDR_STRLEN], portstr[8], intfpath[IFNAMSIZ + 64];
+        char addrstr[INET6_ADDR_STRLEN], portstr[8];
         struct controlHdrSR *cHdrSR = (struct controlHdrSR *) repo.defBuffer;
 #ifdef AUTH_KEY_ENABLE
         char *key;
@@ -236,27 +263,6 @@ int send_setupreq(int connindex, int mcIndex, int serverIndex) {
         // Additional initialization on first setup request
         //
         if (c->mcIndex == 0) {
-                //
-                // Open local sysfs interface statistics
-                //
-                if (*conf.intfName) {
-                        for (i = 0; i < 2; i++) {
-                                var = sprintf(intfpath, "/sys/class/net/%s/statistics/", conf.intfName);
-                                if ((conf.usTesting && i == 0) || (conf.dsTesting && i == 1))
-                                        strcat(&intfpath[var], "tx_bytes");
-                                else
-                                        strcat(&intfpath[var], "rx_bytes");
-                                if ((fd = open(intfpath, O_RDONLY)) < 0) {
-                                        var = sprintf(scratch, "OPEN ERROR: %s (%s)\n", strerror(errno), intfpath);
-                                        send_proc(errConn, scratch, var);
-                                        return -1;
-                                }
-                                if (i == 0)
-                                        repo.intfFD = fd;
-                                else
-                                        repo.intfFDAlt = fd;
-                        }
-                }
                 //
                 // Init aggregate connection and aggregate query timer
                 //
@@ -395,7 +401,7 @@ int timeout_testinit(int connindex) {
 //
 int service_setupreq(int connindex) {
         register struct connection *c = &conn[connindex];
-        int i = -1, var, pver, mbw = 0, currbw = repo.dsBandwidth, errmsg;
+        int i = -1, var, pver, mbw = 0, currbw = repo.dsBandwidth, errmsg, port, rssq;
         BOOL usbw = FALSE;
         struct timespec tspecvar;
         char addrstr[INET6_ADDR_STRLEN], portstr[8];
@@ -503,12 +509,18 @@ int service_setupreq(int connindex) {
                         send_proc(monConn, scratch, var);
                 }
                 //
-                // Obtain new test connection for this client
+                // Obtain new test connection for this client (with RSS-aware port selection if configured)
                 //
-                if ((i = new_conn(-1, repo.server[0].ip, 0, T_UDP, &recv_proc, &service_actreq)) < 0) {
+                port = 0;
+                rssq = -1;
+                if (*conf.rssIntf != '\0')
+                        port = rss_select_port((int) ntohs(cHdrSR->mcIdent), &repo.remSas, &rssq);
+                if ((i = new_conn(-1, repo.server[0].ip, port, T_UDP, &recv_proc, &service_actreq)) < 0) {
                         errmsg              = 0; // Error message already output as part of allocation failure
                         cHdrSR->cmdResponse = CHSR_CRSP_CONNFAIL;
                         psC->connCreateFail++;
+                } else {
+                        sock_busypoll(i);
                 }
         }
         cHdrSR->cmdRequest = CHSR_CREQ_SETUPRSP; // Convert setup request to setup response
@@ -529,6 +541,7 @@ int service_setupreq(int connindex) {
                 cHdrSR->checkSum = checksum(cHdrSR, repo.rcvDataSize);
 #endif
                 psC->setupRejectCnt++;
+                UDPST_PROBE4(setup_reject, (int) cHdrSR->cmdResponse, addrstr, portstr, pver);
                 send_proc(connindex, (char *) cHdrSR, repo.rcvDataSize);
                 return 0;
         }
@@ -542,6 +555,11 @@ int service_setupreq(int connindex) {
         conn[i].mcIndex     = (int) cHdrSR->mcIndex;
         conn[i].mcCount     = (int) cHdrSR->mcCount;
         conn[i].mcIdent     = (int) ntohs(cHdrSR->mcIdent);
+        conn[i].rssQueue    = rssq;
+        if (conf.verbose && rssq >= 0) {
+                var = sprintf(scratch, "[%d]RSS queue %d selected via test port %d\n", i, rssq, port);
+                send_proc(monConn, scratch, var);
+        }
         if (conf.maxBandwidth > 0) {
                 conn[i].maxBandwidth = mbw; // Save bandwidth for adjustment at end of test
                 if (usbw) {
@@ -557,6 +575,24 @@ int service_setupreq(int connindex) {
                         send_proc(monConn, scratch, var);
                 }
         }
+        //
+        // Set rate ceiling from server configuration (explicit or via bandwidth of setup request) and any
+        // lower ceiling of the authentication key used (when from key file)
+        //
+        if (conf.rateLimit > 0)
+                conn[i].rateLimit = conf.rateLimit;
+        else if (conf.rateLimit == 0)
+                conn[i].rateLimit = mbw;
+        if (cHdrSR->authMode == AUTHMODE_1 && conf.keyFile != NULL) {
+                for (var = 0; var < repo.keyCount; var++) {
+                        if (repo.key[var].id == (int) cHdrSR->keyId)
+                                break;
+                }
+                if (var < repo.keyCount && repo.key[var].maxBandwidth > 0) {
+                        if (conn[i].rateLimit == 0 || repo.key[var].maxBandwidth < conn[i].rateLimit)
+                                conn[i].rateLimit = repo.key[var].maxBandwidth;
+                }
+        }
         conn[i].authMode = (int) cHdrSR->authMode;
         memcpy(conn[i].clientKey, ckey, SHA256_KEY_LEN);
         memcpy(conn[i].serverKey, skey, SHA256_KEY_LEN);
@@ -582,6 +618,7 @@ int service_setupreq(int connindex) {
         cHdrSR->checkSum = checksum(cHdrSR, repo.rcvDataSize);
 #endif
         psC->setupAcceptCnt++;
+        UDPST_PROBE5(setup_accept, i, addrstr, portstr, mbw, (int) usbw);
         if (send_proc(connindex, (char *) cHdrSR, repo.rcvDataSize) != repo.rcvDataSize)
                 return 0;
         if (conf.verbose) {
@@ -738,8 +775,27 @@ int service_setupresp(int connindex) {
                 send_proc(errConn, scratch, var);
                 return 0;
         }
+
+        //
+        // If configured for downstream testing (where the client receives the load), rebind to a local
+        // port that places the test flow on the least used RSS queue (server now uses this port)
+        //
+        if (*conf.rssIntf != '\0' && !conf.usTesting) {
+                if ((i = rss_select_port(c->mcIdent, &repo.remSas, &c->rssQueue)) > 0) {
+                        if ((var = sock_rebind(connindex, i)) != 0) {
+                                send_proc(errConn, scratch, var);
+                                tspeccpy(&c->endTime, &repo.systemClock); // Set for immediate close/exit
+                                return 0;
+                        }
+                        if (conf.verbose) {
+                                var = sprintf(scratch, "[%d]RSS queue %d selected via local port %d\n", connindex, c->rssQueue, i);
+                                send_proc(monConn, scratch, var);
+                        }
+                }
+        }
         if (sock_connect(connindex) < 0)
                 return 0;
+        sock_busypoll(connindex);
 
         //
         // Build test activation PDU
@@ -789,12 +845,30 @@ int service_setupresp(int connindex) {
                 c->randPayload = TRUE;
                 cHdrTA->modifierBitmap |= CHTA_RAND_PAYLOAD;
         }
+        if (conf.srContinuous) {
+                c->srContinuous = TRUE;
+                cHdrTA->modifierBitmap |= CHTA_SRATE_CONT;
+        }
+        if (conf.trialAdapt) {
+                c->trialAdapt = TRUE;
+                cHdrTA->modifierBitmap |= CHTA_TRIAL_ADAPT;
+        }
+        if (conf.delayUsec) {
+                c->delayUsec = TRUE;
+                cHdrTA->modifierBitmap |= CHTA_DELAY_USEC;
+        }
         c->rateAdjAlgo       = conf.rateAdjAlgo;
         cHdrTA->rateAdjAlgo  = (uint8_t) c->rateAdjAlgo;
         c->subIntPeriod      = conf.subIntPeriod;
         cHdrTA->subIntPeriod = htons((uint16_t) c->subIntPeriod);
         c->srAdjSuppCount    = conf.srAdjSuppCount;
         cHdrTA->reserved4    = htons((uint16_t) c->srAdjSuppCount); // Utilizes reserved alignment field
+        c->convCount         = conf.convCount;
+        cHdrTA->reserved2    = (uint8_t) c->convCount; // Utilizes reserved alignment field
+        c->convTol           = conf.convTol;
+        cHdrTA->reserved5    = (uint8_t) c->convTol; // Utilizes reserved alignment field
+        c->ecnCeThresh       = conf.ecnCeThresh;
+        cHdrTA->reserved3    = htons((uint16_t) c->ecnCeThresh); // Utilizes reserved alignment field
 
         //
         // Send test activation request to server
@@ -828,7 +902,7 @@ int service_setupresp(int connindex) {
 //
 int service_actreq(int connindex) {
         register struct connection *c = &conn[connindex];
-        int i, var;
+        int i, var, lowmax, lowdef, uppermax, upperdef;
         char addrstr[INET6_ADDR_STRLEN], portstr[8];
         struct sendingRate *sr = repo.sendingRates; // Set to first row of table
         struct timespec tspecvar;
@@ -889,22 +963,35 @@ int service_actreq(int connindex) {
         //
         cHdrTA->cmdResponse = CHTA_CRSP_ACKOK; // Initialize to request accepted
         //
-        // Low and upper delay variation thresholds
+        // Low and upper delay variation thresholds (in usec if requested and supported)
         //
+        if ((cHdrTA->modifierBitmap & CHTA_DELAY_USEC) && c->protocolVer >= USDELAY_PVER) {
+                c->delayUsec = TRUE;
+                lowmax       = MAX_LOW_THRESH_US;
+                lowdef       = DEF_LOW_THRESH_US;
+                uppermax     = MAX_UPPER_THRESH_US;
+                upperdef     = DEF_UPPER_THRESH_US;
+        } else {
+                cHdrTA->modifierBitmap &= ~CHTA_DELAY_USEC; // Reset bit for return
+                lowmax   = MAX_LOW_THRESH;
+                lowdef   = DEF_LOW_THRESH;
+                uppermax = MAX_UPPER_THRESH;
+                upperdef = DEF_UPPER_THRESH;
+        }
         c->lowThresh = (int) ntohs(cHdrTA->lowThresh);
-        if (c->lowThresh < MIN_LOW_THRESH || c->lowThresh > MAX_LOW_THRESH) {
-                c->lowThresh      = DEF_LOW_THRESH;
+        if (c->lowThresh < MIN_LOW_THRESH || c->lowThresh > lowmax) {
+                c->lowThresh      = lowdef;
                 cHdrTA->lowThresh = htons((uint16_t) c->lowThresh);
         }
         c->upperThresh = (int) ntohs(cHdrTA->upperThresh);
-        if (c->upperThresh < MIN_UPPER_THRESH || c->upperThresh > MAX_UPPER_THRESH) {
-                c->upperThresh      = DEF_UPPER_THRESH;
+        if (c->upperThresh < MIN_UPPER_THRESH || c->upperThresh > uppermax) {
+                c->upperThresh      = upperdef;
                 cHdrTA->upperThresh = htons((uint16_t) c->upperThresh);
         }
         if (c->lowThresh > c->upperThresh) { // Check for invalid relationship
-                c->lowThresh        = DEF_LOW_THRESH;
+                c->lowThresh        = lowdef;
                 cHdrTA->lowThresh   = htons((uint16_t) c->lowThresh);
-                c->upperThresh      = DEF_UPPER_THRESH;
+                c->upperThresh      = upperdef;
                 cHdrTA->upperThresh = htons((uint16_t) c->upperThresh);
         }
         //
@@ -915,6 +1002,10 @@ int service_actreq(int connindex) {
                 c->trialInt      = DEF_TRIAL_INT;
                 cHdrTA->trialInt = htons((uint16_t) c->trialInt);
         }
+        c->trialIntConf = c->trialInt;
+        if (cHdrTA->modifierBitmap & CHTA_TRIAL_ADAPT) {
+                c->trialAdapt = TRUE; // Sized from measured RTT during test
+        }
         //
         // Test interval time and sub-interval period
         //
@@ -972,6 +1063,12 @@ int service_actreq(int connindex) {
                 }
         }
         //
+        // Continuous (table-free) sending rates, where indexes are on a continuous rate scale
+        //
+        if (cHdrTA->modifierBitmap & CHTA_SRATE_CONT) {
+                c->srContinuous = TRUE;
+        }
+        //
         // Static or starting sending rate index (special case <Auto>, which is the default but greater than max)
         //
         c->srIndexConf = (int) ntohs(cHdrTA->srIndexConf);
@@ -983,12 +1080,16 @@ int service_actreq(int connindex) {
                         c->srIndexConf      = conf.srIndexConf;
                         cHdrTA->srIndexConf = htons((uint16_t) c->srIndexConf);
                 }
+                if (c->srContinuous && c->srIndexConf > repo.maxContIndex) { // Enforce continuous maximum
+                        c->srIndexConf      = repo.maxContIndex;
+                        cHdrTA->srIndexConf = htons((uint16_t) c->srIndexConf);
+                }
                 if (cHdrTA->modifierBitmap & CHTA_SRIDX_ISSTART) {
                         c->srIndexIsStart = TRUE;           // Designate configured value as starting point
                         c->srIndex        = c->srIndexConf; // Set starting point from configured value
                 }
                 if (c->srIndexConf != CHTA_SRIDX_DEF)
-                        sr = &repo.sendingRates[c->srIndexConf]; // Select starting SR table row
+                        sr = sr_select(connindex, c->srIndexConf); // Select starting SR table row (or synthesize)
         }
         //
         // Use one-way delay flag
@@ -1022,6 +1123,7 @@ int service_actreq(int connindex) {
                 c->seqErrThresh      = DEF_SEQ_ERR_TH;
                 cHdrTA->seqErrThresh = htons((uint16_t) c->seqErrThresh);
         }
+        c->seqErrThreshConf = c->seqErrThresh;
         //
         // Ignore Out-of-Order/Duplicate flag
         //
@@ -1048,6 +1150,7 @@ int service_actreq(int connindex) {
                 c->rateAdjAlgo      = DEF_RA_ALGO;
                 cHdrTA->rateAdjAlgo = (uint8_t) c->rateAdjAlgo;
         }
+        ra_init(connindex);
         //
         // Sending rate adjustment suppression count
         //
@@ -1061,6 +1164,56 @@ int service_actreq(int connindex) {
                 }
         }
         //
+        // Convergence stop sub-interval count and tolerance (only meaningful when searching)
+        //
+        if (c->protocolVer >= CONVSTOP_PVER) {
+                c->convCount = (int) cHdrTA->reserved2; // Utilizes reserved alignment field
+                c->convTol   = (int) cHdrTA->reserved5; // Utilizes reserved alignment field
+                if (c->convCount < MIN_CONV_COUNT || c->convTol < MIN_CONV_TOL || c->convTol > MAX_CONV_TOL ||
+                    (c->srIndexConf != CHTA_SRIDX_DEF && !c->srIndexIsStart)) {
+                        c->convCount = 0;
+                        c->convTol   = 0;
+                }
+                cHdrTA->reserved2 = (uint8_t) c->convCount;
+                cHdrTA->reserved5 = (uint8_t) c->convTol;
+        }
+        //
+        // ECN CE-marked congestion threshold (only meaningful when searching)
+        //
+        if (c->protocolVer >= ECNCE_PVER) {
+                c->ecnCeThresh = (int) ntohs(cHdrTA->reserved3); // Utilizes reserved alignment field
+                if (c->ecnCeThresh < MIN_ECN_CE_THRESH || c->ecnCeThresh > MAX_ECN_CE_THRESH ||
+                    (c->srIndexConf != CHTA_SRIDX_DEF && !c->srIndexIsStart)) {
+                        c->ecnCeThresh = 0;
+                }
+#ifndef HAVE_RECVMMSG
+                if (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS && c->ecnCeThresh > 0) {
+                        c->ecnCeThresh = 0; // Unable to count CE marks without recvmmsg(), declined in response
+                        if (conf.verbose) {
+                                var = sprintf(scratch, "[%d]ECN CE-marked congestion threshold declined (requires recvmmsg())\n",
+                                              connindex);
+                                send_proc(monConn, scratch, var);
+                        }
+                }
+#endif
+                cHdrTA->reserved3 = htons((uint16_t) c->ecnCeThresh);
+        }
+        //
+        // Sending rate index limit for rate ceiling (computed once per test). Downstream load is also shaped by a
+        // token bucket, so the lowest index covering the ceiling is used. Upstream uses the highest index below it.
+        //
+        if (c->rateLimit > 0) {
+                if (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS)
+                        c->rateLimitIndex = sr_rate_index((double) c->rateLimit, c->srContinuous);
+                else
+                        c->rateLimitIndex = sr_ceil_index((double) c->rateLimit, c->srContinuous);
+                if (conf.verbose) {
+                        var = sprintf(scratch, "[%d]Rate ceiling of %d Mbps, sending rate index limited to %d\n", connindex,
+                                      c->rateLimit, c->rateLimitIndex);
+                        send_proc(monConn, scratch, var);
+                }
+        }
+        //
         // If upstream test, send back initial sending rate transmission parameters
         //
         if (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS) {
@@ -1093,15 +1246,21 @@ int service_actreq(int connindex) {
                         // Upstream
                         // Setup to receive load PDUs and send status PDUs
                         //
-                        c->testType     = TEST_TYPE_US;
-                        c->rttMinimum   = STATUS_NODEL;
-                        c->rttVarSample = STATUS_NODEL;
+                        c->testType       = TEST_TYPE_US;
+                        c->rttMinimum     = STATUS_NODEL;
+                        c->rttVarSample   = STATUS_NODEL;
+                        c->rttMinimumUs   = STATUS_NODEL;
+                        c->rttVarSampleUs = STATUS_NODEL;
 #ifdef HAVE_RECVMMSG
                         c->secAction = &service_recvmmsg;
+                        if (c->ecnCeThresh > 0 && (var = sock_recvecn(connindex)) > 0) {
+                                send_proc(errConn, scratch, var); // Not fatal, test continues without ECN feedback
+                        }
 #else
                         c->secAction = &service_loadpdu;
 #endif
-                        c->delayVarMin = STATUS_NODEL;
+                        c->delayVarMin   = STATUS_NODEL;
+                        c->delayVarMinUs = STATUS_NODEL;
                         tspeccpy(&c->trialIntClock, &repo.systemClock);
                         tspecvar.tv_sec  = 0;
                         tspecvar.tv_nsec = (long) (c->trialInt * NSECINMSEC);
@@ -1131,6 +1290,7 @@ int service_actreq(int connindex) {
                         c->timer2Action = &send2_loadpdu;
                 }
                 psC->actAcceptCnt++;
+                UDPST_PROBE5(test_activate, connindex, c->testType, (int) repo.isServer, c->srIndex, c->rateAdjAlgo);
         } else {
                 psC->actRejectCnt++;
         }
@@ -1203,8 +1363,8 @@ int service_actreq(int connindex) {
 int service_actresp(int connindex) {
         register struct connection *c = &conn[connindex];
         int i, var, ipv6add;
-        char *testtype, connid[8], delusage[8], sritext[8], payload[8];
-        char intflabel[IFNAMSIZ + 8];
+        char *testtype, connid[8], delusage[8], sritext[16], payload[8];
+        char intflabel[INTF_LIST_SIZE + 8], ecnlabel[16];
         struct sendingRate *sr = &c->srStruct; // Set to connection structure
         struct timespec tspecvar;
         struct controlHdrTA *cHdrTA = (struct controlHdrTA *) repo.defBuffer;
@@ -1288,6 +1448,8 @@ int service_actresp(int connindex) {
         c->slowAdjThresh  = (int) ntohs(cHdrTA->slowAdjThresh);
         c->seqErrThresh   = (int) ntohs(cHdrTA->seqErrThresh);
         c->ignoreOooDup   = (BOOL) cHdrTA->ignoreOooDup;
+        c->trialIntConf     = c->trialInt; // Retain as-configured values for RTT-adaptive scaling
+        c->seqErrThreshConf = c->seqErrThresh;
         if (cHdrTA->cmdRequest == CHTA_CREQ_TESTACTUS) {
                 // If upstream test, save sending rate parameters sent by server
                 sr_copy(sr, &cHdrTA->srStruct, FALSE);
@@ -1295,6 +1457,22 @@ int service_actresp(int connindex) {
         if (!(cHdrTA->modifierBitmap & CHTA_RAND_PAYLOAD)) {
                 c->randPayload = FALSE; // Payload randomization rejected by server
         }
+        if (!(cHdrTA->modifierBitmap & CHTA_SRATE_CONT)) {
+                c->srContinuous = FALSE; // Continuous sending rates not supported by server
+        }
+        if (!(cHdrTA->modifierBitmap & CHTA_TRIAL_ADAPT)) {
+                c->trialAdapt = FALSE; // RTT-adaptive trial interval not supported by server
+        }
+        if (!(cHdrTA->modifierBitmap & CHTA_DELAY_USEC)) {
+                c->delayUsec = FALSE; // Microsecond delay variation not supported by server
+        }
+        if (c->protocolVer >= CONVSTOP_PVER) {
+                c->convCount = (int) cHdrTA->reserved2; // As accepted by server
+                c->convTol   = (int) cHdrTA->reserved5;
+        }
+        if (c->protocolVer >= ECNCE_PVER) {
+                c->ecnCeThresh = (int) ntohs(cHdrTA->reserved3); // As accepted by server
+        }
         c->rateAdjAlgo = (int) cHdrTA->rateAdjAlgo;
 
         //
@@ -1302,6 +1480,8 @@ int service_actresp(int connindex) {
         //
         c->testAction = TEST_ACT_TEST;
         tspeccpy(&c->pduRxTime, &repo.systemClock);
+        cpu_test_start(); // CPU cost of test begins with first connection
+        UDPST_PROBE5(test_activate, connindex, c->testType, (int) repo.isServer, c->srIndex, c->rateAdjAlgo);
 
         //
         // Finalize connection for testing based on test type
@@ -1333,15 +1513,21 @@ int service_actresp(int connindex) {
                 // Downstream
                 // Setup to receive load PDUs and send status PDUs
                 //
-                testtype        = DSTEST_TEXT;
-                c->rttMinimum   = STATUS_NODEL;
-                c->rttVarSample = STATUS_NODEL;
+                testtype          = DSTEST_TEXT;
+                c->rttMinimum     = STATUS_NODEL;
+                c->rttVarSample   = STATUS_NODEL;
+                c->rttMinimumUs   = STATUS_NODEL;
+                c->rttVarSampleUs = STATUS_NODEL;
 #ifdef HAVE_RECVMMSG
                 c->secAction = &service_recvmmsg;
+                if (c->ecnCeThresh > 0 && (var = sock_recvecn(connindex)) > 0) {
+                        send_proc(errConn, scratch, var); // Not fatal, test continues without ECN feedback
+                }
 #else
                 c->secAction = &service_loadpdu;
 #endif
-                c->delayVarMin = STATUS_NODEL;
+                c->delayVarMin   = STATUS_NODEL;
+                c->delayVarMinUs = STATUS_NODEL;
                 tspeccpy(&c->trialIntClock, &repo.systemClock);
                 tspecvar.tv_sec  = 0;
                 tspecvar.tv_nsec = (long) (c->trialInt * NSECINMSEC);
@@ -1374,15 +1560,21 @@ int service_actresp(int connindex) {
                 } else {
                         sprintf(sritext, "%d", c->srIndexConf);
                 }
+                if (c->srContinuous)
+                        strcat(sritext, SRCONT_SUFFIX);
                 *intflabel = '\0';
+                *ecnlabel  = '\0';
+                if (c->ecnCeThresh > 0)
+                        snprintf(ecnlabel, sizeof(ecnlabel), " [CE>%d%%]", c->ecnCeThresh);
                 if (repo.intfFD >= 0) { // Append interface label
                         snprintf(intflabel, sizeof(intflabel), ", [%s]", conf.intfName);
                 }
                 if (!conf.jsonOutput) {
-                        var = sprintf(scratch, TESTHDR_LINE, connid, testtype, c->testIntTime, c->lowThresh, c->upperThresh,
-                                      delusage, c->trialInt, boolText[c->ignoreOooDup], payload, c->mcIdent, sritext,
-                                      c->slowAdjThresh, c->highSpeedDelta, c->seqErrThresh, rateAdjAlgo[c->rateAdjAlgo], c->mcCount,
-                                      c->dscpEcn, intflabel);
+                        var = sprintf(scratch, TESTHDR_LINE, connid, testtype, c->testIntTime, c->delayUsec ? "us" : "ms",
+                                      c->lowThresh, c->upperThresh, delusage, c->trialInt, c->trialAdapt ? " [Auto]" : "",
+                                      boolText[c->ignoreOooDup], payload, c->mcIdent, sritext, c->slowAdjThresh,
+                                      c->highSpeedDelta, c->seqErrThresh, rateAdjAlgo[c->rateAdjAlgo], c->mcCount, c->dscpEcn,
+                                      ecnlabel, intflabel);
                         send_proc(errConn, scratch, var);
                 } else {
                         if (!conf.jsonBrief) {
@@ -1487,6 +1679,12 @@ int service_actresp(int connindex) {
                                 cJSON_AddNumberToObject(json_input, "SlowAdjThresh", c->slowAdjThresh);
                                 cJSON_AddNumberToObject(json_input, "HSpeedThresh", repo.hSpeedThresh * 1000000);
                                 cJSON_AddStringToObject(json_input, "RateAdjAlgorithm", rateAdjAlgo[c->rateAdjAlgo]);
+                                cJSON_AddNumberToObject(json_input, "ContinuousRates", c->srContinuous);
+                                cJSON_AddNumberToObject(json_input, "StatusFeedbackAdaptive", c->trialAdapt);
+                                cJSON_AddNumberToObject(json_input, "ConvergenceSubIntervals", c->convCount);
+                                cJSON_AddNumberToObject(json_input, "ConvergenceTolerance", c->convTol);
+                                cJSON_AddNumberToObject(json_input, "ECNCEThreshold", c->ecnCeThresh);
+                                cJSON_AddNumberToObject(json_input, "DelayVarThreshUsec", c->delayUsec);
                                 cJSON_AddNumberToObject(json_input, "InterfaceDeterminesMax", conf.intfForMax);
                                 //
                                 // Add input object to top-level object
@@ -1765,12 +1963,10 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
                 return i;
 
         //
-        // Set address reuse
+        // Set socket options
         //
         if (type == T_UDP) {
-                var = 1;
-                if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const void *) &var, sizeof(var)) < 0) {
-                        var = sprintf(scratch, "[%d]SET SO_REUSEADDR ERROR: %s\n", i, strerror(errno));
+                if ((var = sock_options(i, fd)) != 0) {
                         send_proc(errConn, scratch, var);
                         init_conn(i, TRUE);
                         return -1;
@@ -1778,30 +1974,10 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
         }
 
         //
-        // Change buffering if specified
+        // Get buffer values if needed
         //
         sndbuf = rcvbuf = 0;
         if (type == T_UDP) {
-                //
-                // Set socket buffers
-                //
-                if (conf.sockSndBuf != 0 && conf.sockRcvBuf != 0) {
-                        if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const void *) &conf.sockSndBuf, sizeof(conf.sockSndBuf)) < 0) {
-                                var = sprintf(scratch, "[%d]SET SO_SNDBUF ERROR: %s\n", i, strerror(errno));
-                                send_proc(errConn, scratch, var);
-                                init_conn(i, TRUE);
-                                return -1;
-                        }
-                        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const void *) &conf.sockRcvBuf, sizeof(conf.sockRcvBuf)) < 0) {
-                                var = sprintf(scratch, "[%d]SET SO_RCVBUF ERROR: %s\n", i, strerror(errno));
-                                send_proc(errConn, scratch, var);
-                                init_conn(i, TRUE);
-                                return -1;
-                        }
-                }
-                //
-                // Get buffer values
-                //
                 if (conf.verbose) {
                         var = sizeof(sndbuf);
                         if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, (void *) &sndbuf, (socklen_t *) &var) < 0) {
@@ -1848,6 +2024,195 @@ int new_conn(int activefd, char *host, int port, int type, int (*priaction)(int)
 }
 //----------------------------------------------------------------------------
 //
+// Set options of UDP socket (address reuse and buffering)
+//
+// Populate scratch buffer and return length on error
+//
+int sock_options(int connindex, int fd) {
+        int var;
+
+        //
+        // Set address reuse
+        //
+        var = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const void *) &var, sizeof(var)) < 0) {
+                var = sprintf(scratch, "[%d]SET SO_REUSEADDR ERROR: %s\n", connindex, strerror(errno));
+                return var;
+        }
+
+        //
+        // Set socket buffers if specified
+        //
+        if (conf.sockSndBuf != 0 && conf.sockRcvBuf != 0) {
+                if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (const void *) &conf.sockSndBuf, sizeof(conf.sockSndBuf)) < 0) {
+                        var = sprintf(scratch, "[%d]SET SO_SNDBUF ERROR: %s\n", connindex, strerror(errno));
+                        return var;
+                }
+                if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const void *) &conf.sockRcvBuf, sizeof(conf.sockRcvBuf)) < 0) {
+                        var = sprintf(scratch, "[%d]SET SO_RCVBUF ERROR: %s\n", connindex, strerror(errno));
+                        return var;
+                }
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Enable busy-poll receive mode on a test socket if specified (poll device queue instead of awaiting interrupt)
+//
+// Since the kernel requires CAP_NET_ADMIN for a busy-poll time above the net.core.busy_read sysctl, for
+// preferred busy-polling, and for a non-default budget, a permission error only produces a warning and
+// the socket falls back to (or remains in) interrupt-driven operation
+//
+void sock_busypoll(int connindex) {
+#if defined(SO_BUSY_POLL) && defined(SO_PREFER_BUSY_POLL) && defined(SO_BUSY_POLL_BUDGET)
+        static BOOL prefWarned = FALSE;
+        int var, fd = conn[connindex].fd;
+
+        if (conf.busyPollUsec <= 0)
+                return;
+        if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, (const void *) &conf.busyPollUsec, sizeof(conf.busyPollUsec)) < 0) {
+                var = sprintf(scratch, "[%d]WARNING: Busy-poll disabled, SET SO_BUSY_POLL failed: %s\n", connindex,
+                              strerror(errno));
+                send_proc(errConn, scratch, var);
+                conf.busyPollUsec = 0; // Avoid repeated attempts (and warnings) for subsequent tests
+                return;
+        }
+        var = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, (const void *) &var, sizeof(var)) < 0) {
+                if (!prefWarned) {
+                        var = sprintf(scratch, "[%d]WARNING: Using non-preferred busy-poll, SET SO_PREFER_BUSY_POLL failed: %s\n",
+                                      connindex, strerror(errno));
+                        send_proc(errConn, scratch, var);
+                        prefWarned = TRUE;
+                }
+                return; // Budget only applies to preferred busy-polling
+        }
+        var = BUSY_POLL_BUDGET;
+        if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, (const void *) &var, sizeof(var)) < 0) {
+                if (!prefWarned) {
+                        var = sprintf(scratch, "[%d]WARNING: Using default busy-poll budget, SET SO_BUSY_POLL_BUDGET failed: %s\n",
+                                      connindex, strerror(errno));
+                        send_proc(errConn, scratch, var);
+                        prefWarned = TRUE;
+                }
+        }
+#else
+        (void) (connindex);
+#endif
+}
+//----------------------------------------------------------------------------
+//
+// Request the received DSCP+ECN byte of load PDUs as ancillary data (IP_RECVTOS/IPV6_RECVTCLASS)
+//
+// Populate scratch buffer and return length on error
+//
+int sock_recvecn(int connindex) {
+#ifdef HAVE_RECVMMSG
+        register struct connection *c = &conn[connindex];
+        int var = 1;
+
+        if (c->ipProtocol == IPPROTO_IPV6) {
+                if (setsockopt(c->fd, IPPROTO_IPV6, IPV6_RECVTCLASS, (const void *) &var, sizeof(var)) < 0) {
+                        var = sprintf(scratch, "[%d]SET IPV6_RECVTCLASS ERROR: %s\n", connindex, strerror(errno));
+                        return var;
+                }
+        } else {
+                if (setsockopt(c->fd, IPPROTO_IP, IP_RECVTOS, (const void *) &var, sizeof(var)) < 0) {
+                        var = sprintf(scratch, "[%d]SET IP_RECVTOS ERROR: %s\n", connindex, strerror(errno));
+                        return var;
+                }
+        }
+        c->ecnRecv = TRUE;
+#else
+        (void) (connindex);
+#endif
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Replace the socket of a connection with one bound to the specified local port, retaining its
+// descriptor (and therefore its epoll data and connection index) so that setup can continue
+//
+// Populate scratch buffer and return length on error
+//
+int sock_rebind(int connindex, int port) {
+        register struct connection *c = &conn[connindex];
+        int i, fd, var;
+        struct sockaddr_storage sas;
+        socklen_t slen;
+#ifdef __linux__
+        struct epoll_event epevent;
+#endif
+
+        //
+        // Obtain bound address of existing socket and update port
+        //
+        slen = sizeof(sas);
+        if (getsockname(c->fd, (struct sockaddr *) &sas, &slen) < 0) {
+                var = sprintf(scratch, "[%d]GETSOCKNAME ERROR: %s\n", connindex, strerror(errno));
+                return var;
+        }
+        if (sas.ss_family == AF_INET6) {
+                ((struct sockaddr_in6 *) &sas)->sin6_port = htons((uint16_t) port);
+        } else {
+                ((struct sockaddr_in *) &sas)->sin_port = htons((uint16_t) port);
+        }
+
+        //
+        // Create and bind new socket (matching IPv6-only setting of existing socket)
+        //
+        if ((fd = socket(sas.ss_family, SOCK_DGRAM, 0)) == -1) {
+                var = sprintf(scratch, "[%d]SOCKET ERROR: %s\n", connindex, strerror(errno));
+                return var;
+        }
+        if (sas.ss_family == AF_INET6) {
+                i   = 0;
+                var = sizeof(i);
+                getsockopt(c->fd, IPPROTO_IPV6, IPV6_V6ONLY, (void *) &i, (socklen_t *) &var);
+                if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, (const void *) &i, sizeof(i)) == -1) {
+                        var = sprintf(scratch, "[%d]IPV6_V6ONLY ERROR: %s (%d)\n", connindex, strerror(errno), i);
+                        close(fd);
+                        return var;
+                }
+        }
+        if (bind(fd, (struct sockaddr *) &sas, slen) == -1) {
+                var = sprintf(scratch, "[%d]BIND ERROR: %s (port %d)\n", connindex, strerror(errno), port);
+                close(fd);
+                return var;
+        }
+        if ((var = sock_options(connindex, fd)) != 0) {
+                close(fd);
+                return var;
+        }
+        var = fcntl(fd, F_GETFL, 0);
+        if (fcntl(fd, F_SETFL, var | O_NONBLOCK) != 0) {
+                var = sprintf(scratch, "[%d]F_SETFL ERROR: %s\n", connindex, strerror(errno));
+                close(fd);
+                return var;
+        }
+
+        //
+        // Move new socket to existing descriptor (implicitly closing the old socket) and re-add for epoll
+        //
+        if (dup2(fd, c->fd) < 0) {
+                var = sprintf(scratch, "[%d]DUP2 ERROR: %s\n", connindex, strerror(errno));
+                close(fd);
+                return var;
+        }
+        close(fd);
+#ifdef __linux__
+        epevent.events   = EPOLLIN;
+        epevent.data.u32 = (uint32_t) connindex;
+        if (epoll_ctl(repo.epollFD, EPOLL_CTL_ADD, c->fd, &epevent) != 0) {
+                var = sprintf(scratch, "[%d]EPOLL_CTL ERROR: %s\n", connindex, strerror(errno));
+                return var;
+        }
+#endif
+        c->locPort = port;
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
 // Initiate a socket connect
 //
 int sock_connect(int connindex) {
@@ -2022,8 +2387,11 @@ int open_outputfile(int connindex) {
         }
 
         //
-        // Open output file
+        // Open binary output file (records queued to writer thread), else CSV output file
         //
+        if (conf.outputFileBin) {
+                return export_open(connindex, fname);
+        }
         if ((c->outputFPtr = fopen(fname, "w")) == NULL) {
                 return sprintf(scratch, "FOPEN ERROR: <%.*s> %s\n", NAME_MAX, fname, strerror(errno));
         }
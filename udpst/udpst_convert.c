@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_convert.c
+ *
+ * This file contains a standalone utility to convert a binary output (export)
+ * archive file of received load metadata into the standard CSV format.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+//
+#include "udpst_common.h"
+#include "udpst_export.h"
+#include "udpst_archive.h"
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+#define CSV_HEADER "SeqNo,PayLoad,SrcTxTime,DstRxTime,OWD,IntfMbps,IntfMbpsAlt,RTTTxTime,RTTRxTime,RTTRespDelay,RTT,StatusLoss\n"
+#define TS_FORMAT  "%llu.%06llu"
+#define TS_VALUES(ns) \
+        (unsigned long long) ((ns) / NSECINSEC), (unsigned long long) (((ns) % NSECINSEC) / NSECINUSEC)
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Convert binary output (export) archive file to CSV
+//
+int main(int argc, char **argv) {
+        uint32_t i;
+        uint64_t n;
+        FILE *ofp = stdout;
+        struct archive ar;
+        struct exportChunk *ec;
+
+        if (argc < 2 || argc > 3) {
+                fprintf(stderr, "Usage: %s binfile [csvfile]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+        if (archive_open(&ar, argv[1]) < 0)
+                return EXIT_FAILURE;
+
+        //
+        // Open output file (if specified) and initialize with header
+        //
+        if (argc == 3 && (ofp = fopen(argv[2], "w")) == NULL) {
+                fprintf(stderr, "FOPEN ERROR: <%s> %s\n", argv[2], strerror(errno));
+                archive_close(&ar);
+                return EXIT_FAILURE;
+        }
+        fputs(CSV_HEADER, ofp);
+
+        //
+        // Output each record of each chunk (RTTRxTime is the same as DstRxTime)
+        //
+        for (n = 0; (ec = archive_chunk(&ar, n)) != NULL; n++) {
+                uint32_t *seqno   = ARCHIVE_COL(ec, EXPCOL_SEQNO, uint32_t);
+                uint16_t *payload = ARCHIVE_COL(ec, EXPCOL_PAYLOAD, uint16_t);
+                uint8_t *flags    = ARCHIVE_COL(ec, EXPCOL_FLAGS, uint8_t);
+                uint64_t *srctx   = ARCHIVE_COL(ec, EXPCOL_SRCTX, uint64_t);
+                uint64_t *dstrx   = ARCHIVE_COL(ec, EXPCOL_DSTRX, uint64_t);
+                int32_t *owd      = ARCHIVE_COL(ec, EXPCOL_OWD, int32_t);
+                double *intf      = ARCHIVE_COL(ec, EXPCOL_INTF, double);
+                double *intfalt   = ARCHIVE_COL(ec, EXPCOL_INTFALT, double);
+                uint64_t *rtttx   = ARCHIVE_COL(ec, EXPCOL_RTTTX, uint64_t);
+                uint16_t *rttrd   = ARCHIVE_COL(ec, EXPCOL_RTTRD, uint16_t);
+                uint32_t *rtt     = ARCHIVE_COL(ec, EXPCOL_RTT, uint32_t);
+                int32_t *statloss = ARCHIVE_COL(ec, EXPCOL_STATLOSS, int32_t);
+
+                for (i = 0; i < ec->records; i++) {
+                        fprintf(ofp, "%u,%u," TS_FORMAT "," TS_FORMAT ",%d,%.2f,%.2f", seqno[i], payload[i], TS_VALUES(srctx[i]),
+                                TS_VALUES(dstrx[i]), owd[i], intf[i], intfalt[i]);
+                        if (flags[i] & EXPREC_RTT) {
+                                fprintf(ofp, "," TS_FORMAT "," TS_FORMAT ",%u,%u,%d\n", TS_VALUES(rtttx[i]), TS_VALUES(dstrx[i]),
+                                        rttrd[i], rtt[i], statloss[i]);
+                        } else {
+                                fputs(",,,,,\n", ofp);
+                        }
+                }
+        }
+        if (ofp != stdout)
+                fclose(ofp);
+
+        //
+        // Report any records that were lost
+        //
+        if (ar.eh->overflow > 0) {
+                fprintf(stderr, "WARNING: %u records lost to ring overflow during capture\n", ar.eh->overflow);
+        }
+        archive_close(&ar);
+        return EXIT_SUCCESS;
+}
+//----------------------------------------------------------------------------
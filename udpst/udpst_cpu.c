@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_cpu.c
+ *
+ * This file samples the CPU time, context switches and send/receive syscall
+ * counts of the process, and derives the per-packet and per-Gbps cost of a
+ * test (client) or performance statistics record (server). These indicate
+ * whether a result was limited by the host rather than the network.
+ *
+ */
+
+#define UDPST_CPU
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_cpu.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern struct repository repo;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static struct cpuSample cpuTestBase;   // Sample at start of test
+static struct cpuSample cpuRecordBase; // Sample at start of performance statistics record
+static BOOL cpuTestStarted;            // Test start has been sampled
+static double cpuHz;                   // Nominal CPU frequency (zero if unknown)
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Obtain nominal CPU frequency from cpufreq, or the first processor listed by cpuinfo
+//
+static double _cpu_hz(void) {
+        FILE *fp;
+        char line[128];
+        double dvar = 0.0;
+
+        if ((fp = fopen(CPU_FREQ_PATH, "r")) != NULL) {
+                if (fscanf(fp, "%lf", &dvar) == 1)
+                        dvar *= 1000.0; // kHz
+                fclose(fp);
+                if (dvar > 0.0)
+                        return dvar;
+        }
+        if ((fp = fopen(CPU_INFO_PATH, "r")) != NULL) {
+                while (fgets(line, sizeof(line), fp) != NULL) {
+                        if (sscanf(line, "cpu MHz : %lf", &dvar) == 1) {
+                                dvar *= 1000000.0;
+                                break;
+                        }
+                }
+                fclose(fp);
+        }
+        return dvar;
+}
+//----------------------------------------------------------------------------
+//
+// Sample CPU usage (the thread CPU time is that of the caller, which is always the event loop)
+//
+static void _sample(struct cpuSample *cs) {
+        struct rusage rusage;
+        struct timespec tspecvar;
+
+        memset(cs, 0, sizeof(struct cpuSample));
+        clock_gettime(CLOCK_MONOTONIC, &cs->wall);
+        if (getrusage(RUSAGE_SELF, &rusage) == 0) {
+                cs->userNsec = ((uint64_t) rusage.ru_utime.tv_sec * NSECINSEC) + ((uint64_t) rusage.ru_utime.tv_usec * NSECINUSEC);
+                cs->sysNsec  = ((uint64_t) rusage.ru_stime.tv_sec * NSECINSEC) + ((uint64_t) rusage.ru_stime.tv_usec * NSECINUSEC);
+                cs->volCsw   = (uint64_t) rusage.ru_nvcsw;
+                cs->invCsw   = (uint64_t) rusage.ru_nivcsw;
+        }
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &tspecvar) == 0)
+                cs->threadNsec = ((uint64_t) tspecvar.tv_sec * NSECINSEC) + (uint64_t) tspecvar.tv_nsec;
+        cs->sc = repo.sysCalls;
+}
+//----------------------------------------------------------------------------
+//
+// Derive cost between two samples, given the data rate achieved in between
+//
+static void _cost(struct cpuSample *begin, struct cpuSample *end, double mbps, struct cpuCost *cc) {
+        double cpunsec;
+
+        memset(cc, 0, sizeof(struct cpuCost));
+        cc->wallSec = (double) (end->wall.tv_sec - begin->wall.tv_sec);
+        cc->wallSec += (double) (end->wall.tv_nsec - begin->wall.tv_nsec) / NSECINSEC;
+        cc->userSec   = (double) (end->userNsec - begin->userNsec) / NSECINSEC;
+        cc->sysSec    = (double) (end->sysNsec - begin->sysNsec) / NSECINSEC;
+        cc->threadSec = (double) (end->threadNsec - begin->threadNsec) / NSECINSEC;
+        cc->volCsw    = end->volCsw - begin->volCsw;
+        cc->invCsw    = end->invCsw - begin->invCsw;
+        cc->txCalls   = end->sc.txCalls - begin->sc.txCalls;
+        cc->rxCalls   = end->sc.rxCalls - begin->sc.rxCalls;
+        cc->packets   = (end->sc.txDgrams - begin->sc.txDgrams) + (end->sc.rxDgrams - begin->sc.rxDgrams);
+        if (cc->wallSec <= 0.0)
+                return;
+
+        cc->utilization = (cc->userSec + cc->sysSec) / cc->wallSec;
+        cc->threadUtil  = cc->threadSec / cc->wallSec;
+        cc->hostLimited = (cc->threadUtil >= CPU_LIMIT_RATIO);
+        if (cc->packets > 0) {
+                cpunsec             = (cc->userSec + cc->sysSec) * NSECINSEC;
+                cc->nsecPerPacket   = cpunsec / (double) cc->packets;
+                cc->cyclesPerPacket = (cpunsec * cpuHz / NSECINSEC) / (double) cc->packets;
+        }
+        if (mbps > 0.0)
+                cc->cpuPerGbps = cc->utilization / (mbps / 1000.0);
+}
+//----------------------------------------------------------------------------
+//
+// Initialize CPU accounting at startup
+//
+void cpu_init(void) {
+        cpuHz = _cpu_hz();
+        _sample(&cpuTestBase);
+        cpuRecordBase = cpuTestBase;
+}
+//----------------------------------------------------------------------------
+//
+// Sample CPU usage at activation of the first test connection (client)
+//
+void cpu_test_start(void) {
+        if (cpuTestStarted)
+                return;
+        _sample(&cpuTestBase);
+        cpuTestStarted = TRUE;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain cost of test so far, given its average data rate
+//
+void cpu_test_cost(struct cpuCost *cc, double mbps) {
+        struct cpuSample cs;
+
+        _sample(&cs);
+        _cost(&cpuTestBase, &cs, mbps, cc);
+}
+//----------------------------------------------------------------------------
+//
+// Add CPU object to performance statistics record, given the bytes transmitted and received, and return length
+//
+int cpu_json(char *buf, unsigned long long bytes) {
+        int len = 0;
+        double dvar, mbps = 0.0;
+        struct cpuSample cs;
+        struct cpuCost cc;
+
+        _sample(&cs);
+        dvar = (double) (cs.wall.tv_sec - cpuRecordBase.wall.tv_sec);
+        dvar += (double) (cs.wall.tv_nsec - cpuRecordBase.wall.tv_nsec) / NSECINSEC;
+        if (dvar > 0.0)
+                mbps = ((double) bytes * 8.0) / (dvar * 1000000.0);
+        _cost(&cpuRecordBase, &cs, mbps, &cc);
+        cpuRecordBase = cs;
+        if (dvar <= 0.0)
+                dvar = 1.0; // Rates of zero
+
+        len += sprintf(&buf[len], "\t\"cpu\": {\n");
+        len += sprintf(&buf[len], "\t\t\"utilization\": %.3f,\n", cc.utilization);
+        len += sprintf(&buf[len], "\t\t\"thread_utilization\": %.3f,\n", cc.threadUtil);
+        len += sprintf(&buf[len], "\t\t\"user_sec\": %.3f,\n", cc.userSec);
+        len += sprintf(&buf[len], "\t\t\"system_sec\": %.3f,\n", cc.sysSec);
+        len += sprintf(&buf[len], "\t\t\"voluntary_csw_rate\": %.2f,\n", (double) cc.volCsw / dvar);
+        len += sprintf(&buf[len], "\t\t\"involuntary_csw_rate\": %.2f,\n", (double) cc.invCsw / dvar);
+        len += sprintf(&buf[len], "\t\t\"tx_syscall_rate\": %.2f,\n", (double) cc.txCalls / dvar);
+        len += sprintf(&buf[len], "\t\t\"rx_syscall_rate\": %.2f,\n", (double) cc.rxCalls / dvar);
+        len += sprintf(&buf[len], "\t\t\"packet_rate\": %.2f,\n", (double) cc.packets / dvar);
+        len += sprintf(&buf[len], "\t\t\"nsec_per_packet\": %.1f,\n", cc.nsecPerPacket);
+        len += sprintf(&buf[len], "\t\t\"cycles_per_packet\": %.1f,\n", cc.cyclesPerPacket);
+        len += sprintf(&buf[len], "\t\t\"cpu_per_gbps\": %.3f,\n", cc.cpuPerGbps);
+        len += sprintf(&buf[len], "\t\t\"host_limited\": %s\n", cc.hostLimited ? "true" : "false");
+        len += sprintf(&buf[len], "\t},\n");
+
+        return len;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_cpu.h
+ *
+ * This file contains the CPU usage sample and cost structures as well as the
+ * external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_CPU_H
+#define UDPST_CPU_H
+
+//----------------------------------------------------------------------------
+//
+// CPU usage of the process and its event loop (main) thread
+//
+// The event loop is single-threaded, so a main thread that is busy for nearly all of the
+// elapsed time cannot have kept up with the network and the result is flagged as host-limited.
+//
+#define CPU_LIMIT_RATIO 0.90                                                    // Thread utilization considered host-limited
+#define CPU_FREQ_PATH   "/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq" // Max frequency (kHz)
+#define CPU_INFO_PATH   "/proc/cpuinfo"                                         // Fallback for frequency (MHz)
+struct cpuSample {
+        struct timespec wall;      // Sample time (CLOCK_MONOTONIC)
+        uint64_t userNsec;         // Process user CPU time
+        uint64_t sysNsec;          // Process system CPU time
+        uint64_t threadNsec;       // Event loop thread CPU time
+        uint64_t volCsw;           // Voluntary context switches
+        uint64_t invCsw;           // Involuntary context switches
+        struct sysCallCounters sc; // Send/receive syscall counters
+};
+struct cpuCost {
+        double wallSec;         // Elapsed time
+        double userSec;         // Process user CPU time
+        double sysSec;          // Process system CPU time
+        double threadSec;       // Event loop thread CPU time
+        double utilization;     // Process CPU time per elapsed time
+        double threadUtil;      // Thread CPU time per elapsed time
+        uint64_t volCsw;        // Voluntary context switches
+        uint64_t invCsw;        // Involuntary context switches
+        uint64_t txCalls;       // Send syscalls
+        uint64_t rxCalls;       // Receive syscalls
+        uint64_t packets;       // Datagrams sent and received
+        double nsecPerPacket;   // Process CPU time per datagram
+        double cyclesPerPacket; // CPU cycles per datagram (zero if frequency unknown)
+        double cpuPerGbps;      // CPU cores used per Gbps (zero without traffic)
+        BOOL hostLimited;       // Event loop thread was saturated
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern void cpu_init(void);
+extern void cpu_test_start(void);
+extern void cpu_test_cost(struct cpuCost *, double);
+extern int cpu_json(char *, unsigned long long);
+
+#endif /* UDPST_CPU_H */
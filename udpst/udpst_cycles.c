@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_cycles.c
+ *
+ * This file reports the hot-path stage timing collected when the software is
+ * built with ADD_CYCLE_COUNTERS, both as part of each performance statistics
+ * record and as a verbose text summary.
+ *
+ */
+
+#define UDPST_CYCLES
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_cycles.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+#ifdef ADD_CYCLE_COUNTERS
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+double cycles_nsec_per_tick(void);
+double cycles_percentile(struct cycStage *, double, double);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern char scratch[STRING_SIZE];
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+struct cycStage cycStage[CYC_STAGES]; // Stage timing since last report
+static uint64_t calTicks, calMono;    // Counter and monotonic clock at calibration start
+static char *cycName[CYC_STAGES] = {"dispatch",    "recv",       "load_pdu",   "burst_build",
+                                    "sendmmsg",    "status_pdu", "timer_scan", "sub_interval"};
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Return monotonic clock in nanoseconds
+//
+uint64_t cycles_mono(void) {
+        struct timespec tspecvar;
+
+        clock_gettime(CLOCK_MONOTONIC, &tspecvar);
+        return ((uint64_t) tspecvar.tv_sec * NSECINSEC) + (uint64_t) tspecvar.tv_nsec;
+}
+//----------------------------------------------------------------------------
+//
+// Return histogram bucket of tick count (exact below 4, then four buckets per power of two)
+//
+int cycles_index(uint64_t ticks) {
+        int msb, index;
+
+        if (ticks < (1 << CYC_SUB_BITS))
+                return (int) ticks;
+        msb   = 63 - __builtin_clzll(ticks);
+        index = (msb - CYC_SUB_BITS + 1) << CYC_SUB_BITS;
+        index += (int) ((ticks >> (msb - CYC_SUB_BITS)) & ((1 << CYC_SUB_BITS) - 1));
+        if (index >= CYC_BUCKETS)
+                index = CYC_BUCKETS - 1;
+        return index;
+}
+//----------------------------------------------------------------------------
+//
+// Start calibration of counter ticks against monotonic clock
+//
+void cycles_init(void) {
+        calTicks = CYC_NOW();
+        calMono  = cycles_mono();
+}
+//----------------------------------------------------------------------------
+//
+// Add stage timing object to performance statistics record, reset stages, and return length
+//
+int cycles_json(char *buf) {
+        int i, len = 0;
+        double scale = cycles_nsec_per_tick();
+        struct cycStage *cs;
+
+        len += sprintf(&buf[len], "\t\"cycle_stages\": {\n");
+        for (i = 0; i < CYC_STAGES; i++) {
+                cs = &cycStage[i];
+                len += sprintf(&buf[len], "\t\t\"%s\": {\"count\": %llu, \"avg_nsec\": %.1f, \"p50_nsec\": %.0f, ", cycName[i],
+                               (unsigned long long) cs->count, cs->count ? (double) cs->total * scale / cs->count : 0.0,
+                               cycles_percentile(cs, 0.50, scale));
+                len += sprintf(&buf[len], "\"p99_nsec\": %.0f, \"max_nsec\": %.0f}%s\n", cycles_percentile(cs, 0.99, scale),
+                               (double) cs->max * scale, (i < CYC_STAGES - 1) ? "," : "");
+        }
+        len += sprintf(&buf[len], "\t},\n");
+        cycles_reset();
+
+        return len;
+}
+//----------------------------------------------------------------------------
+//
+// Output stage timing as text (stages are not reset)
+//
+void cycles_dump(int connindex) {
+        int i, var;
+        double scale = cycles_nsec_per_tick();
+        struct cycStage *cs;
+
+        for (i = 0; i < CYC_STAGES; i++) {
+                cs = &cycStage[i];
+                if (cs->count == 0)
+                        continue;
+                var = sprintf(scratch, "Stage(ns) %-12s Count: %llu, Avg: %.1f, p50: %.0f, p99: %.0f, Max: %.0f\n", cycName[i],
+                              (unsigned long long) cs->count, (double) cs->total * scale / cs->count,
+                              cycles_percentile(cs, 0.50, scale), cycles_percentile(cs, 0.99, scale),
+                              (double) cs->max * scale);
+                send_proc(connindex, scratch, var);
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Reset all stages
+//
+void cycles_reset(void) {
+        memset(cycStage, 0, sizeof(cycStage));
+}
+//----------------------------------------------------------------------------
+//
+// Return nanoseconds per counter tick, as measured since calibration start
+//
+double cycles_nsec_per_tick(void) {
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t ticks = CYC_NOW() - calTicks, mono = cycles_mono() - calMono;
+
+        if (ticks > 0 && mono > 0)
+                return (double) mono / (double) ticks;
+#endif
+        return 1.0;
+}
+//----------------------------------------------------------------------------
+//
+// Return percentile of stage in nanoseconds (highest value of the bucket containing it, limited to maximum)
+//
+double cycles_percentile(struct cycStage *cs, double quantile, double scale) {
+        int i, msb;
+        uint64_t target, sum = 0, ticks = 0;
+
+        if (cs->count == 0)
+                return 0.0;
+        target = (uint64_t) (quantile * (double) cs->count);
+        if (target < 1)
+                target = 1;
+        for (i = 0; i < CYC_BUCKETS; i++) {
+                if ((sum += cs->bucket[i]) >= target)
+                        break;
+        }
+        if (i < (1 << CYC_SUB_BITS)) {
+                ticks = (uint64_t) i;
+        } else {
+                msb   = (i >> CYC_SUB_BITS) + CYC_SUB_BITS - 1;
+                ticks = ((uint64_t) ((1 << CYC_SUB_BITS) + (i & ((1 << CYC_SUB_BITS) - 1)) + 1) << (msb - CYC_SUB_BITS)) - 1;
+        }
+        if (ticks > cs->max)
+                ticks = cs->max;
+        return (double) ticks * scale;
+}
+#endif /* ADD_CYCLE_COUNTERS */
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_cycles.h
+ *
+ * This file contains the hot-path stage timing macros and data structures as
+ * well as the external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_CYCLES_H
+#define UDPST_CYCLES_H
+
+//----------------------------------------------------------------------------
+//
+// Hot-path stage timing (only compiled in when ADD_CYCLE_COUNTERS is defined)
+//
+// Each stage accumulates a count, total and maximum of its durations in counter ticks, along with a log-linear
+// histogram (four buckets per power of two) for percentiles. On x86 the time stamp counter is read directly, while
+// elsewhere the monotonic clock is used with one tick per nanosecond. Ticks are only converted to nanoseconds when
+// reported, via a rate calibrated against the monotonic clock since startup.
+//
+// When not compiled in the macros are empty, leaving no code or data in the hot path.
+//
+#define CYC_DISPATCH  0   // Ready FD wait from epoll_wait() return to dispatch
+#define CYC_RECV      1   // Receive processing (recv_proc)
+#define CYC_LOADPDU   2   // Load PDU servicing per recvmmsg() batch
+#define CYC_HDRBUILD  3   // Load PDU burst build (headers and message structures)
+#define CYC_SENDMMSG  4   // Load PDU sendmmsg() system call
+#define CYC_STATUSPDU 5   // Status PDU processing and send
+#define CYC_TIMERSCAN 6   // Timer scan of all connections (includes timer actions)
+#define CYC_CURRATE   7   // Sub-interval output (output_currate)
+#define CYC_STAGES    8   // Number of stages
+#define CYC_SUB_BITS  2   // Sub-bucket bits per power of two
+#define CYC_BUCKETS   160 // Buckets (up to 2^40 ticks)
+struct cycStage {
+        uint64_t count;               // Samples
+        uint64_t total;               // Total ticks
+        uint64_t max;                 // Maximum ticks
+        uint32_t bucket[CYC_BUCKETS]; // Log-linear histogram of ticks
+};
+#ifdef ADD_CYCLE_COUNTERS
+#if defined(__x86_64__) || defined(__i386__)
+#define CYC_NOW() __builtin_ia32_rdtsc()
+#else
+#define CYC_NOW() cycles_mono()
+#endif
+#define CYC_START(var) ((var) = CYC_NOW())
+#define CYC_STOP(stage, var)                                                                                           \
+        do {                                                                                                           \
+                uint64_t _ticks = CYC_NOW() - (var);                                                                   \
+                cycStage[stage].count++;                                                                               \
+                cycStage[stage].total += _ticks;                                                                       \
+                if (_ticks > cycStage[stage].max)                                                                      \
+                        cycStage[stage].max = _ticks;                                                                  \
+                cycStage[stage].bucket[cycles_index(_ticks)]++;                                                        \
+        } while (0)
+#else
+#define CYC_START(var)
+#define CYC_STOP(stage, var)
+#endif
+
+//----------------------------------------------------------------------------
+//
+// External data and function prototypes
+//
+#ifdef ADD_CYCLE_COUNTERS
+extern struct cycStage cycStage[CYC_STAGES];
+extern uint64_t cycles_mono(void);
+extern int cycles_index(uint64_t);
+extern void cycles_init(void);
+extern int cycles_json(char *);
+extern void cycles_dump(int);
+extern void cycles_reset(void);
+#endif
+
+#endif /* UDPST_CYCLES_H */
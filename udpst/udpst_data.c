@@ -97,6 +97,7 @@
 #include <fcntl.h>
 #include <time.h>
 #include <math.h>
+#include <sched.h>
 #include <unistd.h>
 #include <net/if.h>
 #include <arpa/inet.h>
@@ -114,7 +115,17 @@
 #include "udpst_common.h"
 #include "udpst_protocol.h"
 #include "udpst.h"
+#include "udpst_cpu.h"
+#include "udpst_cycles.h"
 #include "udpst_data.h"
+#include "udpst_export.h"
+#include "udpst_histo.h"
+#include "udpst_jsonw.h"
+#include "udpst_intf.h"
+#include "udpst_probe.h"
+#include "udpst_ralgo.h"
+#include "udpst_shmstats.h"
+#include "udpst_srates.h"
 #ifndef __linux__
 #include "../udpst_data_alt2.h"
 #endif
@@ -124,17 +135,15 @@
 // Internal function prototypes
 //
 int send_loadpdu(int, int);
-int adjust_sending_rate(int);
+int check_convergence(int);
 int output_currate(int);
 int output_maxrate(int);
-double get_rate(int, struct subIntStats *, int);
 #ifdef __linux__
 int socket_error(int, int, char *);
 int receive_trunc(int, int, int);
 #endif
 void sis_copy(struct subIntStats *, struct subIntStats *, BOOL);
 void output_warning(int, int);
-void upd_intf_stats(BOOL);
 void output_minimum(int);
 void output_debug(int);
 BOOL verify_datapdu(int, struct loadHdr *, struct statusHdr *);
@@ -150,7 +159,7 @@ extern struct configuration conf;
 extern struct repository repo;
 extern struct connection *conn;
 //
-extern cJSON *json_top, *json_output, *json_siArray;
+extern cJSON *json_top, *json_output;
 extern char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
 
 //----------------------------------------------------------------------------
@@ -159,14 +168,29 @@ extern char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
 //
 #define LOSSRATIO_TEXT "LossRatio: %.2E, "
 #define DELIVERED_TEXT "Delivered(%%): %6.2f, "
-#define SUMMARY_TEXT   "Loss/OoO/Dup: %u/%u/%u, OWDVar(ms): %u/%u/%u, RTTVar(ms): %u/%u/%u, Mbps(L3/IP): %.2f%s\n"
+#define SUMMARY_TEXT   "Loss/OoO/Dup: %llu/%llu/%llu, OWDVar(ms): %u/%u/%u, RTTVar(ms): %u/%u/%u, Mbps(L3/IP): %.2f%s\n"
 #define MINIMUM_TEXT   "Minimum One-Way Delay(ms): %d [w/clock diff], Round-Trip Time(ms): %u"
 #define MINIMUM_FINAL  MINIMUM_TEXT ", Active Connections: %d\n"
+#define CONVERGED_TEXT "Converged (Early Stop): %s, Sub-Intervals: %d\n"
+#define QUANTILE_TEXT  "Percentiles(ms) p50/p90/p99/p99.9, OWDVar: %.3f/%.3f/%.3f/%.3f, RTTVar: %.3f/%.3f/%.3f/%.3f\n"
+#define TXSCHED_TEXT   "Tx[%d] Schedule(us) Bursts: %llu, Slip p50/p99/p99.9/Max: %u/%u/%u/%u, Jitter p50/p99/Max: %u/%u/%u, " \
+                       "Gap Avg[Intended]: %.1f[%.1f]\n"
+#define HOSTCPU_TEXT   "Host CPU(%%) Process/Thread: %.1f/%.1f, CtxSw Vol/Invol: %llu/%llu, Syscalls Tx/Rx: %llu/%llu, " \
+                       "Cycles/Pkt: %.0f, CPU/Gbps: %.3f%s\n"
 #define DEBUG_STATS    "[Loss/OoO/Dup: %u/%u/%u, OWDVar(ms): %u/%u/%u, RTTVar(ms): %d]"
 #define CLIENT_DEBUG   "[%d]DEBUG Status Feedback " DEBUG_STATS " Mbps(L3/IP): %.2f\n"
 #define SERVER_DEBUG   "[%d]DEBUG Rate Adjustment " DEBUG_STATS " SRIndex: %d\n"
 static char scratch2[STRING_SIZE + 32]; // Allow for log file timestamp prefix
+static const char *pdvQuantileName[HISTO_QUANTILES] = {"PDVP50", "PDVP90", "PDVP99", "PDVP999"};
+static const char *rttQuantileName[HISTO_QUANTILES] = {"RTTP50", "RTTP90", "RTTP99", "RTTP999"};
+static const char *slipQuantileName[HISTO_QUANTILES] = {"SlipP50", "SlipP90", "SlipP99", "SlipP999"};
+static const char *jitQuantileName[HISTO_QUANTILES]  = {"JitterP50", "JitterP90", "JitterP99", "JitterP999"};
 static int mmsgDataSize[RECVMMSG_SIZE]; // Received data size of each message
+static int mmsgEcn[RECVMMSG_SIZE];      // Received ECN codepoint of each message
+#ifdef SO_INCOMING_CPU
+static cpu_set_t cpuSetOrig; // Original CPU affinity (prior to pinning)
+static BOOL cpuPinned;       // Process pinned to incoming CPU
+#endif
 
 //----------------------------------------------------------------------------
 // Function definitions
@@ -190,6 +214,27 @@ static void _populate_header(struct loadHdr *lHdr, struct connection *c, unsigne
 }
 //----------------------------------------------------------------------------
 //
+// Calculate RTT response delay since last PDU was received (in usec, saturated to fit the
+// load header, when delay variation is in usec)
+//
+static unsigned int _rtt_resp_delay(struct connection *c) {
+        unsigned int rttrd = 0;
+        struct timespec tspecvar;
+
+        if (tspecisset(&c->pduRxTime)) {
+                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
+                if (c->delayUsec) {
+                        rttrd = (unsigned int) tspecusec(&tspecvar);
+                        if (rttrd > LOAD_RTTRD_MAX)
+                                rttrd = LOAD_RTTRD_MAX;
+                } else {
+                        rttrd = (unsigned int) tspecmsec(&tspecvar);
+                }
+        }
+        return rttrd;
+}
+//----------------------------------------------------------------------------
+//
 // Randomize payload of datagram (via single call of random())
 //
 static void _randomize_payload(char *buffer, unsigned int length) {
@@ -230,6 +275,40 @@ static void _randomize_payload(char *buffer, unsigned int length) {
 }
 //----------------------------------------------------------------------------
 //
+// Update per-connection performance statistics based on message(s) accepted by send request
+//
+static void _update_send_psconn(int connindex, int requested, int accepted, unsigned int payload, unsigned int addon) {
+        register struct connection *c = &conn[connindex];
+        unsigned int uvar;
+        struct perfStatsConn *psT = &c->psConn;
+
+        if (accepted > 0) {
+                psT->qdDatagrams += (unsigned int) accepted;
+                psT->qdBytes += (unsigned long long) (accepted * L3DG_OVERHEAD);
+                if (c->ipProtocol == IPPROTO_IPV6) {
+                        psT->qdBytes += (unsigned long long) (accepted * IPV6_ADDSIZE);
+                }
+                uvar = (unsigned int) accepted;
+                if (accepted == requested && addon > 0) {
+                        psT->qdBytes += (unsigned long long) addon;
+                        uvar--;
+                }
+                psT->qdBytes += (unsigned long long) (uvar * payload);
+#if defined(HAVE_SENDMMSG)
+                psT->txBurstCount++;
+                psT->txBurstTotal += (unsigned int) accepted;
+                if ((unsigned int) accepted > psT->txBurstSize)
+                        psT->txBurstSize = (unsigned int) accepted;
+#endif
+        }
+        if (accepted < requested) {
+                psT->txOverrunCount++;
+                psT->txOverrunTotal += (unsigned int) (requested - accepted);
+        }
+        return;
+}
+//----------------------------------------------------------------------------
+//
 // Update performance statistics based on message(s) accepted by send request
 //
 static void _update_send_ps(int connindex, int requested, int accepted, unsigned int payload, unsigned int addon) {
@@ -243,6 +322,8 @@ static void _update_send_ps(int connindex, int requested, int accepted, unsigned
         //
         if (accepted < 0)
                 accepted = 0;
+        if (conf.psConn)
+                _update_send_psconn(connindex, requested, accepted, payload, addon);
 
         //
         // Count accepted messages/bytes from beginning of burst (addon is at the end)
@@ -293,15 +374,15 @@ static void _sendmmsg_gso(int connindex, int totalburst, int burstsize, unsigned
         struct cmsghdr *cmsg;
         struct mmsghdr mmsg[MMSG_SEGMENTS];
         struct iovec iov[MMSG_SEGMENTS];
-        struct timespec tspecvar;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cyc;
+#endif
 
         //
         // Calculate RTT response delay
         //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                rttrd = (unsigned int) tspecmsec(&tspecvar);
-        }
+        CYC_START(cyc);
+        rttrd = _rtt_resp_delay(c);
 
         //
         // Prepare send structures
@@ -382,8 +463,11 @@ static void _sendmmsg_gso(int connindex, int totalburst, int burstsize, unsigned
         //
         // NOTE: Certain error conditions are expected when overloading an interface
         //
+        CYC_STOP(CYC_HDRBUILD, cyc);
+        CYC_START(cyc);
         var       = sendmmsg(c->fd, mmsg, j, 0);
         senderrno = errno;
+        CYC_STOP(CYC_SENDMMSG, cyc);
         if (var == -1 && (senderrno == EINVAL || senderrno == EMSGSIZE)) { // Flag GSO incompatibility (for older OR newer kernels)
                 var = sprintf(scratch, "ERROR: GSO incompatible with IP fragmentation (disable jumbo sizes or increase MTU)\n");
                 send_proc(errConn, scratch, var);
@@ -407,7 +491,10 @@ static void _sendmmsg_gso(int connindex, int totalburst, int burstsize, unsigned
         if (conf.seqNumAdjust && j < totalburst) { // Adjust sequence numbers to correct for datagrams not accepted
                 c->lpduSeqNo -= (unsigned int) (totalburst - j);
         }
-        if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) { // Update performance statistics
+        repo.sysCalls.txCalls++;
+        repo.sysCalls.txDgrams += (unsigned int) j;
+        UDPST_PROBE4(send_burst, connindex, c->srIndex, totalburst, j);
+        if (c->testAction == TEST_ACT_TEST && repo.psActive) { // Update performance statistics
                 _update_send_ps(connindex, totalburst, j, payload, addon);
         }
         if (!conf.errSuppress) {
@@ -438,16 +525,16 @@ static void _sendmmsg_burst(int connindex, int totalburst, int burstsize, unsign
         unsigned int uvar, rttrd = 0;
         char *nextsndbuf;
         int i, j, var, senderrno;
-        struct timespec tspecvar;
         struct loadHdr *lHdr;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cyc;
+#endif
 
         //
         // Calculate RTT response delay
         //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                rttrd = (unsigned int) tspecmsec(&tspecvar);
-        }
+        CYC_START(cyc);
+        rttrd = _rtt_resp_delay(c);
 
         //
         // Prepare send structures
@@ -489,14 +576,20 @@ static void _sendmmsg_burst(int connindex, int totalburst, int burstsize, unsign
         //
         // NOTE: Certain error conditions are expected when overloading an interface
         //
+        CYC_STOP(CYC_HDRBUILD, cyc);
+        CYC_START(cyc);
         var       = sendmmsg(c->fd, mmsg, totalburst, 0);
         senderrno = errno;
+        CYC_STOP(CYC_SENDMMSG, cyc);
         if ((j = var) < 0) // Datagrams accepted
                 j = 0;
         if (conf.seqNumAdjust && j < totalburst) { // Adjust sequence numbers to correct for datagrams not accepted
                 c->lpduSeqNo -= (unsigned int) (totalburst - j);
         }
-        if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) { // Update performance statistics
+        repo.sysCalls.txCalls++;
+        repo.sysCalls.txDgrams += (unsigned int) j;
+        UDPST_PROBE4(send_burst, connindex, c->srIndex, totalburst, j);
+        if (c->testAction == TEST_ACT_TEST && repo.psActive) { // Update performance statistics
                 _update_send_ps(connindex, totalburst, j, payload, addon);
         }
         if (!conf.errSuppress) {
@@ -526,17 +619,13 @@ static void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigne
         struct msghdr msg;
         struct iovec iov;
         unsigned int uvar, rttrd = 0;
-        int i, j, var, senderrno;
+        int i, j, var, senderrno, accepted = 0;
         struct loadHdr *lHdr;
-        struct timespec tspecvar;
 
         //
         // Calculate RTT response delay
         //
-        if (tspecisset(&c->pduRxTime)) {
-                tspecminus(&repo.systemClock, &c->pduRxTime, &tspecvar);
-                rttrd = (unsigned int) tspecmsec(&tspecvar);
-        }
+        rttrd = _rtt_resp_delay(c);
 
         //
         // Prepare send structures
@@ -579,10 +668,15 @@ static void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigne
                 //
                 var       = sendmsg(c->fd, &msg, 0);
                 senderrno = errno;
+                repo.sysCalls.txCalls++;
+                if (var > 0) {
+                        repo.sysCalls.txDgrams++;
+                        accepted++;
+                }
                 if (conf.seqNumAdjust && var <= 0) { // Adjust sequence number to correct for datagram not accepted
                         c->lpduSeqNo--;
                 }
-                if (c->testAction == TEST_ACT_TEST && conf.psFile != NULL) { // Update performance statistics
+                if (c->testAction == TEST_ACT_TEST && repo.psActive) { // Update performance statistics
                         if ((j = var) > 0)
                                 j = 1; // Convert byte count to message count of one (valid for UDP)
                         _update_send_ps(connindex, 1, j, 0, uvar);
@@ -604,10 +698,191 @@ static void _sendmsg_burst(int connindex, int totalburst, int burstsize, unsigne
                         }
                 }
         }
+        UDPST_PROBE4(send_burst, connindex, c->srIndex, totalburst, accepted);
 }
 #endif // HAVE_SENDMMSG
 //----------------------------------------------------------------------------
 //
+// Sample the CPU that processed the incoming load traffic (SO_INCOMING_CPU) and compare it to the
+// CPU currently executing the process. Optionally pin the process to the incoming CPU when learned.
+//
+static void _sample_incoming_cpu(int connindex) {
+#ifdef SO_INCOMING_CPU
+        register struct connection *c = &conn[connindex];
+        int var, cpu, curcpu;
+        socklen_t optlen = sizeof(cpu);
+        cpu_set_t cpuset;
+        struct perfStatsAverages *psA = &repo.psAverages;
+
+        if (c->tiRxDatagrams == 0)
+                return;
+        if (getsockopt(c->fd, SOL_SOCKET, SO_INCOMING_CPU, (void *) &cpu, &optlen) < 0 || cpu < 0)
+                return;
+        curcpu = sched_getcpu();
+
+        //
+        // Update locality stats
+        //
+        psA->rxCpuSamples++;
+        if (cpu == curcpu)
+                psA->rxCpuLocal++;
+        if (cpu < MAX_RXCPU_COUNT) {
+                psA->rxCpuSamplesPer[cpu]++;
+                if (cpu == curcpu)
+                        psA->rxCpuLocalPer[cpu]++;
+        }
+        if (c->incomingCpu == cpu)
+                return;
+
+        //
+        // Incoming CPU learned (or changed), pin process to it if configured and permitted by original mask
+        //
+        c->incomingCpu = cpu;
+        if (conf.verbose) {
+                var = sprintf(scratch, "[%d]Incoming CPU %d, process CPU %d\n", connindex, cpu, curcpu);
+                send_proc(monConn, scratch, var);
+        }
+        if (!conf.cpuAffinity || cpuPinned || cpu == curcpu)
+                return;
+        if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuSetOrig) < 0)
+                return;
+        if (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &cpuSetOrig))
+                return;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpu, &cpuset);
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset) < 0) {
+                var = sprintf(scratch, "[%d]SCHED_SETAFFINITY ERROR: %s\n", connindex, strerror(errno));
+                send_proc(errConn, scratch, var);
+                return;
+        }
+        cpuPinned = TRUE;
+        if (conf.verbose) {
+                var = sprintf(scratch, "[%d]Process pinned to CPU %d\n", connindex, cpu);
+                send_proc(monConn, scratch, var);
+        }
+#else
+        (void) (connindex);
+#endif
+}
+//----------------------------------------------------------------------------
+//
+// Shape a burst to the rate ceiling via token bucket (in bits at L3), reducing the burst size and/or dropping
+// the add-on datagram when not enough tokens are available
+//
+static void _shape_burst(struct connection *c, int *burstsize, unsigned int payload, unsigned int *addon) {
+        long long depth, needed, usec, subusec, dgbits, addbits = 0;
+        int count;
+        struct timespec tspecvar;
+
+        //
+        // Obtain datagram sizes (in bits at L3) and depth of bucket, which always allows at least the full burst
+        //
+        dgbits = (long long) (payload + L3DG_OVERHEAD) * 8;
+        if (*addon > 0)
+                addbits = (long long) (*addon + L3DG_OVERHEAD) * 8;
+        if (c->ipProtocol == IPPROTO_IPV6) {
+                dgbits += IPV6_ADDSIZE * 8;
+                if (*addon > 0)
+                        addbits += IPV6_ADDSIZE * 8;
+        }
+        needed = ((long long) *burstsize * dgbits) + addbits;
+        depth  = (long long) c->rateLimit * TBUCKET_DEPTH; // Mbps equals bits per usec
+        if (depth < needed)
+                depth = needed;
+
+        //
+        // Add tokens for time elapsed (bucket starts full), advancing update time only by time credited
+        //
+        // NOTE: Tokens are added slightly below the ceiling rate, by the bucket depth per sub-interval, so that the
+        // rate measured over any sub-interval (including a full bucket at its start) does not exceed the ceiling
+        //
+        if (!tspecisset(&c->tbTime)) {
+                c->tbTokens = depth;
+                tspeccpy(&c->tbTime, &repo.systemClock);
+        } else {
+                tspecminus(&repo.systemClock, &c->tbTime, &tspecvar);
+                usec    = (long long) tspecusec(&tspecvar);
+                subusec = (long long) c->subIntPeriod * USECINMSEC;
+                if (usec >= subusec)
+                        c->tbTokens = depth;
+                else if (subusec > TBUCKET_DEPTH)
+                        c->tbTokens += (usec * c->rateLimit * (subusec - TBUCKET_DEPTH)) / subusec;
+                if (c->tbTokens >= depth) {
+                        c->tbTokens = depth;
+                        tspeccpy(&c->tbTime, &repo.systemClock);
+                } else {
+                        tspecvar.tv_sec  = (time_t) (usec / USECINSEC);
+                        tspecvar.tv_nsec = (long) ((usec % USECINSEC) * NSECINUSEC);
+                        tspecplus(&c->tbTime, &tspecvar, &c->tbTime);
+                }
+        }
+
+        //
+        // Consume tokens for what can be sent
+        //
+        if (dgbits > 0 && *burstsize > 0) {
+                count = (int) (c->tbTokens / dgbits);
+                if (count < *burstsize)
+                        *burstsize = count;
+                c->tbTokens -= (long long) *burstsize * dgbits;
+        }
+        if (*addon > 0) {
+                if (c->tbTokens >= addbits)
+                        c->tbTokens -= addbits;
+                else
+                        *addon = 0;
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Size the trial interval from the measured minimum RTT (when RTT-adaptive). The interval is kept within the
+// configured limits and is always an even divisor of the sub-interval period so that status PDUs remain aligned.
+//
+static void _adapt_trial_int(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var, target, trialint;
+
+        if (!c->trialAdapt || c->rttMinimum == STATUS_NODEL)
+                return;
+        target = (int) c->rttMinimum;
+        if (target < MIN_TRIAL_INT)
+                target = MIN_TRIAL_INT;
+        if (target > MAX_TRIAL_INT)
+                target = MAX_TRIAL_INT;
+        if (target > c->subIntPeriod / 2)
+                target = c->subIntPeriod / 2;
+        for (trialint = target; trialint > MIN_TRIAL_INT; trialint--) {
+                if (c->subIntPeriod % trialint == 0)
+                        break;
+        }
+        if (c->subIntPeriod % trialint != 0 || trialint == c->trialInt)
+                return;
+        if (conf.verbose) {
+                var = sprintf(scratch, "[%d]Trial interval adapted from %d to %d ms (RTT min: %u ms)\n", connindex, c->trialInt,
+                              trialint, c->rttMinimum);
+                send_proc(monConn, scratch, var);
+        }
+        c->trialInt = trialint;
+}
+//----------------------------------------------------------------------------
+//
+// Restore original CPU affinity if process was pinned to an incoming CPU (called when server goes idle)
+//
+void restore_affinity(void) {
+#ifdef SO_INCOMING_CPU
+        int var;
+
+        if (!cpuPinned)
+                return;
+        cpuPinned = FALSE;
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuSetOrig) < 0) {
+                var = sprintf(scratch, "SCHED_SETAFFINITY ERROR: %s\n", strerror(errno));
+                send_proc(errConn, scratch, var);
+        }
+#endif
+}
+//----------------------------------------------------------------------------
+//
 // Send load PDUs via periodic timers for transmitters 1 & 2
 //
 int send1_loadpdu(int connindex) {
@@ -629,7 +904,7 @@ int send_loadpdu(int connindex, int transmitter) {
         // Select sending rate source
         //
         if (repo.isServer) {
-                sr = &repo.sendingRates[c->srIndex]; // Local table if server
+                sr = sr_select(connindex, c->srIndex); // Local table (or synthesized) if server
         } else {
                 sr = &c->srStruct; // Server specified values if client
         }
@@ -687,7 +962,10 @@ int send_loadpdu(int connindex, int transmitter) {
                                 int var = sprintf(scratch, "[%d]Sending test stop\n", connindex);
                                 send_proc(monConn, scratch, var);
                         }
-                        c->testAction = TEST_ACT_STOP2; // Second phase of test stop
+                        if (c->convStopped)
+                                c->testAction = TEST_ACT_STOPC; // Second phase of test stop (converged)
+                        else
+                                c->testAction = TEST_ACT_STOP2; // Second phase of test stop
                 } else {
                         //
                         // The PDU sent in this pass will confirm the test stop back to the server,
@@ -714,6 +992,11 @@ int send_loadpdu(int connindex, int transmitter) {
                 tspecalt = &c->timer1Thresh;
         }
         //
+        // Record transmit schedule accuracy (test traffic of client, or for performance statistics of server)
+        //
+        if (c->testAction == TEST_ACT_TEST && (!repo.isServer || repo.psActive))
+                histo_txsched(connindex, transmitter, tspecpri, txintpri);
+        //
         // Reset or clear primary timer (this one)
         //
         if (txintpri > 0) {
@@ -732,15 +1015,23 @@ int send_loadpdu(int connindex, int transmitter) {
                 tspecplus(&repo.systemClock, &tspecvar, tspecalt);
         } else if (tspecisset(tspecalt) && txintalt == 0) {
                 tspecclear(tspecalt);
+                tspecclear(&c->txLastTime[2 - transmitter]); // Schedule accuracy starts over when set again
+                c->txLastGap[2 - transmitter] = 0;
         }
 
         //
-        // Initialize interface stats on first PDU if sysfs FD is valid
+        // Initialize interface stats on first PDU if netlink socket is valid
         //
         if (repo.intfFD >= 0 && !tspecisset(&repo.intfTime)) {
-                upd_intf_stats(TRUE);
+                intf_update(TRUE);
         }
 
+        //
+        // Shape load traffic to rate ceiling if needed (test stop is never delayed)
+        //
+        if (c->rateLimit > 0 && c->testAction == TEST_ACT_TEST)
+                _shape_burst(c, &burstsize, payload, &addon);
+
         //
         // Check for burst size of zero
         //
@@ -760,8 +1051,11 @@ int send_loadpdu(int connindex, int transmitter) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_LOC_STOPPED);
                         }
-                        if (c->testAction == TEST_ACT_TEST)
+                        if (c->testAction == TEST_ACT_TEST) {
                                 psA->locTrafficStop++;
+                                if (conf.psConn)
+                                        c->psConn.locTrafficStop++;
+                        }
                 } else {
                         c->rxStoppedLoc = FALSE;
                 }
@@ -793,9 +1087,12 @@ int service_loadpdu(int connindex) {
         register struct connection *c = &conn[connindex];
         int i, delta, var;
         BOOL bvar, firstpdu = FALSE;
-        unsigned int uvar, seqno, rttrd, payload;
+        unsigned int uvar, rttrd, rttus, payload;
+        unsigned long long seqno;
+        long long deltaus = 0;
         struct loadHdr *lHdr = (struct loadHdr *) repo.rcvDataPtr;
         struct timespec tspecvar, tspecdelta;
+        struct exportRecord exprec;
         char *nulloutput              = ",,,,,\n";
         struct perfStatsAverages *psA = &repo.psAverages;
 
@@ -824,10 +1121,15 @@ int service_loadpdu(int connindex) {
                         //
                         if (c->testAction == TEST_ACT_TEST) {
                                 if (conf.verbose) {
-                                        var = sprintf(scratch, "[%d]Test stop received\n", connindex);
+                                        var = sprintf(scratch, "[%d]Test stop received%s\n", connindex,
+                                                      lHdr->testAction == TEST_ACT_STOPC ? " (converged)" : "");
                                         send_proc(monConn, scratch, var);
                                 }
                                 c->testAction = (int) lHdr->testAction;
+                                if (c->testAction == TEST_ACT_STOPC) {
+                                        c->convStopped = TRUE;
+                                        repo.convConnCount++;
+                                }
                         }
                         return 0;
                 }
@@ -852,8 +1154,11 @@ int service_loadpdu(int connindex) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_REM_STOPPED);
                         }
-                        if (c->testAction == TEST_ACT_TEST)
+                        if (c->testAction == TEST_ACT_TEST) {
                                 psA->remTrafficStop++;
+                                if (conf.psConn)
+                                        c->psConn.remTrafficStop++;
+                        }
                 }
         }
 
@@ -864,23 +1169,36 @@ int service_loadpdu(int connindex) {
         c->sisAct.rxDatagrams++;
         c->sisAct.rxBytes += (uint64_t) payload;
         c->tiRxDatagrams++;
-        c->tiRxBytes += payload;
+        c->tiRxBytes += (unsigned long long) payload;
+        if (c->ecnRecv && repo.rcvEcn != ECN_NOTECT) {
+                c->tiRxEct++;
+                if (repo.rcvEcn == ECN_CE)
+                        c->tiRxCe++;
+        }
 
         //
         // Check sequence number for loss, also reordering/duplication (end processing if so)
         //
+        // NOTE: The 32-bit sequence number in the PDU is extended to 64 bits relative to the last one received
+        // (serial number arithmetic), so that wrapping during long high-rate tests is not seen as loss or reordering.
+        //
         if (c->lpduSeqNo == 0)
                 firstpdu = TRUE;
-        var   = 0; // Used below for history buffer processing
-        seqno = (unsigned int) ntohl(lHdr->lpduSeqNo);
+        var = 0; // Used below for history buffer processing
+        if (firstpdu)
+                seqno = (unsigned long long) ntohl(lHdr->lpduSeqNo);
+        else
+                seqno = c->lpduSeqNo +
+                        (unsigned long long) (long long) (int32_t) (ntohl(lHdr->lpduSeqNo) - (uint32_t) c->lpduSeqNo);
         if (seqno >= c->lpduSeqNo + 1) {
                 //
                 // Sequence number greater than or equal to expected
                 //
                 if (seqno > c->lpduSeqNo + 1) {
-                        uvar = seqno - c->lpduSeqNo - 1; // Calculate loss
+                        uvar = (unsigned int) (seqno - c->lpduSeqNo - 1); // Calculate loss
                         c->seqErrLoss += uvar;
                         c->sisAct.seqErrLoss += (uint32_t) uvar;
+                        UDPST_PROBE3(seq_loss, connindex, seqno, uvar);
                 }
                 c->lpduSeqNo = seqno; // Update for next expected
         } else {
@@ -898,6 +1216,7 @@ int service_loadpdu(int connindex) {
                         c->seqErrDup++;
                         c->sisAct.seqErrDup++;
                         var = 2; // Skip history buffer insertion as well as subsequent processing
+                        UDPST_PROBE4(seq_reorder, connindex, seqno, c->lpduSeqNo + 1, 1);
                 } else {
                         //
                         // Sequence number NOT in history buffer, increment out-of-order count
@@ -905,6 +1224,7 @@ int service_loadpdu(int connindex) {
                         c->seqErrOoo++;
                         c->sisAct.seqErrOoo++;
                         var = 1; // Skip subsequent processing
+                        UDPST_PROBE4(seq_reorder, connindex, seqno, c->lpduSeqNo + 1, 0);
 
                         //
                         // Correct previous loss count that resulted from this "late" datagram
@@ -929,15 +1249,28 @@ int service_loadpdu(int connindex) {
         tspecvar.tv_sec  = (time_t) ntohl(lHdr->lpduTime_sec);
         tspecvar.tv_nsec = (long) ntohl(lHdr->lpduTime_nsec);
         tspecminus(&repo.systemClock, &tspecvar, &tspecdelta);
-        delta = (int) tspecmsec(&tspecdelta);
-        if (c->outputFPtr != NULL) { // Start output data with one-way values (store in scratch2 for below)
-                sprintf(scratch2, "%u,%u,%ld.%06ld,%ld.%06ld,%d,%.2f,%.2f", seqno, payload, (long) tspecvar.tv_sec,
+        delta   = (int) tspecmsec(&tspecdelta);
+        deltaus = (long long) tspecusec(&tspecdelta); // Always needed for histogram
+        if (c->exportRing != NULL) { // Start binary record with one-way values (finalized below)
+                memset(&exprec, 0, sizeof(exprec));
+                exprec.seqNo       = (uint32_t) seqno; // Wire value (lower 32 bits)
+                exprec.payload     = (uint16_t) payload;
+                exprec.srcTxTime   = ((uint64_t) tspecvar.tv_sec * NSECINSEC) + (uint64_t) tspecvar.tv_nsec;
+                exprec.dstRxTime   = ((uint64_t) repo.systemClock.tv_sec * NSECINSEC) + (uint64_t) repo.systemClock.tv_nsec;
+                exprec.owd         = (int32_t) delta;
+                exprec.intfMbps    = repo.intfMbps;
+                exprec.intfMbpsAlt = repo.intfMbpsAlt;
+        } else if (c->outputFPtr != NULL) { // Start output data with one-way values (store in scratch2 for below)
+                sprintf(scratch2, "%llu,%u,%ld.%06ld,%ld.%06ld,%d,%.2f,%.2f", seqno, payload, (long) tspecvar.tv_sec,
                         tspecvar.tv_nsec / NSECINUSEC, (long) repo.systemClock.tv_sec, repo.systemClock.tv_nsec / NSECINUSEC, delta,
                         repo.intfMbps, repo.intfMbpsAlt);
         }
         if (var > 0) {
-                if (c->outputFPtr != NULL && conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
-                        fprintf(c->outputFPtr, "%s%s", scratch2, nulloutput);
+                if (conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
+                        if (c->exportRing != NULL)
+                                export_record(c->exportRing, &exprec);
+                        else if (c->outputFPtr != NULL)
+                                fprintf(c->outputFPtr, "%s%s", scratch2, nulloutput);
                 }
                 return 0; // No further processing for non-increasing sequence numbers
         }
@@ -950,11 +1283,24 @@ int service_loadpdu(int connindex) {
         tspecvar.tv_nsec = (long) ntohl(lHdr->spduTime_nsec);
         if (tspecvar.tv_nsec != c->spduTime.tv_nsec || tspecvar.tv_sec != c->spduTime.tv_sec) {
                 tspecminus(&repo.systemClock, &tspecvar, &tspecdelta);
-                uvar = (unsigned int) tspecmsec(&tspecdelta);
+                uvar  = (unsigned int) tspecmsec(&tspecdelta);
+                rttrd = (unsigned int) ntohs(lHdr->rttRespDelay);
+                rttus = STATUS_NODEL;
+                if (c->delayUsec) {
+                        //
+                        // Response delay is in usec, calculate usec RTT (unless response delay was saturated)
+                        // and convert response delay to ms for the processing below
+                        //
+                        if (rttrd < LOAD_RTTRD_MAX) {
+                                rttus = (unsigned int) tspecusec(&tspecdelta);
+                                rttus = (rttrd <= rttus) ? rttus - rttrd : 0;
+                        }
+                        rttrd = (rttrd + (USECINMSEC / 2)) / USECINMSEC;
+                }
                 //
                 // Adjust RTT based on delay between when status PDU was received and load PDU sent
                 //
-                if ((rttrd = (unsigned int) ntohs(lHdr->rttRespDelay)) <= uvar) {
+                if (rttrd <= uvar) {
                         uvar -= rttrd;
                 } else if (rttrd == uvar + 1) { // Allow for rounding adjustment on either end
                         uvar = 0;
@@ -968,44 +1314,69 @@ int service_loadpdu(int connindex) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_REM_STATUS);
                         }
-                        if (c->testAction == TEST_ACT_TEST)
+                        if (c->testAction == TEST_ACT_TEST) {
                                 psA->remStatusLoss += (unsigned int) c->spduSeqErr;
+                                if (conf.psConn)
+                                        c->psConn.remStatusLoss += (unsigned int) c->spduSeqErr;
+                        }
                 }
-                if (c->outputFPtr != NULL) { // Finalize output data with RTT values (use scratch2 from above)
+                if (c->exportRing != NULL) { // Finalize binary record with RTT values
+                        exprec.flags        = EXPREC_RTT;
+                        exprec.rttTxTime    = ((uint64_t) tspecvar.tv_sec * NSECINSEC) + (uint64_t) tspecvar.tv_nsec;
+                        exprec.rttRespDelay = (uint16_t) rttrd;
+                        exprec.rtt          = (uint32_t) uvar;
+                        exprec.statusLoss   = (int32_t) c->spduSeqErr;
+                        export_record(c->exportRing, &exprec);
+                } else if (c->outputFPtr != NULL) { // Finalize output data with RTT values (use scratch2 from above)
                         fprintf(c->outputFPtr, "%s,%ld.%06ld,%ld.%06ld,%u,%u,%d\n", scratch2, (long) tspecvar.tv_sec,
                                 tspecvar.tv_nsec / NSECINUSEC, (long) repo.systemClock.tv_sec,
                                 repo.systemClock.tv_nsec / NSECINUSEC, rttrd, uvar, c->spduSeqErr);
                 }
-                //
-                // Check for new minimum
-                //
-                if (uvar < c->rttMinimum) {
-                        c->rttMinimum  = uvar;
-                        c->delayMinUpd = TRUE;
+                if (!c->delayUsec || rttus != STATUS_NODEL) { // Skip sample if usec response delay was saturated
+                        //
+                        // Check for new minimum
+                        //
+                        if (uvar < c->rttMinimum) {
+                                c->rttMinimum  = uvar;
+                                c->delayMinUpd = TRUE;
+                        }
+                        //
+                        // Update RTT variation for trial interval and RTT variation range for sub-interval
+                        //
+                        c->rttVarSample = uvar - c->rttMinimum;
+                        if (c->rttVarSample < (unsigned int) c->sisAct.rttVarMinimum)
+                                c->sisAct.rttVarMinimum = (uint32_t) c->rttVarSample;
+                        if (c->rttVarSample > (unsigned int) c->sisAct.rttVarMaximum)
+                                c->sisAct.rttVarMaximum = (uint32_t) c->rttVarSample;
+                        c->rttVarSum += c->rttVarSample; // Update local RTT variation sum and count
+                        c->rttVarCnt++;
+                        if (c->delayUsec) { // Update usec RTT minimum and variation for trial interval
+                                if (rttus < c->rttMinimumUs)
+                                        c->rttMinimumUs = rttus;
+                                c->rttVarSampleUs = rttus - c->rttMinimumUs;
+                        }
+                        if (c->histo != NULL) { // Histogram has ms resolution unless usec RTT is available
+                                if (c->delayUsec)
+                                        histo_record(&c->histo->act[HISTO_RTT], c->rttVarSampleUs);
+                                else
+                                        histo_record(&c->histo->act[HISTO_RTT], c->rttVarSample * USECINMSEC);
+                        }
                 }
-                //
-                // Update RTT variation for trial interval and RTT variation range for sub-interval
-                //
-                c->rttVarSample = uvar - c->rttMinimum;
-                if (c->rttVarSample < (unsigned int) c->sisAct.rttVarMinimum)
-                        c->sisAct.rttVarMinimum = (uint32_t) c->rttVarSample;
-                if (c->rttVarSample > (unsigned int) c->sisAct.rttVarMaximum)
-                        c->sisAct.rttVarMaximum = (uint32_t) c->rttVarSample;
-                c->rttVarSum += c->rttVarSample; // Update local RTT variation sum and count
-                c->rttVarCnt++;
                 tspeccpy(&c->spduTime, &tspecvar); // Save to detect updated value
-        } else {
-                if (c->outputFPtr != NULL && conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
+        } else if (conf.outputFileAll) { // Finalize output data with nulls (use scratch2 from above)
+                if (c->exportRing != NULL)
+                        export_record(c->exportRing, &exprec);
+                else if (c->outputFPtr != NULL)
                         fprintf(c->outputFPtr, "%s%s", scratch2, nulloutput);
-                }
         }
 
         //
         // Process one-way clock delta (calculated above) and delay variation for this load PDU
         //
         if (firstpdu) {
-                c->clockDeltaMin = delta;
-                c->delayMinUpd   = TRUE;
+                c->clockDeltaMin   = delta;
+                c->clockDeltaMinUs = deltaus;
+                c->delayMinUpd     = TRUE;
         } else {
                 //
                 // Check for new minimum
@@ -1033,6 +1404,23 @@ int service_loadpdu(int connindex) {
                         c->sisAct.delayVarMax = (uint32_t) uvar;
                 c->sisAct.delayVarSum += (uint32_t) uvar;
                 c->sisAct.delayVarCnt++;
+                c->sisDelayVarSum += (unsigned long long) uvar;
+                //
+                // Update usec one-way delay variation histogram for sub-interval and, if enabled, usec
+                // stats for trial interval (count is shared with above)
+                //
+                if (deltaus < c->clockDeltaMinUs)
+                        c->clockDeltaMinUs = deltaus;
+                uvar = (unsigned int) (deltaus - c->clockDeltaMinUs);
+                if (c->histo != NULL)
+                        histo_record(&c->histo->act[HISTO_OWD], uvar);
+                if (c->delayUsec) {
+                        if (uvar < c->delayVarMinUs)
+                                c->delayVarMinUs = uvar;
+                        if (uvar > c->delayVarMaxUs)
+                                c->delayVarMaxUs = uvar;
+                        c->delayVarSumUs += (unsigned long long) uvar;
+                }
         }
         return 0;
 }
@@ -1042,15 +1430,22 @@ int service_loadpdu(int connindex) {
 //
 int send_statuspdu(int connindex) {
         register struct connection *c = &conn[connindex];
-        int var;
+        int var, trailer = 0;
+        unsigned int ect, ce;
         struct timespec tspecvar;
         struct sendingRate *sr;
+        struct statusHdrExt *sExt;
         struct statusHdr *sHdr        = (struct statusHdr *) repo.defBuffer;
         struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsConn *psT;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cyc;
+#endif
 
         //
         // Check for test stop in progress, else reset status send timer
         //
+        CYC_START(cyc);
         if (c->testAction != TEST_ACT_TEST) {
                 tspecclear(&c->timer1Thresh); // Stop subsequent status messages
                 if (repo.isServer) {
@@ -1058,7 +1453,10 @@ int send_statuspdu(int connindex) {
                                 var = sprintf(scratch, "[%d]Sending test stop\n", connindex);
                                 send_proc(monConn, scratch, var);
                         }
-                        c->testAction = TEST_ACT_STOP2; // Second phase of test stop
+                        if (c->convStopped)
+                                c->testAction = TEST_ACT_STOPC; // Second phase of test stop (converged)
+                        else
+                                c->testAction = TEST_ACT_STOP2; // Second phase of test stop
                 } else {
                         //
                         // The PDU sent in this pass will confirm the test stop back to the server,
@@ -1069,6 +1467,7 @@ int send_statuspdu(int connindex) {
                 if (repo.endTimeStatus > STATUS_WARNMAX)     // Declare success, but retain warnings
                         repo.endTimeStatus = STATUS_SUCCESS; // ErrorStatus
         } else {
+                _adapt_trial_int(connindex);
                 tspecvar.tv_sec  = 0;
                 tspecvar.tv_nsec = (long) (c->trialInt * NSECINMSEC);
                 tspecplus(&repo.systemClock, &tspecvar, &c->timer1Thresh);
@@ -1086,6 +1485,11 @@ int send_statuspdu(int connindex) {
                         return 0;
                 }
 
+                //
+                // Sample incoming CPU locality of receive traffic
+                //
+                _sample_incoming_cpu(connindex);
+
                 //
                 // If server, adjust sending rate based on our receive traffic conditions
                 //
@@ -1106,18 +1510,21 @@ int send_statuspdu(int connindex) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_LOC_STOPPED);
                         }
-                        if (c->testAction == TEST_ACT_TEST)
+                        if (c->testAction == TEST_ACT_TEST) {
                                 psA->locTrafficStop++;
+                                if (conf.psConn)
+                                        c->psConn.locTrafficStop++;
+                        }
                 } else {
                         c->rxStoppedLoc = FALSE;
                 }
         }
 
         //
-        // Initialize interface stats on first PDU if sysfs FD is valid
+        // Initialize interface stats on first PDU if netlink socket is valid
         //
         if (repo.intfFD >= 0 && !tspecisset(&repo.intfTime)) {
-                upd_intf_stats(TRUE);
+                intf_update(TRUE);
         }
 
         //
@@ -1132,7 +1539,7 @@ int send_statuspdu(int connindex) {
         // Copy sending rate parameters or clear structure
         //
         if (repo.isServer) {
-                sr = &repo.sendingRates[c->srIndex];
+                sr = sr_select(connindex, c->srIndex);
                 sr_copy(sr, &sHdr->srStruct, TRUE);
         } else {
                 memset(&sHdr->srStruct, 0, sizeof(struct sendingRate));
@@ -1157,7 +1564,7 @@ int send_statuspdu(int connindex) {
         sHdr->clockDeltaMin = htonl((uint32_t) c->clockDeltaMin);
         sHdr->delayVarMin   = htonl(c->delayVarMin);
         sHdr->delayVarMax   = htonl(c->delayVarMax);
-        sHdr->delayVarSum   = htonl(c->delayVarSum);
+        sHdr->delayVarSum   = htonl((uint32_t) (c->delayVarSum < UINT32_MAX ? c->delayVarSum : UINT32_MAX));
         sHdr->delayVarCnt   = htonl(c->delayVarCnt);
         sHdr->rttMinimum    = htonl(c->rttMinimum);
         sHdr->rttVarSample  = htonl(c->rttVarSample);
@@ -1172,7 +1579,7 @@ int send_statuspdu(int connindex) {
         c->tiDeltaTime      = (unsigned int) tspecusec(&tspecvar);
         sHdr->tiDeltaTime   = htonl((uint32_t) c->tiDeltaTime);
         sHdr->tiRxDatagrams = htonl((uint32_t) c->tiRxDatagrams);
-        sHdr->tiRxBytes     = htonl((uint32_t) c->tiRxBytes);
+        sHdr->tiRxBytes     = htonl((uint32_t) (c->tiRxBytes < UINT32_MAX ? c->tiRxBytes : UINT32_MAX));
 
         //
         // Include time reference for this status PDU
@@ -1180,12 +1587,52 @@ int send_statuspdu(int connindex) {
         sHdr->spduTime_sec  = htonl((uint32_t) repo.systemClock.tv_sec);
         sHdr->spduTime_nsec = htonl((uint32_t) repo.systemClock.tv_nsec);
 
+        //
+        // Include microsecond delay info and 64-bit accumulators via status extension (the 32-bit values above
+        // are saturated for older peers)
+        //
+        if (c->protocolVer >= USDELAY_PVER) {
+                sExt                 = (struct statusHdrExt *) ((char *) sHdr + STATUS_SIZE_CVER);
+                sExt->delayVarMinUs  = htonl(c->delayVarMinUs);
+                sExt->delayVarMaxUs  = htonl(c->delayVarMaxUs);
+                sExt->delayVarSumUs  = (uint64_t) htonll(c->delayVarSumUs);
+                sExt->rttMinimumUs   = htonl(c->rttMinimumUs);
+                sExt->rttVarSampleUs = htonl(c->rttVarSampleUs);
+                if (c->protocolVer >= SEQ64_PVER) {
+                        sExt->delayVarSum    = (uint64_t) htonll(c->delayVarSum);
+                        sExt->sisDelayVarSum = (uint64_t) htonll(c->sisDelayVarSav);
+                        sExt->tiRxBytes      = (uint64_t) htonll(c->tiRxBytes);
+                }
+        }
+
+        //
+        // Append histograms of last saved sub-interval (encoded when it was saved) to the first few status PDUs after it
+        //
+        if (c->protocolVer >= HISTO_PVER && c->histo != NULL && c->histo->wireLen > 0 && c->histo->wireSends > 0) {
+                c->histo->wireSends--;
+                trailer = c->histo->wireLen;
+                memcpy((char *) sHdr + STATUS_SIZE_EVER, c->histo->wire, (size_t) trailer);
+        }
+
         //
         // Authentication
         //
         if (c->protocolVer >= EXTAUTH_PVER) {
                 sHdr->reserved3    = 0;
                 sHdr->reserved4    = 0;
+                if (c->protocolVer >= ECNCE_PVER && c->tiRxEct > 0) {
+                        //
+                        // Include ECN counts (scaled to 16 bits if needed, retaining the CE fraction)
+                        //
+                        ect = c->tiRxEct;
+                        ce  = c->tiRxCe;
+                        if (ect > UINT16_MAX) {
+                                ce  = (unsigned int) (((unsigned long long) ce * UINT16_MAX) / ect);
+                                ect = UINT16_MAX;
+                        }
+                        sHdr->reserved2 = htons((uint16_t) ect); // Utilizes reserved alignment field
+                        sHdr->reserved3 = htons((uint16_t) ce);  // Utilizes reserved alignment field
+                }
                 sHdr->authMode     = (uint8_t) c->authMode;
                 sHdr->authUnixTime = 0;
                 memset(&sHdr->authDigest, 0, AUTH_DIGEST_LENGTH);
@@ -1194,7 +1641,10 @@ int send_statuspdu(int connindex) {
                 //
                 sHdr->checkSum = 0;
 #ifdef ADD_HEADER_CSUM
-                sHdr->checkSum = checksum(sHdr, STATUS_SIZE_CVER);
+                if (c->protocolVer >= USDELAY_PVER)
+                        sHdr->checkSum = checksum(sHdr, (int) STATUS_SIZE_EVER + trailer);
+                else
+                        sHdr->checkSum = checksum(sHdr, STATUS_SIZE_CVER);
 #endif
         } else {
                 sHdr->reserved2 = 0;
@@ -1219,18 +1669,28 @@ int send_statuspdu(int connindex) {
         // Update performance statistics with this trial interval data
         // A transmitted status message covers datagrams received (and delivered)
         //
-        if (conf.psFile != NULL) {
+        if (repo.psActive) {
                 psA->txStatusMsgs++;
                 //
                 psA->rxDatagrams += c->tiRxDatagrams;
-                psA->rxBytes += (unsigned long long) (c->tiRxDatagrams * L3DG_OVERHEAD);
+                psA->rxBytes += (unsigned long long) c->tiRxDatagrams * L3DG_OVERHEAD;
                 if (c->ipProtocol == IPPROTO_IPV6) {
-                        psA->rxBytes += (unsigned long long) (c->tiRxDatagrams * IPV6_ADDSIZE);
+                        psA->rxBytes += (unsigned long long) c->tiRxDatagrams * IPV6_ADDSIZE;
                 }
-                psA->rxBytes += (unsigned long long) c->tiRxBytes;
+                psA->rxBytes += c->tiRxBytes;
                 //
                 psA->rxSeqErrLoss += c->seqErrLoss;
                 psA->rxSeqErrOooDup += c->seqErrOoo + c->seqErrDup;
+                //
+                if (conf.psConn) {
+                        psT = &c->psConn;
+                        psT->rxDatagrams += c->tiRxDatagrams;
+                        psT->rxBytes += (unsigned long long) c->tiRxDatagrams * L3DG_OVERHEAD;
+                        if (c->ipProtocol == IPPROTO_IPV6) {
+                                psT->rxBytes += (unsigned long long) c->tiRxDatagrams * IPV6_ADDSIZE;
+                        }
+                        psT->rxBytes += c->tiRxBytes;
+                }
         }
 
         //
@@ -1240,22 +1700,30 @@ int send_statuspdu(int connindex) {
         c->seqErrOoo  = 0;
         c->seqErrDup  = 0;
         // Do not clear clock delta minimum
-        c->delayVarMin = STATUS_NODEL;
-        c->delayVarMax = 0;
-        c->delayVarSum = 0;
-        c->delayVarCnt = 0;
+        c->delayVarMin   = STATUS_NODEL;
+        c->delayVarMax   = 0;
+        c->delayVarSum   = 0;
+        c->delayVarCnt   = 0;
+        c->delayVarMinUs = STATUS_NODEL;
+        c->delayVarMaxUs = 0;
+        c->delayVarSumUs = 0;
         // Do not clear global RTT minimum
-        c->rttVarSample = STATUS_NODEL;
-        c->delayMinUpd  = FALSE;
+        c->rttVarSample   = STATUS_NODEL;
+        c->rttVarSampleUs = STATUS_NODEL;
+        c->delayMinUpd    = FALSE;
         tspeccpy(&c->trialIntClock, &repo.systemClock);
         c->tiDeltaTime   = 0;
         c->tiRxDatagrams = 0;
         c->tiRxBytes     = 0;
+        c->tiRxEct       = 0;
+        c->tiRxCe        = 0;
 
         //
         // Send status message
         //
-        if (c->protocolVer >= EXTAUTH_PVER) {
+        if (c->protocolVer >= USDELAY_PVER) {
+                var = (int) STATUS_SIZE_EVER + trailer;
+        } else if (c->protocolVer >= EXTAUTH_PVER) {
                 var = STATUS_SIZE_CVER;
         } else {
                 //
@@ -1265,6 +1733,7 @@ int send_statuspdu(int connindex) {
                 var  = STATUS_SIZE_MVER;
         }
         send_proc(connindex, (char *) sHdr, var);
+        CYC_STOP(CYC_STATUSPDU, cyc);
 
         //
         // Initialize or process sub-interval statistics. Because it is checked with each
@@ -1304,8 +1773,10 @@ int service_statuspdu(int connindex) {
         BOOL bvar;
         unsigned int uvar, seqno;
         struct timespec tspecvar;
+        struct statusHdrExt *sExt     = NULL;
         struct statusHdr *sHdr        = (struct statusHdr *) repo.defBuffer;
         struct perfStatsAverages *psA = &repo.psAverages;
+        struct perfStatsConn *psT;
 
         //
         // Verify PDU
@@ -1344,10 +1815,15 @@ int service_statuspdu(int connindex) {
                         //
                         if (c->testAction == TEST_ACT_TEST) {
                                 if (conf.verbose) {
-                                        var = sprintf(scratch, "[%d]Test stop received\n", connindex);
+                                        var = sprintf(scratch, "[%d]Test stop received%s\n", connindex,
+                                                      sHdr->testAction == TEST_ACT_STOPC ? " (converged)" : "");
                                         send_proc(monConn, scratch, var);
                                 }
                                 c->testAction = (int) sHdr->testAction;
+                                if (c->testAction == TEST_ACT_STOPC) {
+                                        c->convStopped = TRUE;
+                                        repo.convConnCount++;
+                                }
                         }
                         // Delay return until after statistics are updated below
                         // return 0;
@@ -1373,8 +1849,11 @@ int service_statuspdu(int connindex) {
                                 c->warningCount++;
                                 output_warning(connindex, WARN_REM_STOPPED);
                         }
-                        if (c->testAction == TEST_ACT_TEST)
+                        if (c->testAction == TEST_ACT_TEST) {
                                 psA->remTrafficStop++;
+                                if (conf.psConn)
+                                        c->psConn.remTrafficStop++;
+                        }
                 }
         }
 
@@ -1397,8 +1876,11 @@ int service_statuspdu(int connindex) {
                         c->warningCount++;
                         output_warning(connindex, WARN_LOC_STATUS);
                 }
-                if (c->testAction == TEST_ACT_TEST)
+                if (c->testAction == TEST_ACT_TEST) {
                         psA->locStatusLoss += (unsigned int) c->spduSeqErr;
+                        if (conf.psConn)
+                                c->psConn.locStatusLoss += (unsigned int) c->spduSeqErr;
+                }
         }
 
         //
@@ -1414,7 +1896,7 @@ int service_statuspdu(int connindex) {
         c->clockDeltaMin = (int) ntohl(sHdr->clockDeltaMin);
         c->delayVarMin   = ntohl(sHdr->delayVarMin);
         c->delayVarMax   = ntohl(sHdr->delayVarMax);
-        c->delayVarSum   = ntohl(sHdr->delayVarSum);
+        c->delayVarSum   = (unsigned long long) ntohl(sHdr->delayVarSum);
         c->delayVarCnt   = ntohl(sHdr->delayVarCnt);
         c->rttMinimum    = ntohl(sHdr->rttMinimum);
         c->rttVarSample  = ntohl(sHdr->rttVarSample);
@@ -1423,13 +1905,29 @@ int service_statuspdu(int connindex) {
                 c->rttVarSum += c->rttVarSample; // Update local RTT variation sum and count
                 c->rttVarCnt++;
         }
+        if (repo.rcvDataSize >= (int) STATUS_SIZE_EVER) { // Microsecond delay info and 64-bit accumulators via extension
+                sExt              = (struct statusHdrExt *) ((char *) sHdr + STATUS_SIZE_CVER);
+                c->delayVarMinUs  = ntohl(sExt->delayVarMinUs);
+                c->delayVarMaxUs  = ntohl(sExt->delayVarMaxUs);
+                c->delayVarSumUs  = (unsigned long long) ntohll(sExt->delayVarSumUs);
+                c->rttMinimumUs   = ntohl(sExt->rttMinimumUs);
+                c->rttVarSampleUs = ntohl(sExt->rttVarSampleUs);
+                if (c->protocolVer >= SEQ64_PVER)
+                        c->delayVarSum = (unsigned long long) ntohll(sExt->delayVarSum);
+        }
 
         //
         // Save trial interval info
         //
         c->tiDeltaTime   = (unsigned int) ntohl(sHdr->tiDeltaTime);
         c->tiRxDatagrams = (unsigned int) ntohl(sHdr->tiRxDatagrams);
-        c->tiRxBytes     = (unsigned int) ntohl(sHdr->tiRxBytes);
+        c->tiRxBytes     = (unsigned long long) ntohl(sHdr->tiRxBytes);
+        if (sExt != NULL && c->protocolVer >= SEQ64_PVER)
+                c->tiRxBytes = (unsigned long long) ntohll(sExt->tiRxBytes);
+        if (c->protocolVer >= ECNCE_PVER) {
+                c->tiRxEct = (unsigned int) ntohs(sHdr->reserved2); // Utilizes reserved alignment field
+                c->tiRxCe  = (unsigned int) ntohs(sHdr->reserved3); // Utilizes reserved alignment field
+        }
 
         //
         // Save time reference for this status PDU
@@ -1441,18 +1939,28 @@ int service_statuspdu(int connindex) {
         // Update performance statistics with this trial interval data
         // A received status message covers datagrams transmitted (and delivered)
         //
-        if (conf.psFile != NULL) {
+        if (repo.psActive) {
                 psA->rxStatusMsgs++;
                 //
                 psA->txDatagrams += c->tiRxDatagrams;
-                psA->txBytes += (unsigned long long) (c->tiRxDatagrams * L3DG_OVERHEAD);
+                psA->txBytes += (unsigned long long) c->tiRxDatagrams * L3DG_OVERHEAD;
                 if (c->ipProtocol == IPPROTO_IPV6) {
-                        psA->txBytes += (unsigned long long) (c->tiRxDatagrams * IPV6_ADDSIZE);
+                        psA->txBytes += (unsigned long long) c->tiRxDatagrams * IPV6_ADDSIZE;
                 }
-                psA->txBytes += (unsigned long long) c->tiRxBytes;
+                psA->txBytes += c->tiRxBytes;
                 //
                 psA->txSeqErrLoss += c->seqErrLoss;
                 psA->txSeqErrOooDup += c->seqErrOoo + c->seqErrDup;
+                //
+                if (conf.psConn) {
+                        psT = &c->psConn;
+                        psT->txDatagrams += c->tiRxDatagrams;
+                        psT->txBytes += (unsigned long long) c->tiRxDatagrams * L3DG_OVERHEAD;
+                        if (c->ipProtocol == IPPROTO_IPV6) {
+                                psT->txBytes += (unsigned long long) c->tiRxDatagrams * IPV6_ADDSIZE;
+                        }
+                        psT->txBytes += c->tiRxBytes;
+                }
         }
 
         //
@@ -1490,6 +1998,16 @@ int service_statuspdu(int connindex) {
         if (uvar != c->subIntSeqNo) {
                 c->subIntSeqNo = uvar; // Save it to detect updated stats
                 sis_copy(&c->sisSav, &sHdr->sisSav, FALSE);
+                if (sExt != NULL && c->protocolVer >= SEQ64_PVER)
+                        c->sisDelayVarSav = (unsigned long long) ntohll(sExt->sisDelayVarSum);
+                else
+                        c->sisDelayVarSav = (unsigned long long) c->sisSav.delayVarSum;
+                if (repo.rcvDataSize > (int) STATUS_SIZE_EVER) { // Histograms via trailer
+                        histo_decode(connindex, (unsigned char *) sHdr + STATUS_SIZE_EVER,
+                                     repo.rcvDataSize - (int) STATUS_SIZE_EVER);
+                } else if (c->histo != NULL) {
+                        memset(c->histo->sav, 0, sizeof(c->histo->sav));
+                }
                 //
                 // Process and output the latest rate info indicated by receiver
                 //
@@ -1518,12 +2036,38 @@ int service_statuspdu(int connindex) {
 }
 //----------------------------------------------------------------------------
 //
+// Obtain the actual trial (status feedback) interval in usec. When RTT-adaptive, the status sender sizes its
+// own interval, so the server uses its adapted interval when upstream and the one carried in the status PDU
+// when downstream (the configured interval until one is received).
+//
+unsigned int trial_usec(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        if (c->trialAdapt && c->testType != TEST_TYPE_US && c->tiDeltaTime > 0)
+                return c->tiDeltaTime;
+        return (unsigned int) c->trialInt * USECINMSEC;
+}
+//----------------------------------------------------------------------------
+//
 // Server function to perform sending rate adjustment calculation
 //
 int adjust_sending_rate(int connindex) {
         register struct connection *c = &conn[connindex];
-        unsigned int dvmin, dvavg;
-        int var, delay, seqerr;
+        unsigned int dvmin, dvavg, trialusec;
+        int var, delay, seqerr, srprev;
+        struct perfStatsConn *psT;
+
+        //
+        // If RTT-adaptive, scale the sequence error threshold to the actual trial interval so that the tolerated
+        // loss rate matches the configured one (the status sender's interval is known directly or via the PDU)
+        //
+        if (c->trialAdapt) {
+                trialusec = trial_usec(connindex);
+                if (trialusec > 0 && c->trialIntConf > 0) {
+                        var = c->trialIntConf * USECINMSEC;
+                        c->seqErrThresh = (int) (((unsigned long) c->seqErrThreshConf * trialusec + var - 1) / var);
+                }
+        }
 
         //
         // Select algorithm parameters
@@ -1536,7 +2080,7 @@ int adjust_sending_rate(int connindex) {
         dvmin = dvavg = 0;
         if (c->delayVarCnt > 0) {
                 dvmin = c->delayVarMin;
-                dvavg = (((c->delayVarSum * 10) / c->delayVarCnt) + 5) / 10;
+                dvavg = (unsigned int) ((((c->delayVarSum * 10) / c->delayVarCnt) + 5) / 10);
         }
         if (c->useOwDelVar) {
                 // Use average one-way delay variation
@@ -1549,10 +2093,33 @@ int adjust_sending_rate(int connindex) {
                         delay = (int) c->rttVarSample;
                 }
         }
+        if (c->delayUsec) {
+                //
+                // Thresholds are in usec, so use the microsecond-resolution values instead
+                //
+                if (c->useOwDelVar) {
+                        if (c->delayVarCnt > 0 && c->delayVarMinUs != STATUS_NODEL)
+                                delay = (int) ((c->delayVarSumUs + (c->delayVarCnt / 2)) / c->delayVarCnt);
+                } else {
+                        if (c->rttVarSampleUs != STATUS_NODEL)
+                                delay = (int) c->rttVarSampleUs;
+                }
+        }
+        //
+        // If ECN feedback is used, a CE-marked fraction above the threshold is treated as congestion
+        // (presented to the algorithm as delay variation exceeding the upper threshold)
+        //
+        if (c->ecnCeThresh > 0 && c->tiRxEct > 0) {
+                if ((unsigned long long) c->tiRxCe * 100 > (unsigned long long) c->tiRxEct * c->ecnCeThresh) {
+                        if (delay <= c->upperThresh)
+                                delay = c->upperThresh + 1;
+                }
+        }
 
         //
         // Adjust sending rate as needed
         //
+        srprev = c->srIndex;
         if (c->srAdjSuppCount > 0 && c->subIntSeqNo < (unsigned int) c->srAdjSuppCount) { // Check if suppressed
                 if (c->srIndexConf != CHTA_SRIDX_DEF && !c->srIndexIsStart)
                         c->srIndex = 0; // If static sending rate, use zero rate during suppressed sub-intervals
@@ -1560,130 +2127,41 @@ int adjust_sending_rate(int connindex) {
         } else if (c->srIndexConf != CHTA_SRIDX_DEF && !c->srIndexIsStart) {
                 c->srIndex = c->srIndexConf; // Use static sending rate if not specified as starting point
 
-        } else if (c->rateAdjAlgo == CHTA_RA_ALGO_B) {
-                //
-                // This section of code corresponds to the flowchart in TR-471 section 5.2.1,
-                // Sending Rate Search Algorithm, and ITU-T Recommendation Y.1540, Annex B
-                //
-                if (seqerr <= c->seqErrThresh && delay < c->lowThresh) {
-                        if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount < c->slowAdjThresh) {
-                                if (c->srIndex + c->highSpeedDelta > repo.hSpeedThresh)
-                                        c->srIndex = repo.hSpeedThresh;
-                                else
-                                        c->srIndex += c->highSpeedDelta;
-                                c->slowAdjCount = 0;
-                        } else {
-                                if (c->srIndex < repo.maxSendingRates - 1)
-                                        c->srIndex++;
-                        }
-                } else if (seqerr > c->seqErrThresh || delay > c->upperThresh) {
-                        c->slowAdjCount++;
-                        if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount == c->slowAdjThresh) {
-                                if (c->srIndex > c->highSpeedDelta * HS_DELTA_BACKUP)
-                                        c->srIndex -= c->highSpeedDelta * HS_DELTA_BACKUP;
-                                else
-                                        c->srIndex = 0;
-                        } else {
-                                if (c->srIndex > 0)
-                                        c->srIndex--;
-                        }
-                }
-        } else if (c->rateAdjAlgo == CHTA_RA_ALGO_C) {
-                if (c->algoCRetryThresh == 0)
-                        c->algoCRetryThresh = RETRY_THRESH_ALGOC; // Keep non-zero initialization local to algorithm
-                //
-                // Multiplicative adjust sending rate : 1.5x previous rate : with retry after waiting
-                // This section of code provides an optional algorithm, with the properties of faster search to the
-                // max region, meaning less time when errors might end a fast search, and retry fast if that happens.
-                //
-                if (seqerr <= c->seqErrThresh && delay < c->lowThresh) {
-                        if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount < c->slowAdjThresh) { // Congestion not detected
-                                if (c->srIndex * 2 > repo.hSpeedThresh) { // If no room to jump within high-speed threshold
-                                        c->srIndex = repo.hSpeedThresh;   // Truncate jump at high-speed threshold
-                                } else {
-                                        if (c->srIndex == 0)
-                                                c->srIndex++; // Pre-increment to deal with zero index
-
-                                        if (c->algoCUpdate == TRUE) { // Halve the multiplicative rate, using algoCUpdate
-                                                c->srIndex *= 2;      // Jump forward (while staying below high-speed threshold)
-                                                c->algoCUpdate = FALSE;
-                                        } else {
-                                                c->algoCUpdate = TRUE;
-                                        }
-                                }
-                                c->slowAdjCount = 0; // Reset congestion detection counter
-                        } else {
-                                if (c->srIndex < repo.maxSendingRates - 1) {
-                                        c->srIndex++;         // Increment index (slow path)
-                                        c->algoCRetryCount++; // Increment waiting count until retry fast ramp-up
-                                }
-                                if (c->algoCRetryCount >= c->algoCRetryThresh) {
-                                        c->slowAdjCount    = 0; // Retry fast ramp-up again
-                                        c->algoCRetryCount = 0; // Clear variables to enable fast ramp-up
-                                        c->algoCRetryThresh +=
-                                            RETRY_THRESH_ALGOC; // Use higher wait threshold for the next fast ramp-up
-                                }
-                        }
-                } else if (seqerr > c->seqErrThresh || delay > c->upperThresh) {
-                        c->slowAdjCount++;
-                        if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount == c->slowAdjThresh) { // Congestion detected
-                                if (c->srIndex > c->highSpeedDelta * HS_DELTA_BACKUP) {              // If room to jump backward
-                                        c->srIndex -=
-                                            c->highSpeedDelta * HS_DELTA_BACKUP; // Large jump backward (staying above start)
-                                } else {
-                                        c->srIndex = 0; // Jump backward to start
-                                }
-                        } else {
-                                if (c->srIndex > 0) {
-                                        c->srIndex--;         // Decrement index (slow path)
-                                        c->algoCRetryCount++; // Increment waiting count until fast ramp-up retry
-
-                                        if (c->algoCRetryCount >= c->algoCRetryThresh) {
-                                                c->slowAdjCount    = 0; // Retry fast ramp-up again
-                                                c->algoCRetryCount = 0; // Use the same thresholds in the next fast ramp-up
-                                        }
-                                }
-                        }
-                }
+        } else {
+                ra_update(connindex, seqerr, delay); // Adjust via selected algorithm
         }
-#ifdef RATE_LIMITING
         //
-        // Perform rate limiting when bandwidth management is used (-B mbps) by limiting the maximum sending rate index
+        // Enforce rate ceiling (-Y mbps or key file) via sending rate index limit precomputed at test activation
         //
-        // NOTE: This is for test purposes only and only needs to be enabled on the server. It is intended for testing
-        // speeds below the actual achievable maximum, generally as part of server scale testing. For example, simulating
-        // low-speed tests when the client and server are actually connected via high speed.
+        // NOTE: This is intended for testing speeds below the actual achievable maximum, generally as part of server
+        // scale testing or verification of tiered services. For example, simulating low-speed tests when the client
+        // and server are actually connected via high speed.
         //
-        if (c->maxBandwidth > 0) {
-                //
-                // Enforce limit directly when index is equal to bandwidth, else find sending rate index that covers bandwidth
-                //
-                int i = c->maxBandwidth, bw = c->maxBandwidth;
-                if (c->maxBandwidth > 1000) { // If index != bandwidth
-                        struct sendingRate *sr;
-                        for (i = 1001, sr = &repo.sendingRates[i]; i < repo.maxSendingRates; i++, sr++) {
-                                bw = 0; // Simplified bandwidth calculation (random sizes ignored)
-                                if (sr->txInterval1 > 0)
-                                        bw += ((sr->udpPayload1 + L3DG_OVERHEAD) * sr->burstSize1 * 8) / sr->txInterval1;
-                                if (sr->txInterval2 > 0) {
-                                        if (sr->udpPayload2 > 0)
-                                                bw += ((sr->udpPayload2 + L3DG_OVERHEAD) * sr->burstSize2 * 8) / sr->txInterval2;
-                                        if (sr->udpAddon2 > 0)
-                                                bw += ((sr->udpAddon2 + L3DG_OVERHEAD) * 8) / sr->txInterval2;
-                                }
-                                if (bw >= c->maxBandwidth)
-                                        break;
-                        }
-                }
-                if (c->srIndex > i) // Enforce limit
-                        c->srIndex = i;
-                if (conf.verbose && c->spduSeqNo == 1) { // Generate notification once per test
-                        var = sprintf(scratch, "[%d]RATE_LIMITING: Rate adjustment limited to sending rate index %d (%d Mbps)\n",
-                                      connindex, i, bw);
-                        send_proc(errConn, scratch, var);
+        if (c->rateLimit > 0 && c->srIndex > c->rateLimitIndex)
+                c->srIndex = c->rateLimitIndex;
+        UDPST_PROBE6(rate_adjust, connindex, seqerr, delay, srprev, c->srIndex, c->rateAdjAlgo);
+        (void) (srprev); // Only referenced by probe (compiled out without ADD_USDT_PROBES)
+
+        //
+        // Publish live state of test to shared-memory statistics segment
+        //
+        if (conf.shmStats)
+                shmstats_conn(connindex);
+        //
+        // Track sending rate index trajectory for per-connection performance statistics
+        //
+        if (conf.psConn && c->testAction == TEST_ACT_TEST) {
+                psT = &c->psConn;
+                if (psT->srIndexUpdates++ == 0) {
+                        psT->srIndexFirst = c->srIndex;
+                        psT->srIndexMin   = c->srIndex;
+                        psT->srIndexMax   = c->srIndex;
+                } else if (c->srIndex < psT->srIndexMin) {
+                        psT->srIndexMin = c->srIndex;
+                } else if (c->srIndex > psT->srIndexMax) {
+                        psT->srIndexMax = c->srIndex;
                 }
         }
-#endif // RATE_LIMITING
 
         //
         // Output debug messages if configured
@@ -1696,6 +2174,68 @@ int adjust_sending_rate(int connindex) {
                               c->delayVarMax, var, c->srIndex);
                 send_proc(monConn, scratch, var);
         }
+
+        //
+        // Check for convergence if early stop was requested
+        //
+        if (c->convCount > 0 && c->testAction == TEST_ACT_TEST)
+                check_convergence(connindex);
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Check if the search has converged on a maximum and stop the test early
+//
+// The maximum sub-interval rate is considered held when each new sub-interval rate stays within the tolerance of it,
+// and the sending rate index settled within the same band during the sub-interval. A rate above the band raises the
+// maximum and a rate below it (e.g., recovery from congestion) restarts the count.
+//
+int check_convergence(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var;
+        double mbps, tol;
+
+        //
+        // Track sending rate index range during sub-interval
+        //
+        if (c->srIndex < c->convSrMin)
+                c->convSrMin = c->srIndex;
+        if (c->srIndex > c->convSrMax)
+                c->convSrMax = c->srIndex;
+        if (c->subIntSeqNo == c->convSubIntSeqNo)
+                return 0;
+        c->convSubIntSeqNo = c->subIntSeqNo;
+
+        //
+        // Compare latest sub-interval rate to maximum (ignoring sub-intervals with suppressed rate adjustments)
+        //
+        tol  = (double) c->convTol / 100.0;
+        mbps = get_rate(connindex, &c->sisSav, L3DG_OVERHEAD);
+        if (c->subIntSeqNo <= (unsigned int) c->srAdjSuppCount) {
+                c->convHeld = 0;
+        } else if (mbps > c->convMaxRate * (1.0 + tol) || mbps < c->convMaxRate * (1.0 - tol)) {
+                c->convHeld = 0;
+        } else if (sr_index_mbps(connindex, c->convSrMax) > sr_index_mbps(connindex, c->convSrMin) * (1.0 + (2.0 * tol))) {
+                c->convHeld = 0; // Sending rate still moving
+        } else {
+                c->convHeld++;
+        }
+        if (mbps > c->convMaxRate)
+                c->convMaxRate = mbps;
+        c->convSrMin = c->convSrMax = c->srIndex; // Restart range for next sub-interval
+
+        //
+        // Stop test once held for the required sub-intervals
+        //
+        if (c->convHeld >= c->convCount) {
+                if (conf.verbose) {
+                        var = sprintf(scratch, "[%d]Converged at %.2f Mbps(L3/IP) after %u sub-intervals\n", connindex,
+                                      c->convMaxRate, c->subIntSeqNo);
+                        send_proc(monConn, scratch, var);
+                }
+                c->convStopped = TRUE;
+                stop_test(connindex);
+        }
         return 0;
 }
 //----------------------------------------------------------------------------
@@ -1719,6 +2259,10 @@ int proc_subinterval(int connindex, BOOL initialize) {
                 c->accumTime += (unsigned int) tspecmsec(&tspecvar);
                 c->sisAct.accumTime = (uint32_t) c->accumTime;
                 memcpy(&c->sisSav, &c->sisAct, sizeof(struct subIntStats));
+                c->sisDelayVarSav = c->sisDelayVarSum;
+                if (c->sisDelayVarSav > UINT32_MAX)
+                        c->sisSav.delayVarSum = UINT32_MAX; // Saturate 32-bit sum for older peers
+                histo_save(connindex);
 
                 //
                 // Process and output our latest rate info as receiver
@@ -1736,9 +2280,12 @@ int proc_subinterval(int connindex, BOOL initialize) {
         memset(&c->sisAct, 0, sizeof(struct subIntStats));
         c->sisAct.delayVarMin = STATUS_NODEL;
         c->sisAct.rttVarMinimum  = STATUS_NODEL;
+        c->sisDelayVarSum     = 0;
         tspeccpy(&c->subIntClock, &repo.systemClock);
-        if (initialize)
+        if (initialize) {
                 c->accumTime = 0;
+                histo_conn(connindex); // Start recording histograms (skipped if allocation fails)
+        }
 
         return 0;
 }
@@ -1802,9 +2349,14 @@ int output_currate(int connindex) {
         register struct connection *c = &conn[connindex], *a;
         int i, var;
         unsigned int dvmin, dvavg, rttmin, rttavg;
+        unsigned int pdvq[HISTO_QUANTILES], rttq[HISTO_QUANTILES];
         double dvar, mbps, sent, delivered = 0.0, intfmbps = 0.0;
-        char connid[8], intfrate[16];
+        char connid[8], intfrate[16], jwbuf[JSONW_BUF_SIZE];
         struct testSummary *ts;
+        struct jsonWriter jw;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cyc;
+#endif
 
         //
         // Do not allow sub-interval count to exceed expected maximum
@@ -1813,6 +2365,7 @@ int output_currate(int connindex) {
                 if (c->subIntCount >= (c->testIntTime * MSECINSEC) / c->subIntPeriod)
                         return 0;
         }
+        CYC_START(cyc);
 
         //
         // Increment sub-interval count and obtain sub-interval rate info
@@ -1833,7 +2386,7 @@ int output_currate(int connindex) {
                 // Obtain interface rate at first non-aggregate sub-interval
                 //
                 if (repo.intfFD >= 0 && repo.sisConnCount == 0) {
-                        upd_intf_stats(FALSE); // Save for subsequent use by aggregate connection
+                        intf_update(FALSE); // Save for subsequent use by aggregate connection
                 }
                 repo.sisConnCount++; // Increment connection count for this sub-interval
         } else {
@@ -1841,6 +2394,8 @@ int output_currate(int connindex) {
                 intfmbps          = repo.intfMbps;    // Previously obtained interface rate
                 repo.sisConnCount = 0;                // Reset counter for next sub-interval
         }
+        UDPST_PROBE7(subint_final, connindex, c->subIntCount, (unsigned int) (mbps * 1000.0), c->sisSav.rxDatagrams,
+                     c->sisSav.seqErrLoss, c->sisSav.seqErrOoo, c->sisSav.seqErrDup);
 
         //
         // Check if aggregate maximum so far
@@ -1865,6 +2420,7 @@ int output_currate(int connindex) {
                         tspeccpy(&repo.timeOfMax[i], &repo.systemClock);
                         repo.actConnections[i] = repo.actConnCount;
                         memcpy(&repo.sisMax[i], &c->sisSav, sizeof(struct subIntStats));
+                        repo.delayVarSumMax[i] = c->sisDelayVarSav;
                         repo.rateMaxL3[i] = mbps;
                         repo.rateMaxL2[i] = repo.siAggRateL2;
                         repo.rateMaxL1[i] = repo.siAggRateL1;
@@ -1873,7 +2429,7 @@ int output_currate(int connindex) {
                         //
                         repo.rttAverage[i] = 0; // Local RTT variation average
                         if (c->rttVarCnt > 0) {
-                                repo.rttAverage[i] = (((c->rttVarSum * 10) / c->rttVarCnt) + 5) / 10;
+                                repo.rttAverage[i] = (unsigned int) ((((c->rttVarSum * 10) / c->rttVarCnt) + 5) / 10);
                         }
                 }
         }
@@ -1903,7 +2459,7 @@ int output_currate(int connindex) {
                 a->sisSav.seqErrDup += c->sisSav.seqErrDup;
                 if (c->sisSav.delayVarMin < a->sisSav.delayVarMin)
                         a->sisSav.delayVarMin = c->sisSav.delayVarMin;
-                a->sisSav.delayVarSum += c->sisSav.delayVarSum;
+                a->sisDelayVarSav += c->sisDelayVarSav;
                 a->sisSav.delayVarCnt += c->sisSav.delayVarCnt;
                 if (c->sisSav.delayVarMax > a->sisSav.delayVarMax)
                         a->sisSav.delayVarMax = c->sisSav.delayVarMax;
@@ -1914,6 +2470,11 @@ int output_currate(int connindex) {
                 //
                 a->rttVarSum += c->rttVarSum; // Merge local RTT variation sum and count
                 a->rttVarCnt += c->rttVarCnt;
+                if (c->histo != NULL && histo_conn(aggConn) != NULL) {
+                        for (i = 0; i < HISTO_TYPES; i++) {
+                                histo_merge(&a->histo->sav[i], &c->histo->sav[i]);
+                        }
+                }
                 //
                 a->sisSav.accumTime = c->sisSav.accumTime; // Use accumulated time of last test connection processed
         }
@@ -1934,7 +2495,7 @@ int output_currate(int connindex) {
         dvmin = dvavg = 0;
         if (c->sisSav.delayVarCnt > 0) {
                 dvmin = (unsigned int) c->sisSav.delayVarMin;
-                dvavg = (unsigned int) ((((c->sisSav.delayVarSum * 10) / c->sisSav.delayVarCnt) + 5) / 10);
+                dvavg = (unsigned int) ((((c->sisDelayVarSav * 10) / c->sisSav.delayVarCnt) + 5) / 10);
         }
         rttmin = 0;
         if (c->sisSav.rttVarMinimum != STATUS_NODEL) {
@@ -1942,7 +2503,13 @@ int output_currate(int connindex) {
         }
         rttavg = 0;
         if (c->rttVarCnt > 0) {
-                rttavg = (((c->rttVarSum * 10) / c->rttVarCnt) + 5) / 10;
+                rttavg = (unsigned int) ((((c->rttVarSum * 10) / c->rttVarCnt) + 5) / 10);
+        }
+        memset(pdvq, 0, sizeof(pdvq));
+        memset(rttq, 0, sizeof(rttq));
+        if (c->histo != NULL) {
+                histo_quantiles(&c->histo->sav[HISTO_OWD], pdvq);
+                histo_quantiles(&c->histo->sav[HISTO_RTT], rttq);
         }
         if (!conf.summaryOnly) {
                 if (!conf.jsonOutput && (conf.verbose || connindex == aggConn)) {
@@ -1960,75 +2527,89 @@ int output_currate(int connindex) {
                                 snprintf(intfrate, sizeof(intfrate), " [%.2f]", intfmbps);
                         }
                         dvar = (double) c->sisSav.accumTime / MSECINSEC;
-                        var  = sprintf(scratch, scratch2, connid, c->subIntCount, i, dvar, delivered, c->sisSav.seqErrLoss,
-                                       c->sisSav.seqErrOoo, c->sisSav.seqErrDup, dvmin, dvavg, c->sisSav.delayVarMax, rttmin, rttavg,
-                                       c->sisSav.rttVarMaximum, mbps, intfrate);
+                        var  = sprintf(scratch, scratch2, connid, c->subIntCount, i, dvar, delivered,
+                                       (unsigned long long) c->sisSav.seqErrLoss, (unsigned long long) c->sisSav.seqErrOoo,
+                                       (unsigned long long) c->sisSav.seqErrDup, dvmin, dvavg, c->sisSav.delayVarMax, rttmin,
+                                       rttavg, c->sisSav.rttVarMaximum, mbps, intfrate);
                         send_proc(errConn, scratch, var);
                 } else if (conf.jsonOutput && connindex == aggConn) {
                         //
-                        // Create JSON sub-interval array if needed
-                        //
-                        if (json_siArray == NULL) {
-                                json_siArray = cJSON_CreateArray();
-                        }
-                        //
-                        // Create sub-interval object and add items to it
+                        // Serialize sub-interval object as next element of sub-interval array
                         //
-                        cJSON *json_subint = cJSON_CreateObject();
-                        cJSON_AddNumberToObject(json_subint, "Interval", c->subIntCount);
+                        jsonw_init(&jw, jwbuf, sizeof(jwbuf), JSONW_SI_DEPTH, conf.jsonFormatted);
+                        jsonw_begin(&jw);
+                        jsonw_number(&jw, "Interval", c->subIntCount, 0);
                         dvar = (double) c->sisSav.accumTime / MSECINSEC;
-                        cJSON_AddNumberPToObject(json_subint, "Seconds", dvar, 1);
+                        jsonw_number(&jw, "Seconds", dvar, 1);
                         //
                         create_timestamp(&repo.systemClock, TRUE);
-                        cJSON_AddStringToObject(json_subint, "TimeOfSubInterval", scratch);
-                        cJSON_AddNumberToObject(json_subint, "ActiveConnections", repo.actConnCount);
+                        jsonw_string(&jw, "TimeOfSubInterval", scratch);
+                        jsonw_number(&jw, "ActiveConnections", repo.actConnCount, 0);
                         //
                         if (sent > 0.0) {
                                 dvar = ((double) c->sisSav.rxDatagrams * 100.0) / sent;
-                                cJSON_AddNumberPToObject(json_subint, "DeliveredPercent", dvar, 2);
+                                jsonw_number(&jw, "DeliveredPercent", dvar, 2);
                                 dvar = (double) c->sisSav.seqErrLoss / sent;
-                                cJSON_AddNumberPToObject(json_subint, "LossRatio", dvar, 9);
+                                jsonw_number(&jw, "LossRatio", dvar, 9);
                                 dvar = (double) c->sisSav.seqErrOoo / sent;
-                                cJSON_AddNumberPToObject(json_subint, "ReorderedRatio", dvar, 9);
+                                jsonw_number(&jw, "ReorderedRatio", dvar, 9);
                                 dvar = (double) c->sisSav.seqErrDup / sent;
-                                cJSON_AddNumberPToObject(json_subint, "ReplicatedRatio", dvar, 9);
+                                jsonw_number(&jw, "ReplicatedRatio", dvar, 9);
                         } else {
-                                cJSON_AddNumberPToObject(json_subint, "DeliveredPercent", 0.0, 2);
-                                cJSON_AddNumberPToObject(json_subint, "LossRatio", 0.0, 9);
-                                cJSON_AddNumberPToObject(json_subint, "ReorderedRatio", 0.0, 9);
-                                cJSON_AddNumberPToObject(json_subint, "ReplicatedRatio", 0.0, 9);
+                                jsonw_number(&jw, "DeliveredPercent", 0.0, 2);
+                                jsonw_number(&jw, "LossRatio", 0.0, 9);
+                                jsonw_number(&jw, "ReorderedRatio", 0.0, 9);
+                                jsonw_number(&jw, "ReplicatedRatio", 0.0, 9);
                         }
-                        cJSON_AddNumberToObject(json_subint, "LossCount", c->sisSav.seqErrLoss);
-                        cJSON_AddNumberToObject(json_subint, "ReorderedCount", c->sisSav.seqErrOoo);
-                        cJSON_AddNumberToObject(json_subint, "ReplicatedCount", c->sisSav.seqErrDup);
+                        jsonw_number(&jw, "LossCount", c->sisSav.seqErrLoss, 0);
+                        jsonw_number(&jw, "ReorderedCount", c->sisSav.seqErrOoo, 0);
+                        jsonw_number(&jw, "ReplicatedCount", c->sisSav.seqErrDup, 0);
                         //
                         dvar = (double) dvmin / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "PDVMin", dvar, -9);
+                        jsonw_number(&jw, "PDVMin", dvar, -9);
                         dvar = (double) dvavg / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "PDVAvg", dvar, -9);
+                        jsonw_number(&jw, "PDVAvg", dvar, -9);
                         dvar = (double) c->sisSav.delayVarMax / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "PDVMax", dvar, -9);
+                        jsonw_number(&jw, "PDVMax", dvar, -9);
                         dvar = (double) (c->sisSav.delayVarMax - dvmin) / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "PDVRange", dvar, -9);
+                        jsonw_number(&jw, "PDVRange", dvar, -9);
                         //
                         dvar = (double) rttmin / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "RTTMin", dvar, -9);
+                        jsonw_number(&jw, "RTTMin", dvar, -9);
                         dvar = (double) rttavg / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "RTTAvg", dvar, -9); // Local RTT variation average
+                        jsonw_number(&jw, "RTTAvg", dvar, -9); // Local RTT variation average
                         dvar = (double) c->sisSav.rttVarMaximum / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "RTTMax", dvar, -9);
+                        jsonw_number(&jw, "RTTMax", dvar, -9);
                         dvar = (double) (c->sisSav.rttVarMaximum - rttmin) / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "RTTRange", dvar, -9);
+                        jsonw_number(&jw, "RTTRange", dvar, -9);
+                        //
+                        for (i = 0; i < HISTO_QUANTILES; i++) {
+                                jsonw_number(&jw, pdvQuantileName[i], (double) pdvq[i] / USECINSEC, 6);
+                        }
+                        for (i = 0; i < HISTO_QUANTILES; i++) {
+                                jsonw_number(&jw, rttQuantileName[i], (double) rttq[i] / USECINSEC, 6);
+                        }
                         //
-                        cJSON_AddNumberPToObject(json_subint, "IPLayerCapacity", mbps, 2);
-                        cJSON_AddNumberPToObject(json_subint, "InterfaceEthMbps", intfmbps, 2);
+                        jsonw_number(&jw, "IPLayerCapacity", mbps, 2);
+                        jsonw_number(&jw, "InterfaceEthMbps", intfmbps, 2);
+                        if (repo.intfFD >= 0)
+                                intf_json(&jw); // Rates of each interface (and queue)
                         //
                         dvar = ((double) c->clockDeltaMin + (double) dvmin) / 1000.0;
-                        cJSON_AddNumberPToObject(json_subint, "MinOnewayDelay", dvar, -9);
+                        jsonw_number(&jw, "MinOnewayDelay", dvar, -9);
+                        //
+                        jsonw_end(&jw);
                         //
-                        // Add sub-interval object to sub-interval array
+                        // Spool it for the final document, and with NDJSON also output it immediately as its own line
                         //
-                        cJSON_AddItemToArray(json_siArray, json_subint);
+                        if ((var = jsonw_spool(&jw)) > 0) {
+                                send_proc(errConn, scratch, var);
+                        } else if (conf.jsonStream) {
+                                jsonw_append(&jw, "\n", 1);
+                                conf.jsonOutput = FALSE; // Bypass JSON error capture of console output
+                                send_proc(aggConn, jw.buf, jw.len);
+                                conf.jsonOutput = TRUE;
+                        }
                 }
         }
 
@@ -2066,13 +2647,22 @@ int output_currate(int connindex) {
                 ts->rttVarSum += c->rttVarSum; // Local RTT variation sum and count
                 ts->rttVarCnt += c->rttVarCnt;
                 //
-                ts->rxDatagrams += (unsigned int) c->sisSav.rxDatagrams;
-                ts->seqErrLoss += (unsigned int) c->sisSav.seqErrLoss;
-                ts->seqErrOoo += (unsigned int) c->sisSav.seqErrOoo;
-                ts->seqErrDup += (unsigned int) c->sisSav.seqErrDup;
+                ts->rxDatagrams += (unsigned long long) c->sisSav.rxDatagrams;
+                ts->seqErrLoss += (unsigned long long) c->sisSav.seqErrLoss;
+                ts->seqErrOoo += (unsigned long long) c->sisSav.seqErrOoo;
+                ts->seqErrDup += (unsigned long long) c->sisSav.seqErrDup;
                 ts->rateSumL3 += (double) mbps;
                 ts->rateSumIntf += (double) intfmbps;
                 ts->sampleCount++;
+                if (c->histo != NULL) {
+                        if (ts->histo == NULL)
+                                ts->histo = histo_alloc(HISTO_TYPES);
+                        if (ts->histo != NULL) {
+                                for (var = 0; var < HISTO_TYPES; var++) {
+                                        histo_merge(&ts->histo[var], &c->histo->sav[var]);
+                                }
+                        }
+                }
 
                 //
                 // Re-initialize stats for next sub-interval
@@ -2080,6 +2670,9 @@ int output_currate(int connindex) {
                 memset(&c->sisSav, 0, sizeof(struct subIntStats));
                 c->sisSav.delayVarMin = STATUS_NODEL;
                 c->sisSav.rttVarMinimum  = STATUS_NODEL;
+                c->sisDelayVarSav     = 0;
+                if (c->histo != NULL)
+                        memset(c->histo->sav, 0, sizeof(c->histo->sav));
                 repo.siAggRateL3      = 0.0;
                 repo.siAggRateL2      = 0.0;
                 repo.siAggRateL1      = 0.0;
@@ -2090,6 +2683,7 @@ int output_currate(int connindex) {
         //
         c->rttVarSum = 0;
         c->rttVarCnt = 0;
+        CYC_STOP(CYC_CURRATE, cyc);
 
         return 0;
 }
@@ -2100,11 +2694,14 @@ int output_currate(int connindex) {
 int output_maxrate(int connindex) {
         register struct connection *c = &conn[connindex];
         char *testtype, connid[8], labeltext[32], intfrate[16];
-        int i, sibegin, siend, var;
+        int i, j, sibegin, siend, var;
         unsigned int dvmin, dvavg, rttmin;
-        double dvar, sent, delivered = 0.0;
+        unsigned int pdvq[HISTO_QUANTILES], rttq[HISTO_QUANTILES];
+        unsigned int slipq[HISTO_QUANTILES], jitq[HISTO_QUANTILES];
+        double dvar, sent, delivered = 0.0, gapavg, intavg;
         struct testSummary *ts;
-        cJSON *json_modalArray = NULL;
+        struct cpuCost cc;
+        cJSON *json_modalArray = NULL, *json_txArray;
 
         //
         // Setup header fields
@@ -2119,13 +2716,22 @@ int output_maxrate(int connindex) {
         }
         if (conf.jsonOutput) {
                 //
-                // If it exists add JSON sub-interval array to output object
+                // If sub-intervals were spooled add placeholder for them to output object (see json_finish)
                 //
-                if (json_siArray != NULL) {
-                        cJSON_AddItemToObject(json_output, "IncrementalResult", json_siArray);
+                if (jsonw_spool_count() > 0) {
+                        cJSON_AddRawToObject(json_output, "IncrementalResult", JSONW_SPLICE);
                 }
         }
 
+        //
+        // Obtain CPU cost of test at its average L3 rate (before sums are converted to averages)
+        //
+        var  = repo.testSum[0].sampleCount + repo.testSum[1].sampleCount;
+        dvar = 0.0;
+        if (var > 0)
+                dvar = (repo.testSum[0].rateSumL3 + repo.testSum[1].rateSumL3) / (double) var;
+        cpu_test_cost(&cc, dvar);
+
         //
         // Output summary info for either single summary or both bimodal summaries
         //
@@ -2151,6 +2757,12 @@ int output_maxrate(int connindex) {
                 if (ts->rttVarCnt > 0) {
                         ts->rttVarSum = (((ts->rttVarSum * 10) / ts->rttVarCnt) + 5) / 10; // Convert sum to average
                 }
+                memset(pdvq, 0, sizeof(pdvq));
+                memset(rttq, 0, sizeof(rttq));
+                if (ts->histo != NULL) {
+                        histo_quantiles(&ts->histo[HISTO_OWD], pdvq);
+                        histo_quantiles(&ts->histo[HISTO_RTT], rttq);
+                }
                 if (!conf.jsonOutput) {
                         if (conf.bimodalCount == 0) {
                                 strcpy(labeltext, "Summary");
@@ -2168,9 +2780,19 @@ int output_maxrate(int connindex) {
                                 snprintf(intfrate, sizeof(intfrate), " [%.2f]", ts->rateSumIntf);
                         }
                         var = sprintf(scratch, scratch2, connid, testtype, delivered, ts->seqErrLoss, ts->seqErrOoo, ts->seqErrDup,
-                                      ts->delayVarMin, ts->delayVarSum, ts->delayVarMax, ts->rttVarMinimum, ts->rttVarSum,
+                                      ts->delayVarMin, (unsigned int) ts->delayVarSum, ts->delayVarMax, ts->rttVarMinimum,
+                                      (unsigned int) ts->rttVarSum,
                                       ts->rttVarMaximum, ts->rateSumL3, intfrate);
                         send_proc(errConn, scratch, var);
+                        if (ts->histo != NULL) {
+                                strcpy(scratch2, "%s%s %s " QUANTILE_TEXT);
+                                var = sprintf(scratch, scratch2, connid, testtype, labeltext, (double) pdvq[0] / USECINMSEC,
+                                              (double) pdvq[1] / USECINMSEC, (double) pdvq[2] / USECINMSEC,
+                                              (double) pdvq[3] / USECINMSEC, (double) rttq[0] / USECINMSEC,
+                                              (double) rttq[1] / USECINMSEC, (double) rttq[2] / USECINMSEC,
+                                              (double) rttq[3] / USECINMSEC);
+                                send_proc(errConn, scratch, var);
+                        }
                 } else {
                         if (conf.bimodalCount == 0) {
                                 var = c->subIntCount;
@@ -2223,6 +2845,15 @@ int output_maxrate(int connindex) {
                         dvar = (double) (ts->rttVarMaximum - ts->rttVarMinimum) / 1000.0;
                         cJSON_AddNumberPToObject(json_summary, "RTTRangeSummary", dvar, -9);
                         //
+                        for (j = 0; j < HISTO_QUANTILES; j++) {
+                                dvar = (double) pdvq[j] / USECINSEC;
+                                cJSON_AddNumberPToObject(json_summary, pdvQuantileName[j], dvar, 6);
+                        }
+                        for (j = 0; j < HISTO_QUANTILES; j++) {
+                                dvar = (double) rttq[j] / USECINSEC;
+                                cJSON_AddNumberPToObject(json_summary, rttQuantileName[j], dvar, 6);
+                        }
+                        //
                         cJSON_AddNumberPToObject(json_summary, "IPLayerCapacitySummary", ts->rateSumL3, 2);
                         cJSON_AddNumberPToObject(json_summary, "InterfaceEthMbps", ts->rateSumIntf, 2);
                         //
@@ -2233,6 +2864,27 @@ int output_maxrate(int connindex) {
                                 rttmin = c->rttMinimum;
                         dvar = (double) rttmin / 1000.0;
                         cJSON_AddNumberPToObject(json_summary, "MinRTTSummary", dvar, -9); // Global value for all modes
+                        //
+                        if (i == 0) { // CPU cost of whole test is only added to first summary
+                                cJSON *json_cpu = cJSON_CreateObject();
+                                //
+                                cJSON_AddNumberPToObject(json_cpu, "ElapsedTime", cc.wallSec, -9);
+                                cJSON_AddNumberPToObject(json_cpu, "UserCPUTime", cc.userSec, -9);
+                                cJSON_AddNumberPToObject(json_cpu, "SystemCPUTime", cc.sysSec, -9);
+                                cJSON_AddNumberPToObject(json_cpu, "ThreadCPUTime", cc.threadSec, -9);
+                                cJSON_AddNumberPToObject(json_cpu, "CPUUtilization", cc.utilization, 3);
+                                cJSON_AddNumberPToObject(json_cpu, "ThreadCPUUtilization", cc.threadUtil, 3);
+                                cJSON_AddNumberToObject(json_cpu, "VoluntaryContextSwitches", (double) cc.volCsw);
+                                cJSON_AddNumberToObject(json_cpu, "InvoluntaryContextSwitches", (double) cc.invCsw);
+                                cJSON_AddNumberToObject(json_cpu, "SendSyscalls", (double) cc.txCalls);
+                                cJSON_AddNumberToObject(json_cpu, "RecvSyscalls", (double) cc.rxCalls);
+                                cJSON_AddNumberToObject(json_cpu, "Packets", (double) cc.packets);
+                                cJSON_AddNumberPToObject(json_cpu, "NsecPerPacket", cc.nsecPerPacket, 1);
+                                cJSON_AddNumberPToObject(json_cpu, "CyclesPerPacket", cc.cyclesPerPacket, 1);
+                                cJSON_AddNumberPToObject(json_cpu, "CPUPerGbps", cc.cpuPerGbps, 3);
+                                cJSON_AddNumberToObject(json_cpu, "HostLimited", cc.hostLimited);
+                                cJSON_AddItemToObject(json_summary, "HostCPU", json_cpu);
+                        }
 
                         //
                         // On first pass add summary object to output and create modal array, else add to modal array
@@ -2337,7 +2989,7 @@ int output_maxrate(int connindex) {
                         if (repo.sisMax[i].delayVarCnt > 0) {
                                 dvmin = (unsigned int) repo.sisMax[i].delayVarMin;
                                 dvavg =
-                                    (unsigned int) ((((repo.sisMax[i].delayVarSum * 10) / repo.sisMax[i].delayVarCnt) + 5) / 10);
+                                    (unsigned int) ((((repo.delayVarSumMax[i] * 10) / repo.sisMax[i].delayVarCnt) + 5) / 10);
                         }
                         dvar = (double) dvmin / 1000.0;
                         cJSON_AddNumberPToObject(json_atmax, "PDVMin", dvar, -9);
@@ -2394,6 +3046,87 @@ int output_maxrate(int connindex) {
                 siend   = c->subIntCount;
         }
 
+        //
+        // Output convergence result if early stop was requested (all connections must have converged)
+        //
+        if (conf.convCount > 0) {
+                i = (repo.convConnCount > 0 && repo.convConnCount >= repo.actConnCount);
+                if (!conf.jsonOutput) {
+                        strcpy(scratch2, "%s%s " CONVERGED_TEXT);
+                        var = sprintf(scratch, scratch2, connid, testtype, i ? "Yes" : "No", c->subIntCount);
+                        send_proc(errConn, scratch, var);
+                } else {
+                        cJSON_AddNumberToObject(json_output, "Converged", i);
+                }
+        }
+
+        //
+        // Output transmit schedule accuracy of local transmitters (only available when sending load traffic)
+        //
+        if (repo.txSched != NULL) {
+                json_txArray = NULL;
+                for (i = 0; i < HISTO_TXCOUNT; i++) {
+                        if (repo.txSched->tx[i][HISTO_SLIP].total == 0)
+                                continue;
+                        histo_quantiles(&repo.txSched->tx[i][HISTO_SLIP], slipq);
+                        histo_quantiles(&repo.txSched->tx[i][HISTO_JITTER], jitq);
+                        gapavg = intavg = 0.0;
+                        if (repo.txSched->gapCount[i] > 0) {
+                                gapavg = (double) repo.txSched->gapTotal[i] / (double) repo.txSched->gapCount[i];
+                                intavg = (double) repo.txSched->intTotal[i] / (double) repo.txSched->gapCount[i];
+                        }
+                        if (!conf.jsonOutput) {
+                                if (!conf.verbose)
+                                        continue;
+                                strcpy(scratch2, "%s%s " TXSCHED_TEXT);
+                                var = sprintf(scratch, scratch2, connid, testtype, i + 1,
+                                              (unsigned long long) repo.txSched->tx[i][HISTO_SLIP].total, slipq[0], slipq[2],
+                                              slipq[3], repo.txSched->tx[i][HISTO_SLIP].max, jitq[0], jitq[2],
+                                              repo.txSched->tx[i][HISTO_JITTER].max, gapavg, intavg);
+                                send_proc(errConn, scratch, var);
+                                continue;
+                        }
+                        //
+                        // Create JSON transmitter object and add items to it (values in seconds)
+                        //
+                        cJSON *json_tx = cJSON_CreateObject();
+                        //
+                        cJSON_AddNumberToObject(json_tx, "Transmitter", i + 1);
+                        cJSON_AddNumberToObject(json_tx, "Bursts", (double) repo.txSched->tx[i][HISTO_SLIP].total);
+                        for (j = 0; j < HISTO_QUANTILES; j++) {
+                                dvar = (double) slipq[j] / USECINSEC;
+                                cJSON_AddNumberPToObject(json_tx, slipQuantileName[j], dvar, 6);
+                        }
+                        dvar = (double) repo.txSched->tx[i][HISTO_SLIP].max / USECINSEC;
+                        cJSON_AddNumberPToObject(json_tx, "SlipMax", dvar, 6);
+                        for (j = 0; j < HISTO_QUANTILES; j++) {
+                                dvar = (double) jitq[j] / USECINSEC;
+                                cJSON_AddNumberPToObject(json_tx, jitQuantileName[j], dvar, 6);
+                        }
+                        dvar = (double) repo.txSched->tx[i][HISTO_JITTER].max / USECINSEC;
+                        cJSON_AddNumberPToObject(json_tx, "JitterMax", dvar, 6);
+                        cJSON_AddNumberPToObject(json_tx, "GapAvg", gapavg / USECINSEC, 7);
+                        cJSON_AddNumberPToObject(json_tx, "IntendedGapAvg", intavg / USECINSEC, 7);
+                        if (json_txArray == NULL)
+                                json_txArray = cJSON_CreateArray();
+                        cJSON_AddItemToArray(json_txArray, json_tx);
+                }
+                if (json_txArray != NULL)
+                        cJSON_AddItemToObject(json_output, "TransmitSchedule", json_txArray);
+        }
+
+        //
+        // Output CPU cost of test as text (always when the event loop was saturated, see JSON summary otherwise)
+        //
+        if (!conf.jsonOutput && (conf.verbose || cc.hostLimited)) {
+                strcpy(scratch2, "%s%s " HOSTCPU_TEXT);
+                var = sprintf(scratch, scratch2, connid, testtype, cc.utilization * 100.0, cc.threadUtil * 100.0,
+                              (unsigned long long) cc.volCsw, (unsigned long long) cc.invCsw, (unsigned long long) cc.txCalls,
+                              (unsigned long long) cc.rxCalls, cc.cyclesPerPacket, cc.cpuPerGbps,
+                              cc.hostLimited ? " [Host-Limited]" : "");
+                send_proc(errConn, scratch, var);
+        }
+
         return 0;
 }
 //----------------------------------------------------------------------------
@@ -2454,26 +3187,60 @@ int service_recvmmsg(int connindex) {
         int i;
         struct perfStatsAverages *psA = &repo.psAverages;
         struct perfStatsMaximums *psM = &repo.psMaximums;
+        struct perfStatsConn *psT;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cyc;
+#endif
 
+        CYC_START(cyc);
         repo.rcvDataPtr = repo.defBuffer;
         for (i = 0; i < RECVMMSG_SIZE; i++) {
                 if (mmsgDataSize[i] == 0)
                         break;
                 repo.rcvDataSize = mmsgDataSize[i];
+                repo.rcvEcn      = mmsgEcn[i];
                 service_loadpdu(connindex);
                 repo.rcvDataPtr += RCV_HEADER_SIZE;
         }
-        if (conf.psFile != NULL) { // Update performance statistics
+        CYC_STOP(CYC_LOADPDU, cyc);
+        if (repo.psActive) { // Update performance statistics
                 if (i > 0) {
                         psA->rxBurstCount++;
                         psA->rxBurstTotal += (unsigned int) i;
                         if ((unsigned int) i > psM->rxBurstSize)
                                 psM->rxBurstSize = (unsigned int) i;
+                        if (conf.psConn) {
+                                psT = &conn[connindex].psConn;
+                                psT->rxBurstCount++;
+                                psT->rxBurstTotal += (unsigned int) i;
+                                if ((unsigned int) i > psT->rxBurstSize)
+                                        psT->rxBurstSize = (unsigned int) i;
+                        }
                 }
         }
         return 0;
 }
 //----------------------------------------------------------------------------
+#ifdef HAVE_RECVMMSG
+//
+// Extract ECN codepoint from received ancillary data (IP_TOS/IPV6_TCLASS)
+//
+static int _cmsg_ecn(struct msghdr *msg) {
+        struct cmsghdr *cmsg;
+        int tclass;
+
+        for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+                if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS) {
+                        return (int) (*(unsigned char *) CMSG_DATA(cmsg) & ECN_MASK);
+                } else if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS) {
+                        memcpy(&tclass, CMSG_DATA(cmsg), sizeof(tclass));
+                        return tclass & ECN_MASK;
+                }
+        }
+        return ECN_NOTECT;
+}
+#endif
+//----------------------------------------------------------------------------
 //
 // Generic connection receive processor
 //
@@ -2481,12 +3248,22 @@ int recv_proc(int connindex) {
         register struct connection *c = &conn[connindex];
         static struct mmsghdr mmsg[RECVMMSG_SIZE]; // Static array
         static struct iovec iov[RECVMMSG_SIZE];    // Static array
+#ifdef HAVE_RECVMMSG
+        static union {
+                char buf[ECN_CMSG_SIZE];
+                struct cmsghdr align;
+        } ctrl[RECVMMSG_SIZE]; // Static array (aligned for ancillary data)
+#endif
         char *rcvbuf;
         int i, var, recvsize;
+#ifdef ADD_CYCLE_COUNTERS
+        uint64_t cyc;
+#endif
 
         //
         // Specify receive buffer size (truncate load PDUs to reduce overhead of memory copy)
         //
+        CYC_START(cyc);
         if (c->secAction == &service_recvmmsg || c->secAction == &service_loadpdu) {
                 recvsize = RCV_HEADER_SIZE;
         } else {
@@ -2517,12 +3294,23 @@ int recv_proc(int connindex) {
                                 mmsgDataSize[i] = 0; // Initialize as empty
                         }
 #ifdef HAVE_RECVMMSG
+                        if (c->ecnRecv) {
+                                for (i = 0; i < RECVMMSG_SIZE; i++) {
+                                        mmsg[i].msg_hdr.msg_control    = ctrl[i].buf;
+                                        mmsg[i].msg_hdr.msg_controllen = ECN_CMSG_SIZE;
+                                }
+                        }
                         //
                         // Perform read and process messages
                         //
                         repo.rcvDataSize = recvmmsg(c->fd, mmsg, RECVMMSG_SIZE, MSG_TRUNC, NULL); // Returns number of messages
+                        repo.sysCalls.rxCalls++;
+                        if (repo.rcvDataSize > 0)
+                                repo.sysCalls.rxDgrams += (unsigned int) repo.rcvDataSize;
+                        UDPST_PROBE2(recv_batch, connindex, repo.rcvDataSize);
                         for (i = 0; i < repo.rcvDataSize; i++) {
                                 mmsgDataSize[i] = (int) mmsg[i].msg_len; // Save actual received length (although truncated)
+                                mmsgEcn[i]      = c->ecnRecv ? _cmsg_ecn(&mmsg[i].msg_hdr) : ECN_NOTECT;
                         }
                         if (repo.rcvDataSize < RECVMMSG_SIZE) {
                                 c->dataReady = FALSE; // Indicate all data has been read from this connection
@@ -2530,6 +3318,9 @@ int recv_proc(int connindex) {
 #endif
                 } else {
                         repo.rcvDataSize = recv(c->fd, repo.defBuffer, recvsize, 0);
+                        repo.sysCalls.rxCalls++;
+                        if (repo.rcvDataSize > 0)
+                                repo.sysCalls.rxDgrams++;
                         if (c->secAction == &service_statuspdu) {
                                 c->dataReady = FALSE; // Indicate all data has been read from this connection
                         }
@@ -2537,6 +3328,9 @@ int recv_proc(int connindex) {
         } else if (c->subType == SOCK_DGRAM) {
                 repo.remSasLen   = sizeof(repo.remSas);
                 repo.rcvDataSize = recvfrom(c->fd, repo.defBuffer, recvsize, 0, (struct sockaddr *) &repo.remSas, &repo.remSasLen);
+                repo.sysCalls.rxCalls++;
+                if (repo.rcvDataSize > 0)
+                        repo.sysCalls.rxDgrams++;
         } else {
                 repo.rcvDataSize = read(c->fd, repo.defBuffer, recvsize);
         }
@@ -2560,6 +3354,7 @@ int recv_proc(int connindex) {
                 }
                 return -1;
         }
+        CYC_STOP(CYC_RECV, cyc);
         return repo.rcvDataSize;
 }
 //----------------------------------------------------------------------------
@@ -2607,9 +3402,15 @@ int send_proc(int connindex, char *sendbuffer, int sendsize) {
         //
         if (c->subType == SOCK_STREAM || c->connected) {
                 actual = send(c->fd, sendbuffer, sendsize, 0);
+                repo.sysCalls.txCalls++;
+                if (actual > 0)
+                        repo.sysCalls.txDgrams++;
 
         } else if (c->subType == SOCK_DGRAM) {
                 actual = sendto(c->fd, sendbuffer, sendsize, 0, (struct sockaddr *) &repo.remSas, repo.remSasLen);
+                repo.sysCalls.txCalls++;
+                if (actual > 0)
+                        repo.sysCalls.txDgrams++;
         } else {
                 var = c->fd;
                 if ((c->type == T_CONSOLE) || (c->type == T_NULL)) {
@@ -2829,60 +3630,6 @@ int create_timestamp(struct timespec *tspecvar, BOOL utc) {
 }
 //----------------------------------------------------------------------------
 //
-// Update interface statistics via sysfs
-//
-void upd_intf_stats(BOOL initialize) {
-        int i, fd, var;
-        unsigned long long intfbytes, *ib; // Always handle counters as 64-bit values
-        double mbps, *im;
-        struct timespec tspecvar;
-        char buffer[32];
-
-        if (!initialize) {
-                lseek(repo.intfFD, 0, SEEK_SET);    // Reset position to read new value
-                lseek(repo.intfFDAlt, 0, SEEK_SET); // Reset position to read new value
-        }
-        for (i = 0; i < 2; i++) {
-                if (i == 0) {
-                        fd = repo.intfFD;
-                        ib = &repo.intfBytes;
-                        im = &repo.intfMbps;
-                } else {
-                        fd = repo.intfFDAlt;
-                        ib = &repo.intfBytesAlt;
-                        im = &repo.intfMbpsAlt;
-                }
-                if ((var = (int) read(fd, buffer, sizeof(buffer))) > 0) {
-                        buffer[var] = '\0';
-                        if ((intfbytes = strtoull(buffer, NULL, 10)) > 0) {
-                                if (!initialize) {
-                                        if (tspecisset(&repo.intfTime)) {
-                                                tspecminus(&repo.systemClock, &repo.intfTime, &tspecvar);
-                                                if (intfbytes >= *ib) {
-                                                        mbps = (double) (intfbytes - *ib);
-                                                } else { // Counter wrapped (allow for 32 or 64-bit wrap threshold)
-                                                        if (*ib <= 4294967295ULL) {
-                                                                mbps = (double) ((4294967295ULL - *ib) + intfbytes + 1);
-                                                        } else {
-                                                                mbps = (double) ((ULLONG_MAX - *ib) + intfbytes + 1);
-                                                        }
-                                                }
-                                                mbps *= 8.0;
-                                                mbps /= (double) tspecusec(&tspecvar);
-                                                *im = mbps;
-                                        }
-                                }
-                                *ib = intfbytes; // Save current value
-                                if (i == 1) {
-                                        tspeccpy(&repo.intfTime, &repo.systemClock); // Save current time
-                                }
-                        }
-                }
-        }
-        return;
-}
-//----------------------------------------------------------------------------
-//
 // Return a uniformly distributed random number between min and max
 //
 int getuniform(int min, int max) {
@@ -2915,7 +3662,7 @@ void output_debug(int connindex) {
         dvmin = dvavg = 0;
         if (c->delayVarCnt > 0) {
                 dvmin = c->delayVarMin;
-                dvavg = (((c->delayVarSum * 10) / c->delayVarCnt) + 5) / 10;
+                dvavg = (unsigned int) ((((c->delayVarSum * 10) / c->delayVarCnt) + 5) / 10);
         }
         var = -1;
         if (c->rttVarSample != STATUS_NODEL)
@@ -2960,7 +3707,7 @@ unsigned short checksum(register void *p, register int count) {
 //
 BOOL verify_datapdu(int connindex, struct loadHdr *lHdr, struct statusHdr *sHdr) {
         register struct connection *c = &conn[connindex];
-        int var;
+        int var, size;
         BOOL bvar;
         char connid[8];
         struct perfStatsCounters *psC = &repo.psCounters;
@@ -2999,11 +3746,21 @@ BOOL verify_datapdu(int connindex, struct loadHdr *lHdr, struct statusHdr *sHdr)
                 } else {
                         csumptr = (uint16_t *) (((unsigned char *) sHdr) + STATUS_CSOFF_MVER);
                 }
-                if (!repo.isServer && repo.rcvDataSize != (int) STATUS_SIZE_CVER) {
+                if (c->protocolVer >= USDELAY_PVER) {
+                        size = (int) STATUS_SIZE_EVER;
+                } else if (c->protocolVer >= EXTAUTH_PVER) {
+                        size = (int) STATUS_SIZE_CVER;
+                } else {
+                        size = (int) STATUS_SIZE_MVER;
+                }
+                if (c->protocolVer >= HISTO_PVER && repo.rcvDataSize >= size + (int) sizeof(struct statusHdrHisto)) {
+                        size += histo_wire_size((unsigned char *) sHdr + size); // Histogram trailer
+                }
+                if (!repo.isServer && repo.rcvDataSize != size) {
                         bvar = TRUE;
                         psC->statusInvalidSize++;
 
-                } else if (repo.isServer &&
+                } else if (repo.isServer && repo.rcvDataSize != size &&
                            (repo.rcvDataSize != (int) STATUS_SIZE_MVER && repo.rcvDataSize != (int) STATUS_SIZE_CVER)) {
                         bvar = TRUE;
                         psC->statusInvalidSize++;
@@ -44,14 +44,18 @@ extern int service_loadpdu(int);
 extern int service_recvmmsg(int);
 extern int send_statuspdu(int);
 extern int service_statuspdu(int);
+extern unsigned int trial_usec(int);
+extern int adjust_sending_rate(int);
 extern int proc_subinterval(int, BOOL);
 extern int agg_query_proc(int);
+extern double get_rate(int, struct subIntStats *, int);
 extern int stop_test(int);
 extern int recv_proc(int);
 extern int send_proc(int, char *, int);
 extern void sr_copy(struct sendingRate *, struct sendingRate *, BOOL);
 extern int create_timestamp(struct timespec *, BOOL);
 extern int getuniform(int, int);
+extern void restore_affinity(void);
 extern unsigned short checksum(void *, int);
 
 #endif /* UDPST_DATA_H */
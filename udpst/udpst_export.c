@@ -0,0 +1,445 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_export.c
+ *
+ * This file manages the binary output (export) of received load metadata. The
+ * receive path places fixed-width records into a per-connection lock-free ring
+ * and a writer thread drains all rings, building columnar chunks that are
+ * written to their archive files using large writes.
+ *
+ */
+
+#define UDPST_EXPORT
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_export.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern int errConn, monConn, aggConn;
+extern char scratch[STRING_SIZE];
+extern struct connection *conn;
+
+#ifdef __linux__
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void *export_writer(void *);
+int export_drain(struct exportRing *);
+void export_flush(struct exportRing *);
+void export_header(struct exportHeader *, struct exportRing *, uint64_t);
+void export_finish(struct exportRing *);
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static pthread_t expThread;                                  // Writer thread
+static pthread_mutex_t expMutex = PTHREAD_MUTEX_INITIALIZER; // Protects ring list
+static struct exportRing *expRingList;                       // Rings serviced by writer
+static BOOL expThreadActive;                                 // Writer thread created
+static int expThreadStop;                                    // Writer thread stop request
+static const int expColSize[EXPCOL_MAX] = EXPCOL_SIZES;      // Column element sizes
+static size_t expColBase[EXPCOL_MAX];                        // Column offsets in chunk buffer
+static const char expPad[EXPORT_ALIGN];                      // Column alignment padding
+#define EXPCOL(er, col, type) ((type *) ((er)->chunk + expColBase[col]))
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Open binary output (export) file and attach ring to connection
+//
+// Populate scratch buffer and return length on error
+//
+int export_open(int connindex, char *fname) {
+        register struct connection *c = &conn[connindex];
+        int i, var;
+        size_t size;
+        sigset_t sigset, sigsave;
+        struct exportRing *er;
+        struct exportHeader eh;
+
+        //
+        // Determine column layout of chunk buffer (each column sized for a full chunk)
+        //
+        for (i = 0, size = 0; i < EXPCOL_MAX; i++) {
+                expColBase[i] = size;
+                size += EXPORT_ALIGNUP((size_t) EXPORT_CHUNK_RECS * expColSize[i]);
+        }
+
+        //
+        // Allocate ring and chunk buffer
+        //
+        if ((er = calloc(1, sizeof(struct exportRing))) == NULL) {
+                return sprintf(scratch, "ERROR: Memory allocation failure for output ring\n");
+        }
+        er->buffer = malloc(EXPORT_RING_SIZE * sizeof(struct exportRecord));
+        er->chunk  = malloc(size);
+        if (er->buffer == NULL || er->chunk == NULL) {
+                free(er->buffer);
+                free(er->chunk);
+                free(er);
+                return sprintf(scratch, "ERROR: Memory allocation failure for output ring\n");
+        }
+
+        //
+        // Open output file and initialize with header
+        //
+        if ((er->fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) {
+                var = sprintf(scratch, "OPEN ERROR: <%.*s> %s\n", NAME_MAX, fname, strerror(errno));
+                free(er->buffer);
+                free(er->chunk);
+                free(er);
+                return var;
+        }
+        export_header(&eh, er, 0);
+        if (write(er->fd, &eh, sizeof(eh)) != (ssize_t) sizeof(eh)) {
+                var = sprintf(scratch, "WRITE ERROR: <%.*s> %s\n", NAME_MAX, fname, strerror(errno));
+                close(er->fd);
+                free(er->buffer);
+                free(er->chunk);
+                free(er);
+                return var;
+        }
+        er->fileOffset = sizeof(eh);
+
+        //
+        // Start writer thread on first use (with all signals blocked so they remain with main thread)
+        //
+        if (!expThreadActive) {
+                sigfillset(&sigset);
+                pthread_sigmask(SIG_SETMASK, &sigset, &sigsave);
+                var = pthread_create(&expThread, NULL, export_writer, NULL);
+                pthread_sigmask(SIG_SETMASK, &sigsave, NULL);
+                if (var != 0) {
+                        var = sprintf(scratch, "ERROR: Unable to create output writer thread: %s\n", strerror(var));
+                        close(er->fd);
+                        free(er->buffer);
+                        free(er->chunk);
+                        free(er);
+                        return var;
+                }
+                expThreadActive = TRUE;
+        }
+
+        //
+        // Hand ring to writer thread and attach to connection
+        //
+        pthread_mutex_lock(&expMutex);
+        er->next    = expRingList;
+        expRingList = er;
+        pthread_mutex_unlock(&expMutex);
+        c->exportRing = er;
+
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Place record in ring (receive path, count overflow if writer has fallen behind)
+//
+void export_record(struct exportRing *er, struct exportRecord *rec) {
+        unsigned int head = er->head;
+
+        if (head - __atomic_load_n(&er->tail, __ATOMIC_ACQUIRE) >= EXPORT_RING_SIZE) {
+                er->overflow++;
+                return;
+        }
+        er->buffer[head & EXPORT_RING_MASK] = *rec;
+        __atomic_store_n(&er->head, head + 1, __ATOMIC_RELEASE);
+}
+//----------------------------------------------------------------------------
+//
+// Release ring of connection (writer thread drains and closes file)
+//
+void export_close(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var;
+        struct exportRing *er = c->exportRing;
+
+        if (er == NULL)
+                return;
+        if (er->overflow > 0) {
+                var = sprintf(scratch, "[%d]WARNING: Output (export) ring overflow, %u records lost\n", connindex,
+                              er->overflow);
+                send_proc(errConn, scratch, var);
+        }
+        __atomic_store_n(&er->state, EXPORT_RING_CLOSE, __ATOMIC_RELEASE);
+        c->exportRing = NULL;
+}
+//----------------------------------------------------------------------------
+//
+// Stop writer thread after all released rings are drained
+//
+void export_shutdown(void) {
+        if (!expThreadActive)
+                return;
+        __atomic_store_n(&expThreadStop, TRUE, __ATOMIC_RELEASE);
+        pthread_join(expThread, NULL);
+        expThreadActive = FALSE;
+}
+//----------------------------------------------------------------------------
+//
+// Writer thread, service all rings until stopped and no rings remain
+//
+void *export_writer(void *arg) {
+        int state;
+        BOOL busy, stop, empty;
+        struct exportRing *er, **erp;
+
+        (void) arg;
+        for (;;) {
+                stop = (BOOL) __atomic_load_n(&expThreadStop, __ATOMIC_ACQUIRE);
+                busy = FALSE;
+                pthread_mutex_lock(&expMutex);
+                erp = &expRingList;
+                while ((er = *erp) != NULL) {
+                        //
+                        // Obtain state before draining so a released ring is known to be complete
+                        //
+                        state = __atomic_load_n(&er->state, __ATOMIC_ACQUIRE);
+                        if (export_drain(er) > 0)
+                                busy = TRUE;
+                        if (state == EXPORT_RING_CLOSE) {
+                                *erp = er->next;
+                                export_finish(er);
+                                continue;
+                        }
+                        erp = &er->next;
+                }
+                empty = (expRingList == NULL);
+                pthread_mutex_unlock(&expMutex);
+                if (stop && empty)
+                        break;
+                if (!busy)
+                        usleep(EXPORT_IDLE_USEC);
+        }
+        return NULL;
+}
+//----------------------------------------------------------------------------
+//
+// Transpose all available records of ring into chunk columns (writing each chunk as it fills)
+//
+int export_drain(struct exportRing *er) {
+        int count = 0;
+        unsigned int head, tail, idx;
+        struct exportRecord *rec;
+
+        head = __atomic_load_n(&er->head, __ATOMIC_ACQUIRE);
+        for (tail = er->tail; tail != head; tail++) {
+                rec = &er->buffer[tail & EXPORT_RING_MASK];
+                idx = er->chunkCount++;
+                EXPCOL(er, EXPCOL_SEQNO, uint32_t)[idx]   = rec->seqNo;
+                EXPCOL(er, EXPCOL_PAYLOAD, uint16_t)[idx] = rec->payload;
+                EXPCOL(er, EXPCOL_FLAGS, uint8_t)[idx]    = rec->flags;
+                EXPCOL(er, EXPCOL_SRCTX, uint64_t)[idx]   = rec->srcTxTime;
+                EXPCOL(er, EXPCOL_DSTRX, uint64_t)[idx]   = rec->dstRxTime;
+                EXPCOL(er, EXPCOL_OWD, int32_t)[idx]      = rec->owd;
+                EXPCOL(er, EXPCOL_INTF, double)[idx]      = rec->intfMbps;
+                EXPCOL(er, EXPCOL_INTFALT, double)[idx]   = rec->intfMbpsAlt;
+                EXPCOL(er, EXPCOL_RTTTX, uint64_t)[idx]   = rec->rttTxTime;
+                EXPCOL(er, EXPCOL_RTTRD, uint16_t)[idx]   = rec->rttRespDelay;
+                EXPCOL(er, EXPCOL_RTT, uint32_t)[idx]     = rec->rtt;
+                EXPCOL(er, EXPCOL_STATLOSS, int32_t)[idx] = rec->statusLoss;
+                if (er->chunkCount >= EXPORT_CHUNK_RECS) {
+                        __atomic_store_n(&er->tail, tail + 1, __ATOMIC_RELEASE); // Release ring entries before write
+                        export_flush(er);
+                }
+                count++;
+        }
+        __atomic_store_n(&er->tail, tail, __ATOMIC_RELEASE);
+        return count;
+}
+//----------------------------------------------------------------------------
+//
+// Write chunk being built (chunk header followed by aligned columns) and add to index
+//
+void export_flush(struct exportRing *er) {
+        int i, n;
+        size_t len, total;
+        ssize_t sz;
+        struct exportChunk ec;
+        struct exportIndex *ei;
+        struct iovec iov[1 + (2 * EXPCOL_MAX)];
+
+        if (er->chunkCount == 0)
+                return;
+        if (er->writeError) {
+                er->chunkCount = 0; // Discard, file already truncated at last complete chunk
+                return;
+        }
+
+        //
+        // Build chunk header and I/O vector of column data (padding each column to alignment)
+        //
+        memset(&ec, 0, sizeof(ec));
+        ec.chunkId      = EXPCHUNK_ID;
+        ec.columns      = EXPCOL_MAX;
+        ec.records      = er->chunkCount;
+        iov[0].iov_base = &ec;
+        iov[0].iov_len  = sizeof(ec);
+        total           = sizeof(ec);
+        for (i = 0, n = 1; i < EXPCOL_MAX; i++) {
+                ec.colOffset[i]  = (uint32_t) total;
+                len              = (size_t) er->chunkCount * expColSize[i];
+                iov[n].iov_base  = er->chunk + expColBase[i];
+                iov[n++].iov_len = len;
+                if (EXPORT_ALIGNUP(len) > len) {
+                        iov[n].iov_base  = (void *) expPad;
+                        iov[n++].iov_len = EXPORT_ALIGNUP(len) - len;
+                }
+                total += EXPORT_ALIGNUP(len);
+        }
+        ec.chunkSize = (uint32_t) total;
+
+        //
+        // Write chunk, on failure truncate to last complete chunk and discard all remaining records
+        //
+        if ((sz = writev(er->fd, iov, n)) != (ssize_t) total) {
+                er->writeError = TRUE;
+                er->chunkCount = 0;
+                if (sz > 0)
+                        sz = ftruncate(er->fd, (off_t) er->fileOffset);
+                return;
+        }
+
+        //
+        // Add to index
+        //
+        if (er->indexCount >= er->indexMax) {
+                er->indexMax = (er->indexMax == 0) ? 64 : er->indexMax * 2;
+                if ((ei = realloc(er->index, er->indexMax * sizeof(struct exportIndex))) == NULL) {
+                        er->indexMax = er->indexCount; // Continue without index, chunks can still be walked
+                } else {
+                        er->index = ei;
+                }
+        }
+        if (er->indexCount < er->indexMax) {
+                ei           = &er->index[er->indexCount];
+                ei->offset   = er->fileOffset;
+                ei->records  = er->chunkCount;
+                ei->reserved = 0;
+        }
+        er->indexCount++;
+        er->fileOffset += total;
+        er->records += er->chunkCount;
+        er->chunkCount = 0;
+}
+//----------------------------------------------------------------------------
+//
+// Populate file header with current ring counts
+//
+void export_header(struct exportHeader *eh, struct exportRing *er, uint64_t indexoffset) {
+        memset(eh, 0, sizeof(struct exportHeader));
+        memcpy(eh->magic, EXPORT_MAGIC, sizeof(eh->magic));
+        eh->version      = EXPORT_VERSION;
+        eh->columns      = EXPCOL_MAX;
+        eh->byteOrder    = EXPORT_BYTE_ORDER;
+        eh->chunkRecords = EXPORT_CHUNK_RECS;
+        eh->overflow     = er->overflow;
+        eh->records      = er->records;
+        eh->chunks       = er->indexCount;
+        eh->indexOffset  = indexoffset;
+}
+//----------------------------------------------------------------------------
+//
+// Write final chunk and index, finalize header, close file and free ring
+//
+void export_finish(struct exportRing *er) {
+        int var;
+        size_t len;
+        uint64_t indexoffset = 0;
+        struct exportHeader eh;
+
+        export_flush(er);
+        if (!er->writeError && er->indexCount > 0 && er->indexCount <= er->indexMax) { // Only if index is complete
+                len = (size_t) er->indexCount * sizeof(struct exportIndex);
+                if (write(er->fd, er->index, len) == (ssize_t) len)
+                        indexoffset = er->fileOffset;
+        }
+        export_header(&eh, er, indexoffset);
+        var = (int) pwrite(er->fd, &eh, sizeof(eh), 0); // If unsuccessful, readers walk chunks instead
+        (void) var;
+        close(er->fd);
+        free(er->index);
+        free(er->chunk);
+        free(er->buffer);
+        free(er);
+}
+#else
+//----------------------------------------------------------------------------
+//
+// Binary output (export) unavailable without writer thread support
+//
+int export_open(int connindex, char *fname) {
+        return sprintf(scratch, "ERROR: Binary output (export) not supported\n");
+}
+void export_record(struct exportRing *er, struct exportRecord *rec) {
+        return;
+}
+void export_close(int connindex) {
+        return;
+}
+void export_shutdown(void) {
+        return;
+}
+#endif // __linux__
+//----------------------------------------------------------------------------
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_export.h
+ *
+ * This file contains the binary output (export) record formats as well as the
+ * external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_EXPORT_H
+#define UDPST_EXPORT_H
+
+//----------------------------------------------------------------------------
+//
+// Binary output (export) archive layout
+//
+// The file starts with a header and is followed by chunks of up to chunkRecords
+// records stored column by column (each column starts on an EXPORT_ALIGN byte
+// boundary within the file so it can be scanned directly when memory-mapped).
+// An index of chunk offsets is appended when the file is closed, and the header
+// counts and index offset are updated. If the file is not closed normally the
+// chunks can still be walked sequentially via each chunk header.
+//
+// NOTE: All fields are in host byte order (see byteOrder)
+//
+#define EXPORT_MAGIC      "UDPSTBIN" // File identifier
+#define EXPORT_VERSION    2          // File format version (columnar)
+#define EXPORT_BYTE_ORDER 0x01020304 // Byte order indicator
+#define EXPORT_ALIGN      64         // Header, chunk and column alignment (bytes)
+#define EXPORT_CHUNK_RECS 65536      // Maximum records per chunk
+#define EXPORT_ALIGNUP(x) (((x) + EXPORT_ALIGN - 1) & ~((uint64_t) EXPORT_ALIGN - 1))
+//
+// Columns (in chunk order) and their element sizes
+//
+#define EXPCOL_SEQNO    0  // uint32_t: Load PDU sequence number
+#define EXPCOL_PAYLOAD  1  // uint16_t: UDP payload (bytes)
+#define EXPCOL_FLAGS    2  // uint8_t: Record flags
+#define EXPCOL_SRCTX    3  // uint64_t: Source transmit time (ns)
+#define EXPCOL_DSTRX    4  // uint64_t: Destination receive time (ns)
+#define EXPCOL_OWD      5  // int32_t: One-way delay w/clock diff (ms)
+#define EXPCOL_INTF     6  // double: Local interface rate
+#define EXPCOL_INTFALT  7  // double: Local interface rate (alternate direction)
+#define EXPCOL_RTTTX    8  // uint64_t: Status PDU transmit time for RTT (ns)
+#define EXPCOL_RTTRD    9  // uint16_t: RTT response delay (ms)
+#define EXPCOL_RTT      10 // uint32_t: Round-trip time (ms)
+#define EXPCOL_STATLOSS 11 // int32_t: Status PDU sequence errors
+#define EXPCOL_MAX      12
+#define EXPCOL_SIZES    {4, 2, 1, 8, 8, 4, 8, 8, 8, 2, 4, 4}
+#pragma pack(push, 1)
+struct exportHeader {
+        char magic[8];         // File identifier
+        uint16_t version;      // File format version
+        uint16_t columns;      // Columns per chunk
+        uint32_t byteOrder;    // Byte order indicator
+        uint32_t chunkRecords; // Maximum records per chunk
+        uint32_t overflow;     // Records lost to ring overflow
+        uint64_t records;      // Records written
+        uint64_t chunks;       // Chunks written
+        uint64_t indexOffset;  // File offset of chunk index (0 = none)
+        uint8_t reserved[16];  // (reserved for alignment)
+};
+#define EXPCHUNK_ID 0xC4C4
+struct exportChunk {
+        uint16_t chunkId;               // Chunk ID
+        uint16_t columns;               // Columns in chunk
+        uint32_t records;               // Records in chunk
+        uint32_t colOffset[EXPCOL_MAX]; // Column offsets (from start of chunk)
+        uint32_t chunkSize;             // Total chunk size incl. padding
+        uint8_t reserved[4];            // (reserved for alignment)
+};
+struct exportIndex {
+        uint64_t offset;   // File offset of chunk
+        uint32_t records;  // Records in chunk
+        uint32_t reserved; // (reserved for alignment)
+};
+#define EXPREC_RTT 0x01 // RTT fields are valid
+struct exportRecord {
+        uint32_t seqNo;        // Load PDU sequence number
+        uint16_t payload;      // UDP payload (bytes)
+        uint8_t flags;         // Record flags
+        uint8_t reserved1;     // (reserved for alignment)
+        uint64_t srcTxTime;    // Source transmit time (ns)
+        uint64_t dstRxTime;    // Destination receive time (ns)
+        int32_t owd;           // One-way delay w/clock diff (ms)
+        uint16_t rttRespDelay; // RTT response delay (ms)
+        uint16_t reserved2;    // (reserved for alignment)
+        double intfMbps;       // Local interface rate
+        double intfMbpsAlt;    // Local interface rate (alternate direction)
+        uint64_t rttTxTime;    // Status PDU transmit time for RTT (ns)
+        uint32_t rtt;          // Round-trip time (ms)
+        int32_t statusLoss;    // Status PDU sequence errors
+};
+#pragma pack(pop)
+//
+// Single-producer (receive path) single-consumer (writer thread) ring
+//
+#define EXPORT_RING_SIZE  65536 // Ring entries (must be power of 2)
+#define EXPORT_RING_MASK  (EXPORT_RING_SIZE - 1)
+#define EXPORT_IDLE_USEC  10000 // Writer sleep time when ring(s) empty
+#define EXPORT_RING_OPEN  0     // Ring in use by receive path
+#define EXPORT_RING_CLOSE 1     // Ring released, close after drain
+struct exportRing {
+        struct exportRecord *buffer; // Ring buffer
+        unsigned int head;           // Producer index (receive path)
+        unsigned int tail;           // Consumer index (writer thread)
+        unsigned int overflow;       // Records lost to ring overflow
+        int state;                   // Ring state
+        int fd;                      // Output file descriptor
+        BOOL writeError;             // Write failure (discard remaining)
+        uint64_t records;            // Records written
+        uint64_t fileOffset;         // Current file offset
+        char *chunk;                 // Column buffers of chunk being built
+        unsigned int chunkCount;     // Records in chunk being built
+        struct exportIndex *index;   // Chunk index
+        uint64_t indexCount;         // Chunks written
+        uint64_t indexMax;           // Chunk index entries allocated
+        struct exportRing *next;     // Next ring serviced by writer
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int export_open(int, char *);
+extern void export_record(struct exportRing *, struct exportRecord *);
+extern void export_close(int);
+extern void export_shutdown(void);
+
+#endif /* UDPST_EXPORT_H */
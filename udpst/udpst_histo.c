@@ -0,0 +1,494 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_histo.c
+ *
+ * This file maintains the log-linear delay and RTT variation histograms of
+ * each test connection. Histograms are recorded per sub-interval by the load
+ * PDU receiver, carried to the peer in an optional status PDU trailer, merged
+ * into the aggregate connection, and reduced to percentiles for output. It
+ * also records the timer slip and burst jitter of the local transmitters.
+ *
+ */
+
+#define UDPST_HISTO
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <net/if.h>
+#include <arpa/inet.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_histo.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+int histo_encode(struct histogram *, int, unsigned char *, int);
+int histo_unpack(struct histogram *, int, unsigned char *, int);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern struct repository repo;
+extern struct connection *conn;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static const unsigned int histoPerMille[HISTO_QUANTILES] = {500, 900, 990, 999}; // p50, p90, p99, p99.9
+static const char *histoQuantileName[HISTO_QUANTILES]     = {"p50", "p90", "p99", "p999"};
+static const char *histoTxTypeName[HISTO_TXTYPES]         = {"slip", "jitter"};
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Highest value counted in a bucket (used when reporting, so a percentile is never understated)
+//
+static unsigned int _bucket_value(int index) {
+        int shift;
+
+        if (index < (2 << HISTO_SUB_BITS))
+                return (unsigned int) index; // One value per bucket in the first two ranges
+        shift = (index >> HISTO_SUB_BITS) - 1;
+        return ((((unsigned int) index & (HISTO_SUB_COUNT - 1)) + HISTO_SUB_COUNT) << shift) + (1U << shift) - 1;
+}
+//----------------------------------------------------------------------------
+//
+// Append unsigned varint (7 bits per byte, low-order group first)
+//
+// Return length, or -1 if it does not fit
+//
+static int _put_varint(unsigned char *buf, int size, uint64_t value) {
+        int len = 0;
+
+        do {
+                if (len >= size)
+                        return -1;
+                buf[len] = (unsigned char) (value & 0x7F);
+                value >>= 7;
+                if (value > 0)
+                        buf[len] |= 0x80;
+                len++;
+        } while (value > 0);
+        return len;
+}
+//----------------------------------------------------------------------------
+//
+// Extract unsigned varint
+//
+// Return length, or -1 if truncated or too long
+//
+static int _get_varint(unsigned char *buf, int size, uint64_t *value) {
+        int len;
+
+        *value = 0;
+        for (len = 0; len < size && len < 10; len++) {
+                *value |= (uint64_t) (buf[len] & 0x7F) << (7 * len);
+                if ((buf[len] & 0x80) == 0)
+                        return len + 1;
+        }
+        return -1;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain histogram set of connection, allocating it on first use
+//
+// Return NULL if unavailable (histograms are then skipped for the connection)
+//
+struct histoSet *histo_conn(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        if (c->histo == NULL)
+                c->histo = calloc(1, sizeof(struct histoSet));
+        return c->histo;
+}
+//----------------------------------------------------------------------------
+//
+// Allocate zeroed histogram array
+//
+struct histogram *histo_alloc(int count) {
+        return calloc((size_t) count, sizeof(struct histogram));
+}
+//----------------------------------------------------------------------------
+//
+// Record value (us) in histogram
+//
+void histo_record(struct histogram *h, unsigned int value) {
+        unsigned int index, shift;
+
+        if (value < (2U << HISTO_SUB_BITS)) {
+                index = value;
+        } else {
+                shift = (unsigned int) (31 - __builtin_clz(value)) - HISTO_SUB_BITS;
+                index = ((shift + 1) << HISTO_SUB_BITS) + (value >> shift) - HISTO_SUB_COUNT;
+                if (index >= HISTO_BUCKETS)
+                        index = HISTO_BUCKETS - 1; // Saturate
+        }
+        h->count[index]++;
+        h->total++;
+        if (value > h->max)
+                h->max = value;
+}
+//----------------------------------------------------------------------------
+//
+// Merge source histogram into destination
+//
+void histo_merge(struct histogram *dst, struct histogram *src) {
+        int i;
+
+        if (src->total == 0)
+                return;
+        for (i = 0; i < HISTO_BUCKETS; i++) {
+                dst->count[i] += src->count[i];
+        }
+        dst->total += src->total;
+        if (src->max > dst->max)
+                dst->max = src->max;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain p50, p90, p99, and p99.9 values (us) of histogram, all zero if empty
+//
+void histo_quantiles(struct histogram *h, unsigned int *quantile) {
+        int i, j;
+        uint64_t cumulative, rank[HISTO_QUANTILES];
+
+        for (j = 0; j < HISTO_QUANTILES; j++) {
+                quantile[j] = 0;
+                rank[j]     = (h->total * histoPerMille[j] + 999) / 1000; // Nearest rank (rounded up)
+                if (rank[j] == 0)
+                        rank[j] = 1;
+        }
+        if (h->total == 0)
+                return;
+        cumulative = 0;
+        for (i = 0, j = 0; i < HISTO_BUCKETS && j < HISTO_QUANTILES; i++) {
+                cumulative += h->count[i];
+                while (j < HISTO_QUANTILES && cumulative >= rank[j]) {
+                        quantile[j] = _bucket_value(i);
+                        if (quantile[j] > h->max)
+                                quantile[j] = h->max; // Bucket may extend beyond maximum
+                        j++;
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Save active histograms at end of sub-interval and encode them for the status PDU trailer
+//
+void histo_save(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int coarsen, var, len[HISTO_TYPES];
+        struct histoSet *hs = c->histo;
+        struct statusHdrHisto *hh;
+
+        if (hs == NULL)
+                return;
+        memcpy(hs->sav, hs->act, sizeof(hs->sav));
+        memset(hs->act, 0, sizeof(hs->act));
+
+        //
+        // Encode at full resolution if possible, otherwise combine adjacent buckets until both fit
+        //
+        hs->wireLen = 0;
+        for (coarsen = 0; coarsen <= HISTO_SUB_BITS; coarsen++) {
+                var = sizeof(struct statusHdrHisto);
+                if ((len[HISTO_OWD] = histo_encode(&hs->sav[HISTO_OWD], coarsen, &hs->wire[var], STATUS_HISTO_MAX)) < 0)
+                        continue;
+                var += len[HISTO_OWD];
+                if ((len[HISTO_RTT] = histo_encode(&hs->sav[HISTO_RTT], coarsen, &hs->wire[var],
+                                                   STATUS_HISTO_MAX - len[HISTO_OWD])) < 0)
+                        continue;
+                hs->wireLen = var + len[HISTO_RTT];
+                break;
+        }
+        if (hs->wireLen == 0)
+                return;
+        hs->wireSends      = HISTO_WIRE_SENDS;
+        hh                 = (struct statusHdrHisto *) hs->wire;
+        hh->delayVarMaxUs  = htonl(hs->sav[HISTO_OWD].max);
+        hh->rttVarMaxUs    = htonl(hs->sav[HISTO_RTT].max);
+        hh->delayVarLength = htons((uint16_t) len[HISTO_OWD]);
+        hh->rttVarLength   = htons((uint16_t) len[HISTO_RTT]);
+        hh->subBits        = HISTO_SUB_BITS;
+        hh->maxBits        = HISTO_MAX_BITS;
+        hh->coarsen        = (uint8_t) coarsen;
+        hh->reserved1      = 0;
+}
+//----------------------------------------------------------------------------
+//
+// Encode histogram as (gap, count) varint pairs of non-empty buckets, after combining
+// 2^coarsen adjacent buckets into one
+//
+// Return length, or -1 if it does not fit
+//
+int histo_encode(struct histogram *h, int coarsen, unsigned char *buf, int size) {
+        int i, group, prev, len, var;
+        uint64_t count;
+
+        len  = 0;
+        prev = -1;
+        for (group = 0; group < (HISTO_BUCKETS >> coarsen); group++) {
+                count = 0;
+                for (i = group << coarsen; i < (group + 1) << coarsen; i++) {
+                        count += h->count[i];
+                }
+                if (count == 0)
+                        continue;
+                if ((var = _put_varint(&buf[len], size - len, (uint64_t) (group - prev - 1))) < 0)
+                        return -1;
+                len += var;
+                if ((var = _put_varint(&buf[len], size - len, count)) < 0)
+                        return -1;
+                len += var;
+                prev = group;
+        }
+        return len;
+}
+//----------------------------------------------------------------------------
+//
+// Total size of status PDU histogram trailer (caller verifies the fixed part was received)
+//
+int histo_wire_size(unsigned char *buf) {
+        struct statusHdrHisto *hh = (struct statusHdrHisto *) buf;
+
+        return (int) sizeof(struct statusHdrHisto) + (int) ntohs(hh->delayVarLength) + (int) ntohs(hh->rttVarLength);
+}
+//----------------------------------------------------------------------------
+//
+// Decode status PDU histogram trailer of peer into saved histograms
+//
+// Histograms that cannot be decoded are left empty (no percentiles are output for them)
+//
+void histo_decode(int connindex, unsigned char *buf, int size) {
+        int var, len[HISTO_TYPES];
+        struct histoSet *hs;
+        struct statusHdrHisto *hh = (struct statusHdrHisto *) buf;
+
+        if ((hs = histo_conn(connindex)) == NULL)
+                return;
+        memset(hs->sav, 0, sizeof(hs->sav));
+        if (size < (int) sizeof(struct statusHdrHisto) || histo_wire_size(buf) != size)
+                return;
+        if (hh->subBits != HISTO_SUB_BITS || hh->maxBits != HISTO_MAX_BITS || hh->coarsen > HISTO_SUB_BITS)
+                return; // Incompatible layout
+        len[HISTO_OWD] = (int) ntohs(hh->delayVarLength);
+        len[HISTO_RTT] = (int) ntohs(hh->rttVarLength);
+
+        var = sizeof(struct statusHdrHisto);
+        if (histo_unpack(&hs->sav[HISTO_OWD], hh->coarsen, &buf[var], len[HISTO_OWD]) == 0) {
+                hs->sav[HISTO_OWD].max = ntohl(hh->delayVarMaxUs);
+        } else {
+                memset(&hs->sav[HISTO_OWD], 0, sizeof(struct histogram));
+        }
+        var += len[HISTO_OWD];
+        if (histo_unpack(&hs->sav[HISTO_RTT], hh->coarsen, &buf[var], len[HISTO_RTT]) == 0) {
+                hs->sav[HISTO_RTT].max = ntohl(hh->rttVarMaxUs);
+        } else {
+                memset(&hs->sav[HISTO_RTT], 0, sizeof(struct histogram));
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Unpack encoded histogram, placing each combined count in the highest bucket of its group
+//
+// Return 0 on success, or -1 if invalid
+//
+int histo_unpack(struct histogram *h, int coarsen, unsigned char *buf, int size) {
+        int pos, var, prev;
+        uint64_t gap, count, index;
+
+        pos  = 0;
+        prev = -1;
+        while (pos < size) {
+                if ((var = _get_varint(&buf[pos], size - pos, &gap)) < 0)
+                        return -1;
+                pos += var;
+                if ((var = _get_varint(&buf[pos], size - pos, &count)) < 0)
+                        return -1;
+                pos += var;
+                index = ((((uint64_t) prev + 1 + gap) + 1) << coarsen) - 1;
+                if (gap >= HISTO_BUCKETS || index >= HISTO_BUCKETS)
+                        return -1;
+                if (count > UINT32_MAX - h->count[index])
+                        count = UINT32_MAX - h->count[index]; // Saturate
+                h->count[index] += (uint32_t) count;
+                h->total += count;
+                prev = (int) (index >> coarsen);
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Release histogram set of connection
+//
+void histo_free(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        if (c->histo != NULL) {
+                free(c->histo);
+                c->histo = NULL;
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Elapsed time (us) from b to a, limited to the range of a histogram
+//
+static unsigned int _elapsed_usec(struct timespec *a, struct timespec *b) {
+        long long deltaus;
+        struct timespec tspecvar;
+
+        tspecminus(a, b, &tspecvar);
+        deltaus = (long long) tspecusec(&tspecvar);
+        if (deltaus < 0)
+                return 0;
+        if (deltaus > (1LL << HISTO_MAX_BITS))
+                return 1U << HISTO_MAX_BITS;
+        return (unsigned int) deltaus;
+}
+//----------------------------------------------------------------------------
+//
+// Record transmit schedule accuracy of a load PDU burst, before the transmitter timer is reset
+//
+// Slip is how far beyond its ideal deadline (the timer threshold plus the send timer adjustment)
+// the burst was sent, and jitter is the change of the achieved inter-burst gap from the previous one
+// (while the send interval is unchanged). The achieved gap is also summed along with the intended
+// gap, i.e. the send interval in effect when the timer was last set, so the two can be compared.
+//
+void histo_txsched(int connindex, int transmitter, struct timespec *thresh, int interval) {
+        register struct connection *c = &conn[connindex];
+        int t = transmitter - 1;
+        unsigned int gap;
+        struct timespec tspecvar, deadline;
+        struct txSchedSet *tss;
+
+        if (repo.txSched == NULL) {
+                if ((repo.txSched = calloc(1, sizeof(struct txSchedSet))) == NULL)
+                        return;
+        }
+        tss = repo.txSched;
+
+        if (tspecisset(thresh)) {
+                tspecvar.tv_sec  = 0;
+                tspecvar.tv_nsec = (long) (SEND_TIMER_ADJ * NSECINUSEC);
+                tspecplus(thresh, &tspecvar, &deadline); // Timer is set early by the adjustment
+                histo_record(&tss->tx[t][HISTO_SLIP], _elapsed_usec(&repo.systemClock, &deadline));
+        }
+        if (tspecisset(&c->txLastTime[t])) {
+                gap = _elapsed_usec(&repo.systemClock, &c->txLastTime[t]);
+                if (c->txLastGap[t] > 0) {
+                        if (gap >= c->txLastGap[t])
+                                histo_record(&tss->tx[t][HISTO_JITTER], gap - c->txLastGap[t]);
+                        else
+                                histo_record(&tss->tx[t][HISTO_JITTER], c->txLastGap[t] - gap);
+                }
+                tss->gapCount[t]++;
+                tss->gapTotal[t] += gap;
+                tss->intTotal[t] += c->txLastInt[t];
+                c->txLastGap[t] = gap;
+        }
+
+        //
+        // Start over if the transmitter is being stopped (its timer is cleared)
+        //
+        if (interval > 0) {
+                tspeccpy(&c->txLastTime[t], &repo.systemClock);
+                if (c->txLastInt[t] != (unsigned int) interval)
+                        c->txLastGap[t] = 0; // Sending rate change is not jitter
+                c->txLastInt[t] = (unsigned int) interval;
+        } else {
+                tspecclear(&c->txLastTime[t]);
+                c->txLastGap[t] = 0;
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Append transmit schedule accuracy of this performance statistics record, then reset it
+//
+// Return length of output
+//
+int histo_txsched_json(char *buf) {
+        int i, j, k, len = 0;
+        unsigned int quantile[HISTO_QUANTILES];
+        double gapavg, intavg;
+        struct histogram *h;
+        struct txSchedSet *tss = repo.txSched;
+
+        len += sprintf(&buf[len], "\t\"tx_schedule\": [\n");
+        for (i = 0; i < HISTO_TXCOUNT; i++) {
+                gapavg = intavg = 0.0;
+                if (tss != NULL && tss->gapCount[i] > 0) {
+                        gapavg = (double) tss->gapTotal[i] / (double) tss->gapCount[i];
+                        intavg = (double) tss->intTotal[i] / (double) tss->gapCount[i];
+                }
+                h = (tss != NULL) ? &tss->tx[i][HISTO_SLIP] : NULL;
+                len += sprintf(&buf[len], "\t\t{\"transmitter\": %d, \"bursts\": %llu, ", i + 1,
+                               (h != NULL) ? (unsigned long long) h->total : 0ULL);
+                for (j = 0; j < HISTO_TXTYPES; j++) {
+                        memset(quantile, 0, sizeof(quantile));
+                        h = NULL;
+                        if (tss != NULL) {
+                                h = &tss->tx[i][j];
+                                histo_quantiles(h, quantile);
+                        }
+                        for (k = 0; k < HISTO_QUANTILES; k++) {
+                                len += sprintf(&buf[len], "\"%s_%s_usec\": %u, ", histoTxTypeName[j], histoQuantileName[k],
+                                               quantile[k]);
+                        }
+                        len += sprintf(&buf[len], "\"%s_max_usec\": %u, ", histoTxTypeName[j], (h != NULL) ? h->max : 0);
+                }
+                len += sprintf(&buf[len], "\"gap_avg_usec\": %.1f, \"intended_gap_avg_usec\": %.1f}%s\n", gapavg, intavg,
+                               (i < HISTO_TXCOUNT - 1) ? "," : "");
+        }
+        len += sprintf(&buf[len], "\t],\n");
+
+        if (tss != NULL)
+                memset(tss, 0, sizeof(struct txSchedSet));
+        return len;
+}
+//----------------------------------------------------------------------------
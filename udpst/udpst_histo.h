@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_histo.h
+ *
+ * This file contains the delay and RTT variation histogram structures as well
+ * as the external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_HISTO_H
+#define UDPST_HISTO_H
+
+//----------------------------------------------------------------------------
+//
+// Log-linear histogram of delay variation values (us)
+//
+// Values below HISTO_SUB_COUNT each have their own bucket. Above that, every
+// power-of-2 range is divided into HISTO_SUB_COUNT equal-width buckets, which
+// bounds the relative error of any reported value to 1/HISTO_SUB_COUNT (~3%)
+// while covering 0 to 2^HISTO_MAX_BITS us (~33 sec) with a fixed bucket array.
+// Larger values are counted in the last bucket.
+//
+#define HISTO_SUB_BITS  5                                                         // Sub-bucket bits
+#define HISTO_SUB_COUNT (1 << HISTO_SUB_BITS)                                     // Sub-buckets per range
+#define HISTO_MAX_BITS  25                                                        // Value bits (us)
+#define HISTO_BUCKETS   ((HISTO_MAX_BITS - HISTO_SUB_BITS + 1) * HISTO_SUB_COUNT) // Total buckets
+#define HISTO_OWD       0                                                         // One-way delay variation
+#define HISTO_RTT       1                                                         // RTT variation
+#define HISTO_TYPES     2                                                         // Histograms per set
+#define HISTO_QUANTILES 4                                                         // Reported percentiles
+struct histogram {
+        uint32_t count[HISTO_BUCKETS]; // Bucket counts
+        uint64_t total;                // Total count
+        uint32_t max;                  // Maximum value recorded (us)
+};
+//
+// Histogram set of a test connection, recorded by the load PDU receiver and saved with each
+// sub-interval (the saved set is either local or decoded from the status PDUs of the peer)
+//
+// The peer only decodes the trailer of the first status PDU it receives after a sub-interval is
+// saved, so it is only carried by the first few (allowing for the loss of some of them).
+//
+#define HISTO_WIRE_SENDS 3 // Status PDUs carrying each saved set
+struct histoSet {
+        struct histogram act[HISTO_TYPES];                                    // Sub-interval active histograms
+        struct histogram sav[HISTO_TYPES];                                    // Sub-interval saved histograms
+        int wireLen;                                                          // Encoded length of saved histograms
+        int wireSends;                                                        // Status PDUs left to carry trailer
+        unsigned char wire[sizeof(struct statusHdrHisto) + STATUS_HISTO_MAX]; // Status PDU trailer
+};
+//
+// Transmit schedule accuracy of the local load PDU transmitters, accumulated over the test by a
+// client and over each performance statistics record by a server
+//
+#define HISTO_SLIP    0 // Timer slip (send time beyond ideal deadline)
+#define HISTO_JITTER  1 // Burst jitter (change in achieved inter-burst gap)
+#define HISTO_TXTYPES 2 // Histograms per transmitter
+#define HISTO_TXCOUNT 2 // Transmitters per connection
+struct txSchedSet {
+        struct histogram tx[HISTO_TXCOUNT][HISTO_TXTYPES]; // Slip and jitter histograms per transmitter
+        uint64_t gapCount[HISTO_TXCOUNT];                  // Achieved gap count
+        uint64_t gapTotal[HISTO_TXCOUNT];                  // Achieved gap total (us)
+        uint64_t intTotal[HISTO_TXCOUNT];                  // Intended gap total (us)
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern struct histoSet *histo_conn(int);
+extern struct histogram *histo_alloc(int);
+extern void histo_record(struct histogram *, unsigned int);
+extern void histo_merge(struct histogram *, struct histogram *);
+extern void histo_quantiles(struct histogram *, unsigned int *);
+extern void histo_save(int);
+extern int histo_wire_size(unsigned char *);
+extern void histo_decode(int, unsigned char *, int);
+extern void histo_free(int);
+extern void histo_txsched(int, int, struct timespec *, int);
+extern int histo_txsched_json(char *);
+
+#endif /* UDPST_HISTO_H */
@@ -0,0 +1,556 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_intf.c
+ *
+ * This file samples the statistics of the local interface(s) given by the
+ * client, via one netlink request per interface for its 64-bit link counters
+ * and, optionally, the per-queue driver counters via ethtool. The
+ * rates obtained each sub-interval are summed for the interface rate of the
+ * test and output per interface and queue.
+ *
+ */
+
+#define UDPST_INTF
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_jsonw.h"
+#include "udpst_intf.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern char scratch[STRING_SIZE];
+extern struct configuration conf;
+extern struct repository repo;
+
+#ifdef __linux__
+#define INTF_TX 0 // Transmit direction index
+#define INTF_RX 1 // Receive direction index
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+int intf_sample(int, double);
+void intf_link(struct intfEntry *, struct rtnl_link_stats64 *, double);
+void intf_queue_init(struct intfEntry *);
+void intf_queue_sample(struct intfEntry *, double);
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static struct intfEntry intfTable[MAX_INTF_COUNT]; // Local interfaces
+static int intfCount;                              // Local interface count
+static int intfEthFD = -1;                         // Socket for ethtool commands
+static int intfMsgType;                            // Netlink request (RTM_GETSTATS or RTM_GETLINK)
+static unsigned int intfSeqNo;                     // Netlink request sequence number
+static char *intfNlBuf;                            // Netlink receive buffer
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Delta of counter (64-bit counters do not wrap, so a decrease means they were reset)
+//
+static double _delta(unsigned long long cur, unsigned long long prev) {
+        if (cur < prev)
+                return 0.0;
+        return (double) (cur - prev);
+}
+//----------------------------------------------------------------------------
+//
+// Open netlink socket and resolve local interface list, obtaining initial counters
+//
+// Populate scratch buffer and return length on error
+//
+int intf_open(void) {
+        int fd, var;
+        char list[INTF_LIST_SIZE], *name, *saveptr;
+        struct intfEntry *ie;
+
+        //
+        // Resolve each interface of comma separated list
+        //
+        strcpy(list, conf.intfName);
+        for (name = strtok_r(list, ",", &saveptr); name != NULL; name = strtok_r(NULL, ",", &saveptr)) {
+                if (intfCount >= MAX_INTF_COUNT) {
+                        return sprintf(scratch, "ERROR: Local interface count exceeds maximum (%d)\n", MAX_INTF_COUNT);
+                }
+                ie = &intfTable[intfCount];
+                if (strlen(name) >= IFNAMSIZ || (ie->ifIndex = (int) if_nametoindex(name)) == 0) {
+                        return sprintf(scratch, "ERROR: Local interface %s not found\n", name);
+                }
+                strcpy(ie->name, name);
+                intfCount++;
+        }
+        if (intfCount == 0) {
+                return sprintf(scratch, "ERROR: Local interface list is empty\n");
+        }
+
+        //
+        // Open netlink socket (replies are only read without blocking, see intf_sample)
+        //
+        if ((intfNlBuf = malloc(INTF_NLBUF_SIZE)) == NULL) {
+                return sprintf(scratch, "ERROR: Unable to allocate netlink buffer\n");
+        }
+        if ((fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)) < 0) {
+                return sprintf(scratch, "SOCKET ERROR: %s (netlink)\n", strerror(errno));
+        }
+        repo.intfFD = fd;
+
+        //
+        // Obtain initial counters, falling back to link request if statistics request is unsupported
+        //
+#ifdef IFLA_STATS_FILTER_BIT
+        intfMsgType = RTM_GETSTATS;
+        if ((var = intf_sample(intfMsgType, 0.0)) < 0 && var != -EAGAIN)
+#endif
+        {
+                intfMsgType = RTM_GETLINK;
+                var         = intf_sample(intfMsgType, 0.0);
+        }
+        if (var < 0) {
+                return sprintf(scratch, "NETLINK ERROR: %s (interface statistics)\n", strerror(-var));
+        }
+        for (var = 0; var < intfCount; var++) {
+                if (!intfTable[var].sampled) {
+                        return sprintf(scratch, "ERROR: Local interface %s statistics unavailable\n", intfTable[var].name);
+                }
+        }
+
+        //
+        // Map per-queue driver statistics if requested
+        //
+        if (conf.intfQueues) {
+                if ((intfEthFD = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)) < 0) {
+                        return sprintf(scratch, "SOCKET ERROR: %s (ethtool)\n", strerror(errno));
+                }
+                for (var = 0; var < intfCount; var++) {
+                        intf_queue_init(&intfTable[var]);
+                }
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Update interface statistics, where the rates are only obtained after the counters are initialized
+//
+// The interface rate of the test direction (and alternate direction) is the sum of all interfaces
+//
+void intf_update(BOOL initialize) {
+        int i, dir;
+        double usec = 0.0;
+        struct timespec tspecvar;
+
+        if (!initialize && tspecisset(&repo.intfTime)) {
+                tspecminus(&repo.systemClock, &repo.intfTime, &tspecvar);
+                usec = (double) tspecusec(&tspecvar);
+        }
+        if (intf_sample(intfMsgType, usec) < 0)
+                return; // Retain previous rates and counters
+        for (i = 0; i < intfCount; i++) {
+                if (intfTable[i].queueCount > 0)
+                        intf_queue_sample(&intfTable[i], usec);
+        }
+        tspeccpy(&repo.intfTime, &repo.systemClock);
+        if (usec <= 0.0)
+                return;
+
+        dir              = conf.usTesting ? INTF_TX : INTF_RX;
+        repo.intfMbps    = 0.0;
+        repo.intfMbpsAlt = 0.0;
+        for (i = 0; i < intfCount; i++) {
+                repo.intfMbps += intfTable[i].mbps[dir];
+                repo.intfMbpsAlt += intfTable[i].mbps[1 - dir];
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Request link statistics of each local interface (one non-dump request per interface index, sent as a
+// single batch) and process the replies
+//
+// Since rtnetlink processes requests synchronously within send(), the replies are already queued when it
+// returns and are read without blocking. Any reply still missing is treated as unavailable for this sample
+// (the interface retains its previous rates and counters), so the event loop is never stalled.
+//
+// Return 0 on success, or negative errno
+//
+int intf_sample(int msgtype, double usec) {
+        int i, len, attrlen, ifindex, attrtype, pending, error = 0;
+        uint32_t req[MAX_INTF_COUNT * 16]; // Aligned request buffer (one message per interface)
+        unsigned int seqbase;
+        struct nlmsghdr *nlh;
+        struct rtattr *rta;
+        struct ifinfomsg *ifi;
+        struct rtnl_link_stats64 stats;
+#ifdef IFLA_STATS_FILTER_BIT
+        struct if_stats_msg *ifsm;
+#endif
+
+        //
+        // Build and send request for each interface
+        //
+        memset(req, 0, sizeof(req));
+        seqbase = intfSeqNo + 1;
+        for (i = 0, len = 0; i < intfCount; i++) {
+                nlh              = (struct nlmsghdr *) ((char *) req + len);
+                nlh->nlmsg_type  = (uint16_t) msgtype;
+                nlh->nlmsg_flags = NLM_F_REQUEST;
+                nlh->nlmsg_seq   = ++intfSeqNo;
+#ifdef IFLA_STATS_FILTER_BIT
+                if (msgtype == RTM_GETSTATS) {
+                        nlh->nlmsg_len    = NLMSG_LENGTH(sizeof(struct if_stats_msg));
+                        ifsm              = NLMSG_DATA(nlh);
+                        ifsm->family      = AF_UNSPEC;
+                        ifsm->ifindex     = (uint32_t) intfTable[i].ifIndex;
+                        ifsm->filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+                } else
+#endif
+                {
+                        nlh->nlmsg_len  = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+                        ifi             = NLMSG_DATA(nlh);
+                        ifi->ifi_family = AF_UNSPEC;
+                        ifi->ifi_index  = intfTable[i].ifIndex;
+                }
+                len += (int) NLMSG_ALIGN(nlh->nlmsg_len);
+                intfTable[i].sampled = FALSE;
+        }
+        if (send(repo.intfFD, req, (size_t) len, 0) < 0)
+                return -errno;
+
+        //
+        // Process replies until each request is answered or none remain queued
+        //
+        for (pending = intfCount; pending > 0;) {
+                if ((len = (int) recv(repo.intfFD, intfNlBuf, INTF_NLBUF_SIZE, MSG_DONTWAIT)) < 0) {
+                        if (errno == EINTR)
+                                continue;
+                        return -errno;
+                }
+                for (nlh = (struct nlmsghdr *) intfNlBuf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+                        if (nlh->nlmsg_seq < seqbase || nlh->nlmsg_seq > intfSeqNo)
+                                continue; // Reply to an earlier request
+                        pending--;
+                        if (nlh->nlmsg_type == NLMSG_ERROR) {
+                                error = ((struct nlmsgerr *) NLMSG_DATA(nlh))->error;
+                                continue;
+                        }
+                        //
+                        // Locate 64-bit link statistics attribute of local interface
+                        //
+#ifdef IFLA_STATS_FILTER_BIT
+                        if (nlh->nlmsg_type == RTM_NEWSTATS) {
+                                ifsm     = NLMSG_DATA(nlh);
+                                ifindex  = (int) ifsm->ifindex;
+                                rta      = (struct rtattr *) ((char *) ifsm + NLMSG_ALIGN(sizeof(struct if_stats_msg)));
+                                attrlen  = (int) nlh->nlmsg_len - (int) NLMSG_LENGTH(sizeof(struct if_stats_msg));
+                                attrtype = IFLA_STATS_LINK_64;
+                        } else
+#endif
+                        if (nlh->nlmsg_type == RTM_NEWLINK) {
+                                ifi      = NLMSG_DATA(nlh);
+                                ifindex  = ifi->ifi_index;
+                                rta      = IFLA_RTA(ifi);
+                                attrlen  = (int) IFLA_PAYLOAD(nlh);
+                                attrtype = IFLA_STATS64;
+                        } else {
+                                continue;
+                        }
+                        for (i = 0; i < intfCount; i++) {
+                                if (intfTable[i].ifIndex == ifindex)
+                                        break;
+                        }
+                        if (i == intfCount)
+                                continue;
+                        for (; RTA_OK(rta, attrlen); rta = RTA_NEXT(rta, attrlen)) {
+                                if (rta->rta_type != attrtype)
+                                        continue;
+                                memset(&stats, 0, sizeof(stats));
+                                memcpy(&stats, RTA_DATA(rta), RTA_PAYLOAD(rta) < sizeof(stats) ? RTA_PAYLOAD(rta) : sizeof(stats));
+                                intf_link(&intfTable[i], &stats, usec);
+                                break;
+                        }
+                }
+        }
+        return error;
+}
+//----------------------------------------------------------------------------
+//
+// Save link counters of interface, first obtaining rates if an interval is given
+//
+void intf_link(struct intfEntry *ie, struct rtnl_link_stats64 *stats, double usec) {
+
+        if (usec > 0.0) {
+                ie->mbps[INTF_TX]     = (_delta(stats->tx_bytes, ie->bytes[INTF_TX]) * 8.0) / usec;
+                ie->mbps[INTF_RX]     = (_delta(stats->rx_bytes, ie->bytes[INTF_RX]) * 8.0) / usec;
+                ie->dropRate[INTF_TX] = (_delta(stats->tx_dropped, ie->dropped[INTF_TX]) * USECINSEC) / usec;
+                ie->dropRate[INTF_RX] = (_delta(stats->rx_dropped, ie->dropped[INTF_RX]) * USECINSEC) / usec;
+        }
+        ie->bytes[INTF_TX]   = stats->tx_bytes;
+        ie->bytes[INTF_RX]   = stats->rx_bytes;
+        ie->packets[INTF_TX] = stats->tx_packets;
+        ie->packets[INTF_RX] = stats->rx_packets;
+        ie->dropped[INTF_TX] = stats->tx_dropped;
+        ie->dropped[INTF_RX] = stats->rx_dropped;
+        ie->sampled          = TRUE;
+}
+//----------------------------------------------------------------------------
+//
+// Map driver statistics of interface that are per-queue byte or drop counters
+//
+// Names such as "tx_queue_0_bytes" (ixgbe, virtio_net), "tx-0.bytes" (i40e) and "tx0_bytes" (mlx5)
+// are recognized, with drop counters ending in "drops" or "dropped" instead of "bytes". An
+// interface without any such counters is reported without queues.
+//
+void intf_queue_init(struct intfEntry *ie) {
+        int i, count, queue, dir, kind;
+        char *name;
+        struct ifreq ifr;
+        struct {
+                struct ethtool_sset_info hdr;
+                uint32_t data[1];
+        } sset;
+        struct ethtool_gstrings *strings;
+
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, ie->name, IFNAMSIZ - 1);
+
+        //
+        // Obtain statistics count and names
+        //
+        memset(&sset, 0, sizeof(sset));
+        sset.hdr.cmd       = ETHTOOL_GSSET_INFO;
+        sset.hdr.sset_mask = 1ULL << ETH_SS_STATS;
+        ifr.ifr_data       = (void *) &sset;
+        if (ioctl(intfEthFD, SIOCETHTOOL, &ifr) < 0 || sset.hdr.sset_mask == 0 || (count = (int) sset.data[0]) == 0)
+                return;
+        if ((strings = calloc(1, sizeof(struct ethtool_gstrings) + ((size_t) count * ETH_GSTRING_LEN))) == NULL)
+                return;
+        strings->cmd        = ETHTOOL_GSTRINGS;
+        strings->string_set = ETH_SS_STATS;
+        strings->len        = (uint32_t) count;
+        ifr.ifr_data        = (void *) strings;
+        if (ioctl(intfEthFD, SIOCETHTOOL, &ifr) < 0 || (ie->statMap = malloc((size_t) count * sizeof(int))) == NULL) {
+                free(strings);
+                return;
+        }
+
+        //
+        // Map names to queue, direction and counter kind (encoded as queue * 4 + dir * 2 + kind)
+        //
+        for (i = 0; i < count; i++) {
+                ie->statMap[i] = -1;
+                name           = (char *) &strings->data[i * ETH_GSTRING_LEN];
+                name[ETH_GSTRING_LEN - 1] = '\0';
+                if ((name[0] != 't' && name[0] != 'r') || name[1] != 'x')
+                        continue;
+                dir = (name[0] == 't') ? INTF_TX : INTF_RX;
+                name += 2;
+                if (strncmp(name, "_queue_", 7) == 0)
+                        name += 7;
+                else if (*name == '-' || *name == '_')
+                        name++;
+                if (!isdigit((unsigned char) *name))
+                        continue;
+                queue = (int) strtol(name, &name, 10);
+                if ((*name != '_' && *name != '.') || queue >= INTF_QUEUE_MAX)
+                        continue;
+                name++;
+                if (strcmp(name, "bytes") == 0)
+                        kind = 0;
+                else if (strcmp(name, "drops") == 0 || strcmp(name, "dropped") == 0)
+                        kind = 1;
+                else
+                        continue;
+                ie->statMap[i] = (queue * 4) + (dir * 2) + kind;
+                if (queue >= ie->queueCount)
+                        ie->queueCount = queue + 1;
+        }
+        free(strings);
+
+        //
+        // Allocate statistics buffer and queue table, then obtain initial counters
+        //
+        if (ie->queueCount > 0) {
+                ie->ethStats = calloc(1, sizeof(struct ethtool_stats) + ((size_t) count * sizeof(uint64_t)));
+                ie->queue    = calloc(INTF_QUEUE_MAX, sizeof(struct intfQueue));
+        }
+        if (ie->ethStats == NULL || ie->queue == NULL) {
+                ie->queueCount = 0;
+                return;
+        }
+        ie->statCount = count;
+        intf_queue_sample(ie, 0.0);
+}
+//----------------------------------------------------------------------------
+//
+// Obtain per-queue driver counters of interface, first obtaining rates if an interval is given
+//
+void intf_queue_sample(struct intfEntry *ie, double usec) {
+        int i, q, var;
+        unsigned long long cur[INTF_QUEUE_MAX][4];
+        struct intfQueue *iq;
+        struct ifreq ifr;
+
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, ie->name, IFNAMSIZ - 1);
+        ie->ethStats->cmd     = ETHTOOL_GSTATS;
+        ie->ethStats->n_stats = (uint32_t) ie->statCount;
+        ifr.ifr_data          = (void *) ie->ethStats;
+        if (ioctl(intfEthFD, SIOCETHTOOL, &ifr) < 0)
+                return;
+
+        //
+        // Sum mapped counters of each queue (a driver may split them, e.g. per ring and per XDP ring)
+        //
+        memset(cur, 0, sizeof(cur));
+        for (i = 0; i < ie->statCount; i++) {
+                if ((var = ie->statMap[i]) >= 0)
+                        cur[var / 4][var % 4] += ie->ethStats->data[i];
+        }
+        for (q = 0; q < ie->queueCount; q++) {
+                iq = &ie->queue[q];
+                for (i = 0; i < 2; i++) {
+                        if (usec > 0.0) {
+                                iq->mbps[i]     = (_delta(cur[q][i * 2], iq->bytes[i]) * 8.0) / usec;
+                                iq->dropRate[i] = (_delta(cur[q][(i * 2) + 1], iq->drops[i]) * USECINSEC) / usec;
+                        }
+                        iq->bytes[i] = cur[q][i * 2];
+                        iq->drops[i] = cur[q][(i * 2) + 1];
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Output array of interface (and queue) rates into sub-interval object
+//
+void intf_json(struct jsonWriter *w) {
+        int i, q;
+        struct intfEntry *ie;
+
+        jsonw_array(w, "Interfaces");
+        for (i = 0; i < intfCount; i++) {
+                ie = &intfTable[i];
+                jsonw_element(w);
+                jsonw_string(w, "Name", ie->name);
+                jsonw_number(w, "TxMbps", ie->mbps[INTF_TX], 2);
+                jsonw_number(w, "RxMbps", ie->mbps[INTF_RX], 2);
+                jsonw_number(w, "TxDropRate", ie->dropRate[INTF_TX], 2);
+                jsonw_number(w, "RxDropRate", ie->dropRate[INTF_RX], 2);
+                if (ie->queueCount > 0) {
+                        jsonw_array(w, "Queues");
+                        for (q = 0; q < ie->queueCount; q++) {
+                                jsonw_element(w);
+                                jsonw_number(w, "Queue", q, 0);
+                                jsonw_number(w, "TxMbps", ie->queue[q].mbps[INTF_TX], 2);
+                                jsonw_number(w, "RxMbps", ie->queue[q].mbps[INTF_RX], 2);
+                                jsonw_number(w, "TxDropRate", ie->queue[q].dropRate[INTF_TX], 2);
+                                jsonw_number(w, "RxDropRate", ie->queue[q].dropRate[INTF_RX], 2);
+                                jsonw_end(w);
+                        }
+                        jsonw_array_end(w);
+                }
+                jsonw_end(w);
+        }
+        jsonw_array_end(w);
+}
+//----------------------------------------------------------------------------
+//
+// Close sockets and release interface resources
+//
+void intf_close(void) {
+        int i;
+
+        for (i = 0; i < intfCount; i++) {
+                free(intfTable[i].statMap);
+                free(intfTable[i].ethStats);
+                free(intfTable[i].queue);
+        }
+        intfCount = 0;
+        if (intfEthFD >= 0) {
+                close(intfEthFD);
+                intfEthFD = -1;
+        }
+        if (repo.intfFD >= 0) {
+                close(repo.intfFD);
+                repo.intfFD = -1;
+        }
+        free(intfNlBuf);
+        intfNlBuf = NULL;
+}
+#else
+//----------------------------------------------------------------------------
+//
+// Local interface statistics unavailable without netlink support
+//
+int intf_open(void) {
+        return sprintf(scratch, "ERROR: Local interface statistics not supported\n");
+}
+void intf_update(BOOL initialize) {
+        return;
+}
+void intf_json(struct jsonWriter *w) {
+        return;
+}
+void intf_close(void) {
+        return;
+}
+#endif // __linux__
+//----------------------------------------------------------------------------
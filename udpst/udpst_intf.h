@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_intf.h
+ *
+ * This file contains the local interface statistics structures as well as
+ * the external function prototypes of the netlink sampler.
+ *
+ */
+
+#ifndef UDPST_INTF_H
+#define UDPST_INTF_H
+
+//----------------------------------------------------------------------------
+//
+// Local interface statistics
+//
+// The 64-bit link counters of every interface in the list are obtained with a
+// batch of netlink statistics requests, one per interface index (RTM_GETSTATS,
+// or RTM_GETLINK on kernels that predate it), on the sub-interval cadence. When the option value is prefixed
+// with INTF_QUEUE_PREFIX, the per-queue byte and drop counters exposed by the
+// driver are also obtained via ethtool.
+//
+#define INTF_QUEUE_MAX  32    // Maximum queues reported per interface
+#define INTF_NLBUF_SIZE 32768 // Netlink receive buffer size
+struct intfQueue {
+        unsigned long long bytes[2]; // Byte counters (tx, rx)
+        unsigned long long drops[2]; // Drop counters (tx, rx)
+        double mbps[2];              // Rates (tx, rx)
+        double dropRate[2];          // Drop rates per second (tx, rx)
+};
+struct intfEntry {
+        char name[IFNAMSIZ];            // Interface name
+        int ifIndex;                    // Interface index
+        BOOL sampled;                   // Counters obtained by last sample
+        unsigned long long bytes[2];    // Byte counters (tx, rx)
+        unsigned long long packets[2];  // Packet counters (tx, rx)
+        unsigned long long dropped[2];  // Dropped packet counters (tx, rx)
+        double mbps[2];                 // Rates (tx, rx)
+        double dropRate[2];             // Drop rates per second (tx, rx)
+        int statCount;                  // Driver (ethtool) statistics count
+        int *statMap;                   // Queue mapping of each driver statistic (-1 = none)
+        struct ethtool_stats *ethStats; // Driver statistics buffer
+        int queueCount;                 // Queues with mapped statistics
+        struct intfQueue *queue;        // Per-queue statistics (INTF_QUEUE_MAX)
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int intf_open(void);
+extern void intf_update(BOOL);
+extern void intf_json(struct jsonWriter *);
+extern void intf_close(void);
+
+#endif /* UDPST_INTF_H */
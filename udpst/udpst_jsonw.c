@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_jsonw.c
+ *
+ * This file provides a streaming JSON writer for client results. Objects are
+ * serialized without allocation into a caller supplied buffer, using the same
+ * layout and number formatting as cJSON, so that spooled output can be spliced
+ * into a document printed by cJSON without altering a single byte.
+ *
+ */
+
+#define UDPST_JSONW
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_jsonw.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void jsonw_key(struct jsonWriter *, const char *);
+int jsonw_format_number(char *, double, int);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern char scratch[STRING_SIZE];
+extern struct configuration conf;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static FILE *jwSpool; // Spool file of serialized array elements
+static int jwCount;   // Spooled element count
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Initialize writer for output into buffer at depth of enclosing container
+//
+void jsonw_init(struct jsonWriter *w, char *buf, int size, int depth, BOOL format) {
+
+        w->buf      = buf;
+        w->size     = size;
+        w->len      = 0;
+        w->depth    = depth;
+        w->items    = 0;
+        w->nest     = 0;
+        w->format   = format;
+        w->overflow = FALSE;
+        *buf        = '\0';
+}
+//----------------------------------------------------------------------------
+//
+// Append text to output buffer, flagging overflow instead of truncating
+//
+void jsonw_append(struct jsonWriter *w, const char *text, int len) {
+
+        if (w->overflow || w->len + len >= w->size) {
+                w->overflow = TRUE;
+                return;
+        }
+        memcpy(&w->buf[w->len], text, len);
+        w->len += len;
+        w->buf[w->len] = '\0';
+}
+//----------------------------------------------------------------------------
+//
+// Save item count of enclosing container when entering a nested one, and restore it when leaving
+//
+static void _enter(struct jsonWriter *w) {
+
+        if (w->nest >= JSONW_NEST_MAX) {
+                w->overflow = TRUE;
+                return;
+        }
+        w->outer[w->nest++] = w->items;
+        w->items            = 0;
+        w->depth++;
+}
+static void _leave(struct jsonWriter *w) {
+
+        if (w->nest > 0)
+                w->items = w->outer[--w->nest];
+        w->depth--;
+}
+//----------------------------------------------------------------------------
+//
+// Begin and end object (the formatted layout matches print_object() of cJSON)
+//
+void jsonw_begin(struct jsonWriter *w) {
+
+        jsonw_append(w, "{", 1);
+        _enter(w);
+}
+void jsonw_end(struct jsonWriter *w) {
+        int i;
+
+        if (w->format) {
+                jsonw_append(w, "\n", 1);
+                for (i = 0; i < w->depth - 1; i++)
+                        jsonw_append(w, "\t", 1);
+        }
+        jsonw_append(w, "}", 1);
+        _leave(w);
+}
+//----------------------------------------------------------------------------
+//
+// Begin array item and end it (the layout matches print_array() of cJSON, which keeps elements on one line)
+//
+void jsonw_array(struct jsonWriter *w, const char *name) {
+
+        jsonw_key(w, name);
+        jsonw_append(w, "[", 1);
+        _enter(w);
+}
+void jsonw_array_end(struct jsonWriter *w) {
+
+        jsonw_append(w, "]", 1);
+        _leave(w);
+}
+//----------------------------------------------------------------------------
+//
+// Begin object as next array element (ended by jsonw_end)
+//
+void jsonw_element(struct jsonWriter *w) {
+
+        if (w->items++ > 0) {
+                if (w->format)
+                        jsonw_append(w, ", ", 2);
+                else
+                        jsonw_append(w, ",", 1);
+        }
+        jsonw_begin(w);
+}
+//----------------------------------------------------------------------------
+//
+// Output separator and quoted key of next object item
+//
+// NOTE: Keys are literals that never require escaping
+//
+void jsonw_key(struct jsonWriter *w, const char *name) {
+        int i;
+
+        if (w->items++ > 0)
+                jsonw_append(w, ",", 1);
+        if (w->format) {
+                jsonw_append(w, "\n", 1);
+                for (i = 0; i < w->depth; i++)
+                        jsonw_append(w, "\t", 1);
+        }
+        jsonw_append(w, "\"", 1);
+        jsonw_append(w, name, strlen(name));
+        if (w->format)
+                jsonw_append(w, "\":\t", 3);
+        else
+                jsonw_append(w, "\":", 2);
+}
+//----------------------------------------------------------------------------
+//
+// Output number item, where a non-zero precision has the meaning given to it by cJSON_AddNumberPToObject()
+//
+void jsonw_number(struct jsonWriter *w, const char *name, double number, int precision) {
+        char numbuf[64];
+
+        jsonw_key(w, name);
+        jsonw_append(w, numbuf, jsonw_format_number(numbuf, number, precision));
+}
+//----------------------------------------------------------------------------
+//
+// Output string item, escaped as print_string_ptr() of cJSON does
+//
+void jsonw_string(struct jsonWriter *w, const char *name, const char *string) {
+        const unsigned char *ptr;
+        char escbuf[8];
+
+        jsonw_key(w, name);
+        jsonw_append(w, "\"", 1);
+        for (ptr = (const unsigned char *) string; *ptr != '\0'; ptr++) {
+                if (*ptr > 31 && *ptr != '\"' && *ptr != '\\') {
+                        jsonw_append(w, (const char *) ptr, 1);
+                        continue;
+                }
+                switch (*ptr) {
+                case '\\':
+                        jsonw_append(w, "\\\\", 2);
+                        break;
+                case '\"':
+                        jsonw_append(w, "\\\"", 2);
+                        break;
+                case '\b':
+                        jsonw_append(w, "\\b", 2);
+                        break;
+                case '\f':
+                        jsonw_append(w, "\\f", 2);
+                        break;
+                case '\n':
+                        jsonw_append(w, "\\n", 2);
+                        break;
+                case '\r':
+                        jsonw_append(w, "\\r", 2);
+                        break;
+                case '\t':
+                        jsonw_append(w, "\\t", 2);
+                        break;
+                default:
+                        jsonw_append(w, escbuf, sprintf(escbuf, "\\u%04x", *ptr));
+                        break;
+                }
+        }
+        jsonw_append(w, "\"", 1);
+}
+//----------------------------------------------------------------------------
+//
+// Format number exactly as print_number() of cJSON would, and return length
+//
+// Integral values (counters) and fixed-point values not near a rounding tie are converted directly, everything
+// else falls back to the printf conversion cJSON itself uses. Precision 0 selects the default cJSON conversion,
+// a positive precision is the number of decimal places, and a negative precision is the number of significant
+// digits (with a decimal point always present). Zero is always output as 0.0 when a precision is given.
+//
+int jsonw_format_number(char *numbuf, double number, int precision) {
+        static const double scale[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+        unsigned long long ullvar;
+        double dvar, test;
+        char digits[24], *ptr;
+        int i, len;
+
+        if (isnan(number) || isinf(number))
+                return sprintf(numbuf, "null");
+
+        if (precision == 0) {
+                if (number == floor(number) && fabs(number) < 1e15) {
+                        ptr    = &digits[sizeof(digits)];
+                        ullvar = (unsigned long long) fabs(number);
+                        do {
+                                *--ptr = '0' + (char) (ullvar % 10);
+                                ullvar /= 10;
+                        } while (ullvar > 0);
+                        len = 0;
+                        if (signbit(number))
+                                numbuf[len++] = '-';
+                        memcpy(&numbuf[len], ptr, &digits[sizeof(digits)] - ptr);
+                        len += (int) (&digits[sizeof(digits)] - ptr);
+                        numbuf[len] = '\0';
+                        return len;
+                }
+                len = sprintf(numbuf, "%1.15g", number);
+                if (sscanf(numbuf, "%lg", &test) != 1 ||
+                    fabs(test - number) > fmax(fabs(test), fabs(number)) * DBL_EPSILON) {
+                        len = sprintf(numbuf, "%1.17g", number);
+                }
+                return len;
+        }
+        if (number == 0.0)
+                return sprintf(numbuf, "%s", signbit(number) ? "-0.0" : "0.0");
+
+        if (precision > 0) {
+                //
+                // Scaled value must be well within double precision and clear of a rounding tie, where the product
+                // could round differently than the exact decimal conversion done by printf
+                //
+                if (precision < (int) (sizeof(scale) / sizeof(scale[0]))) {
+                        dvar = fabs(number) * scale[precision];
+                        if (dvar < 1e13 && fabs(dvar - floor(dvar) - 0.5) > 0.01) {
+                                ullvar = (unsigned long long) llround(dvar);
+                                ptr    = &digits[sizeof(digits)];
+                                for (i = 0; i < precision || ullvar > 0 || i == precision; i++) {
+                                        if (i == precision)
+                                                *--ptr = '.';
+                                        *--ptr = '0' + (char) (ullvar % 10);
+                                        ullvar /= 10;
+                                }
+                                len = 0;
+                                if (signbit(number))
+                                        numbuf[len++] = '-';
+                                memcpy(&numbuf[len], ptr, &digits[sizeof(digits)] - ptr);
+                                len += (int) (&digits[sizeof(digits)] - ptr);
+                                numbuf[len] = '\0';
+                                return len;
+                        }
+                }
+                return sprintf(numbuf, "%.*f", precision, number);
+        }
+        len = sprintf(numbuf, "%.*g", -precision, number);
+        if (strchr(numbuf, '.') == NULL)
+                len = sprintf(numbuf, "%.1f", number);
+        return len;
+}
+//----------------------------------------------------------------------------
+//
+// Append serialized object to spool as next array element
+//
+// Populate scratch buffer and return length on error
+//
+int jsonw_spool(struct jsonWriter *w) {
+        const char *sep;
+
+        if (w->overflow) {
+                return sprintf(scratch, "ERROR: JSON object exceeds writer buffer (%d bytes)\n", w->size);
+        }
+        if (jwSpool == NULL) {
+                if ((jwSpool = tmpfile()) == NULL) {
+                        return sprintf(scratch, "TMPFILE ERROR: %s\n", strerror(errno));
+                }
+                jwCount = 0;
+        }
+        if (jwCount == 0)
+                sep = "[";
+        else if (w->format)
+                sep = ", ";
+        else
+                sep = ",";
+        if (fputs(sep, jwSpool) < 0 || fwrite(w->buf, 1, w->len, jwSpool) != (size_t) w->len) {
+                return sprintf(scratch, "FWRITE ERROR: %s\n", strerror(errno));
+        }
+        jwCount++;
+
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Return spooled element count
+//
+int jsonw_spool_count(void) {
+
+        return jwCount;
+}
+//----------------------------------------------------------------------------
+//
+// Send spooled array to connection and release spool
+//
+void jsonw_spool_send(int connindex) {
+        char buf[JSONW_BUF_SIZE * 8];
+        size_t var;
+
+        if (jwSpool == NULL)
+                return;
+        fflush(jwSpool);
+        rewind(jwSpool);
+        while ((var = fread(buf, 1, sizeof(buf), jwSpool)) > 0) {
+                send_proc(connindex, buf, (int) var);
+        }
+        send_proc(connindex, "]", 1);
+        fclose(jwSpool);
+        jwSpool = NULL;
+        jwCount = 0;
+}
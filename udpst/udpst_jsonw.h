@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_jsonw.h
+ *
+ * This file contains constants, structures, and external function prototypes
+ * for the associated module.
+ *
+ */
+
+#ifndef UDPST_JSONW_H
+#define UDPST_JSONW_H
+
+//----------------------------------------------------------------------------
+//
+// Streaming JSON writer
+//
+// Sub-interval results are serialized into a fixed buffer as they are produced,
+// with the same layout and number formatting cJSON would use at the same depth,
+// and appended to a spool file. The final document is printed by cJSON with a
+// raw placeholder that is replaced by the spool contents when output. Memory use
+// is therefore bounded by the buffer size, but the document is still only output
+// at the end of the test (see jsonStream for live NDJSON output).
+//
+#define JSONW_BUF_SIZE 24576  // Serialization buffer size (single object)
+#define JSONW_SI_DEPTH 3      // Depth of sub-interval objects within document
+#define JSONW_SPLICE   "\001" // Raw placeholder for spooled array in document
+#define JSONW_NEST_MAX 8      // Maximum nested objects and arrays
+
+struct jsonWriter {
+        char *buf;                 // Output buffer
+        int size;                  // Output buffer size
+        int len;                   // Output length
+        int depth;                 // Depth of enclosing container
+        int items;                 // Item count of current object or array
+        int nest;                  // Nesting level of objects and arrays
+        int outer[JSONW_NEST_MAX]; // Item counts of enclosing objects and arrays
+        BOOL format;               // Formatted (indented) output
+        BOOL overflow;             // Output buffer too small
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern void jsonw_init(struct jsonWriter *, char *, int, int, BOOL);
+extern void jsonw_begin(struct jsonWriter *);
+extern void jsonw_end(struct jsonWriter *);
+extern void jsonw_array(struct jsonWriter *, const char *);
+extern void jsonw_array_end(struct jsonWriter *);
+extern void jsonw_element(struct jsonWriter *);
+extern void jsonw_append(struct jsonWriter *, const char *, int);
+extern void jsonw_number(struct jsonWriter *, const char *, double, int);
+extern void jsonw_string(struct jsonWriter *, const char *, const char *);
+extern int jsonw_spool(struct jsonWriter *);
+extern int jsonw_spool_count(void);
+extern void jsonw_spool_send(int);
+
+#endif /* UDPST_JSONW_H */
@@ -0,0 +1,655 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_metrics.c
+ *
+ * This file provides the server metrics endpoint, which exposes performance
+ * statistics counters, the maximums and averages of the last statistics
+ * record, and per-test gauges (plus optional per-connection counters) in
+ * OpenMetrics text format.
+ *
+ */
+
+#define UDPST_METRICS
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_control.h"
+#include "udpst_data.h"
+#include "udpst_srates.h"
+#include "udpst_metrics.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+int metrics_accept(int);
+int metrics_request(int);
+int metrics_send(int);
+int metrics_timeout(int);
+int metrics_render(char *, int);
+int mx_printf(char *, int, int, const char *, ...);
+double mx_field(const void *, size_t, size_t);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern int errConn, monConn;
+extern char scratch[STRING_SIZE];
+extern struct configuration conf;
+extern struct repository repo;
+extern struct connection *conn;
+
+//----------------------------------------------------------------------------
+//
+// Metric family templates
+//
+// The text of each template is the preformatted TYPE and HELP lines of the family followed by the sample name, so
+// that rendering a fixed family is a single copy plus its value. Counters are cumulative since process start, while
+// maximums and averages are those of the last performance statistics record (as written to the '-G' file).
+//
+#define MX_VALUE 0 // Value of field
+#define MX_MBPS  1 // Byte field as Mbps over record interval
+#define MX_RATE  2 // Count field per second over record interval
+#define MX_RATIO 3 // Field divided by second field
+struct mxTemplate {
+        const char *text; // TYPE/HELP lines and sample name
+        size_t offset;    // Offset of value field
+        size_t size;      // Size of value field
+        size_t offset2;   // Offset of divisor field (ratio)
+        int kind;         // Value kind
+};
+#define MX_FSIZE(type, field) sizeof(((struct type *) 0)->field)
+#define MX_COUNTER(name, help, field)                                                                                  \
+        { "# TYPE udpst_" name " counter\n# HELP udpst_" name " " help "\nudpst_" name "_total ",                     \
+          offsetof(struct perfStatsCounters, field), MX_FSIZE(perfStatsCounters, field), 0, MX_VALUE }
+#define MX_MAXIMUM(name, help, field)                                                                                  \
+        { "# TYPE udpst_maximum_" name " gauge\n# HELP udpst_maximum_" name " " help "\nudpst_maximum_" name " ",       \
+          offsetof(struct perfStatsMaximums, field), MX_FSIZE(perfStatsMaximums, field), 0, MX_VALUE }
+#define MX_AVERAGE(name, help, field, field2, kind)                                                                    \
+        { "# TYPE udpst_average_" name " gauge\n# HELP udpst_average_" name " " help "\nudpst_average_" name " ",       \
+          offsetof(struct perfStatsAverages, field), MX_FSIZE(perfStatsAverages, field),                               \
+          offsetof(struct perfStatsAverages, field2), kind }
+static const struct mxTemplate mxCounters[] = {
+        MX_COUNTER("setup_requests_received", "Setup requests received.", setupRequestCnt),
+        MX_COUNTER("setup_accepts_sent", "Setup accepts sent.", setupAcceptCnt),
+        MX_COUNTER("setup_rejects_sent", "Setup rejects sent.", setupRejectCnt),
+        MX_COUNTER("setup_invalid_protocol_ver", "Setup requests with invalid protocol version.", invalidProtocolVer),
+        MX_COUNTER("setup_invalid_setup_option", "Setup requests with invalid option.", invalidSetupOption),
+        MX_COUNTER("setup_bandwidth_exceeded", "Setup requests exceeding available bandwidth.", bandwidthExceeded),
+        MX_COUNTER("setup_connection_create_fail", "Test connection creation failures.", connCreateFail),
+        MX_COUNTER("setup_legacy_protocol_ver", "Setup requests with legacy protocol version.", legacyProtocolVer),
+        MX_COUNTER("activation_timeout_waiting", "Timeouts awaiting test activation.", timeoutAwaitingAct),
+        MX_COUNTER("activation_requests_received", "Test activation requests received.", actRequestCnt),
+        MX_COUNTER("activation_accepts_sent", "Test activation accepts sent.", actAcceptCnt),
+        MX_COUNTER("activation_rejects_sent", "Test activation rejects sent.", actRejectCnt),
+        MX_COUNTER("activation_bad_parameter", "Test activation requests with bad parameter.", badActParameter),
+        MX_COUNTER("control_invalid_size", "Control messages with invalid size.", ctrlInvalidSize),
+        MX_COUNTER("control_invalid_format", "Control messages with invalid format.", ctrlInvalidFormat),
+        MX_COUNTER("control_invalid_checksum", "Control messages with invalid checksum.", ctrlInvalidChksum),
+        MX_COUNTER("control_auth_failure", "Control messages failing authentication.", ctrlAuthFailure),
+        MX_COUNTER("control_bad_auth_time", "Control messages with bad authentication time.", ctrlBadAuthTime),
+        MX_COUNTER("data_load_invalid_size", "Load messages with invalid size.", loadInvalidSize),
+        MX_COUNTER("data_load_invalid_format", "Load messages with invalid format.", loadInvalidFormat),
+        MX_COUNTER("data_load_invalid_checksum", "Load messages with invalid checksum.", loadInvalidChksum),
+        MX_COUNTER("data_status_invalid_size", "Status messages with invalid size.", statusInvalidSize),
+        MX_COUNTER("data_status_invalid_format", "Status messages with invalid format.", statusInvalidFormat),
+        MX_COUNTER("data_status_invalid_checksum", "Status messages with invalid checksum.", statusInvalidChksum)};
+static const struct mxTemplate mxMaximums[] = {
+        MX_MAXIMUM("allocated_connection_count", "Connections allocated.", connCount),
+        MX_MAXIMUM("allocated_downstream_bandwidth", "Downstream bandwidth allocated (Mbps).", dsBandwidth),
+        MX_MAXIMUM("allocated_upstream_bandwidth", "Upstream bandwidth allocated (Mbps).", usBandwidth),
+        MX_MAXIMUM("system_tx_overrun_size", "Queued transmit overrun size.", txOverrunSize),
+        MX_MAXIMUM("system_tx_burst_size", "Transmit burst size.", txBurstSize),
+        MX_MAXIMUM("system_rx_burst_size", "Receive burst size.", rxBurstSize),
+        MX_MAXIMUM("system_fd_ready_size", "Ready file descriptors per wait.", fdReadySize),
+        MX_MAXIMUM("system_timer_coalesce_size", "Coalesced timer expirations.", timCoalesceSize)};
+static const struct mxTemplate mxAverages[] = {
+        MX_AVERAGE("queued_tx_ip_rate_mbps", "Queued transmit IP rate (Mbps).", qdBytes, qdBytes, MX_MBPS),
+        MX_AVERAGE("queued_tx_datagram_rate", "Queued transmit datagrams per second.", qdDatagrams, qdDatagrams, MX_RATE),
+        MX_AVERAGE("delivered_tx_ip_rate_mbps", "Delivered transmit IP rate (Mbps).", txBytes, txBytes, MX_MBPS),
+        MX_AVERAGE("delivered_tx_datagram_rate", "Delivered transmit datagrams per second.", txDatagrams, txDatagrams,
+                   MX_RATE),
+        MX_AVERAGE("delivered_tx_loss_rate", "Transmit loss per second.", txSeqErrLoss, txSeqErrLoss, MX_RATE),
+        MX_AVERAGE("delivered_tx_ooo_dup_rate", "Transmit out-of-order and duplicates per second.", txSeqErrOooDup,
+                   txSeqErrOooDup, MX_RATE),
+        MX_AVERAGE("delivered_rx_ip_rate_mbps", "Delivered receive IP rate (Mbps).", rxBytes, rxBytes, MX_MBPS),
+        MX_AVERAGE("delivered_rx_datagram_rate", "Delivered receive datagrams per second.", rxDatagrams, rxDatagrams,
+                   MX_RATE),
+        MX_AVERAGE("delivered_rx_loss_rate", "Receive loss per second.", rxSeqErrLoss, rxSeqErrLoss, MX_RATE),
+        MX_AVERAGE("delivered_rx_ooo_dup_rate", "Receive out-of-order and duplicates per second.", rxSeqErrOooDup,
+                   rxSeqErrOooDup, MX_RATE),
+        MX_AVERAGE("system_tx_overrun_rate", "Queued transmit overruns per second.", txOverrunCount, txOverrunCount,
+                   MX_RATE),
+        MX_AVERAGE("system_tx_overrun_size", "Queued transmit overrun size.", txOverrunTotal, txOverrunCount, MX_RATIO),
+        MX_AVERAGE("system_tx_burst_rate", "Transmit bursts per second.", txBurstCount, txBurstCount, MX_RATE),
+        MX_AVERAGE("system_tx_burst_size", "Transmit burst size.", txBurstTotal, txBurstCount, MX_RATIO),
+        MX_AVERAGE("system_rx_burst_rate", "Receive bursts per second.", rxBurstCount, rxBurstCount, MX_RATE),
+        MX_AVERAGE("system_rx_burst_size", "Receive burst size.", rxBurstTotal, rxBurstCount, MX_RATIO),
+        MX_AVERAGE("system_fd_ready_rate", "File descriptor ready indications per second.", fdReadyCount, fdReadyCount,
+                   MX_RATE),
+        MX_AVERAGE("system_fd_ready_size", "Ready file descriptors per wait.", fdReadyTotal, fdReadyCount, MX_RATIO),
+        MX_AVERAGE("system_timer_coalesce_rate", "Timer coalesce indications per second.", timCoalesceCount,
+                   timCoalesceCount, MX_RATE),
+        MX_AVERAGE("system_timer_coalesce_size", "Coalesced timer expirations.", timCoalesceTotal, timCoalesceCount,
+                   MX_RATIO),
+        MX_AVERAGE("status_tx_message_rate", "Status messages transmitted per second.", txStatusMsgs, txStatusMsgs,
+                   MX_RATE),
+        MX_AVERAGE("status_rx_message_rate", "Status messages received per second.", rxStatusMsgs, rxStatusMsgs,
+                   MX_RATE),
+        MX_AVERAGE("status_loc_message_loss_rate", "Local status messages lost per second.", locStatusLoss,
+                   locStatusLoss, MX_RATE),
+        MX_AVERAGE("status_rem_message_loss_rate", "Remote status messages lost per second.", remStatusLoss,
+                   remStatusLoss, MX_RATE),
+        MX_AVERAGE("status_loc_traffic_stop_rate", "Local traffic stop indications per second.", locTrafficStop,
+                   locTrafficStop, MX_RATE),
+        MX_AVERAGE("status_rem_traffic_stop_rate", "Remote traffic stop indications per second.", remTrafficStop,
+                   remTrafficStop, MX_RATE),
+        MX_AVERAGE("locality_rx_cpu_sample_count", "Incoming CPU samples.", rxCpuSamples, rxCpuSamples, MX_VALUE),
+        MX_AVERAGE("locality_rx_cpu_local_ratio", "Ratio of incoming CPU samples local to process.", rxCpuLocal,
+                   rxCpuSamples, MX_RATIO)};
+#define MX_COUNT(array) ((int) (sizeof(array) / sizeof(array[0])))
+//
+// Per-test gauge families (one sample per active test connection)
+//
+#define MX_TEST_SRINDEX 0
+#define MX_TEST_SRMBPS  1
+#define MX_TEST_RXDG    2
+#define MX_TEST_LOSS    3
+#define MX_TEST_DVMAX   4
+#define MX_TEST_RTTMIN  5
+#define MX_TEST_MAX     6
+// Per-test families carry one labeled sample per test connection
+struct mxTest {
+        const char *family; // TYPE and HELP lines
+        const char *sample; // Sample name
+};
+static const struct mxTest mxTests[MX_TEST_MAX] = {
+        {"# TYPE udpst_test_sending_rate_index gauge\n# HELP udpst_test_sending_rate_index Sending rate index.\n",
+         "udpst_test_sending_rate_index"},
+        {"# TYPE udpst_test_sending_rate_mbps gauge\n# HELP udpst_test_sending_rate_mbps Nominal sending rate (Mbps).\n",
+         "udpst_test_sending_rate_mbps"},
+        {"# TYPE udpst_test_subinterval_rx_datagrams gauge\n"
+         "# HELP udpst_test_subinterval_rx_datagrams Datagrams received in last sub-interval.\n",
+         "udpst_test_subinterval_rx_datagrams"},
+        {"# TYPE udpst_test_subinterval_loss gauge\n# HELP udpst_test_subinterval_loss Datagrams lost in last sub-interval.\n",
+         "udpst_test_subinterval_loss"},
+        {"# TYPE udpst_test_delay_variation_max_seconds gauge\n"
+         "# HELP udpst_test_delay_variation_max_seconds Maximum delay variation of last sub-interval.\n",
+         "udpst_test_delay_variation_max_seconds"},
+        {"# TYPE udpst_test_rtt_minimum_seconds gauge\n# HELP udpst_test_rtt_minimum_seconds Minimum round-trip time.\n",
+         "udpst_test_rtt_minimum_seconds"}};
+//
+// Per-connection counter families (enabled by '+' prefix of '-G'/'-J'), cumulative since the test connection started
+//
+struct mxConn {
+        const char *family; // TYPE and HELP lines
+        const char *sample; // Sample name
+        size_t offset;      // Offset of value field
+        size_t size;        // Size of value field
+        double scale;       // Multiplier of value field
+};
+#define MX_CONN(name, help, field, scale)                                                                              \
+        { "# TYPE udpst_conn_" name " counter\n# HELP udpst_conn_" name " " help "\n", "udpst_conn_" name "_total",     \
+          offsetof(struct perfStatsConn, field), MX_FSIZE(perfStatsConn, field), scale }
+static const struct mxConn mxConns[] = {
+        MX_CONN("queued_tx_bytes", "IP bytes queued for transmit.", qdBytes, 1.0),
+        MX_CONN("queued_tx_datagrams", "Datagrams queued for transmit.", qdDatagrams, 1.0),
+        MX_CONN("tx_bytes", "IP bytes transmitted (and delivered).", txBytes, 1.0),
+        MX_CONN("tx_datagrams", "Datagrams transmitted (and delivered).", txDatagrams, 1.0),
+        MX_CONN("rx_bytes", "IP bytes received.", rxBytes, 1.0),
+        MX_CONN("rx_datagrams", "Datagrams received.", rxDatagrams, 1.0),
+        MX_CONN("tx_overruns", "Transmit overrun indications.", txOverrunCount, 1.0),
+        MX_CONN("tx_overrun_datagrams", "Datagrams not accepted by transmit.", txOverrunTotal, 1.0),
+        MX_CONN("tx_bursts", "Transmit bursts.", txBurstCount, 1.0),
+        MX_CONN("tx_burst_datagrams", "Datagrams transmitted in bursts.", txBurstTotal, 1.0),
+        MX_CONN("rx_bursts", "Receive bursts.", rxBurstCount, 1.0),
+        MX_CONN("rx_burst_datagrams", "Datagrams received in bursts.", rxBurstTotal, 1.0),
+        MX_CONN("loc_status_loss", "Local status messages lost.", locStatusLoss, 1.0),
+        MX_CONN("rem_status_loss", "Remote status messages lost.", remStatusLoss, 1.0),
+        MX_CONN("loc_traffic_stops", "Local traffic stop indications.", locTrafficStop, 1.0),
+        MX_CONN("rem_traffic_stops", "Remote traffic stop indications.", remTrafficStop, 1.0),
+        MX_CONN("busy_seconds", "Event processing time of connection.", busyTime, 1.0 / NSECINSEC)};
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static struct perfStatsMaximums mxMax; // Maximums of last statistics record
+static struct perfStatsAverages mxAvg; // Averages of last statistics record
+static double mxDelta;                 // Interval of last statistics record (ms, 0 = none yet)
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Create listening socket of metrics endpoint and add it to connection table
+//
+// Populate scratch buffer and return length on error
+//
+int metrics_init(void) {
+        int i, fd, var, port;
+        char host[INET6_ADDR_STRLEN], *ptr;
+        struct sockaddr_storage sas;
+        struct sockaddr_in *sin  = (struct sockaddr_in *) &sas;
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &sas;
+        struct sockaddr_un *sun  = (struct sockaddr_un *) &sas;
+        struct stat statbuf;
+        socklen_t saslen;
+
+        //
+        // Endpoint is either a UNIX socket path or [host:]port
+        //
+        memset(&sas, 0, sizeof(sas));
+        if (*conf.metricsAddr == '/') {
+                if (strlen(conf.metricsAddr) >= sizeof(sun->sun_path)) {
+                        return sprintf(scratch, "ERROR: Metrics endpoint path exceeds maximum length\n");
+                }
+                sun->sun_family = AF_UNIX;
+                strcpy(sun->sun_path, conf.metricsAddr);
+                saslen = sizeof(struct sockaddr_un);
+                //
+                // Remove stale socket left by a prior instance
+                //
+                if (lstat(sun->sun_path, &statbuf) == 0 && S_ISSOCK(statbuf.st_mode))
+                        unlink(sun->sun_path);
+        } else {
+                strcpy(host, METRICS_DEF_HOST);
+                if ((ptr = strrchr(conf.metricsAddr, ':')) != NULL) {
+                        var = (int) (ptr - conf.metricsAddr);
+                        if (*conf.metricsAddr == '[' && var > 1 && ptr[-1] == ']')
+                                snprintf(host, sizeof(host), "%.*s", var - 2, conf.metricsAddr + 1);
+                        else
+                                snprintf(host, sizeof(host), "%.*s", var, conf.metricsAddr);
+                        ptr++;
+                } else {
+                        ptr = conf.metricsAddr;
+                }
+                port = atoi(ptr);
+                if (port < 1 || port > 65535) {
+                        return sprintf(scratch, "ERROR: Invalid metrics endpoint port '%s'\n", ptr);
+                }
+                if (inet_pton(AF_INET, host, &sin->sin_addr) == 1) {
+                        sin->sin_family = AF_INET;
+                        sin->sin_port   = htons((uint16_t) port);
+                        saslen          = sizeof(struct sockaddr_in);
+                } else if (inet_pton(AF_INET6, host, &sin6->sin6_addr) == 1) {
+                        sin6->sin6_family = AF_INET6;
+                        sin6->sin6_port   = htons((uint16_t) port);
+                        saslen            = sizeof(struct sockaddr_in6);
+                } else {
+                        return sprintf(scratch, "ERROR: Invalid metrics endpoint address '%s'\n", host);
+                }
+        }
+
+        //
+        // Obtain socket, bind, and listen
+        //
+        if ((fd = socket(sas.ss_family, SOCK_STREAM, 0)) == -1) {
+                return sprintf(scratch, "SOCKET ERROR: %s (metrics)\n", strerror(errno));
+        }
+        if (sas.ss_family != AF_UNIX) {
+                var = 1;
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (const void *) &var, sizeof(var));
+        }
+        if (bind(fd, (struct sockaddr *) &sas, saslen) == -1) {
+                var = sprintf(scratch, "BIND ERROR: %s (%s)\n", strerror(errno), conf.metricsAddr);
+                close(fd);
+                return var;
+        }
+        if (listen(fd, METRICS_BACKLOG) == -1) {
+                var = sprintf(scratch, "LISTEN ERROR: %s (%s)\n", strerror(errno), conf.metricsAddr);
+                close(fd);
+                return var;
+        }
+        if ((i = new_conn(fd, NULL, 0, T_METRICS, &metrics_accept, &null_action)) < 0) {
+                return sprintf(scratch, "ERROR: Unable to add metrics endpoint connection\n");
+        }
+        conn[i].subType = SOCK_STREAM;
+        conn[i].state   = S_LISTEN;
+        if (conf.verbose) {
+                var = sprintf(scratch, "[%d]Metrics endpoint listening on %s\n", i, conf.metricsAddr);
+                send_proc(monConn, scratch, var);
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Save maximums and averages of statistics record just completed (before they are reset)
+//
+void metrics_record(void) {
+        struct timespec tspecvar;
+
+        tspecminus(&repo.systemClock, &repo.psRecordTime, &tspecvar);
+        mxDelta = (double) tspecmsec(&tspecvar);
+        memcpy(&mxMax, &repo.psMaximums, sizeof(struct perfStatsMaximums));
+        memcpy(&mxAvg, &repo.psAverages, sizeof(struct perfStatsAverages));
+}
+//----------------------------------------------------------------------------
+//
+// Accept pending requests on listening socket (primary action of endpoint)
+//
+int metrics_accept(int connindex) {
+        int i, fd;
+        struct timespec tspecvar;
+
+        while ((fd = accept4(conn[connindex].fd, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+                if ((i = new_conn(fd, NULL, 0, T_METRICS, &recv_proc, &metrics_request)) < 0) {
+                        if (fcntl(fd, F_GETFD) != -1)
+                                close(fd); // Not yet owned by a connection (e.g., max connections exceeded)
+                        continue;
+                }
+                conn[i].subType = SOCK_STREAM;
+                conn[i].state   = S_DATA;
+                //
+                // Close connection if request/response is not complete in time
+                //
+                tspecvar.tv_sec  = METRICS_TIMEOUT;
+                tspecvar.tv_nsec = 0;
+                tspecplus(&repo.systemClock, &tspecvar, &conn[i].timer1Thresh);
+                conn[i].timer1Action = &metrics_timeout;
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Process request received on accepted connection (secondary action after recv_proc)
+//
+// NOTE: Requests are expected in a single read, only the start of an HTTP request line is examined
+//
+int metrics_request(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var, size, status = 200;
+        char *body, header[METRICS_HDR_SIZE];
+        BOOL http = FALSE;
+
+        if (c->metricsBuf != NULL)
+                return 0; // Ignore anything further once response has started
+        if (repo.rcvDataSize >= 4 && strncmp(repo.defBuffer, "GET ", 4) == 0) {
+                http = TRUE;
+                if (strncmp(&repo.defBuffer[4], "/ ", 2) != 0 && strncmp(&repo.defBuffer[4], "/metrics", 8) != 0)
+                        status = 404;
+        }
+
+        //
+        // Render body after space reserved for header, then place header immediately before it
+        //
+        size = METRICS_BASE_SIZE + (repo.maxConnIndex + 1) * METRICS_CONN_SIZE;
+        if (conf.psConn)
+                size += (repo.maxConnIndex + 1) * METRICS_PSCONN_SIZE;
+        if ((c->metricsBuf = malloc(size)) == NULL) {
+                return -1;
+        }
+        body = &c->metricsBuf[METRICS_HDR_SIZE];
+        var  = 0;
+        if (status == 200)
+                var = metrics_render(body, size - METRICS_HDR_SIZE);
+        c->metricsSent = METRICS_HDR_SIZE;
+        c->metricsLen  = METRICS_HDR_SIZE + var;
+        if (http) {
+                if (status == 200) {
+                        size = sprintf(header, "HTTP/1.0 200 OK\r\nContent-Type: %s\r\nContent-Length: %d\r\n\r\n",
+                                       METRICS_CTYPE, var);
+                } else {
+                        size = sprintf(header, "HTTP/1.0 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+                }
+                c->metricsSent -= size;
+                memcpy(&c->metricsBuf[c->metricsSent], header, size);
+        }
+        return metrics_send(connindex);
+}
+//----------------------------------------------------------------------------
+//
+// Send (remaining) response, waiting for socket to become writable if needed
+//
+int metrics_send(int connindex) {
+        register struct connection *c = &conn[connindex];
+        int var;
+        struct epoll_event epevent;
+
+        while (c->metricsSent < c->metricsLen) {
+                var = send(c->fd, &c->metricsBuf[c->metricsSent], c->metricsLen - c->metricsSent, MSG_NOSIGNAL);
+                if (var < 0) {
+                        if (errno != EAGAIN && errno != EWOULDBLOCK)
+                                return -1;
+                        if (c->priAction != &metrics_send) {
+                                epevent.events   = EPOLLOUT;
+                                epevent.data.u32 = (uint32_t) connindex;
+                                if (epoll_ctl(repo.epollFD, EPOLL_CTL_MOD, c->fd, &epevent) != 0)
+                                        return -1;
+                                c->priAction = &metrics_send;
+                                c->secAction = &null_action;
+                        }
+                        return 0;
+                }
+                c->metricsSent += var;
+        }
+        return -1; // Response complete, close connection
+}
+//----------------------------------------------------------------------------
+//
+// Close connection on expiry of request/response timer
+//
+int metrics_timeout(int connindex) {
+
+        init_conn(connindex, TRUE);
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Append formatted text to buffer, returning updated length (output is truncated at buffer size)
+//
+int mx_printf(char *buf, int len, int size, const char *format, ...) {
+        va_list ap;
+        int var;
+
+        if (len >= size - 1)
+                return len;
+        va_start(ap, format);
+        var = vsnprintf(&buf[len], size - len, format, ap);
+        va_end(ap);
+        if (var < 0)
+                return len;
+        if (len + var >= size)
+                return size - 1;
+        return len + var;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain value of unsigned statistics field
+//
+double mx_field(const void *base, size_t offset, size_t size) {
+        const char *ptr = (const char *) base + offset;
+
+        if (size == sizeof(unsigned long long))
+                return (double) *(const unsigned long long *) ptr;
+        return (double) *(const unsigned int *) ptr;
+}
+//----------------------------------------------------------------------------
+//
+// Render OpenMetrics exposition into buffer and return length
+//
+int metrics_render(char *buf, int size) {
+        register struct connection *c;
+        const struct mxTemplate *mt;
+        int i, j, len = 0, count = 0, limit = size - (int) sizeof("# EOF\n");
+        double dvar, divisor;
+        char *dirtext;
+        struct timespec tspecvar;
+
+        //
+        // Process information
+        //
+        len = mx_printf(buf, len, limit,
+                        "# TYPE udpst_build info\n# HELP udpst_build Software and protocol version.\n"
+                        "udpst_build_info{version=\"%s\",protocol=\"%d\"} 1\n",
+                        SOFTWARE_VER, PROTOCOL_VER);
+        tspecminus(&repo.systemClock, &repo.startTime, &tspecvar);
+        len = mx_printf(buf, len, limit,
+                        "# TYPE udpst_uptime_seconds gauge\n# HELP udpst_uptime_seconds Process uptime.\n"
+                        "udpst_uptime_seconds %ld\n",
+                        (long) tspecvar.tv_sec);
+        len = mx_printf(buf, len, limit,
+                        "# TYPE udpst_allocated_upstream_bandwidth gauge\n"
+                        "# HELP udpst_allocated_upstream_bandwidth Upstream bandwidth currently allocated (Mbps).\n"
+                        "udpst_allocated_upstream_bandwidth %d\n"
+                        "# TYPE udpst_allocated_downstream_bandwidth gauge\n"
+                        "# HELP udpst_allocated_downstream_bandwidth Downstream bandwidth currently allocated (Mbps).\n"
+                        "udpst_allocated_downstream_bandwidth %d\n",
+                        repo.usBandwidth, repo.dsBandwidth);
+
+        //
+        // Counters, then maximums and averages once a statistics record has been completed
+        //
+        for (i = 0; i < MX_COUNT(mxCounters); i++) {
+                mt  = &mxCounters[i];
+                len = mx_printf(buf, len, limit, "%s%.0f\n", mt->text, mx_field(&repo.psCounters, mt->offset, mt->size));
+        }
+        if (mxDelta > 0.0) {
+                for (i = 0; i < MX_COUNT(mxMaximums); i++) {
+                        mt  = &mxMaximums[i];
+                        len = mx_printf(buf, len, limit, "%s%.0f\n", mt->text, mx_field(&mxMax, mt->offset, mt->size));
+                }
+                for (i = 0; i < MX_COUNT(mxAverages); i++) {
+                        mt   = &mxAverages[i];
+                        dvar = mx_field(&mxAvg, mt->offset, mt->size);
+                        if (mt->kind == MX_MBPS) {
+                                dvar = (dvar * 8.0) / mxDelta / MSECINSEC;
+                        } else if (mt->kind == MX_RATE) {
+                                dvar = (dvar * MSECINSEC) / mxDelta;
+                        } else if (mt->kind == MX_RATIO) {
+                                divisor = mx_field(&mxAvg, mt->offset2, mt->size);
+                                dvar    = (divisor > 0.0) ? dvar / divisor : 0.0;
+                        }
+                        len = mx_printf(buf, len, limit, "%s%.2f\n", mt->text, dvar);
+                }
+        }
+
+        //
+        // Per-test gauges, grouped by family as required by OpenMetrics
+        //
+        for (i = 0; i <= repo.maxConnIndex; i++) {
+                if (conn[i].type == T_UDP && conn[i].state == S_DATA && conn[i].testAction == TEST_ACT_TEST &&
+                    conn[i].testType != TEST_TYPE_UNK)
+                        count++;
+        }
+        len = mx_printf(buf, len, limit,
+                        "# TYPE udpst_test_connections gauge\n# HELP udpst_test_connections Active test connections.\n"
+                        "udpst_test_connections %d\n",
+                        count);
+        for (j = 0; j < MX_TEST_MAX && count > 0; j++) {
+                len = mx_printf(buf, len, limit, "%s", mxTests[j].family);
+                for (i = 0; i <= repo.maxConnIndex; i++) {
+                        c = &conn[i];
+                        if (c->type != T_UDP || c->state != S_DATA || c->testAction != TEST_ACT_TEST ||
+                            c->testType == TEST_TYPE_UNK)
+                                continue;
+                        if (limit - len < METRICS_CONN_SIZE / MX_TEST_MAX)
+                                break; // Keep exposition well-formed if buffer is exhausted
+                        if (j == MX_TEST_SRINDEX) {
+                                dvar = (double) c->srIndex;
+                        } else if (j == MX_TEST_SRMBPS) {
+                                if (c->srIndex < 0 || (!c->srContinuous && c->srIndex >= repo.maxSendingRates))
+                                        continue;
+                                dvar = sr_index_mbps(i, c->srIndex);
+                        } else if (j == MX_TEST_RXDG) {
+                                dvar = (double) c->sisSav.rxDatagrams;
+                        } else if (j == MX_TEST_LOSS) {
+                                dvar = (double) c->sisSav.seqErrLoss;
+                        } else if (j == MX_TEST_DVMAX) {
+                                dvar = (double) c->sisSav.delayVarMax / MSECINSEC;
+                        } else {
+                                if (c->rttMinimum == STATUS_NODEL)
+                                        continue;
+                                dvar = (double) c->rttMinimum / MSECINSEC;
+                        }
+                        dirtext = (c->testType == TEST_TYPE_US) ? "upstream" : "downstream";
+                        len = mx_printf(buf, len, limit, "%s{connection=\"%d\",direction=\"%s\",client=\"%s\"} %.9g\n",
+                                        mxTests[j].sample, i, dirtext, c->remAddr, dvar);
+                }
+        }
+
+        //
+        // Per-connection counters, also grouped by family
+        //
+        for (j = 0; j < MX_COUNT(mxConns) && conf.psConn && count > 0; j++) {
+                len = mx_printf(buf, len, limit, "%s", mxConns[j].family);
+                for (i = 0; i <= repo.maxConnIndex; i++) {
+                        c = &conn[i];
+                        if (c->type != T_UDP || c->state != S_DATA || c->testAction != TEST_ACT_TEST ||
+                            c->testType == TEST_TYPE_UNK)
+                                continue;
+                        if (limit - len < METRICS_PSCONN_SIZE / MX_COUNT(mxConns))
+                                break;
+                        dvar    = mx_field(&c->psConn, mxConns[j].offset, mxConns[j].size);
+                        dirtext = (c->testType == TEST_TYPE_US) ? "upstream" : "downstream";
+                        if (mxConns[j].scale == 1.0) { // Keep large byte counts exact
+                                len = mx_printf(buf, len, limit, "%s{connection=\"%d\",direction=\"%s\",client=\"%s\"} %.0f\n",
+                                                mxConns[j].sample, i, dirtext, c->remAddr, dvar);
+                        } else {
+                                len = mx_printf(buf, len, limit, "%s{connection=\"%d\",direction=\"%s\",client=\"%s\"} %.9f\n",
+                                                mxConns[j].sample, i, dirtext, c->remAddr, dvar * mxConns[j].scale);
+                        }
+                }
+        }
+        len = mx_printf(buf, len, size, "# EOF\n");
+
+        return len;
+}
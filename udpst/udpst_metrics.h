@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_metrics.h
+ *
+ * This file contains constants and external function prototypes for the
+ * associated module.
+ *
+ */
+
+#ifndef UDPST_METRICS_H
+#define UDPST_METRICS_H
+
+//----------------------------------------------------------------------------
+//
+// Metrics endpoint (server)
+//
+// A local TCP or UNIX stream socket serviced from the epoll loop. Each accepted
+// connection reads one request and is answered with the performance statistics
+// in OpenMetrics text format (with an HTTP/1.0 header when the request is an
+// HTTP GET), after which it is closed. Responses are rendered in one pass into
+// a buffer sized from the connection count; if the socket cannot accept it all
+// at once, the remainder is sent as it becomes writable.
+//
+#define METRICS_DEF_HOST    "127.0.0.1" // Bind address when only a port is given
+#define METRICS_BACKLOG     16          // Listen backlog
+#define METRICS_TIMEOUT     5           // Request/response timeout (sec)
+#define METRICS_BASE_SIZE   32768       // Response buffer size (fixed families)
+#define METRICS_CONN_SIZE   1024        // Response buffer size (per test connection)
+#define METRICS_PSCONN_SIZE 2560        // Response buffer size (per test connection, per-connection counters)
+#define METRICS_HDR_SIZE    256         // Response buffer space reserved for header
+#define METRICS_CTYPE       "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int metrics_init(void);
+extern void metrics_record(void);
+
+#endif /* UDPST_METRICS_H */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_probe.h
+ *
+ * This file contains the USDT (user statically-defined tracing) probe macros
+ * and the list of probes with their arguments.
+ *
+ */
+
+#ifndef UDPST_PROBE_H
+#define UDPST_PROBE_H
+
+//----------------------------------------------------------------------------
+//
+// USDT probes (provider "udpst", only compiled in when ADD_USDT_PROBES is defined and <sys/sdt.h> is available)
+//
+// Each probe site is a single no-op instruction plus an ELF note describing where its arguments are, so it costs
+// nothing until a tracer such as bpftrace or perf attaches (which replaces the no-op with a breakpoint). Arguments
+// are values already at hand at each site, so no work is done to prepare them. Strings are passed as pointers.
+//
+//   Probe            Arguments
+//   --------------   ----------------------------------------------------------------------------------------------
+//   setup_accept     connindex of new test connection, client address, client port, max bandwidth (Mbps), upstream
+//   setup_reject     setup response code (CHSR_CRSP_*), client address, client port, protocol version
+//   test_activate    connindex, test type (TEST_TYPE_*), is server, sending rate index, rate adjustment algorithm
+//   send_burst       connindex, sending rate index, datagrams requested, datagrams accepted
+//   recv_batch       connindex, datagrams returned by recvmmsg()
+//   seq_loss         connindex, sequence number received, datagrams lost before it
+//   seq_reorder      connindex, sequence number received, next expected sequence number, is duplicate
+//   rate_adjust      connindex, sequence errors, delay (variation) used, previous index, new index, algorithm
+//   subint_final     connindex (or that of the aggregate connection), sub-interval count, L3 rate (kbps), received
+//                    datagrams, loss, out-of-order, duplicates
+//
+#if defined(ADD_USDT_PROBES) && defined(__linux__)
+#include <sys/sdt.h>
+#define UDPST_PROBE2(name, a1, a2)                     DTRACE_PROBE2(udpst, name, a1, a2)
+#define UDPST_PROBE3(name, a1, a2, a3)                 DTRACE_PROBE3(udpst, name, a1, a2, a3)
+#define UDPST_PROBE4(name, a1, a2, a3, a4)             DTRACE_PROBE4(udpst, name, a1, a2, a3, a4)
+#define UDPST_PROBE5(name, a1, a2, a3, a4, a5)         DTRACE_PROBE5(udpst, name, a1, a2, a3, a4, a5)
+#define UDPST_PROBE6(name, a1, a2, a3, a4, a5, a6)     DTRACE_PROBE6(udpst, name, a1, a2, a3, a4, a5, a6)
+#define UDPST_PROBE7(name, a1, a2, a3, a4, a5, a6, a7) DTRACE_PROBE7(udpst, name, a1, a2, a3, a4, a5, a6, a7)
+#else
+#define UDPST_PROBE2(name, a1, a2)
+#define UDPST_PROBE3(name, a1, a2, a3)
+#define UDPST_PROBE4(name, a1, a2, a3, a4)
+#define UDPST_PROBE5(name, a1, a2, a3, a4, a5)
+#define UDPST_PROBE6(name, a1, a2, a3, a4, a5, a6)
+#define UDPST_PROBE7(name, a1, a2, a3, a4, a5, a6, a7)
+#endif
+
+#endif /* UDPST_PROBE_H */
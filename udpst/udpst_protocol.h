@@ -43,11 +43,16 @@
 //
 // Protocol version
 //
-#define PROTOCOL_VER  20 // Current protocol version between client and server
+#define PROTOCOL_VER  21 // Current protocol version between client and server
 #define PROTOCOL_MIN  11 // Minimum protocol version for backward compatibility
 #define MSSUBINT_PVER 20 // Protocol version required for ms sub-interval support
 #define EXTAUTH_PVER  20 // Protocol version required for extended auth. support
 #define SRASUPP_PVER  20 // Protocol version required for sending rate adj. suppression
+#define CONVSTOP_PVER 21 // Protocol version required for convergence stop
+#define ECNCE_PVER    21 // Protocol version required for ECN CE feedback
+#define USDELAY_PVER  21 // Protocol version required for usec delay variation
+#define SEQ64_PVER    21 // Protocol version required for 64-bit sequence/accumulator support
+#define HISTO_PVER    21 // Protocol version required for delay/RTT variation histograms
 
 //----------------------------------------------------------------------------
 //
@@ -170,9 +175,13 @@ struct controlHdrTA {
         uint8_t ignoreOooDup;        // Ignore out-of-order/Dup (BOOL)
 #define CHTA_SRIDX_ISSTART 0x01      // Use srIndexConf as starting index
 #define CHTA_RAND_PAYLOAD  0x02      // Randomize payload
+#define CHTA_SRATE_CONT    0x04      // Continuous (table-free) sending rates
+#define CHTA_TRIAL_ADAPT   0x08      // RTT-adaptive trial interval
+#define CHTA_DELAY_USEC    0x10      // Delay variation thresholds in usec
         uint8_t modifierBitmap;      // Modifier bitmap
 #define CHTA_RA_ALGO_B 0             // Algorithm B
 #define CHTA_RA_ALGO_C 1             // Algorithm C
+#define CHTA_RA_ALGO_D 2             // Algorithm D
         uint8_t rateAdjAlgo;         // Rate adjust. algorithm
         uint8_t reserved2;           // (reserved for alignment)
         struct sendingRate srStruct; // Sending Rate structure
@@ -189,7 +198,7 @@ struct controlHdrTA {
         uint16_t checkSum;     // Header checksum
 };
 #define CHTA_RA_ALGO_MIN CHTA_RA_ALGO_B
-#define CHTA_RA_ALGO_MAX CHTA_RA_ALGO_C
+#define CHTA_RA_ALGO_MAX CHTA_RA_ALGO_D
 #define CHTA_SIZE_CVER   sizeof(struct controlHdrTA) // Current protocol version
 #define CHTA_SIZE_MVER   (CHTA_SIZE_CVER - 44)       // Minimum protocol version
 //----------------------------------------------------------------------------
@@ -202,6 +211,7 @@ struct loadHdr {
 #define TEST_ACT_TEST  0        // Test active
 #define TEST_ACT_STOP1 1        // Stop indication used locally by server
 #define TEST_ACT_STOP2 2        // Stop indication exchanged with client
+#define TEST_ACT_STOPC 3        // Stop indication exchanged with client (converged)
         uint8_t testAction;     // Test action
         uint8_t rxStopped;      // Receive traffic stopped (BOOL)
         uint32_t lpduSeqNo;     // Load PDU sequence number
@@ -211,10 +221,11 @@ struct loadHdr {
         uint32_t spduTime_nsec; // Send time in last rx'd status PDU
         uint32_t lpduTime_sec;  // Send time of this Load PDU
         uint32_t lpduTime_nsec; // Send time of this Load PDU
-        uint16_t rttRespDelay;  // Response delay for RTT (ms)
+#define LOAD_RTTRD_MAX UINT16_MAX // Saturated response delay (usec)
+        uint16_t rttRespDelay;  // Response delay for RTT (ms or usec)
         uint16_t checkSum;      // Header checksum
 };
-#define TEST_ACT_MAX TEST_ACT_STOP2
+#define TEST_ACT_MAX TEST_ACT_STOPC
 //----------------------------------------------------------------------------
 //
 // Sub-Interval statistics structure for received traffic information
@@ -281,6 +292,41 @@ struct statusHdr {
 #define STATUS_SIZE_MVER   (STATUS_SIZE_CVER - 36)  // Minimum protocol version (w/subIntStats padding)
 #define STATUS_CSOFF_MVER  146                      // Checksum offset (w/subIntStats padding)
 #define STATUS_NPSIZE_MVER (STATUS_SIZE_MVER - 8)   // No padding size (no subIntStats padding)
+//
+// Status Feedback extension appended to status header (microsecond delay resolution and 64-bit accumulators)
+//
+#pragma pack(push, 1)
+struct statusHdrExt {
+        uint32_t delayVarMinUs;  // Delay variation minimum (us)
+        uint32_t delayVarMaxUs;  // Delay variation maximum (us)
+        uint64_t delayVarSumUs;  // Delay variation sum (us, 64 bits)
+        uint32_t rttMinimumUs;   // Min round-trip time sampled (us)
+        uint32_t rttVarSampleUs; // Last round-trip time sample (us)
+        uint64_t delayVarSum;    // Delay variation sum (ms, 64 bits)
+        uint64_t sisDelayVarSum; // Sub-Interval delay variation sum (ms, 64 bits)
+        uint64_t tiRxBytes;      // Trial interval receive bytes (64 bits)
+};
+#pragma pack(pop)
+#define STATUS_SIZE_EVER (STATUS_SIZE_CVER + sizeof(struct statusHdrExt)) // Extended protocol version (USDELAY_PVER)
+//
+// Optional histogram trailer appended to status extension (delay and RTT variation histograms of the saved
+// sub-interval). It is followed by the delay variation histogram and then the RTT variation histogram, each
+// encoded as (gap, count) varint pairs of non-empty buckets. When the encoded histograms would exceed
+// STATUS_HISTO_MAX, buckets are combined by dropping low-order sub-bucket bits (see coarsen).
+//
+#pragma pack(push, 1)
+struct statusHdrHisto {
+        uint32_t delayVarMaxUs;  // Delay variation histogram maximum (us)
+        uint32_t rttVarMaxUs;    // RTT variation histogram maximum (us)
+        uint16_t delayVarLength; // Encoded delay variation histogram length
+        uint16_t rttVarLength;   // Encoded RTT variation histogram length
+        uint8_t subBits;         // Sub-bucket bits of histogram layout
+        uint8_t maxBits;         // Value bits of histogram layout
+        uint8_t coarsen;         // Sub-bucket bits dropped during encoding
+        uint8_t reserved1;       // (reserved for alignment)
+};
+#pragma pack(pop)
+#define STATUS_HISTO_MAX 1024 // Max encoded histogram bytes (both histograms)
 //----------------------------------------------------------------------------
 //
 // Authentication overlay structure (for common processing across PDUs)
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_psconn.c
+ *
+ * This file maintains the optional per-connection performance statistics of
+ * the server, and adds them (along with a per-client aggregation) to each
+ * record of the performance statistics file. Counters are kept in the cold
+ * data of each connection; a snapshot taken at every record provides the
+ * per-record deltas, and connections that close mid-record are retained so
+ * their final interval is still reported.
+ *
+ */
+
+#define UDPST_PSCONN
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_psconn.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+BOOL psconn_alloc(void);
+void psconn_snapshot(int, struct psConnEntry *, BOOL);
+int psconn_entry(char *, struct psConnEntry *, double, BOOL);
+int psconn_clients(char *, int, double);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern struct configuration conf;
+extern struct repository repo;
+extern struct connection *conn;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+// Entries of connections closed during a record are held at the front of the array, entries of active connections
+// are appended after them only while the record is being built
+//
+static struct psConnEntry *psEntry; // Entries of record (closed then active)
+static int psEntryMax;              // Entry array size
+static int psClosedCount;           // Entries of connections closed during record
+static unsigned int psClosedDrops;  // Closed connections not retained (array full)
+static char *boolText[] = {"false", "true"};
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Accumulate event processing time of connection since start time (system clock must be current)
+//
+void psconn_busy(int connindex, struct timespec *start) {
+        struct timespec tspecvar;
+
+        tspecminus(&repo.systemClock, start, &tspecvar);
+        conn[connindex].psConn.busyTime += ((unsigned long long) tspecvar.tv_sec * NSECINSEC) + tspecvar.tv_nsec;
+}
+//----------------------------------------------------------------------------
+//
+// Retain statistics of test connection being closed until the current record is built
+//
+void psconn_close(int connindex) {
+        if (!psconn_alloc())
+                return;
+        if (psClosedCount >= STATS_CONN_CLOSED) {
+                psClosedDrops++;
+                return;
+        }
+        psconn_snapshot(connindex, &psEntry[psClosedCount++], TRUE);
+}
+//----------------------------------------------------------------------------
+//
+// Return buffer space needed by per-connection and per-client sections of the next record
+//
+int psconn_size(void) {
+        int i, count = psClosedCount;
+
+        for (i = 0; i <= repo.maxConnIndex; i++) {
+                if (conn[i].type == T_UDP && conn[i].testType != TEST_TYPE_UNK)
+                        count++;
+        }
+        return ((count * 2) + 1) * STATS_CONN_SIZE;
+}
+//----------------------------------------------------------------------------
+//
+// Add per-connection and per-client sections to record and return length (delta is record interval in ms)
+//
+// Baselines of active connections are reset, and retained closed connections released, for the next record
+//
+int psconn_record(char *buf, double delta) {
+        int i, count, len = 0;
+
+        if (!psconn_alloc())
+                return 0;
+
+        //
+        // Snapshot active test connections (after those closed during record)
+        //
+        count = psClosedCount;
+        for (i = 0; i <= repo.maxConnIndex && count < psEntryMax; i++) {
+                if (conn[i].type == T_UDP && conn[i].testType != TEST_TYPE_UNK)
+                        psconn_snapshot(i, &psEntry[count++], FALSE);
+        }
+
+        //
+        // Add connections, then their aggregation per client
+        //
+        len += sprintf(&buf[len], "\t\"connections\": [");
+        for (i = 0; i < count; i++) {
+                len += psconn_entry(&buf[len], &psEntry[i], delta, (BOOL) (i == count - 1));
+        }
+        len += sprintf(&buf[len], "],\n");
+        len += sprintf(&buf[len], "\t\"connections_dropped\": %u,\n", psClosedDrops);
+        //
+        len += sprintf(&buf[len], "\t\"clients\": [");
+        len += psconn_clients(&buf[len], count, delta);
+        len += sprintf(&buf[len], "],\n");
+
+        psClosedCount = 0;
+        psClosedDrops = 0;
+        return len;
+}
+//----------------------------------------------------------------------------
+//
+// Allocate entry array on first use (sized for every connection plus those retained after closing)
+//
+BOOL psconn_alloc(void) {
+        if (psEntry != NULL)
+                return TRUE;
+        psEntryMax = conf.maxConnections + STATS_CONN_CLOSED;
+        if ((psEntry = calloc((size_t) psEntryMax, sizeof(struct psConnEntry))) == NULL) {
+                psEntryMax = 0;
+                return FALSE;
+        }
+        return TRUE;
+}
+//----------------------------------------------------------------------------
+//
+// Populate entry with statistics of connection since last record and reset its baseline
+//
+void psconn_snapshot(int connindex, struct psConnEntry *pe, BOOL closed) {
+        register struct connection *c = &conn[connindex];
+        struct perfStatsConn *cur = &c->psConn, *base = &c->psConnRec, *ps = &pe->ps;
+
+        pe->connIndex = connindex;
+        pe->testType  = c->testType;
+        pe->remPort   = c->remPort;
+        pe->srIndex   = c->srIndex;
+        pe->closed    = closed;
+        pe->grouped   = FALSE;
+        strcpy(pe->remAddr, c->remAddr);
+
+        //
+        // Cumulative counters are reported as deltas, per-record values as is
+        //
+        *ps = *cur;
+        ps->qdBytes -= base->qdBytes;
+        ps->qdDatagrams -= base->qdDatagrams;
+        ps->txBytes -= base->txBytes;
+        ps->txDatagrams -= base->txDatagrams;
+        ps->rxBytes -= base->rxBytes;
+        ps->rxDatagrams -= base->rxDatagrams;
+        ps->busyTime -= base->busyTime;
+        ps->txOverrunCount -= base->txOverrunCount;
+        ps->txOverrunTotal -= base->txOverrunTotal;
+        ps->txBurstCount -= base->txBurstCount;
+        ps->txBurstTotal -= base->txBurstTotal;
+        ps->rxBurstCount -= base->rxBurstCount;
+        ps->rxBurstTotal -= base->rxBurstTotal;
+        ps->locStatusLoss -= base->locStatusLoss;
+        ps->remStatusLoss -= base->remStatusLoss;
+        ps->locTrafficStop -= base->locTrafficStop;
+        ps->remTrafficStop -= base->remTrafficStop;
+
+        //
+        // Start next record from current values
+        //
+        cur->txBurstSize    = 0;
+        cur->rxBurstSize    = 0;
+        cur->srIndexUpdates = 0;
+        *base               = *cur;
+}
+//----------------------------------------------------------------------------
+//
+// Add JSON object of connection entry and return length
+//
+int psconn_entry(char *buf, struct psConnEntry *pe, double delta, BOOL last) {
+        int len = 0;
+        double dvar;
+        struct perfStatsConn *ps = &pe->ps;
+
+        len += sprintf(&buf[len], "{\n");
+        len += sprintf(&buf[len], "\t\t\"connection\": %d,\n", pe->connIndex);
+        len += sprintf(&buf[len], "\t\t\"client_ip_address\": \"%s\",\n", pe->remAddr);
+        len += sprintf(&buf[len], "\t\t\"client_port\": %d,\n", pe->remPort);
+        len += sprintf(&buf[len], "\t\t\"direction\": \"%s\",\n",
+                       (pe->testType == TEST_TYPE_US) ? "upstream" : "downstream");
+        len += sprintf(&buf[len], "\t\t\"closed\": %s,\n", boolText[pe->closed]);
+        //
+        dvar = ((double) ps->qdBytes * 8.0) / delta / MSECINSEC;
+        len += sprintf(&buf[len], "\t\t\"queued_tx_ip_rate_mbps\": %.2f,\n", dvar);
+        dvar = ((double) ps->txBytes * 8.0) / delta / MSECINSEC;
+        len += sprintf(&buf[len], "\t\t\"tx_ip_rate_mbps\": %.2f,\n", dvar);
+        dvar = ((double) ps->txDatagrams * MSECINSEC) / delta;
+        len += sprintf(&buf[len], "\t\t\"tx_datagram_rate\": %.2f,\n", dvar);
+        dvar = ((double) ps->rxBytes * 8.0) / delta / MSECINSEC;
+        len += sprintf(&buf[len], "\t\t\"rx_ip_rate_mbps\": %.2f,\n", dvar);
+        dvar = ((double) ps->rxDatagrams * MSECINSEC) / delta;
+        len += sprintf(&buf[len], "\t\t\"rx_datagram_rate\": %.2f,\n", dvar);
+        //
+        len += sprintf(&buf[len], "\t\t\"tx_overrun_count\": %u,\n", ps->txOverrunCount);
+        dvar = 0;
+        if (ps->txOverrunCount > 0)
+                dvar = (double) ps->txOverrunTotal / (double) ps->txOverrunCount;
+        len += sprintf(&buf[len], "\t\t\"tx_overrun_size\": %.2f,\n", dvar);
+        dvar = 0;
+        if (ps->txBurstCount > 0)
+                dvar = (double) ps->txBurstTotal / (double) ps->txBurstCount;
+        len += sprintf(&buf[len], "\t\t\"tx_burst_size\": %.2f,\n", dvar);
+        len += sprintf(&buf[len], "\t\t\"tx_burst_size_max\": %u,\n", ps->txBurstSize);
+        dvar = 0;
+        if (ps->rxBurstCount > 0)
+                dvar = (double) ps->rxBurstTotal / (double) ps->rxBurstCount;
+        len += sprintf(&buf[len], "\t\t\"rx_burst_size\": %.2f,\n", dvar);
+        len += sprintf(&buf[len], "\t\t\"rx_burst_size_max\": %u,\n", ps->rxBurstSize);
+        //
+        len += sprintf(&buf[len], "\t\t\"loc_message_loss\": %u,\n", ps->locStatusLoss);
+        len += sprintf(&buf[len], "\t\t\"rem_message_loss\": %u,\n", ps->remStatusLoss);
+        len += sprintf(&buf[len], "\t\t\"loc_traffic_stop\": %u,\n", ps->locTrafficStop);
+        len += sprintf(&buf[len], "\t\t\"rem_traffic_stop\": %u,\n", ps->remTrafficStop);
+        //
+        len += sprintf(&buf[len], "\t\t\"sending_rate_index\": {\n");
+        len += sprintf(&buf[len], "\t\t\t\"update_count\": %u,\n", ps->srIndexUpdates);
+        if (ps->srIndexUpdates > 0) {
+                len += sprintf(&buf[len], "\t\t\t\"first\": %d,\n", ps->srIndexFirst);
+                len += sprintf(&buf[len], "\t\t\t\"minimum\": %d,\n", ps->srIndexMin);
+                len += sprintf(&buf[len], "\t\t\t\"maximum\": %d,\n", ps->srIndexMax);
+        }
+        len += sprintf(&buf[len], "\t\t\t\"last\": %d\n", pe->srIndex);
+        len += sprintf(&buf[len], "\t\t},\n");
+        //
+        len += sprintf(&buf[len], "\t\t\"busy_time_usec\": %llu,\n", ps->busyTime / NSECINUSEC);
+        dvar = (double) ps->busyTime / (delta * NSECINMSEC);
+        len += sprintf(&buf[len], "\t\t\"busy_ratio\": %.4f\n", dvar);
+        len += sprintf(&buf[len], "\t}%s", last ? "" : ", ");
+
+        return len;
+}
+//----------------------------------------------------------------------------
+//
+// Add JSON objects aggregating entries per client address and return length
+//
+int psconn_clients(char *buf, int count, double delta) {
+        int i, j, conns, len = 0;
+        unsigned long long txbytes, rxbytes, busytime;
+        unsigned int overruns, locloss, remloss, locstop, remstop;
+        struct psConnEntry *pe;
+
+        for (i = 0; i < count; i++) {
+                if (psEntry[i].grouped)
+                        continue;
+                conns    = 0;
+                txbytes  = rxbytes = busytime = 0;
+                overruns = locloss = remloss = locstop = remstop = 0;
+                for (j = i; j < count; j++) {
+                        pe = &psEntry[j];
+                        if (pe->grouped || strcmp(pe->remAddr, psEntry[i].remAddr) != 0)
+                                continue;
+                        pe->grouped = TRUE;
+                        conns++;
+                        txbytes += pe->ps.txBytes;
+                        rxbytes += pe->ps.rxBytes;
+                        busytime += pe->ps.busyTime;
+                        overruns += pe->ps.txOverrunCount;
+                        locloss += pe->ps.locStatusLoss;
+                        remloss += pe->ps.remStatusLoss;
+                        locstop += pe->ps.locTrafficStop;
+                        remstop += pe->ps.remTrafficStop;
+                }
+                if (len > 0)
+                        len += sprintf(&buf[len], ", ");
+                len += sprintf(&buf[len], "{\n");
+                len += sprintf(&buf[len], "\t\t\"client_ip_address\": \"%s\",\n", psEntry[i].remAddr);
+                len += sprintf(&buf[len], "\t\t\"connection_count\": %d,\n", conns);
+                len += sprintf(&buf[len], "\t\t\"tx_ip_rate_mbps\": %.2f,\n", ((double) txbytes * 8.0) / delta / MSECINSEC);
+                len += sprintf(&buf[len], "\t\t\"rx_ip_rate_mbps\": %.2f,\n", ((double) rxbytes * 8.0) / delta / MSECINSEC);
+                len += sprintf(&buf[len], "\t\t\"tx_overrun_count\": %u,\n", overruns);
+                len += sprintf(&buf[len], "\t\t\"loc_message_loss\": %u,\n", locloss);
+                len += sprintf(&buf[len], "\t\t\"rem_message_loss\": %u,\n", remloss);
+                len += sprintf(&buf[len], "\t\t\"loc_traffic_stop\": %u,\n", locstop);
+                len += sprintf(&buf[len], "\t\t\"rem_traffic_stop\": %u,\n", remstop);
+                len += sprintf(&buf[len], "\t\t\"busy_time_usec\": %llu\n", busytime / NSECINUSEC);
+                len += sprintf(&buf[len], "\t}");
+        }
+        return len;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_psconn.h
+ *
+ * This file contains the external function prototypes for the per-connection
+ * performance statistics module.
+ *
+ */
+
+#ifndef UDPST_PSCONN_H
+#define UDPST_PSCONN_H
+
+//----------------------------------------------------------------------------
+//
+// Per-connection statistics entry of a performance statistics record
+//
+struct psConnEntry {
+        int connIndex;                   // Connection index
+        int testType;                    // Test type (direction)
+        int remPort;                     // Remote port
+        int srIndex;                     // Sending rate index at snapshot
+        BOOL closed;                     // Connection closed during record
+        BOOL grouped;                    // Already aggregated into a client
+        char remAddr[INET6_ADDR_STRLEN]; // Remote IP address as string
+        struct perfStatsConn ps;         // Statistics over record (delta)
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern void psconn_busy(int, struct timespec *);
+extern void psconn_close(int);
+extern int psconn_size(void);
+extern int psconn_record(char *, double);
+
+#endif /* UDPST_PSCONN_H */
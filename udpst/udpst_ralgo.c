@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_ralgo.c
+ *
+ * This file contains the sending rate adjustment algorithms used by the server
+ * to search for the maximum sending rate, along with the table used to select
+ * them.
+ *
+ */
+
+#define UDPST_RALGO
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_ralgo.h"
+#include "udpst_srates.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void algo_b_update(int, int, int);
+void algo_c_init(int);
+void algo_c_update(int, int, int);
+void algo_d_init(int);
+void algo_d_update(int, int, int);
+void algo_d_subint(int);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern struct configuration conf;
+extern struct repository repo;
+extern struct connection *conn;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static const struct rateAdjOps rateAdjTable[CHTA_RA_ALGO_MAX + 1] = {
+    {NULL, &algo_b_update, NULL},                  // CHTA_RA_ALGO_B
+    {&algo_c_init, &algo_c_update, NULL},          // CHTA_RA_ALGO_C
+    {&algo_d_init, &algo_d_update, &algo_d_subint} // CHTA_RA_ALGO_D
+};
+#define RA_CONGESTED(c, seqerr, delay) ((seqerr) > (c)->seqErrThresh || (delay) > (c)->upperThresh)
+#define RA_CLEAR(c, seqerr, delay)     ((seqerr) <= (c)->seqErrThresh && (delay) < (c)->lowThresh)
+#define RA_MAXINDEX(c)                 ((c)->srContinuous ? repo.maxContIndex : repo.maxSendingRates - 1)
+#define RA_LAGTRIALS(c, usec)                                                                                              \
+        ((c)->rttMinimum == STATUS_NODEL ? 0 : (int) (((c)->rttMinimum * USECINMSEC + (usec) - 1) / (usec)))
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Initialize algorithm state at test activation
+//
+void ra_init(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        memset(&c->raState, 0, sizeof(union raState));
+        c->raSubIntSeqNo = c->subIntSeqNo;
+        if (rateAdjTable[c->rateAdjAlgo].init != NULL)
+                (rateAdjTable[c->rateAdjAlgo].init)(connindex);
+}
+//----------------------------------------------------------------------------
+//
+// Pass trial interval feedback to algorithm (preceded by end of sub-interval notification when
+// a new sub-interval has completed since the last update)
+//
+void ra_update(int connindex, int seqerr, int delay) {
+        register struct connection *c = &conn[connindex];
+
+        if (c->subIntSeqNo != c->raSubIntSeqNo) {
+                c->raSubIntSeqNo = c->subIntSeqNo;
+                if (rateAdjTable[c->rateAdjAlgo].subint != NULL)
+                        (rateAdjTable[c->rateAdjAlgo].subint)(connindex);
+        }
+        if (rateAdjTable[c->rateAdjAlgo].update != NULL)
+                (rateAdjTable[c->rateAdjAlgo].update)(connindex, seqerr, delay);
+}
+//----------------------------------------------------------------------------
+//
+// Algorithm B
+//
+// This section of code corresponds to the flowchart in TR-471 section 5.2.1,
+// Sending Rate Search Algorithm, and ITU-T Recommendation Y.1540, Annex B
+//
+void algo_b_update(int connindex, int seqerr, int delay) {
+        register struct connection *c = &conn[connindex];
+
+        if (RA_CLEAR(c, seqerr, delay)) {
+                if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount < c->slowAdjThresh) {
+                        if (c->srIndex + c->highSpeedDelta > repo.hSpeedThresh)
+                                c->srIndex = repo.hSpeedThresh;
+                        else
+                                c->srIndex += c->highSpeedDelta;
+                        c->slowAdjCount = 0;
+                } else {
+                        if (c->srIndex < RA_MAXINDEX(c))
+                                c->srIndex++;
+                }
+        } else if (RA_CONGESTED(c, seqerr, delay)) {
+                c->slowAdjCount++;
+                if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount == c->slowAdjThresh) {
+                        if (c->srIndex > c->highSpeedDelta * HS_DELTA_BACKUP)
+                                c->srIndex -= c->highSpeedDelta * HS_DELTA_BACKUP;
+                        else
+                                c->srIndex = 0;
+                } else {
+                        if (c->srIndex > 0)
+                                c->srIndex--;
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Algorithm C
+//
+// Multiplicative adjust sending rate : 1.5x previous rate : with retry after waiting
+// This section of code provides an optional algorithm, with the properties of faster search to the
+// max region, meaning less time when errors might end a fast search, and retry fast if that happens.
+//
+void algo_c_init(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        c->raState.c.retryThresh = RETRY_THRESH_ALGOC;
+}
+void algo_c_update(int connindex, int seqerr, int delay) {
+        register struct connection *c = &conn[connindex];
+        struct raStateC *ra           = &c->raState.c;
+
+        if (RA_CLEAR(c, seqerr, delay)) {
+                if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount < c->slowAdjThresh) { // Congestion not detected
+                        if (c->srIndex * 2 > repo.hSpeedThresh) { // If no room to jump within high-speed threshold
+                                c->srIndex = repo.hSpeedThresh;   // Truncate jump at high-speed threshold
+                        } else {
+                                if (c->srIndex == 0)
+                                        c->srIndex++; // Pre-increment to deal with zero index
+
+                                if (ra->update == TRUE) { // Halve the multiplicative rate, using update
+                                        c->srIndex *= 2;  // Jump forward (while staying below high-speed threshold)
+                                        ra->update = FALSE;
+                                } else {
+                                        ra->update = TRUE;
+                                }
+                        }
+                        c->slowAdjCount = 0; // Reset congestion detection counter
+                } else {
+                        if (c->srIndex < RA_MAXINDEX(c)) {
+                                c->srIndex++;     // Increment index (slow path)
+                                ra->retryCount++; // Increment waiting count until retry fast ramp-up
+                        }
+                        if (ra->retryCount >= ra->retryThresh) {
+                                c->slowAdjCount = 0;                  // Retry fast ramp-up again
+                                ra->retryCount  = 0;                  // Clear variables to enable fast ramp-up
+                                ra->retryThresh += RETRY_THRESH_ALGOC; // Use higher wait threshold for the next fast ramp-up
+                        }
+                }
+        } else if (RA_CONGESTED(c, seqerr, delay)) {
+                c->slowAdjCount++;
+                if (c->srIndex < repo.hSpeedThresh && c->slowAdjCount == c->slowAdjThresh) { // Congestion detected
+                        if (c->srIndex > c->highSpeedDelta * HS_DELTA_BACKUP) {              // If room to jump backward
+                                c->srIndex -= c->highSpeedDelta * HS_DELTA_BACKUP; // Large jump backward (staying above start)
+                        } else {
+                                c->srIndex = 0; // Jump backward to start
+                        }
+                } else {
+                        if (c->srIndex > 0) {
+                                c->srIndex--;     // Decrement index (slow path)
+                                ra->retryCount++; // Increment waiting count until fast ramp-up retry
+
+                                if (ra->retryCount >= ra->retryThresh) {
+                                        c->slowAdjCount = 0; // Retry fast ramp-up again
+                                        ra->retryCount  = 0; // Use the same thresholds in the next fast ramp-up
+                                }
+                        }
+                }
+        }
+}
+//----------------------------------------------------------------------------
+//
+// Algorithm D
+//
+// Bracket the maximum sending rate by expanding the rate geometrically (never slower than the high-speed
+// delta of Algorithm B until a bound is known) until congestion is seen or the delay rises over a step,
+// then bisect in rate space between the highest clear rate and the lowest rate found above capacity.
+// Each step is held for the trials spanned by the minimum RTT so that feedback reflects it, and a rise
+// in delay over that hold identifies a rate above capacity before the queue reaches the thresholds.
+// Once the bracket is closed, the index is tracked one row at a time (as with Algorithm B) below the
+// upper bound, and the expansion is restarted from the current rate if a complete sub-interval passes
+// without congestion or delay at the top of the bracket.
+//
+void algo_d_init(int connindex) {
+        register struct connection *c = &conn[connindex];
+        struct raStateD *ra           = &c->raState.d;
+
+        ra->phase = RA_PHASE_EXPAND;
+        ra->lower = c->srIndex;
+        ra->upper = -1;
+        ra->delay = c->lowThresh;
+}
+void algo_d_update(int connindex, int seqerr, int delay) {
+        register struct connection *c = &conn[connindex];
+        struct raStateD *ra           = &c->raState.d;
+        int var, hold;
+        double mbps;
+        BOOL clear, congested, rising, above;
+
+        //
+        // Classify feedback (congestion must be sustained before it ends tracking)
+        //
+        clear     = RA_CLEAR(c, seqerr, delay);
+        congested = FALSE;
+        if (!clear)
+                ra->congSubInt = TRUE;
+        if (RA_CONGESTED(c, seqerr, delay)) {
+                if (++ra->congCount >= c->slowAdjThresh) {
+                        ra->congCount = 0;
+                        congested     = TRUE;
+                }
+        } else {
+                ra->congCount = 0;
+        }
+        if (ra->settle > 0) { // Allow feedback to reflect latest index
+                ra->settle--;
+                return;
+        }
+        rising    = (delay > ra->delay + DELAY_RISE_ALGOD); // Queue grew while step was held
+        ra->delay = delay;
+        hold      = RA_LAGTRIALS(c, trial_usec(connindex));
+
+        switch (ra->phase) {
+        case RA_PHASE_EXPAND:
+                if (clear && !rising) {
+                        ra->lower = c->srIndex;
+                        mbps      = sr_index_mbps(connindex, ra->lower);
+                        var       = sr_rate_index(mbps * GROWTH_ALGOD, c->srContinuous);
+                        if (ra->upper < 0) { // Initial ramp-up, at least the Algorithm B rate of increase
+                                mbps += sr_index_mbps(connindex, c->highSpeedDelta * (hold + 1));
+                                if (var < sr_rate_index(mbps, c->srContinuous))
+                                        var = sr_rate_index(mbps, c->srContinuous);
+                        }
+                        if (var <= ra->lower)
+                                var = ra->lower + 1;
+                        c->srIndex = (var > RA_MAXINDEX(c)) ? RA_MAXINDEX(c) : var;
+                        ra->settle = hold;
+                        return;
+                }
+                if (!RA_CONGESTED(c, seqerr, delay) && !rising)
+                        return; // Hold while feedback is neither clear nor congested
+                ra->upper = c->srIndex;
+                ra->phase = RA_PHASE_BISECT;
+                above     = TRUE;
+                break;
+        case RA_PHASE_BISECT:
+                //
+                // Judge by loss and delay trend (a queue left by the last step may still be draining)
+                //
+                above = (seqerr > c->seqErrThresh || rising);
+                if (above)
+                        ra->upper = c->srIndex;
+                else
+                        ra->lower = c->srIndex;
+                break;
+        default: // RA_PHASE_TRACK
+                if (congested) {
+                        ra->upper = c->srIndex;
+                        ra->phase = RA_PHASE_BISECT;
+                        above     = TRUE;
+                        break;
+                }
+                if (clear) {
+                        if (c->srIndex + 1 < ra->upper)
+                                c->srIndex++;
+                } else if (RA_CONGESTED(c, seqerr, delay)) {
+                        if (c->srIndex > 0) {
+                                ra->upper = c->srIndex;
+                                c->srIndex--;
+                        }
+                }
+                return;
+        }
+
+        //
+        // Bisect current bracket in rate space (lower index may reach upper if conditions improved, or upper may
+        // fall to or below lower if conditions worsened, in which case the lower bound is halved in rate)
+        //
+        if (ra->lower >= ra->upper) {
+                if (!above) {
+                        ra->phase = RA_PHASE_EXPAND; // Resume expansion from new lower bound
+                        return;
+                }
+                ra->lower = sr_rate_index(sr_index_mbps(connindex, ra->upper) / 2.0, c->srContinuous);
+                if (ra->lower >= ra->upper)
+                        ra->lower = ra->upper - 1;
+        }
+        if (ra->upper - ra->lower <= 1) {
+                c->srIndex = ra->lower;
+                ra->phase  = RA_PHASE_TRACK;
+        } else {
+                mbps = (sr_index_mbps(connindex, ra->lower) + sr_index_mbps(connindex, ra->upper)) / 2.0;
+                var  = sr_rate_index(mbps, c->srContinuous);
+                if (var <= ra->lower)
+                        var = ra->lower + 1;
+                else if (var >= ra->upper)
+                        var = ra->upper - 1;
+                c->srIndex = var;
+        }
+        ra->settle = hold;
+}
+void algo_d_subint(int connindex) {
+        register struct connection *c = &conn[connindex];
+        struct raStateD *ra           = &c->raState.d;
+
+        //
+        // Restart expansion (geometric only, upper bound retained) if tracking has reached the top of the
+        // bracket without congestion or delay
+        //
+        if (ra->phase == RA_PHASE_TRACK && !ra->congSubInt && c->srIndex + 1 >= ra->upper) {
+                ra->lower = c->srIndex;
+                ra->phase = RA_PHASE_EXPAND;
+        }
+        ra->congSubInt = FALSE;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_ralgo.h
+ *
+ * This file contains the rate adjustment algorithm interface as well as the
+ * external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_RALGO_H
+#define UDPST_RALGO_H
+
+//----------------------------------------------------------------------------
+//
+// Rate adjustment algorithm interface
+//
+// Each algorithm registers its hooks in the algorithm table at the index of
+// its CHTA_RA_ALGO_x identifier (with its name in rateAdjAlgo[]). Any hook may
+// be NULL. Private per-connection state is kept in the raState union of the
+// connection and is cleared with the connection structure.
+//
+struct rateAdjOps {
+        void (*init)(int);             // Test activation (initialize private state)
+        void (*update)(int, int, int); // Trial interval feedback (seq. errors, delay variation)
+        void (*subint)(int);           // End of sub-interval (prior to update)
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern void ra_init(int);
+extern void ra_update(int, int, int);
+
+#endif /* UDPST_RALGO_H */
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_rss.c
+ *
+ * This file predicts the receive queue of test flows from the receive-side
+ * scaling (RSS) configuration of the local interface, and selects local test
+ * ports that spread the connections of a multi-connection test across queues.
+ *
+ */
+
+#define UDPST_RSS
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_rss.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern int errConn, monConn, aggConn;
+extern char scratch[STRING_SIZE];
+extern struct configuration conf;
+extern struct repository repo;
+extern struct connection *conn;
+
+#ifdef __linux__
+#ifndef ETH_RSS_HASH_TOP
+#define ETH_RSS_HASH_TOP 0x01 // Toeplitz hash function (not in older headers)
+#endif
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+int rss_ethtool(char *, void *);
+int rss_input(struct sockaddr_storage *, struct sockaddr_storage *, uint8_t *);
+uint32_t rss_toeplitz(uint8_t *, int);
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static uint32_t *rssIndir;    // Indirection table (hash to queue)
+static uint32_t rssIndirSize; // Indirection table size
+static uint8_t *rssKey;       // Toeplitz hash key
+static uint32_t rssKeySize;   // Toeplitz hash key size
+static int rssQueues;         // Number of receive queues
+static int *rssQueueCount;    // Queue use count (per selection)
+static BOOL rssL4[2];         // Ports included in hash (IPv4, IPv6)
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Obtain RSS indirection table, hash key and UDP hash fields of interface
+//
+// Populate scratch buffer and return length on error
+//
+int rss_init(char *intf) {
+        int i, var;
+        struct ethtool_rxfh rxfh, *prxfh;
+        struct ethtool_rxnfc rxnfc;
+
+        //
+        // Obtain table and key sizes, then table and key
+        //
+        memset(&rxfh, 0, sizeof(rxfh));
+        rxfh.cmd = ETHTOOL_GRSSH;
+        if (rss_ethtool(intf, &rxfh) < 0) {
+                var = sprintf(scratch, "ERROR: Unable to obtain RSS configuration of %s: %s\n", intf, strerror(errno));
+                return var;
+        }
+        if (rxfh.indir_size == 0 || rxfh.key_size < RSS_INPUT_V4 + sizeof(uint32_t)) {
+                var = sprintf(scratch, "ERROR: RSS indirection table or hash key unavailable on %s\n", intf);
+                return var;
+        }
+        var = (int) (sizeof(struct ethtool_rxfh) + (rxfh.indir_size * sizeof(uint32_t)) + rxfh.key_size);
+        if ((prxfh = calloc(1, (size_t) var)) == NULL) {
+                var = sprintf(scratch, "ERROR: Unable to allocate RSS configuration\n");
+                return var;
+        }
+        prxfh->cmd        = ETHTOOL_GRSSH;
+        prxfh->indir_size = rxfh.indir_size;
+        prxfh->key_size   = rxfh.key_size;
+        if (rss_ethtool(intf, prxfh) < 0) {
+                var = sprintf(scratch, "ERROR: Unable to obtain RSS configuration of %s: %s\n", intf, strerror(errno));
+                free(prxfh);
+                return var;
+        }
+        if (prxfh->hfunc != 0 && (prxfh->hfunc & ETH_RSS_HASH_TOP) == 0) {
+                var = sprintf(scratch, "ERROR: RSS hash function of %s is not Toeplitz\n", intf);
+                free(prxfh);
+                return var;
+        }
+#ifdef RXH_XFRM_SYM_XOR
+        if (prxfh->input_xfrm & RXH_XFRM_SYM_XOR) {
+                var = sprintf(scratch, "ERROR: Symmetric RSS input transform on %s not supported\n", intf);
+                free(prxfh);
+                return var;
+        }
+#endif
+
+        //
+        // Save indirection table and key, and derive the number of queues from the table
+        //
+        rssIndirSize = prxfh->indir_size;
+        rssKeySize   = prxfh->key_size;
+        rssIndir     = malloc(rssIndirSize * sizeof(uint32_t));
+        rssKey       = malloc(rssKeySize);
+        if (rssIndir == NULL || rssKey == NULL) {
+                var = sprintf(scratch, "ERROR: Unable to allocate RSS configuration\n");
+                free(prxfh);
+                return var;
+        }
+        memcpy(rssIndir, prxfh->rss_config, rssIndirSize * sizeof(uint32_t));
+        memcpy(rssKey, (uint8_t *) &prxfh->rss_config[rssIndirSize], rssKeySize);
+        free(prxfh);
+        for (i = 0, rssQueues = 0; i < (int) rssIndirSize; i++) {
+                if ((int) rssIndir[i] >= rssQueues)
+                        rssQueues = (int) rssIndir[i] + 1;
+        }
+        if ((rssQueueCount = calloc((size_t) rssQueues, sizeof(int))) == NULL) {
+                var = sprintf(scratch, "ERROR: Unable to allocate RSS configuration\n");
+                return var;
+        }
+
+        //
+        // Verify that UDP flows are hashed with ports (else selection has no effect)
+        //
+        for (i = 0; i < 2; i++) {
+                memset(&rxnfc, 0, sizeof(rxnfc));
+                rxnfc.cmd       = ETHTOOL_GRXFH;
+                rxnfc.flow_type = (i == 0) ? UDP_V4_FLOW : UDP_V6_FLOW;
+                if (rss_ethtool(intf, &rxnfc) < 0)
+                        continue;
+                if ((rxnfc.data & (RXH_L4_B_0_1 | RXH_L4_B_2_3)) == (RXH_L4_B_0_1 | RXH_L4_B_2_3))
+                        rssL4[i] = TRUE;
+        }
+        if (rssKeySize < RSS_INPUT_MAX + sizeof(uint32_t))
+                rssL4[1] = FALSE; // Key too short for IPv6 input
+        if (!rssL4[0] && !rssL4[1]) {
+                var = sprintf(scratch,
+                              "ERROR: RSS hash of UDP on %s excludes ports (see 'ethtool -N %s rx-flow-hash udp4 sdfn')\n",
+                              intf, intf);
+                return var;
+        }
+        if (conf.verbose) {
+                var = sprintf(scratch, "RSS-aware port selection on %s (Queues: %d, Table: %u, Key: %u, Ports: %s%s)\n", intf,
+                              rssQueues, rssIndirSize, rssKeySize, rssL4[0] ? "UDPv4" : "", rssL4[1] ? " UDPv6" : "");
+                send_proc(monConn, scratch, var);
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Select local port for a flow from the remote address so that it is received on the least
+// used queue of its multi-connection group
+//
+// Return selected port and queue (or zero to let the system assign a port)
+//
+int rss_select_port(int mcIdent, struct sockaddr_storage *remSas, int *queue) {
+        int i, fd, port, start, min, inlen;
+        uint8_t input[RSS_INPUT_MAX];
+        struct sockaddr_storage locSas;
+        socklen_t slen;
+
+        *queue = -1;
+        if (rssQueueCount == NULL)
+                return 0;
+
+        //
+        // Determine the local address used to reach the remote address (via a connected probe socket)
+        //
+        if ((fd = socket(remSas->ss_family, SOCK_DGRAM, 0)) < 0)
+                return 0;
+        slen = (remSas->ss_family == AF_INET6) ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+        if (connect(fd, (struct sockaddr *) remSas, slen) < 0) {
+                close(fd);
+                return 0;
+        }
+        slen = sizeof(locSas);
+        if (getsockname(fd, (struct sockaddr *) &locSas, &slen) < 0) {
+                close(fd);
+                return 0;
+        }
+        close(fd);
+        if ((inlen = rss_input(remSas, &locSas, input)) == 0)
+                return 0;
+
+        //
+        // Count queues already used by the group and determine the minimum
+        //
+        memset(rssQueueCount, 0, (size_t) rssQueues * sizeof(int));
+        for (i = 0; i <= repo.maxConnIndex; i++) {
+                if (conn[i].fd >= 0 && conn[i].mcIdent == mcIdent && conn[i].rssQueue >= 0)
+                        rssQueueCount[conn[i].rssQueue]++;
+        }
+        for (i = 1, min = rssQueueCount[0]; i < rssQueues; i++) {
+                if (rssQueueCount[i] < min)
+                        min = rssQueueCount[i];
+        }
+
+        //
+        // Evaluate candidate ports until one maps to a least used queue and is available
+        //
+        start = getuniform(RSS_PORT_MIN, RSS_PORT_MAX);
+        for (i = 0; i < RSS_PORT_TRIES; i++) {
+                port = RSS_PORT_MIN + ((start - RSS_PORT_MIN + i) % (RSS_PORT_MAX - RSS_PORT_MIN + 1));
+                input[inlen - 2] = (uint8_t) (port >> 8);
+                input[inlen - 1] = (uint8_t) port;
+                *queue = (int) rssIndir[rss_toeplitz(input, inlen) % rssIndirSize];
+                if (rssQueueCount[*queue] > min)
+                        continue;
+                if (locSas.ss_family == AF_INET6) {
+                        ((struct sockaddr_in6 *) &locSas)->sin6_port = htons((uint16_t) port);
+                        slen = sizeof(struct sockaddr_in6);
+                } else {
+                        ((struct sockaddr_in *) &locSas)->sin_port = htons((uint16_t) port);
+                        slen = sizeof(struct sockaddr_in);
+                }
+                if ((fd = socket(locSas.ss_family, SOCK_DGRAM, 0)) < 0)
+                        break;
+                if (bind(fd, (struct sockaddr *) &locSas, slen) == 0) {
+                        close(fd);
+                        return port;
+                }
+                close(fd);
+        }
+        *queue = -1;
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Build Toeplitz hash input (source address, destination address, source port, destination port)
+// from the remote (source) and local (destination) addresses, with IPv4-mapped addresses reduced
+// to IPv4. The destination port is left for the caller.
+//
+// Return input length (or zero if ports are not hashed for the address family)
+//
+int rss_input(struct sockaddr_storage *remSas, struct sockaddr_storage *locSas, uint8_t *input) {
+        struct sockaddr_in *rem4 = (struct sockaddr_in *) remSas, *loc4 = (struct sockaddr_in *) locSas;
+        struct sockaddr_in6 *rem6 = (struct sockaddr_in6 *) remSas, *loc6 = (struct sockaddr_in6 *) locSas;
+
+        if (remSas->ss_family == AF_INET) {
+                if (!rssL4[0])
+                        return 0;
+                memcpy(&input[0], &rem4->sin_addr, 4);
+                memcpy(&input[4], &loc4->sin_addr, 4);
+                memcpy(&input[8], &rem4->sin_port, 2);
+                return RSS_INPUT_V4;
+        } else if (IN6_IS_ADDR_V4MAPPED(&rem6->sin6_addr)) {
+                if (!rssL4[0])
+                        return 0;
+                memcpy(&input[0], &rem6->sin6_addr.s6_addr[12], 4);
+                memcpy(&input[4], &loc6->sin6_addr.s6_addr[12], 4);
+                memcpy(&input[8], &rem6->sin6_port, 2);
+                return RSS_INPUT_V4;
+        }
+        if (!rssL4[1])
+                return 0;
+        memcpy(&input[0], &rem6->sin6_addr, 16);
+        memcpy(&input[16], &loc6->sin6_addr, 16);
+        memcpy(&input[32], &rem6->sin6_port, 2);
+        return RSS_INPUT_MAX;
+}
+//----------------------------------------------------------------------------
+//
+// Compute Toeplitz hash of input using RSS key
+//
+uint32_t rss_toeplitz(uint8_t *input, int len) {
+        int i, b;
+        uint32_t hash = 0, window;
+
+        window = ((uint32_t) rssKey[0] << 24) | ((uint32_t) rssKey[1] << 16) | ((uint32_t) rssKey[2] << 8) | rssKey[3];
+        for (i = 0; i < len; i++) {
+                for (b = 7; b >= 0; b--) {
+                        if (input[i] & (1 << b))
+                                hash ^= window;
+                        window <<= 1;
+                        if (rssKey[i + 4] & (1 << b))
+                                window |= 1;
+                }
+        }
+        return hash;
+}
+//----------------------------------------------------------------------------
+//
+// Issue ethtool command for interface
+//
+int rss_ethtool(char *intf, void *cmd) {
+        int fd, var;
+        struct ifreq ifr;
+
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, intf, IFNAMSIZ - 1);
+        ifr.ifr_data = (void *) cmd;
+        if ((fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
+                return -1;
+        var = ioctl(fd, SIOCETHTOOL, &ifr);
+        close(fd);
+        return var;
+}
+#else
+//----------------------------------------------------------------------------
+//
+// RSS-aware port selection unavailable without ethtool support
+//
+int rss_init(char *intf) {
+        return sprintf(scratch, "ERROR: RSS-aware port selection not supported\n");
+}
+int rss_select_port(int mcIdent, struct sockaddr_storage *remSas, int *queue) {
+        *queue = -1;
+        return 0;
+}
+#endif // __linux__
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_rss.h
+ *
+ * This file contains the RSS-aware port selection constants as well as the
+ * external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_RSS_H
+#define UDPST_RSS_H
+
+//----------------------------------------------------------------------------
+//
+// RSS-aware port selection
+//
+// The receive-side scaling (RSS) indirection table and Toeplitz key of the
+// local interface are obtained via ethtool so that the receive queue of a flow
+// can be predicted. Candidate local ports are then evaluated (starting at a
+// random point within the range) until one maps the flow to the least used
+// queue of its multi-connection group.
+//
+#define RSS_PORT_MIN   32768 // Minimum candidate port
+#define RSS_PORT_MAX   60999 // Maximum candidate port
+#define RSS_PORT_TRIES 4096  // Maximum candidate ports evaluated
+#define RSS_INPUT_V4   12    // Hash input size (IPv4 addresses and ports)
+#define RSS_INPUT_MAX  36    // Maximum hash input (IPv6 addresses and ports)
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int rss_init(char *);
+extern int rss_select_port(int, struct sockaddr_storage *, int *);
+
+#endif /* UDPST_RSS_H */
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_shmread.c
+ *
+ * This file maps the shared-memory statistics segment of a server instance
+ * (read-only) and takes consistent snapshots of it via its sequence locks.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+//
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_shmstats.h"
+#include "udpst_shmread.h"
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+BOOL shmread_copy(const uint32_t *, void *, const void *, size_t);
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Map segment and validate header
+//
+// Output error to stderr and return -1 on failure
+//
+int shmread_open(struct shmReader *rd, char *fname) {
+        int fd;
+        struct stat st;
+        const struct shmStatsHeader *sh;
+
+        memset(rd, 0, sizeof(struct shmReader));
+        if ((fd = open(fname, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+                fprintf(stderr, "OPEN ERROR: <%s> %s\n", fname, strerror(errno));
+                if (fd >= 0)
+                        close(fd);
+                return -1;
+        }
+        rd->size = (size_t) st.st_size;
+        if (rd->size < sizeof(struct shmStatsHeader)) {
+                fprintf(stderr, "ERROR: <%s> is not a statistics segment (or is being created)\n", fname);
+                close(fd);
+                return -1;
+        }
+        if ((rd->sh = mmap(NULL, rd->size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+                fprintf(stderr, "MMAP ERROR: <%s> %s\n", fname, strerror(errno));
+                rd->sh = NULL;
+                close(fd);
+                return -1;
+        }
+        close(fd);
+
+        //
+        // Validate header (identifier is written last by the server)
+        //
+        sh = rd->sh;
+        if (memcmp(sh->magic, SHMSTATS_MAGIC, sizeof(sh->magic)) != 0) {
+                fprintf(stderr, "ERROR: <%s> is not a statistics segment (or is being created)\n", fname);
+                shmread_close(rd);
+                return -1;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (sh->byteOrder != SHMSTATS_BYTE_ORDER) {
+                fprintf(stderr, "ERROR: Segment byte order does not match local system\n");
+                shmread_close(rd);
+                return -1;
+        }
+        if (sh->version != SHMSTATS_VERSION || sh->headerSize != sizeof(struct shmStatsHeader) ||
+            sh->connSize != sizeof(struct shmStatsConn)) {
+                fprintf(stderr, "ERROR: <%s> Unsupported segment version (%u)\n", fname, sh->version);
+                shmread_close(rd);
+                return -1;
+        }
+        if (sh->connOffset < sh->headerSize || sh->connOffset > rd->size ||
+            sh->connSlots > (rd->size - sh->connOffset) / sh->connSize) {
+                fprintf(stderr, "ERROR: <%s> Invalid connection slot layout\n", fname);
+                shmread_close(rd);
+                return -1;
+        }
+        rd->connSlots = sh->connSlots;
+        if ((rd->conn = calloc(rd->connSlots > 0 ? rd->connSlots : 1, sizeof(struct shmStatsConn))) == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation failure\n");
+                shmread_close(rd);
+                return -1;
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Take snapshot of global statistics, last record and connection slots
+//
+// Return count of connection slots in use (slots without a consistent copy are
+// returned as unused), or -1 if the global statistics could not be copied
+//
+int shmread_snapshot(struct shmReader *rd) {
+        int count = 0;
+        uint32_t i;
+        const struct shmStatsHeader *sh = rd->sh;
+
+        rd->stale = (kill((pid_t) sh->pid, 0) == -1 && errno == ESRCH);
+        if (!shmread_copy(&sh->global.seq, &rd->global, &sh->global, sizeof(struct shmStatsGlobal)))
+                return -1;
+        if (!shmread_copy(&sh->record.seq, &rd->record, &sh->record, sizeof(struct shmStatsRecord)))
+                memset(&rd->record, 0, sizeof(struct shmStatsRecord));
+        for (i = 0; i < rd->connSlots; i++) {
+                if (!shmread_copy(&SHMSTATS_CONN(sh, i)->seq, &rd->conn[i], SHMSTATS_CONN(sh, i),
+                                  sizeof(struct shmStatsConn)))
+                        rd->conn[i].testType = TEST_TYPE_UNK;
+                if (rd->conn[i].testType != TEST_TYPE_UNK)
+                        count++;
+        }
+        return count;
+}
+//----------------------------------------------------------------------------
+//
+// Unmap segment
+//
+void shmread_close(struct shmReader *rd) {
+        if (rd->sh != NULL)
+                munmap((void *) rd->sh, rd->size);
+        if (rd->conn != NULL)
+                free(rd->conn);
+        memset(rd, 0, sizeof(struct shmReader));
+}
+//----------------------------------------------------------------------------
+//
+// Copy area protected by sequence lock
+//
+// A copy is retried if an update was in progress (odd sequence) or completed
+// during the copy (changed sequence), return FALSE if no consistent copy could
+// be taken (i.e., the server stopped in the middle of an update)
+//
+BOOL shmread_copy(const uint32_t *seqp, void *dst, const void *src, size_t len) {
+        int i;
+        uint32_t seq;
+
+        for (i = 0; i < SHMREAD_RETRIES; i++) {
+                if ((seq = __atomic_load_n(seqp, __ATOMIC_ACQUIRE)) & 1) {
+                        sched_yield(); // Allow writer to complete update
+                        continue;
+                }
+                memcpy(dst, src, len);
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(seqp, __ATOMIC_RELAXED) == seq)
+                        return TRUE;
+        }
+        return FALSE;
+}
+//----------------------------------------------------------------------------
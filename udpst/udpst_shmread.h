@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_shmread.h
+ *
+ * This file contains the definitions and external function prototypes used by
+ * readers of the shared-memory statistics segments of server instances.
+ *
+ */
+
+#ifndef UDPST_SHMREAD_H
+#define UDPST_SHMREAD_H
+
+//----------------------------------------------------------------------------
+//
+// Mapped (read-only) segment and its last snapshot
+//
+#define SHMREAD_RETRIES 1000 // Sequence lock retries before an area is deemed inconsistent
+struct shmReader {
+        size_t size;                     // Size of mapped segment
+        const struct shmStatsHeader *sh; // Mapped segment
+        struct shmStatsGlobal global;    // Snapshot of global statistics
+        struct shmStatsRecord record;    // Snapshot of last record
+        struct shmStatsConn *conn;       // Snapshot of connection slots (array)
+        uint32_t connSlots;              // Size of connection slot array
+        BOOL stale;                       // Server process no longer exists
+};
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int shmread_open(struct shmReader *, char *);
+extern int shmread_snapshot(struct shmReader *);
+extern void shmread_close(struct shmReader *);
+
+#endif /* UDPST_SHMREAD_H */
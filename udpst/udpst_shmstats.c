@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_shmstats.c
+ *
+ * This file publishes server performance statistics and the live state of
+ * each test connection into a shared-memory segment, allowing any number of
+ * local readers (see udpst-stat) to take consistent snapshots without
+ * involving the server.
+ *
+ */
+
+#define UDPST_SHMSTATS
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_srates.h"
+#include "udpst_shmstats.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+uint64_t shm_time(struct timespec *);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern char scratch[STRING_SIZE];
+extern struct configuration conf;
+extern struct repository repo;
+extern struct connection *conn;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+static struct shmStatsHeader *shmHdr; // Mapped segment (NULL = not published)
+static size_t shmSize;                // Size of mapped segment
+static char shmPath[PATH_MAX];        // Pathname of segment
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Create and map shared-memory statistics segment of server
+//
+// Populate scratch buffer and return length on error
+//
+int shmstats_init(int connindex) {
+        int fd, var;
+        size_t offset;
+        struct shmStatsHeader *sh;
+
+        snprintf(shmPath, sizeof(shmPath), SHMSTATS_DIR SHMSTATS_PREFIX "%d", (int) getpid());
+        offset  = SHMSTATS_ALIGNUP(sizeof(struct shmStatsHeader));
+        shmSize = offset + (size_t) conf.maxConnections * sizeof(struct shmStatsConn);
+
+        //
+        // Create segment (a leftover from a prior process with the same PID is replaced) and map it, the
+        // file is zero-filled so every connection slot starts out unused
+        //
+        if ((fd = open(shmPath, O_RDWR | O_CREAT | O_TRUNC, 0644)) == -1) {
+                return sprintf(scratch, "OPEN ERROR: <%.*s> %s\n", NAME_MAX, shmPath, strerror(errno));
+        }
+        if (ftruncate(fd, (off_t) shmSize) == -1) {
+                var = sprintf(scratch, "FTRUNCATE ERROR: <%.*s> %s\n", NAME_MAX, shmPath, strerror(errno));
+                close(fd);
+                unlink(shmPath);
+                return var;
+        }
+        if ((sh = mmap(NULL, shmSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+                var = sprintf(scratch, "MMAP ERROR: <%.*s> %s\n", NAME_MAX, shmPath, strerror(errno));
+                close(fd);
+                unlink(shmPath);
+                return var;
+        }
+        close(fd);
+
+        //
+        // Populate static header info, the identifier is set last so readers ignore a partial header
+        //
+        sh->version     = SHMSTATS_VERSION;
+        sh->protocolVer = PROTOCOL_VER;
+        sh->byteOrder   = SHMSTATS_BYTE_ORDER;
+        sh->headerSize  = (uint32_t) sizeof(struct shmStatsHeader);
+        sh->connOffset  = (uint32_t) offset;
+        sh->connSize    = (uint32_t) sizeof(struct shmStatsConn);
+        sh->connSlots   = (uint32_t) conf.maxConnections;
+        sh->pid         = (int32_t) getpid();
+        sh->locPort     = (int32_t) conn[connindex].locPort;
+        sh->startTime   = shm_time(&repo.startTime);
+        snprintf(sh->swVersion, sizeof(sh->swVersion), "%s", SOFTWARE_VER);
+        snprintf(sh->locAddr, sizeof(sh->locAddr), "%s", conn[connindex].locAddr);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(sh->magic, SHMSTATS_MAGIC, sizeof(sh->magic));
+        shmHdr = sh;
+
+        shmstats_global();
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Publish counters and current connection/bandwidth usage (invoked via global maximums timer)
+//
+void shmstats_global(void) {
+        int i, count;
+        struct shmStatsGlobal *sg;
+
+        if (shmHdr == NULL)
+                return;
+        for (i = 0, count = 0; i <= repo.maxConnIndex; i++) {
+                if (conn[i].type == T_UDP && conn[i].state == S_DATA && conn[i].testAction == TEST_ACT_TEST &&
+                    conn[i].testType != TEST_TYPE_UNK)
+                        count++;
+        }
+        sg = &shmHdr->global;
+        SHMSTATS_WRITE_BEGIN(&sg->seq);
+        sg->connCount   = (uint32_t) (repo.maxConnIndex - repo.idleConnIndex);
+        sg->testCount   = (uint32_t) count;
+        sg->usBandwidth = (int32_t) repo.usBandwidth;
+        sg->dsBandwidth = (int32_t) repo.dsBandwidth;
+        sg->updateTime  = shm_time(&repo.systemClock);
+        memcpy(&sg->counters, &repo.psCounters, sizeof(struct perfStatsCounters));
+        SHMSTATS_WRITE_END(&sg->seq);
+}
+//----------------------------------------------------------------------------
+//
+// Publish maximums and averages of the performance statistics record just completed
+//
+void shmstats_record(void) {
+        struct timespec tspecvar;
+        struct shmStatsRecord *sr;
+
+        if (shmHdr == NULL)
+                return;
+        tspecminus(&repo.systemClock, &repo.psRecordTime, &tspecvar);
+        sr = &shmHdr->record;
+        SHMSTATS_WRITE_BEGIN(&sr->seq);
+        sr->recordCount++;
+        sr->startTime = shm_time(&repo.psRecordTime);
+        sr->deltaTime = shm_time(&tspecvar);
+        memcpy(&sr->maximums, &repo.psMaximums, sizeof(struct perfStatsMaximums));
+        memcpy(&sr->averages, &repo.psAverages, sizeof(struct perfStatsAverages));
+        SHMSTATS_WRITE_END(&sr->seq);
+}
+//----------------------------------------------------------------------------
+//
+// Publish live state of test connection (invoked after each sending rate adjustment)
+//
+void shmstats_conn(int connindex) {
+        register struct connection *c = &conn[connindex];
+        struct shmStatsConn *sc;
+
+        if (shmHdr == NULL || connindex >= (int) shmHdr->connSlots)
+                return;
+        sc = SHMSTATS_CONN(shmHdr, connindex);
+        SHMSTATS_WRITE_BEGIN(&sc->seq);
+        if (sc->testType == TEST_TYPE_UNK) { // Connection identity only set once per test
+                snprintf(sc->remAddr, sizeof(sc->remAddr), "%s", c->remAddr);
+                sc->remPort    = (uint16_t) c->remPort;
+                sc->seqErrLoss = 0;
+        }
+        sc->testType = (uint8_t) c->testType;
+        sc->srIndex  = (int32_t) c->srIndex;
+        if (c->srIndex >= 0 && (c->srContinuous || c->srIndex < repo.maxSendingRates))
+                sc->rateMbps = sr_index_mbps(connindex, c->srIndex);
+        else
+                sc->rateMbps = 0.0;
+        if (c->rttMinimumUs != STATUS_NODEL)
+                sc->rttMinimum = (uint32_t) c->rttMinimumUs;
+        else if (c->rttMinimum != STATUS_NODEL)
+                sc->rttMinimum = (uint32_t) c->rttMinimum * USECINMSEC;
+        else
+                sc->rttMinimum = STATUS_NODEL;
+        if (sc->subIntSeqNo != (uint32_t) c->subIntSeqNo) { // Sub-interval values only change once per sub-interval
+                sc->subIntSeqNo   = (uint32_t) c->subIntSeqNo;
+                sc->siRateMbps    = get_rate(connindex, &c->sisSav, L3DG_OVERHEAD);
+                sc->siRxDatagrams = c->sisSav.rxDatagrams;
+                sc->siSeqErrLoss  = c->sisSav.seqErrLoss;
+                sc->siDelayVarMax = c->sisSav.delayVarMax;
+        }
+        sc->seqErrLoss += (uint64_t) c->seqErrLoss; // Loss of trial interval just processed
+        sc->updateTime = shm_time(&repo.systemClock);
+        SHMSTATS_WRITE_END(&sc->seq);
+}
+//----------------------------------------------------------------------------
+//
+// Mark connection slot unused (invoked when connection is cleaned up)
+//
+void shmstats_clear(int connindex) {
+        struct shmStatsConn *sc;
+
+        if (shmHdr == NULL || connindex >= (int) shmHdr->connSlots)
+                return;
+        sc = SHMSTATS_CONN(shmHdr, connindex);
+        if (sc->testType == TEST_TYPE_UNK)
+                return;
+        SHMSTATS_WRITE_BEGIN(&sc->seq);
+        sc->testType    = TEST_TYPE_UNK;
+        sc->subIntSeqNo = 0;
+        SHMSTATS_WRITE_END(&sc->seq);
+}
+//----------------------------------------------------------------------------
+//
+// Unmap and remove segment
+//
+void shmstats_close(void) {
+        if (shmHdr == NULL)
+                return;
+        munmap(shmHdr, shmSize);
+        unlink(shmPath);
+        shmHdr = NULL;
+}
+//----------------------------------------------------------------------------
+//
+// Convert time to nanoseconds
+//
+uint64_t shm_time(struct timespec *tspec) {
+        return (uint64_t) tspec->tv_sec * NSECINSEC + (uint64_t) tspec->tv_nsec;
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_shmstats.h
+ *
+ * This file contains the shared-memory statistics segment layout as well as
+ * the external function prototypes for the associated module.
+ *
+ */
+
+#ifndef UDPST_SHMSTATS_H
+#define UDPST_SHMSTATS_H
+
+//----------------------------------------------------------------------------
+//
+// Shared-memory statistics segment
+//
+// Each server instance publishes its statistics into /dev/shm/udpst.<pid>. The
+// segment starts with a header, followed by one slot per connection index. The
+// global, record and slot areas are each protected by a sequence lock: the
+// (single) writer makes the sequence odd, updates the area in place and makes
+// it even again, while readers retry any copy taken with an odd or changed
+// sequence. Updates are plain memory stores, so publishing costs no system
+// calls and readers never block the server.
+//
+// NOTE: The version must be incremented whenever this layout, or that of the
+// perfStats structures it includes, changes. All fields are in host byte order.
+//
+#define SHMSTATS_DIR        "/dev/shm/" // Directory of segments
+#define SHMSTATS_PREFIX     "udpst."    // Segment name prefix (followed by PID)
+#define SHMSTATS_MAGIC      "UDPSTSHM"  // Segment identifier
+#define SHMSTATS_VERSION    2           // Segment layout version
+#define SHMSTATS_BYTE_ORDER 0x01020304  // Byte order indicator
+#define SHMSTATS_ALIGN      64          // Slot alignment (bytes)
+#define SHMSTATS_ADDR_SIZE  64          // Address string size
+#define SHMSTATS_VER_SIZE   32          // Software version string size
+#define SHMSTATS_ALIGNUP(x) (((x) + SHMSTATS_ALIGN - 1) & ~((size_t) SHMSTATS_ALIGN - 1))
+struct shmStatsGlobal {
+        uint32_t seq;                      // Sequence lock
+        uint32_t connCount;                // Connections in use
+        uint32_t testCount;                // Active test connections
+        int32_t usBandwidth;               // Upstream bandwidth allocated
+        int32_t dsBandwidth;               // Downstream bandwidth allocated
+        uint32_t reserved;                 // (reserved for alignment)
+        uint64_t updateTime;               // Time of update (ns)
+        struct perfStatsCounters counters; // Performance statistics (Counters)
+};
+struct shmStatsRecord {
+        uint32_t seq;                      // Sequence lock
+        uint32_t recordCount;              // Records completed
+        uint64_t startTime;                // Start time of last record (ns)
+        uint64_t deltaTime;                // Interval of last record (ns)
+        struct perfStatsMaximums maximums; // Performance statistics (Maximums)
+        struct perfStatsAverages averages; // Performance statistics (Averages)
+};
+struct shmStatsConn {
+        uint32_t seq;                     // Sequence lock
+        uint8_t testType;                 // Test type (TEST_TYPE_UNK = slot unused)
+        uint8_t reserved1;                // (reserved for alignment)
+        uint16_t remPort;                 // Remote port
+        int32_t srIndex;                  // Sending rate index
+        uint32_t rttMinimum;              // Minimum round-trip time (us, STATUS_NODEL = none)
+        double rateMbps;                  // Nominal sending rate (Mbps)
+        double siRateMbps;                // Sub-interval receive rate (Mbps at L3/IP)
+        uint64_t updateTime;              // Time of update (ns)
+        uint32_t subIntSeqNo;             // Sub-interval sequence number
+        uint32_t siRxDatagrams;           // Sub-interval received datagrams
+        uint32_t siSeqErrLoss;            // Sub-interval loss
+        uint32_t siDelayVarMax;           // Sub-interval delay variation maximum (ms)
+        uint64_t seqErrLoss;              // Loss sum of test (trial intervals)
+        char remAddr[SHMSTATS_ADDR_SIZE]; // Remote IP address as string
+};
+struct shmStatsHeader {
+        char magic[8];                     // Segment identifier (set last)
+        uint16_t version;                  // Segment layout version
+        uint16_t protocolVer;              // Protocol version
+        uint32_t byteOrder;                // Byte order indicator
+        uint32_t headerSize;               // Size of header
+        uint32_t connOffset;               // Offset of first connection slot
+        uint32_t connSize;                 // Size of connection slot
+        uint32_t connSlots;                // Connection slots
+        int32_t pid;                       // Process ID of server
+        int32_t locPort;                   // Control port
+        uint64_t startTime;                // Process start time (ns)
+        char swVersion[SHMSTATS_VER_SIZE]; // Software version
+        char locAddr[SHMSTATS_ADDR_SIZE];  // Local address of control port
+        struct shmStatsGlobal global;      // Global statistics
+        struct shmStatsRecord record;      // Last performance statistics record
+};
+#define SHMSTATS_CONN(sh, i) \
+        ((struct shmStatsConn *) ((unsigned char *) (sh) + (sh)->connOffset + (size_t) (i) * (sh)->connSize))
+//
+// Sequence lock writer (single writer, readers see an odd sequence while an update is in progress)
+//
+#define SHMSTATS_WRITE_BEGIN(seqp)                                       \
+        do {                                                             \
+                __atomic_store_n((seqp), *(seqp) + 1, __ATOMIC_RELAXED); \
+                __atomic_thread_fence(__ATOMIC_RELEASE);                 \
+        } while (0)
+#define SHMSTATS_WRITE_END(seqp) __atomic_store_n((seqp), *(seqp) + 1, __ATOMIC_RELEASE)
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int shmstats_init(int);
+extern void shmstats_global(void);
+extern void shmstats_record(void);
+extern void shmstats_conn(int);
+extern void shmstats_clear(int);
+extern void shmstats_close(void);
+
+#endif /* UDPST_SHMSTATS_H */
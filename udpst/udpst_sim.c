@@ -0,0 +1,915 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_sim.c
+ *
+ * This file contains a standalone utility that simulates tests against a model
+ * of a bottleneck link (capacity, buffer, base RTT and random loss), or against
+ * a capacity profile inferred from a binary output (export) archive file. The
+ * server rate adjustment (adjust_sending_rate) and sub-interval accounting
+ * (proc_subinterval) are driven directly from the core library, so the results
+ * reflect the actual algorithm code. For each link profile, the time to
+ * converge, overshoot and loss are reported, and results can be saved and
+ * compared as a regression gate.
+ *
+ */
+
+#define UDPST_SIM
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#ifdef AUTH_KEY_ENABLE
+#include <openssl/hmac.h>
+#include <openssl/x509.h>
+#endif
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_data.h"
+#include "udpst_ralgo.h"
+#include "udpst_srates.h"
+#include "udpst_export.h"
+#include "udpst_archive.h"
+
+//----------------------------------------------------------------------------
+//
+// Global data (normally defined by udpst.c and referenced by the core library)
+//
+int errConn = -1, monConn = -1, aggConn = -1;
+char scratch[STRING_SIZE];
+struct configuration conf;
+struct repository repo;
+struct connection *conn;
+char *boolText[]    = {"Disabled", "Enabled"};
+char *rateAdjAlgo[] = {"B", "C", "D"}; // Aligned to CHTA_RA_ALGO_x
+cJSON *json_top = NULL, *json_output = NULL, *json_siArray = NULL;
+char json_errbuf[STRING_SIZE], json_errbuf2[STRING_SIZE];
+//
+#define DEF_SIM_RUNS     100     // Simulated tests per profile
+#define MAX_SIM_RUNS     1000000 //
+#define DEF_SIM_TOL      10      // Convergence tolerance (% of capacity)
+#define DEF_GATE_TOL     10      // Regression gate tolerance (% of baseline)
+#define DEF_TRACE_BUFFER 50      // Buffer used with trace capacity profile (ms)
+#define DEF_TRACE_RTT    20      // RTT used with trace profile when unavailable (ms)
+#define MAX_PROFILES     64      // Max link profiles
+#define RATE_HISTORY     2048    // Rate history for feedback lag and sub-interval window (trials)
+#define PROFILE_NAME     32      // Max profile name size
+//
+struct profile {
+        char name[PROFILE_NAME]; // Profile name
+        double capacity;         // Bottleneck capacity (Mbps)
+        double bufferMs;         // Bottleneck buffer (ms at capacity)
+        double rttMs;            // Base round-trip time (ms)
+        double lossRatio;        // Random loss ratio
+        double *capSeries;       // Capacity per trial (trace), else NULL
+        int capCount;            // Capacity series size
+};
+static struct profile defProfile[] = {
+    {"dsl-25", 25.0, 100.0, 30.0, 0.0, NULL, 0},          {"cable-300", 300.0, 60.0, 15.0, 0.0, NULL, 0},
+    {"fiber-1g", 1000.0, 20.0, 5.0, 0.0, NULL, 0},        {"fiber-2.5g", 2500.0, 10.0, 4.0, 0.0, NULL, 0},
+    {"fiber-10g", 10000.0, 5.0, 2.0, 0.0, NULL, 0},       {"shallow-1g", 1000.0, 1.0, 5.0, 0.0, NULL, 0},
+    {"bloat-100", 100.0, 1000.0, 20.0, 0.0, NULL, 0},     {"lte-50-loss", 50.0, 150.0, 45.0, 1.0E-4, NULL, 0},
+    {"wifi-400-loss", 400.0, 30.0, 8.0, 1.0E-3, NULL, 0}, {"sat-100", 100.0, 300.0, 600.0, 1.0E-5, NULL, 0}};
+#define DEF_PROFILES (int) (sizeof(defProfile) / sizeof(struct profile))
+//
+struct simResult {
+        double convTime;  // Time to converge (sec), < 0 if never
+        double overshoot; // Max sending rate above capacity (%)
+        double lossPct;   // Lost datagrams (% of sent)
+        double utilPct;   // Delivered rate (% of capacity)
+};
+struct simSummary {
+        char name[PROFILE_NAME]; // Profile name
+        int runs;                // Simulated tests
+        int converged;           // Tests that converged
+        double convAvg;          // Average time to converge (sec)
+        double convP95;          // 95th percentile time to converge (sec)
+        double overAvg;          // Average overshoot (%)
+        double overMax;          // Maximum overshoot (%)
+        double lossAvg;          // Average loss (%)
+        double utilAvg;          // Average delivered rate (% of capacity)
+};
+static uint64_t rngState = 0x9E3779B97F4A7C15ULL; // PRNG state (xorshift64*)
+static BOOL simVerbose    = FALSE;                 // Output sub-intervals (conf.verbose would invoke core output)
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void sim_init_conn(int);
+void sim_test(struct profile *, int, BOOL, struct simResult *);
+void sim_profile(struct profile *, int, int, struct simSummary *);
+double sim_mbps(struct sendingRate *, double *);
+double sim_uniform(void);
+unsigned int sim_poisson(double);
+int load_profiles(char *, struct profile *, int);
+int load_trace(char *, struct profile *, int);
+int save_baseline(char *, struct simSummary *, int);
+int check_baseline(char *, struct simSummary *, int, double);
+int cmp_double(const void *, const void *);
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Simulate tests for each link profile
+//
+int main(int argc, char **argv) {
+        int i, var, runs = DEF_SIM_RUNS, pcount = DEF_PROFILES, convtol = DEF_SIM_TOL, gatetol = DEF_GATE_TOL;
+        char *pfile = NULL, *tfile = NULL, *wfile = NULL, *bfile = NULL, convavg[16], convp95[16];
+        double elapsed;
+        struct timespec tstart, tend;
+        struct profile *pf, profile[MAX_PROFILES];
+        struct simSummary *ss;
+
+        //
+        // Initialize configuration and repository as a server with default test parameters
+        //
+        memset(&conf, 0, sizeof(conf));
+        memset(&repo, 0, sizeof(repo));
+        repo.isServer       = TRUE;
+        conf.jumboStatus    = DEF_JUMBO_STATUS;
+        conf.lowThresh      = DEF_LOW_THRESH;
+        conf.upperThresh    = DEF_UPPER_THRESH;
+        conf.trialInt       = DEF_TRIAL_INT;
+        conf.testIntTime    = DEF_TESTINT_TIME;
+        conf.subIntPeriod   = DEF_SUBINT_PERIOD;
+        conf.slowAdjThresh  = DEF_SLOW_ADJ_TH;
+        conf.highSpeedDelta = DEF_HS_DELTA;
+        conf.seqErrThresh   = DEF_SEQ_ERR_TH;
+        conf.useOwDelVar    = DEF_USE_OWDELVAR;
+        conf.ignoreOooDup   = DEF_IGNORE_OOODUP;
+        conf.rateAdjAlgo    = DEF_RA_ALGO;
+
+        while ((i = getopt(argc, argv, "A:gjTot:F:P:L:U:c:h:q:n:r:x:p:O:w:b:G:v")) != -1) {
+                switch (i) {
+                case 'A':
+                        for (var = CHTA_RA_ALGO_MIN; var <= CHTA_RA_ALGO_MAX; var++) {
+                                if (strcasecmp(optarg, rateAdjAlgo[var]) == 0)
+                                        break;
+                        }
+                        if (var > CHTA_RA_ALGO_MAX) {
+                                fprintf(stderr, "ERROR: '%s' is not a valid rate adjustment algorithm\n", optarg);
+                                return EXIT_FAILURE;
+                        }
+                        conf.rateAdjAlgo = var;
+                        break;
+                case 'g':
+                        conf.srContinuous = TRUE;
+                        break;
+                case 'j':
+                        conf.jumboStatus = !DEF_JUMBO_STATUS;
+                        break;
+                case 'T':
+                        conf.traditionalMTU = TRUE;
+                        break;
+                case 'o':
+                        conf.useOwDelVar = TRUE;
+                        break;
+                case 't':
+                        conf.testIntTime = atoi(optarg);
+                        break;
+                case 'F':
+                        conf.trialInt = atoi(optarg);
+                        break;
+                case 'P':
+                        conf.subIntPeriod = atoi(optarg);
+                        break;
+                case 'L':
+                        conf.lowThresh = atoi(optarg);
+                        break;
+                case 'U':
+                        conf.upperThresh = atoi(optarg);
+                        break;
+                case 'c':
+                        conf.slowAdjThresh = atoi(optarg);
+                        break;
+                case 'h':
+                        conf.highSpeedDelta = atoi(optarg);
+                        break;
+                case 'q':
+                        conf.seqErrThresh = atoi(optarg);
+                        break;
+                case 'n':
+                        runs = atoi(optarg);
+                        break;
+                case 'r':
+                        rngState = strtoull(optarg, NULL, 0) | 1;
+                        break;
+                case 'x':
+                        convtol = atoi(optarg);
+                        break;
+                case 'p':
+                        pfile = optarg;
+                        break;
+                case 'O':
+                        tfile = optarg;
+                        break;
+                case 'w':
+                        wfile = optarg;
+                        break;
+                case 'b':
+                        bfile = optarg;
+                        break;
+                case 'G':
+                        gatetol = atoi(optarg);
+                        break;
+                case 'v':
+                        simVerbose = TRUE;
+                        break;
+                default:
+                        fprintf(stderr, "Usage: %s [option]...\n", argv[0]);
+                        fprintf(stderr, "    -A algo      Rate adjustment algorithm (%s - %s) [Default %s]\n",
+                                rateAdjAlgo[CHTA_RA_ALGO_MIN], rateAdjAlgo[CHTA_RA_ALGO_MAX], rateAdjAlgo[DEF_RA_ALGO]);
+                        fprintf(stderr, "    -g           Continuous (table-free) sending rates\n");
+                        fprintf(stderr, "    -j           Disable jumbo datagram sizes above 1 Gbps\n");
+                        fprintf(stderr, "    -T           Use datagram sizes for traditional (1500 byte) MTU\n");
+                        fprintf(stderr, "    -o           Use One-Way Delay instead of RTT for delay variation\n");
+                        fprintf(stderr, "    -t time      Test interval time in seconds [Default %d]\n", DEF_TESTINT_TIME);
+                        fprintf(stderr, "    -F interval  Status feedback/trial interval in ms [Default %d]\n", DEF_TRIAL_INT);
+                        fprintf(stderr, "    -P period    Sub-interval period in ms [Default %d]\n", DEF_SUBINT_PERIOD);
+                        fprintf(stderr, "    -L delvar    Low delay variation threshold in ms [Default %d]\n", DEF_LOW_THRESH);
+                        fprintf(stderr, "    -U delvar    Upper delay variation threshold in ms [Default %d]\n", DEF_UPPER_THRESH);
+                        fprintf(stderr, "    -c thresh    Congestion slow adjustment threshold [Default %d]\n", DEF_SLOW_ADJ_TH);
+                        fprintf(stderr, "    -h delta     High-speed (row adjustment) delta [Default %d]\n", DEF_HS_DELTA);
+                        fprintf(stderr, "    -q seqerr    Sequence error threshold [Default %d]\n", DEF_SEQ_ERR_TH);
+                        fprintf(stderr, "    -n runs      Simulated tests per profile [Default %d]\n", DEF_SIM_RUNS);
+                        fprintf(stderr, "    -r seed      Random seed\n");
+                        fprintf(stderr, "    -x percent   Convergence tolerance around capacity [Default %d]\n", DEF_SIM_TOL);
+                        fprintf(stderr, "    -p file      Link profiles (name mbps buffer_ms rtt_ms loss_ratio per line)\n");
+                        fprintf(stderr, "    -O binfile   Capacity profile inferred from binary output (export) file\n");
+                        fprintf(stderr, "    -w file      Write results as regression baseline\n");
+                        fprintf(stderr, "    -b file      Compare results to regression baseline (exit status)\n");
+                        fprintf(stderr, "    -G percent   Regression gate tolerance [Default %d]\n", DEF_GATE_TOL);
+                        fprintf(stderr, "    -v           Output sub-interval rates of first test per profile\n");
+                        return EXIT_FAILURE;
+                }
+        }
+        if (conf.testIntTime < MIN_TESTINT_TIME || conf.testIntTime > MAX_TESTINT_TIME ||
+            conf.trialInt < MIN_TRIAL_INT || conf.trialInt > MAX_TRIAL_INT || conf.subIntPeriod < MIN_SUBINT_PERIOD ||
+            conf.subIntPeriod > MAX_SUBINT_PERIOD || conf.subIntPeriod % conf.trialInt != 0 || runs < 1 ||
+            runs > MAX_SIM_RUNS || convtol < 1 || gatetol < 0) {
+                fprintf(stderr, "ERROR: Test parameter out-of-range (sub-interval must be multiple of trial interval)\n");
+                return EXIT_FAILURE;
+        }
+
+        //
+        // Build sending rate table and allocate single test connection
+        //
+        repo.sendingRates = calloc(1, MAX_SENDING_RATES * sizeof(struct sendingRate));
+        conn              = calloc(1, sizeof(struct connection));
+        if (repo.sendingRates == NULL || conn == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation failure\n");
+                return EXIT_FAILURE;
+        }
+        if ((var = def_sending_rates()) > 0) {
+                fputs(scratch, stderr);
+                return EXIT_FAILURE;
+        }
+
+        //
+        // Select link profiles
+        //
+        if (tfile != NULL) {
+                if ((pcount = load_trace(tfile, profile, conf.trialInt)) < 0)
+                        return EXIT_FAILURE;
+        } else if (pfile != NULL) {
+                if ((pcount = load_profiles(pfile, profile, MAX_PROFILES)) < 0)
+                        return EXIT_FAILURE;
+        } else {
+                memcpy(profile, defProfile, sizeof(defProfile));
+        }
+        if ((ss = calloc(pcount, sizeof(struct simSummary))) == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation failure\n");
+                return EXIT_FAILURE;
+        }
+
+        //
+        // Simulate and output results of each profile
+        //
+        printf("Algo: %s%s, Test Int(sec): %d, Trial Int(ms): %d, DelayVar Thresh(ms): %d-%d [%s], Runs: %d, Tol(%%): %d\n",
+               rateAdjAlgo[conf.rateAdjAlgo], conf.srContinuous ? " (Continuous)" : "", conf.testIntTime, conf.trialInt,
+               conf.lowThresh, conf.upperThresh, conf.useOwDelVar ? "OWD" : "RTT", runs, convtol);
+        printf("%-14s %9s %7s %7s %8s %9s %7s %7s %7s %7s %7s %7s\n", "Profile", "Mbps", "Buf(ms)", "RTT(ms)", "Loss", "Converged",
+               "Avg(s)", "P95(s)", "Over(%)", "OMax(%)", "Loss(%)", "Util(%)");
+        clock_gettime(CLOCK_MONOTONIC, &tstart);
+        for (i = 0, pf = profile; i < pcount; i++, pf++) {
+                sim_profile(pf, runs, convtol, &ss[i]);
+                if (ss[i].converged > 0) {
+                        snprintf(convavg, sizeof(convavg), "%.2f", ss[i].convAvg);
+                        snprintf(convp95, sizeof(convp95), "%.2f", ss[i].convP95);
+                } else {
+                        strcpy(convavg, "-"); // Never converged
+                        strcpy(convp95, "-");
+                }
+                printf("%-14s %9.2f %7.0f %7.0f %8.2E %4d/%-4d %7s %7s %7.2f %7.2f %7.3f %7.2f\n", pf->name, pf->capacity,
+                       pf->bufferMs, pf->rttMs, pf->lossRatio, ss[i].converged, ss[i].runs, convavg, convp95, ss[i].overAvg,
+                       ss[i].overMax, ss[i].lossAvg, ss[i].utilAvg);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &tend);
+        elapsed = (double) (tend.tv_sec - tstart.tv_sec) + (double) (tend.tv_nsec - tstart.tv_nsec) / NSECINSEC;
+        printf("Tests: %d, Elapsed(sec): %.3f, Tests/sec: %.0f\n", pcount * runs, elapsed,
+               elapsed > 0.0 ? (double) (pcount * runs) / elapsed : 0.0);
+
+        //
+        // Save and/or compare regression baseline
+        //
+        var = EXIT_SUCCESS;
+        if (wfile != NULL) {
+                if (save_baseline(wfile, ss, pcount) < 0)
+                        var = EXIT_FAILURE;
+        }
+        if (bfile != NULL) {
+                if (check_baseline(bfile, ss, pcount, (double) gatetol / 100.0) != 0)
+                        var = EXIT_FAILURE;
+        }
+        for (i = 0; i < pcount; i++)
+                free(profile[i].capSeries);
+        free(ss);
+        free(conn);
+        free(repo.sendingRates);
+        return var;
+}
+//----------------------------------------------------------------------------
+//
+// Initialize connection as the server side of an accepted test (see service_actreq)
+//
+void sim_init_conn(int connindex) {
+        register struct connection *c = &conn[connindex];
+
+        memset(c, 0, sizeof(struct connection));
+        c->fd             = -1;
+        c->incomingCpu    = -1;
+        c->rssQueue       = -1;
+        c->srStructIndex  = -1;
+        c->testAction     = TEST_ACT_TEST;
+        c->testType       = TEST_TYPE_US;
+        c->lowThresh      = conf.lowThresh;
+        c->upperThresh    = conf.upperThresh;
+        c->trialInt       = conf.trialInt;
+        c->testIntTime    = conf.testIntTime;
+        c->subIntPeriod   = conf.subIntPeriod;
+        c->srIndexConf    = CHTA_SRIDX_DEF;
+        c->useOwDelVar    = conf.useOwDelVar;
+        c->highSpeedDelta = conf.highSpeedDelta;
+        c->slowAdjThresh  = conf.slowAdjThresh;
+        c->seqErrThresh   = conf.seqErrThresh;
+        c->ignoreOooDup   = conf.ignoreOooDup;
+        c->rateAdjAlgo    = conf.rateAdjAlgo;
+        c->srContinuous   = conf.srContinuous;
+        c->rttMinimum     = STATUS_NODEL;
+        c->rttVarSample   = STATUS_NODEL;
+        ra_init(connindex);
+}
+//----------------------------------------------------------------------------
+//
+// Simulate one test against link profile
+//
+// Each trial interval the bottleneck queue (fluid model) is advanced using the sending rate selected RTT ago,
+// the resulting loss and delay variation are placed in the connection as if received via a status PDU, and the
+// server rate adjustment is performed. Sub-intervals are finalized via the standard accounting.
+//
+// When the RTT is not a multiple of the trial interval, the load arriving at the bottleneck is the time-weighted
+// mix of the two sending rates that overlap that trial (e.g., with a 30 ms RTT and 50 ms trials, 40% of a trial
+// already carries the rate selected at its start). A test has converged once the delivered rate (i.e., what the
+// test measures) stays within tolerance of capacity, while overshoot and loss capture what it took to get there.
+//
+void sim_test(struct profile *pf, int convtol, BOOL verbose, struct simResult *sr) {
+        register struct connection *c = &conn[0];
+        int k, trials, lag, window, convk;
+        unsigned int dgrams, lost;
+        double rate, dgsize, cap, bytesin, service, buffer, queue, qprev, overflow, delivered, dvmin, dvavg, pct, lagfrac;
+        double ratehist[RATE_HISTORY], sizehist[RATE_HISTORY], offhist[RATE_HISTORY], delhist[RATE_HISTORY];
+        double svchist[RATE_HISTORY], sent = 0.0, lostsum = 0.0, capsum = 0.0, delsum = 0.0, offwin = 0.0, delwin = 0.0;
+        double svcwin = 0.0, offered;
+        struct timespec tspecvar;
+
+        tspecclear(&repo.systemClock);
+        sim_init_conn(0);
+        proc_subinterval(0, TRUE);
+        memset(sr, 0, sizeof(struct simResult));
+        trials  = (conf.testIntTime * MSECINSEC) / conf.trialInt;
+        lag     = (int) (pf->rttMs / conf.trialInt);
+        lagfrac = (pf->rttMs / conf.trialInt) - lag; // Fraction of trial still carrying the older rate
+        window  = conf.subIntPeriod / conf.trialInt;
+        convk   = 0;
+        queue   = 0.0;
+        if (lag >= RATE_HISTORY - 1) {
+                lag     = RATE_HISTORY - 2;
+                lagfrac = 0.0;
+        }
+        tspecvar.tv_sec  = 0;
+        tspecvar.tv_nsec = (long) conf.trialInt * NSECINMSEC;
+
+        for (k = 0; k < trials; k++) {
+                //
+                // Save sending rate of this trial, then obtain rate arriving at bottleneck
+                //
+                rate                       = sim_mbps(sr_select(0, c->srIndex), &dgsize);
+                ratehist[k % RATE_HISTORY] = rate;
+                sizehist[k % RATE_HISTORY] = dgsize;
+                if (pf->capSeries != NULL)
+                        cap = pf->capSeries[(k < pf->capCount) ? k : pf->capCount - 1];
+                else
+                        cap = pf->capacity;
+                if (cap <= 0.0)
+                        cap = 0.001;
+                pct = ((rate / cap) - 1.0) * 100.0; // Sending rate relative to capacity
+                if (pct > sr->overshoot)
+                        sr->overshoot = pct;
+                bytesin = 0.0;
+                dgsize  = sizehist[k % RATE_HISTORY];
+                if (k >= lag) {
+                        bytesin = (1.0 - lagfrac) * ratehist[(k - lag) % RATE_HISTORY];
+                        dgsize  = sizehist[(k - lag) % RATE_HISTORY];
+                }
+                if (k > lag)
+                        bytesin += lagfrac * ratehist[(k - lag - 1) % RATE_HISTORY];
+                bytesin *= 125.0 * conf.trialInt; // Mbps to bytes per trial
+                offered = bytesin;
+                dgrams = (unsigned int) (bytesin / dgsize + 0.5);
+                sent += (double) dgrams;
+
+                //
+                // Random loss, then bottleneck queue with tail drop
+                //
+                lost = 0;
+                if (pf->lossRatio > 0.0 && dgrams > 0) {
+                        lost = sim_poisson((double) dgrams * pf->lossRatio);
+                        if (lost > dgrams)
+                                lost = dgrams;
+                        bytesin -= (double) lost * dgsize;
+                }
+                service  = cap * 125.0 * conf.trialInt;
+                buffer   = cap * 125.0 * pf->bufferMs;
+                qprev    = queue;
+                queue    = qprev + bytesin - service;
+                overflow = 0.0;
+                if (queue < 0.0) {
+                        queue = 0.0;
+                } else if (queue > buffer) {
+                        overflow = queue - buffer;
+                        queue    = buffer;
+                        lost += (unsigned int) (overflow / dgsize + 0.5);
+                }
+                delivered = qprev + bytesin - queue - overflow;
+                lostsum += (double) lost;
+                capsum += service;
+                delsum += delivered;
+
+                //
+                // Offered and delivered rates over the last sub-interval (sliding), restarting convergence when
+                // either is out of tolerance (allowing for rounding at the tolerance boundary)
+                //
+                offhist[k % RATE_HISTORY] = offered;
+                delhist[k % RATE_HISTORY] = delivered;
+                svchist[k % RATE_HISTORY] = service;
+                offwin += offered;
+                delwin += delivered;
+                svcwin += service;
+                if (k >= window) {
+                        offwin -= offhist[(k - window) % RATE_HISTORY];
+                        delwin -= delhist[(k - window) % RATE_HISTORY];
+                        svcwin -= svchist[(k - window) % RATE_HISTORY];
+                }
+                if (k + 1 >= window && (delwin < svcwin * (1.0 - (double) convtol / 100.0) * (1.0 - 1.0E-9) ||
+                                        offwin > svcwin * (1.0 + (double) convtol / 100.0) * (1.0 + 1.0E-9)))
+                        convk = k + 2 - window; // Start of next window
+
+                //
+                // Populate connection with receiver feedback (per trial values, as in status PDU)
+                //
+                dvmin = (qprev < queue ? qprev : queue) / (cap * 125.0); // Queuing delay in ms
+                dvavg = ((qprev + queue) / 2.0) / (cap * 125.0);
+                dgrams          = (unsigned int) (delivered / dgsize + 0.5);
+                c->seqErrLoss   = lost;
+                c->seqErrOoo    = 0;
+                c->seqErrDup    = 0;
+                c->delayVarCnt  = dgrams;
+                c->delayVarMin  = (dgrams > 0) ? (unsigned int) dvmin : STATUS_NODEL;
+                c->delayVarMax  = (unsigned int) (queue / (cap * 125.0));
+                c->delayVarSum  = (unsigned long long) (dvavg * dgrams);
+                c->rttMinimum   = (unsigned int) (pf->rttMs + 0.5);
+                c->rttVarSample = (unsigned int) (queue / (cap * 125.0) + 0.5);
+                c->sisAct.rxDatagrams += dgrams;
+                c->sisAct.rxBytes += (uint64_t) (delivered - ((double) dgrams * L3DG_OVERHEAD));
+                c->sisAct.seqErrLoss += lost;
+
+                //
+                // Advance clock, finalize sub-interval if reached, then perform rate adjustment
+                //
+                tspecplus(&repo.systemClock, &tspecvar, &repo.systemClock);
+                if ((((k + 1) * conf.trialInt) % conf.subIntPeriod) == 0) {
+                        proc_subinterval(0, FALSE);
+                        if (verbose) {
+                                printf("  Sub-Interval[%u](sec): %6.1f, Loss: %u, DelayVar(ms): %u, Mbps(L3/IP): %.2f, "
+                                       "Capacity: %.2f\n",
+                                       c->subIntSeqNo, (double) c->sisSav.accumTime / MSECINSEC, c->sisSav.seqErrLoss,
+                                       c->rttVarSample, get_rate(0, &c->sisSav, L3DG_OVERHEAD), cap);
+                        }
+                }
+                adjust_sending_rate(0);
+        }
+        //
+        // Converged only if at least one full sub-interval window remained within tolerance through the end of
+        // the test (a single in-tolerance trial at the end of an oscillating test is not convergence)
+        //
+        if (convk + window <= trials)
+                sr->convTime = (double) ((convk + window) * conf.trialInt) / MSECINSEC; // End of first window
+        else
+                sr->convTime = -1.0;
+        sr->lossPct = (sent > 0.0) ? (lostsum * 100.0) / sent : 0.0;
+        sr->utilPct = (capsum > 0.0) ? (delsum * 100.0) / capsum : 0.0;
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Simulate multiple tests against link profile and summarize results
+//
+void sim_profile(struct profile *pf, int runs, int convtol, struct simSummary *ss) {
+        int i;
+        double *conv;
+        struct simResult sr;
+
+        memset(ss, 0, sizeof(struct simSummary));
+        strncpy(ss->name, pf->name, PROFILE_NAME - 1);
+        ss->runs = runs;
+        if ((conv = malloc(runs * sizeof(double))) == NULL)
+                return;
+        for (i = 0; i < runs; i++) {
+                sim_test(pf, convtol, (simVerbose && i == 0), &sr);
+                if (sr.convTime >= 0.0) {
+                        conv[ss->converged++] = sr.convTime;
+                        ss->convAvg += sr.convTime;
+                }
+                ss->overAvg += sr.overshoot;
+                if (sr.overshoot > ss->overMax)
+                        ss->overMax = sr.overshoot;
+                ss->lossAvg += sr.lossPct;
+                ss->utilAvg += sr.utilPct;
+        }
+        if (ss->converged > 0) {
+                qsort(conv, ss->converged, sizeof(double), cmp_double);
+                ss->convAvg /= ss->converged;
+                ss->convP95 = conv[((ss->converged * 95) + 99) / 100 - 1];
+        } else {
+                ss->convAvg = ss->convP95 = -1.0;
+        }
+        ss->overAvg /= runs;
+        ss->lossAvg /= runs;
+        ss->utilAvg /= runs;
+        free(conv);
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Calculate L3 sending rate (Mbps) and average datagram size of sending rate parameters
+//
+double sim_mbps(struct sendingRate *sr, double *dgsize) {
+        double bytes = 0.0, dgrams = 0.0, size;
+
+        if (sr->txInterval1 > 0 && sr->burstSize1 > 0) {
+                size = (double) ((sr->udpPayload1 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD);
+                dgrams += ((double) sr->burstSize1 * BASE_SEND_TIMER2) / sr->txInterval1; // Per transmitter 2 interval
+                bytes += size * ((double) sr->burstSize1 * BASE_SEND_TIMER2) / sr->txInterval1;
+        }
+        if (sr->txInterval2 > 0) {
+                if (sr->burstSize2 > 0) {
+                        size = (double) ((sr->udpPayload2 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD);
+                        dgrams += ((double) sr->burstSize2 * BASE_SEND_TIMER2) / sr->txInterval2;
+                        bytes += size * ((double) sr->burstSize2 * BASE_SEND_TIMER2) / sr->txInterval2;
+                }
+                if ((sr->udpAddon2 & ~SRATE_RAND_BIT) > 0) {
+                        size = (double) (sr->udpAddon2 & ~SRATE_RAND_BIT);
+                        if (sr->udpAddon2 & SRATE_RAND_BIT)
+                                size = (size + (double) MIN_PAYLOAD_SIZE) / 2.0; // Average of random sizes
+                        size += L3DG_OVERHEAD;
+                        dgrams += (double) BASE_SEND_TIMER2 / sr->txInterval2;
+                        bytes += size * (double) BASE_SEND_TIMER2 / sr->txInterval2;
+                }
+        }
+        *dgsize = (dgrams > 0.0) ? bytes / dgrams : (double) (MAX_PAYLOAD_SIZE + L3DG_OVERHEAD);
+        return (bytes * 8.0) / BASE_SEND_TIMER2; // Bits per us = Mbps
+}
+//----------------------------------------------------------------------------
+//
+// Uniform random value in (0, 1) via xorshift64*
+//
+double sim_uniform(void) {
+
+        rngState ^= rngState >> 12;
+        rngState ^= rngState << 25;
+        rngState ^= rngState >> 27;
+        return ((double) ((rngState * 0x2545F4914F6CDD1DULL) >> 11) + 0.5) / 9007199254740992.0;
+}
+//----------------------------------------------------------------------------
+//
+// Random loss count with Poisson distribution (normal approximation for large mean)
+//
+unsigned int sim_poisson(double mean) {
+        unsigned int k = 0;
+        double limit, p = 1.0;
+
+        if (mean > 30.0) {
+                p = mean + sqrt(mean) * sqrt(-2.0 * log(sim_uniform())) * cos(2.0 * M_PI * sim_uniform());
+                return (p > 0.0) ? (unsigned int) (p + 0.5) : 0;
+        }
+        limit = exp(-mean);
+        do {
+                k++;
+                p *= sim_uniform();
+        } while (p > limit);
+        return k - 1;
+}
+//----------------------------------------------------------------------------
+//
+// Load link profiles from file (name, capacity in Mbps, buffer in ms, RTT in ms, loss ratio)
+//
+// Output error to stderr and return -1 on failure, else profile count
+//
+int load_profiles(char *fname, struct profile *pf, int max) {
+        int count = 0, line = 0;
+        char buf[STRING_SIZE], *ptr;
+        FILE *fp;
+
+        if ((fp = fopen(fname, "r")) == NULL) {
+                fprintf(stderr, "ERROR: Unable to open profile file <%s>: %s\n", fname, strerror(errno));
+                return -1;
+        }
+        while (fgets(buf, sizeof(buf), fp) != NULL) {
+                line++;
+                for (ptr = buf; *ptr == ' ' || *ptr == '\t'; ptr++)
+                        ;
+                if (*ptr == '#' || *ptr == '\n' || *ptr == '\r' || *ptr == '\0')
+                        continue;
+                if (count >= max) {
+                        fprintf(stderr, "ERROR: Profile file exceeds maximum of %d profiles\n", max);
+                        fclose(fp);
+                        return -1;
+                }
+                memset(pf, 0, sizeof(struct profile));
+                if (sscanf(ptr, "%31s %lf %lf %lf %lf", pf->name, &pf->capacity, &pf->bufferMs, &pf->rttMs, &pf->lossRatio) != 5 ||
+                    pf->capacity <= 0.0 || pf->bufferMs < 0.0 || pf->rttMs < 0.0 || pf->lossRatio < 0.0 || pf->lossRatio >= 1.0) {
+                        fprintf(stderr, "ERROR: Invalid profile at line %d of <%s>\n", line, fname);
+                        fclose(fp);
+                        return -1;
+                }
+                pf++;
+                count++;
+        }
+        fclose(fp);
+        if (count == 0) {
+                fprintf(stderr, "ERROR: No profiles found in <%s>\n", fname);
+                return -1;
+        }
+        return count;
+}
+//----------------------------------------------------------------------------
+//
+// Load capacity profile from binary output (export) archive file
+//
+// Received load traffic is divided into trial intervals (by receive time). When an interval shows congestion (loss
+// or delay variation above the low threshold) its delivered rate is taken as the capacity, otherwise the capacity
+// is the larger of the delivered rate and the prior capacity. The base RTT is the minimum sampled RTT.
+//
+// Output error to stderr and return -1 on failure, else profile count
+//
+int load_trace(char *fname, struct profile *pf, int trialint) {
+        int i, count;
+        uint32_t j, seqmax = 0, rttmin = UINT32_MAX;
+        uint64_t n, rxbase = 0, rxmax = 0, win = (uint64_t) trialint * NSECINMSEC;
+        int32_t owdmin = INT32_MAX;
+        double *bytes, *lost, cap;
+        int32_t *owd;
+        BOOL started = FALSE;
+        struct archive ar;
+
+        if (archive_open(&ar, fname) < 0)
+                return -1;
+        if (ar.records == 0) {
+                fprintf(stderr, "ERROR: No records in <%s>\n", fname);
+                archive_close(&ar);
+                return -1;
+        }
+
+        //
+        // Determine minimums and span of receive time
+        //
+        for (n = 0; n < ar.chunks; n++) {
+                struct exportChunk *ec = archive_chunk(&ar, n);
+                uint64_t *dstrx        = ARCHIVE_COL(ec, EXPCOL_DSTRX, uint64_t);
+                int32_t *owdcol        = ARCHIVE_COL(ec, EXPCOL_OWD, int32_t);
+                uint8_t *flags         = ARCHIVE_COL(ec, EXPCOL_FLAGS, uint8_t);
+                uint32_t *rtt          = ARCHIVE_COL(ec, EXPCOL_RTT, uint32_t);
+
+                for (j = 0; j < ec->records; j++) {
+                        if (!started || dstrx[j] < rxbase) {
+                                rxbase  = dstrx[j];
+                                started = TRUE;
+                        }
+                        if (dstrx[j] > rxmax)
+                                rxmax = dstrx[j];
+                        if (owdcol[j] < owdmin)
+                                owdmin = owdcol[j];
+                        if ((flags[j] & EXPREC_RTT) && rtt[j] < rttmin)
+                                rttmin = rtt[j];
+                }
+        }
+        count = (int) ((rxmax - rxbase) / win) + 1;
+        bytes = calloc(count, sizeof(double));
+        lost  = calloc(count, sizeof(double));
+        owd   = malloc(count * sizeof(int32_t));
+        pf->capSeries = calloc(count, sizeof(double));
+        if (bytes == NULL || lost == NULL || owd == NULL || pf->capSeries == NULL) {
+                fprintf(stderr, "ERROR: Memory allocation failure for trace\n");
+                archive_close(&ar);
+                return -1;
+        }
+        for (i = 0; i < count; i++)
+                owd[i] = INT32_MAX;
+
+        //
+        // Accumulate delivered bytes, lost datagrams (sequence gaps) and minimum one-way delay per trial interval
+        //
+        for (n = 0; n < ar.chunks; n++) {
+                struct exportChunk *ec = archive_chunk(&ar, n);
+                uint32_t *seqno        = ARCHIVE_COL(ec, EXPCOL_SEQNO, uint32_t);
+                uint16_t *payload      = ARCHIVE_COL(ec, EXPCOL_PAYLOAD, uint16_t);
+                uint64_t *dstrx        = ARCHIVE_COL(ec, EXPCOL_DSTRX, uint64_t);
+                int32_t *owdcol        = ARCHIVE_COL(ec, EXPCOL_OWD, int32_t);
+
+                for (j = 0; j < ec->records; j++) {
+                        i = (int) ((dstrx[j] - rxbase) / win);
+                        bytes[i] += (double) (payload[j] + L3DG_OVERHEAD);
+                        if (seqno[j] > seqmax + 1 && seqmax > 0)
+                                lost[i] += (double) (seqno[j] - seqmax - 1);
+                        if (seqno[j] > seqmax)
+                                seqmax = seqno[j];
+                        if (owdcol[j] < owd[i])
+                                owd[i] = owdcol[j];
+                }
+        }
+        if ((uint64_t) seqmax > 2 * ar.records) {
+                fprintf(stderr, "ERROR: Trace <%s> does not include all load PDUs (export with '%c' prefix)\n", fname,
+                        OUTPUT_ALL_PREFIX);
+                archive_close(&ar);
+                free(bytes);
+                free(lost);
+                free(owd);
+                return -1;
+        }
+        archive_close(&ar);
+
+        //
+        // Infer capacity per trial interval
+        //
+        for (i = 0, cap = 0.0; i < count; i++) {
+                double mbps = (bytes[i] * 8.0) / ((double) trialint * 1000.0);
+                if (lost[i] > 0.0 || (owd[i] != INT32_MAX && owd[i] - owdmin > conf.lowThresh))
+                        cap = mbps;
+                else if (mbps > cap)
+                        cap = mbps;
+                pf->capSeries[i] = cap;
+                pf->capacity += cap;
+        }
+        pf->capCount = count;
+        pf->capacity /= count; // Average capacity
+        pf->bufferMs  = DEF_TRACE_BUFFER;
+        pf->rttMs     = (rttmin != UINT32_MAX) ? (double) rttmin : DEF_TRACE_RTT;
+        pf->lossRatio = 0.0;
+        strncpy(pf->name, "trace", PROFILE_NAME - 1);
+        free(bytes);
+        free(lost);
+        free(owd);
+        return 1;
+}
+//----------------------------------------------------------------------------
+//
+// Write results as regression baseline (one profile per line)
+//
+// Output error to stderr and return -1 on failure
+//
+int save_baseline(char *fname, struct simSummary *ss, int count) {
+        int i;
+        FILE *fp;
+
+        if ((fp = fopen(fname, "w")) == NULL) {
+                fprintf(stderr, "ERROR: Unable to create baseline file <%s>: %s\n", fname, strerror(errno));
+                return -1;
+        }
+        fprintf(fp, "# %s %s runs=%d\n", "udpst-sim", rateAdjAlgo[conf.rateAdjAlgo], ss->runs);
+        for (i = 0; i < count; i++, ss++) {
+                fprintf(fp, "%s %.4f %.3f %.3f %.3f %.4f %.3f\n", ss->name, (double) ss->converged / ss->runs, ss->convAvg,
+                        ss->convP95, ss->overAvg, ss->lossAvg, ss->utilAvg);
+        }
+        fclose(fp);
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Compare results to regression baseline
+//
+// A regression is a lower converged fraction or utilization, or a larger convergence time, overshoot or loss, beyond
+// the gate tolerance (relative to the baseline value, with a small absolute floor)
+//
+// Output regressions and return count, or -1 on failure
+//
+int check_baseline(char *fname, struct simSummary *ss, int count, double gate) {
+        int i, regress = 0;
+        char buf[STRING_SIZE], name[PROFILE_NAME];
+        double convfrac, convavg, convp95, overavg, lossavg, utilavg;
+        FILE *fp;
+        struct simSummary *s;
+
+        if ((fp = fopen(fname, "r")) == NULL) {
+                fprintf(stderr, "ERROR: Unable to open baseline file <%s>: %s\n", fname, strerror(errno));
+                return -1;
+        }
+        while (fgets(buf, sizeof(buf), fp) != NULL) {
+                if (*buf == '#')
+                        continue;
+                if (sscanf(buf, "%31s %lf %lf %lf %lf %lf %lf", name, &convfrac, &convavg, &convp95, &overavg, &lossavg,
+                           &utilavg) != 7)
+                        continue;
+                for (i = 0, s = ss; i < count; i++, s++) {
+                        if (strcmp(s->name, name) == 0)
+                                break;
+                }
+                if (i == count)
+                        continue;
+                if ((double) s->converged / s->runs < convfrac * (1.0 - gate) - 0.01) {
+                        printf("REGRESSION: %s converged %.4f (baseline %.4f)\n", name, (double) s->converged / s->runs,
+                               convfrac);
+                        regress++;
+                }
+                if (convavg >= 0.0 && s->convAvg >= 0.0 && s->convAvg > convavg * (1.0 + gate) + 0.1) {
+                        printf("REGRESSION: %s convergence time %.3f sec (baseline %.3f)\n", name, s->convAvg, convavg);
+                        regress++;
+                }
+                if (s->overAvg > overavg * (1.0 + gate) + 1.0) {
+                        printf("REGRESSION: %s overshoot %.3f%% (baseline %.3f%%)\n", name, s->overAvg, overavg);
+                        regress++;
+                }
+                if (s->lossAvg > lossavg * (1.0 + gate) + 0.01) {
+                        printf("REGRESSION: %s loss %.4f%% (baseline %.4f%%)\n", name, s->lossAvg, lossavg);
+                        regress++;
+                }
+                if (s->utilAvg < utilavg * (1.0 - gate)) {
+                        printf("REGRESSION: %s utilization %.3f%% of capacity (baseline %.3f%%)\n", name, s->utilAvg, utilavg);
+                        regress++;
+                }
+        }
+        fclose(fp);
+        printf("Regression Gate (%.0f%%): %s\n", gate * 100.0, regress > 0 ? "FAIL" : "PASS");
+        return regress;
+}
+//----------------------------------------------------------------------------
+//
+// Compare doubles for qsort
+//
+int cmp_double(const void *a, const void *b) {
+        double da = *(const double *) a, db = *(const double *) b;
+
+        return (da > db) - (da < db);
+}
+//----------------------------------------------------------------------------
@@ -54,6 +54,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <errno.h>
 #include <limits.h>
 #include <time.h>
@@ -84,6 +85,7 @@
 extern char scratch[STRING_SIZE];
 extern struct configuration conf;
 extern struct repository repo;
+extern struct connection *conn;
 
 //----------------------------------------------------------------------------
 // Function definitions
@@ -96,6 +98,7 @@ extern struct repository repo;
 int def_sending_rates(void) {
         int var, i, j, k, jmax, kmax;
         unsigned int payload;
+        double bw;
         BOOL stop;
         struct sendingRate *sr;
 
@@ -212,10 +215,187 @@ int def_sending_rates(void) {
                 var = sprintf(scratch, "ERROR: Sending rate table build failure (overrun)\n");
                 return var;
         }
+
+        //
+        // Determine largest continuous sending rate index, as limited by the max burst size of both transmitters
+        //
+        bw = (double) ((payload + L3DG_OVERHEAD) * MAX_BURST_SIZE * 8);
+        bw = (bw / BASE_SEND_TIMER1) + (bw / BASE_SEND_TIMER2); // Mbps
+        for (repo.maxContIndex = repo.hSpeedThresh; sr_cont_mbps(repo.maxContIndex + 1) <= bw; repo.maxContIndex++)
+                ;
         return 0;
 }
 //----------------------------------------------------------------------------
 //
+// Obtain sending rate (Mbps) of continuous sending rate index
+//
+// Each index below the high-speed threshold adds 1 Mbps, with each index above it adding CRATE_HS_PCT percent
+//
+double sr_cont_mbps(int index) {
+
+        if (index <= repo.hSpeedThresh)
+                return (double) index;
+        return (double) repo.hSpeedThresh * pow(1.0 + (CRATE_HS_PCT / 100.0), (double) (index - repo.hSpeedThresh));
+}
+//----------------------------------------------------------------------------
+//
+// Obtain lowest continuous sending rate index that covers the specified rate (Mbps)
+//
+int sr_cont_index(int mbps) {
+        int index;
+
+        if (mbps <= repo.hSpeedThresh)
+                return mbps;
+        for (index = repo.hSpeedThresh; index < repo.maxContIndex; index++) {
+                if (sr_cont_mbps(index) >= (double) mbps)
+                        break;
+        }
+        return index;
+}
+//----------------------------------------------------------------------------
+//
+// Synthesize transmitter parameters for a target sending rate (Mbps)
+//
+// Transmitter 1 sends bursts of max size datagrams, with the remainder sent by transmitter 2 as bursts and an
+// add-on datagram. The granularity is one byte per transmitter 2 interval (8 Kbps), with jumbo sizes (above the
+// high-speed threshold) avoiding any transmitter 2 datagrams that would not also require fragmentation.
+//
+void sr_synthesize(double mbps, struct sendingRate *sr) {
+        unsigned int total, packet, minpacket, remain;
+
+        memset(sr, 0, sizeof(struct sendingRate));
+        if (conf.jumboStatus && mbps > (double) repo.hSpeedThresh) {
+                packet    = MAX_JL3_PACKET;
+                minpacket = MAX_L3_PACKET + 125;
+        } else {
+                if (conf.traditionalMTU)
+                        packet = MAX_TL3_PACKET;
+                else
+                        packet = MAX_L3_PACKET;
+                minpacket = MIN_PAYLOAD_SIZE + L3DG_OVERHEAD;
+        }
+
+        //
+        // Calculate total bytes per transmitter 2 interval
+        //
+        total = (unsigned int) ((mbps * BASE_SEND_TIMER2) / 8.0 + 0.5);
+
+        //
+        // Transmitter 1
+        //
+        sr->burstSize1 = total / (packet * (BASE_SEND_TIMER2 / BASE_SEND_TIMER1));
+        if (sr->burstSize1 > MAX_BURST_SIZE)
+                sr->burstSize1 = MAX_BURST_SIZE;
+        if (sr->burstSize1 > 0) {
+                sr->txInterval1 = BASE_SEND_TIMER1;
+                sr->udpPayload1 = packet - L3DG_OVERHEAD;
+        }
+        remain = total - (sr->burstSize1 * packet * (BASE_SEND_TIMER2 / BASE_SEND_TIMER1));
+
+        //
+        // Transmitter 2 with add-on
+        //
+        if (remain >= minpacket) {
+                sr->burstSize2 = remain / packet;
+                if (sr->burstSize2 > MAX_BURST_SIZE)
+                        sr->burstSize2 = MAX_BURST_SIZE;
+                if (sr->burstSize2 > 0)
+                        sr->udpPayload2 = packet - L3DG_OVERHEAD;
+                remain -= sr->burstSize2 * packet;
+                if (remain >= minpacket && sr->burstSize2 < MAX_BURST_SIZE)
+                        sr->udpAddon2 = remain - L3DG_OVERHEAD;
+                sr->txInterval2 = BASE_SEND_TIMER2;
+        }
+
+        //
+        // Use minimum (first) table row if nothing could be sent
+        //
+        if (sr->burstSize1 == 0 && sr->burstSize2 == 0 && sr->udpAddon2 == 0)
+                *sr = repo.sendingRates[0];
+        return;
+}
+//----------------------------------------------------------------------------
+//
+// Select sending rate parameters for index, via table row or synthesized (and cached) continuous rate
+//
+struct sendingRate *sr_select(int connindex, int index) {
+        register struct connection *c = &conn[connindex];
+
+        if (!c->srContinuous || index == 0)
+                return &repo.sendingRates[index];
+        if (c->srStructIndex != index) {
+                sr_synthesize(sr_cont_mbps(index), &c->srStruct);
+                c->srStructIndex = index;
+        }
+        return &c->srStruct;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain nominal sending rate (Mbps) of table row (random sizes use their maximum)
+//
+double sr_row_mbps(struct sendingRate *sr) {
+        double mbps = 0.0;
+
+        if (sr->txInterval1 > 0) {
+                mbps += (double) (((sr->udpPayload1 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD) * sr->burstSize1 * 8) /
+                        (double) sr->txInterval1;
+        }
+        if (sr->txInterval2 > 0) {
+                mbps += (double) (((sr->udpPayload2 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD) * sr->burstSize2 * 8) /
+                        (double) sr->txInterval2;
+                if (sr->udpAddon2 > 0)
+                        mbps += (double) (((sr->udpAddon2 & ~SRATE_RAND_BIT) + L3DG_OVERHEAD) * 8) / (double) sr->txInterval2;
+        }
+        return mbps;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain nominal sending rate (Mbps) of index without selecting it
+//
+double sr_index_mbps(int connindex, int index) {
+        register struct connection *c = &conn[connindex];
+
+        if (c->srContinuous && index > 0)
+                return sr_cont_mbps(index);
+        return sr_row_mbps(&repo.sendingRates[index]);
+}
+//----------------------------------------------------------------------------
+//
+// Obtain highest sending rate index (table row or continuous) whose nominal rate does not exceed the specified rate
+//
+int sr_rate_index(double mbps, BOOL continuous) {
+        int index;
+
+        if (continuous) {
+                for (index = repo.maxContIndex; index > 0 && sr_cont_mbps(index) > mbps; index--)
+                        ;
+        } else {
+                for (index = repo.maxSendingRates - 1; index > 0 && sr_row_mbps(&repo.sendingRates[index]) > mbps; index--)
+                        ;
+        }
+        return index;
+}
+//----------------------------------------------------------------------------
+//
+// Obtain lowest sending rate index (table row or continuous) whose nominal rate covers the specified rate
+//
+int sr_ceil_index(double mbps, BOOL continuous) {
+        int index, maxindex;
+
+        index = sr_rate_index(mbps, continuous);
+        if (continuous) {
+                maxindex = repo.maxContIndex;
+                if (index < maxindex && sr_cont_mbps(index) < mbps)
+                        index++;
+        } else {
+                maxindex = repo.maxSendingRates - 1;
+                if (index < maxindex && sr_row_mbps(&repo.sendingRates[index]) < mbps)
+                        index++;
+        }
+        return index;
+}
+//----------------------------------------------------------------------------
+//
 // Display sending rate table parameters for each index
 //
 void show_sending_rates(int fd) {
@@ -40,5 +40,13 @@
 
 extern int def_sending_rates(void);
 extern void show_sending_rates(int);
+extern double sr_cont_mbps(int);
+extern int sr_cont_index(int);
+extern void sr_synthesize(double, struct sendingRate *);
+extern struct sendingRate *sr_select(int, int);
+extern double sr_row_mbps(struct sendingRate *);
+extern double sr_index_mbps(int, int);
+extern int sr_rate_index(double, BOOL);
+extern int sr_ceil_index(double, BOOL);
 
 #endif /* UDPST_SRATES_H */
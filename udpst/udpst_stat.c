@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_stat.c
+ *
+ * This file contains a standalone utility that displays the shared-memory
+ * statistics of all server instances on the local host (or of the segments
+ * specified), either once or repeatedly at a sub-second interval.
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <glob.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+//
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_shmstats.h"
+#include "udpst_shmread.h"
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+#define MIN_INTERVAL 10    // Minimum display interval (ms)
+#define MAX_INTERVAL 60000 // Maximum display interval (ms)
+#define NS_TO_SEC(ns) ((double) (ns) / NSECINSEC)
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void output_segment(struct shmReader *, uint64_t);
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Display shared-memory statistics of server instances
+//
+int main(int argc, char **argv) {
+        int i, interval = 0, count = 0, found;
+        BOOL all = FALSE, prune = FALSE;
+        size_t n;
+        uint64_t now;
+        struct timespec tspecvar;
+        struct shmReader rd;
+        glob_t gl;
+
+        while ((i = getopt(argc, argv, "i:c:ar")) != -1) {
+                switch (i) {
+                case 'i':
+                        interval = atoi(optarg);
+                        if (interval < MIN_INTERVAL || interval > MAX_INTERVAL) {
+                                fprintf(stderr, "ERROR: Interval <%d> out-of-range (%d-%d)\n", interval, MIN_INTERVAL,
+                                        MAX_INTERVAL);
+                                return EXIT_FAILURE;
+                        }
+                        break;
+                case 'c':
+                        count = atoi(optarg);
+                        break;
+                case 'a':
+                        all = TRUE;
+                        break;
+                case 'r':
+                        prune = TRUE;
+                        break;
+                default:
+                        fprintf(stderr, "Usage: %s [-i interval [-c count]] [-a] [-r] [segment]...\n", argv[0]);
+                        fprintf(stderr, "    -i interval Repeat display every interval ms (%d-%d)\n", MIN_INTERVAL,
+                                MAX_INTERVAL);
+                        fprintf(stderr, "    -c count    Number of displays when repeating [Default 0 = Unlimited]\n");
+                        fprintf(stderr, "    -a          Include segments of instances no longer running\n");
+                        fprintf(stderr, "    -r          Remove segments of instances no longer running\n");
+                        fprintf(stderr, "    segment     Segment file [Default %s%s*]\n", SHMSTATS_DIR, SHMSTATS_PREFIX);
+                        return EXIT_FAILURE;
+                }
+        }
+        if (interval == 0)
+                count = 1;
+
+        //
+        // Display all matching segments each interval (they are re-scanned so instances may come and go)
+        //
+        for (i = 0; count == 0 || i < count; i++) {
+                if (i > 0) {
+                        tspecvar.tv_sec  = interval / MSECINSEC;
+                        tspecvar.tv_nsec = (long) (interval % MSECINSEC) * NSECINMSEC;
+                        nanosleep(&tspecvar, NULL);
+                        printf("\n");
+                }
+                memset(&gl, 0, sizeof(gl));
+                if (optind < argc) {
+                        for (found = optind; found < argc; found++)
+                                glob(argv[found], GLOB_NOCHECK | (found > optind ? GLOB_APPEND : 0), NULL, &gl);
+                } else {
+                        glob(SHMSTATS_DIR SHMSTATS_PREFIX "*", 0, NULL, &gl);
+                }
+                clock_gettime(CLOCK_REALTIME, &tspecvar);
+                now = (uint64_t) tspecvar.tv_sec * NSECINSEC + (uint64_t) tspecvar.tv_nsec;
+                for (n = 0, found = 0; n < gl.gl_pathc; n++) {
+                        if (shmread_open(&rd, gl.gl_pathv[n]) < 0)
+                                continue;
+                        if (shmread_snapshot(&rd) < 0) {
+                                fprintf(stderr, "ERROR: <%s> No consistent snapshot available\n", gl.gl_pathv[n]);
+                        } else if (rd.stale && prune) {
+                                if (unlink(gl.gl_pathv[n]) == 0)
+                                        printf("Removed %s (PID %d no longer running)\n", gl.gl_pathv[n], rd.sh->pid);
+                                else
+                                        fprintf(stderr, "UNLINK ERROR: <%s> %s\n", gl.gl_pathv[n], strerror(errno));
+                        } else if (!rd.stale || all) {
+                                output_segment(&rd, now);
+                                found++;
+                        }
+                        shmread_close(&rd);
+                }
+                globfree(&gl);
+                if (found == 0 && !prune)
+                        printf("No server instances found\n");
+                fflush(stdout);
+        }
+        return EXIT_SUCCESS;
+}
+//----------------------------------------------------------------------------
+//
+// Output snapshot of a server instance
+//
+void output_segment(struct shmReader *rd, uint64_t now) {
+        uint32_t i;
+        double usec, rtt;
+        struct shmStatsConn *sc;
+        const struct shmStatsHeader *sh = rd->sh;
+        struct shmStatsGlobal *sg       = &rd->global;
+        struct shmStatsRecord *sr       = &rd->record;
+        struct perfStatsCounters *psC   = &sg->counters;
+        struct perfStatsAverages *psA   = &sr->averages;
+
+        printf("PID %d%s, Software Ver: %s, Protocol Ver: %u, Control: %s:%d, Uptime(sec): %.0f\n", sh->pid,
+               rd->stale ? " [Not Running]" : "", sh->swVersion, sh->protocolVer, sh->locAddr, sh->locPort,
+               NS_TO_SEC(now - sh->startTime));
+        printf("  Connections: %u, Tests: %u, Bandwidth(Mbps) US/DS: %d/%d, Setup Req/Acc/Rej: %u/%u/%u, "
+               "Activation Req/Acc/Rej: %u/%u/%u\n",
+               sg->connCount, sg->testCount, sg->usBandwidth, sg->dsBandwidth, psC->setupRequestCnt, psC->setupAcceptCnt,
+               psC->setupRejectCnt, psC->actRequestCnt, psC->actAcceptCnt, psC->actRejectCnt);
+
+        //
+        // Rates of last record are per-second averages across the record interval
+        //
+        if (sr->recordCount > 0 && sr->deltaTime > 0) {
+                usec = (double) sr->deltaTime / NSECINUSEC;
+                printf("  Record[%u](sec): %.1f, Mbps Tx/Rx: %.2f/%.2f, Datagrams/sec Tx/Rx: %.0f/%.0f, "
+                       "Loss Tx/Rx: %llu/%llu, Max Conn: %u\n",
+                       sr->recordCount, usec / USECINSEC, (double) psA->txBytes * 8 / usec, (double) psA->rxBytes * 8 / usec,
+                       (double) psA->txDatagrams * USECINSEC / usec, (double) psA->rxDatagrams * USECINSEC / usec,
+                       (unsigned long long) psA->txSeqErrLoss, (unsigned long long) psA->rxSeqErrLoss,
+                       sr->maximums.connCount);
+        }
+
+        //
+        // Live state of each test
+        //
+        for (i = 0; i < rd->connSlots; i++) {
+                sc = &rd->conn[i];
+                if (sc->testType == TEST_TYPE_UNK)
+                        continue;
+                rtt = (sc->rttMinimum != STATUS_NODEL) ? (double) sc->rttMinimum / USECINMSEC : -1.0;
+                printf("  [%u]%s %s:%u, SR Index: %d (%.2f Mbps), Sub-Interval Mbps(L3/IP): %.2f, Rx: %u, Loss: %u "
+                       "(Total %llu), DelayVarMax(ms): %u, RTTMin(ms): %.3f, Age(ms): %.0f\n",
+                       i, sc->testType == TEST_TYPE_US ? USTEST_TEXT : DSTEST_TEXT, sc->remAddr, sc->remPort, sc->srIndex,
+                       sc->rateMbps, sc->siRateMbps, sc->siRxDatagrams, sc->siSeqErrLoss,
+                       (unsigned long long) sc->seqErrLoss, sc->siDelayVarMax, rtt,
+                       now > sc->updateTime ? (double) (now - sc->updateTime) / NSECINMSEC : 0.0);
+        }
+}
+//----------------------------------------------------------------------------
@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_wcache.c
+ *
+ * This file maintains a client cache file of the maximum rates achieved by
+ * recent tests, and uses it to set the starting sending rate index of the next
+ * test to the same server (as if '-I @index' had been specified).
+ *
+ */
+
+#define UDPST_WCACHE
+#ifdef __linux__
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#else
+#include "../udpst_data_alt1.h"
+#endif
+//
+#include "cJSON.h"
+#include "udpst_common.h"
+#include "udpst_protocol.h"
+#include "udpst.h"
+#include "udpst_srates.h"
+#include "udpst_wcache.h"
+#ifndef __linux__
+#include "../udpst_data_alt2.h"
+#endif
+
+//----------------------------------------------------------------------------
+//
+// Internal function prototypes
+//
+void wcache_key(char *);
+int wcache_read(time_t);
+
+//----------------------------------------------------------------------------
+//
+// External data
+//
+extern char scratch[STRING_SIZE];
+extern struct configuration conf;
+extern struct repository repo;
+
+//----------------------------------------------------------------------------
+//
+// Global data
+//
+struct wcacheEntry {
+        char key[WCACHE_KEY_SIZE]; // Server, port, interface, and direction
+        time_t time;               // Time of test
+        double mbps;               // Maximum rate per connection (Mbps)
+};
+static struct wcacheEntry wcEntry[WCACHE_ENTRIES]; // Entries in file order (oldest first)
+static int wcCount;                                // Entry count
+
+//----------------------------------------------------------------------------
+// Function definitions
+//----------------------------------------------------------------------------
+//
+// Set starting sending rate index from cached maximums, unless an index was explicitly configured
+//
+// Populate scratch buffer and return length on error
+//
+int wcache_start(int fd) {
+        int i, var, count, pct, index;
+        time_t now, newest = 0;
+        double base = 0.0, mbps;
+        char key[WCACHE_KEY_SIZE];
+
+        if (conf.srIndexConf != DEF_SRINDEX_CONF)
+                return 0;
+        now = time(NULL);
+        if ((var = wcache_read(now)) > 0)
+                return var;
+        wcache_key(key);
+
+        //
+        // Use lowest maximum of the most recent entries for this key
+        //
+        for (i = wcCount - 1, count = 0; i >= 0 && count < WCACHE_KEEP; i--) {
+                if (strcmp(wcEntry[i].key, key) != 0)
+                        continue;
+                if (count++ == 0 || wcEntry[i].mbps < base)
+                        base = wcEntry[i].mbps;
+                if (wcEntry[i].time > newest)
+                        newest = wcEntry[i].time;
+        }
+        if (count == 0)
+                return 0;
+
+        //
+        // Reduce starting percentage as newest entry ages, and ignore rates too low to benefit
+        //
+        pct = WCACHE_START_PCT - (WCACHE_DECAY_PCT * (int) ((now - newest) / 86400));
+        if (pct < WCACHE_MIN_PCT)
+                pct = WCACHE_MIN_PCT;
+        mbps = (base * (double) pct) / 100.0;
+        if (mbps < WCACHE_MIN_MBPS)
+                return 0;
+        if ((index = sr_rate_index(mbps, conf.srContinuous)) > MAX_SRINDEX_CONF)
+                index = MAX_SRINDEX_CONF;
+        conf.srIndexConf    = index;
+        conf.srIndexIsStart = TRUE;
+        if (conf.verbose && !conf.jsonOutput) {
+                var = sprintf(scratch, "Warm-start from cache at sending rate index %d (%d%% of %.2f Mbps, %d test(s))\n", index,
+                              pct, base, count);
+                var = write(fd, scratch, var);
+        }
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Add maximum rate per connection of completed test to cache file
+//
+// Populate scratch buffer and return length on error
+//
+int wcache_update(void) {
+        int i, j, var, count;
+        time_t now;
+        double mbps = 0.0;
+        FILE *f;
+        struct wcacheEntry *we;
+
+        for (i = 0; i < 2; i++) { // Use larger of bimodal maximums
+                if (repo.actConnections[i] > 0 && repo.rateMaxL3[i] / (double) repo.actConnections[i] > mbps)
+                        mbps = repo.rateMaxL3[i] / (double) repo.actConnections[i];
+        }
+        if (mbps <= 0.0)
+                return 0;
+        now = time(NULL);
+        if ((var = wcache_read(now)) > 0)
+                return var;
+
+        //
+        // Append new entry (dropping oldest entry if full)
+        //
+        if (wcCount >= WCACHE_ENTRIES) {
+                memmove(&wcEntry[0], &wcEntry[1], (WCACHE_ENTRIES - 1) * sizeof(struct wcacheEntry));
+                wcCount--;
+        }
+        we = &wcEntry[wcCount++];
+        wcache_key(we->key);
+        we->time = now;
+        we->mbps = mbps;
+
+        //
+        // Rewrite file with the most recent entries of each key
+        //
+        if ((f = fopen(conf.wcacheFile, "w")) == NULL) {
+                var = sprintf(scratch, "FOPEN ERROR: <%.*s> %s\n", NAME_MAX, conf.wcacheFile, strerror(errno));
+                return var;
+        }
+        fprintf(f, "# <key> <time> <mbps> (OB-UDPST warm-start cache)\n");
+        for (i = 0; i < wcCount; i++) {
+                for (j = i + 1, count = 0; j < wcCount; j++) {
+                        if (strcmp(wcEntry[j].key, wcEntry[i].key) == 0)
+                                count++;
+                }
+                if (count < WCACHE_KEEP)
+                        fprintf(f, "%s %lld %.2f\n", wcEntry[i].key, (long long) wcEntry[i].time, wcEntry[i].mbps);
+        }
+        fclose(f);
+        return 0;
+}
+//----------------------------------------------------------------------------
+//
+// Build cache key from server, control port, local interface, and direction
+//
+void wcache_key(char *key) {
+        char *intf = "-";
+
+        if (*conf.intfName != '\0')
+                intf = conf.intfName;
+        snprintf(key, WCACHE_KEY_SIZE, "%.*s:%d/%s/%s", NAME_MAX, repo.server[0].name, repo.server[0].port, intf,
+                 conf.usTesting ? "US" : "DS");
+}
+//----------------------------------------------------------------------------
+//
+// Read valid entries that are not stale (a missing file is treated as empty)
+//
+// Populate scratch buffer and return length on error
+//
+int wcache_read(time_t now) {
+        int i, var;
+        long long tvar;
+        double mbps;
+        char *lbuffer, *tokens[3], *endptr, *saveptr, localbuffer[STRING_SIZE];
+        FILE *f;
+        struct wcacheEntry *we;
+
+        wcCount = 0;
+        if ((f = fopen(conf.wcacheFile, "r")) == NULL) {
+                if (errno == ENOENT)
+                        return 0;
+                var = sprintf(scratch, "FOPEN ERROR: <%.*s> %s\n", NAME_MAX, conf.wcacheFile, strerror(errno));
+                return var;
+        }
+        while (fgets(localbuffer, STRING_SIZE, f) != NULL) {
+                if (*localbuffer == '#')
+                        continue;
+                lbuffer = localbuffer;
+                for (i = 0; i < 3; i++) {
+                        if ((tokens[i] = strtok_r(lbuffer, " \t\r\n", &saveptr)) == NULL)
+                                break;
+                        lbuffer = NULL;
+                }
+                if (i < 3 || strlen(tokens[0]) >= WCACHE_KEY_SIZE)
+                        continue; // Ignore blank and malformed lines
+                tvar = strtoll(tokens[1], &endptr, 10);
+                if (*endptr != '\0' || tvar > (long long) now + 86400 || (long long) now - tvar > WCACHE_STALE_TIME)
+                        continue; // Ignore invalid and stale times
+                mbps = strtod(tokens[2], &endptr);
+                if (*endptr != '\0' || mbps <= 0.0)
+                        continue;
+                if (wcCount >= WCACHE_ENTRIES) { // Retain most recent
+                        memmove(&wcEntry[0], &wcEntry[1], (WCACHE_ENTRIES - 1) * sizeof(struct wcacheEntry));
+                        wcCount--;
+                }
+                we = &wcEntry[wcCount++];
+                strcpy(we->key, tokens[0]);
+                we->time = (time_t) tvar;
+                we->mbps = mbps;
+        }
+        fclose(f);
+        return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2020, Broadband Forum
+ * Copyright (c) 2020, AT&T Communications
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * UDP Speed Test - udpst_wcache.h
+ *
+ * This file contains constants and external function prototypes for the
+ * associated module.
+ *
+ */
+
+#ifndef UDPST_WCACHE_H
+#define UDPST_WCACHE_H
+
+//----------------------------------------------------------------------------
+//
+// Warm-start cache
+//
+// Each line of the cache file holds the maximum rate per connection achieved by
+// a prior test, as "<key> <unix time> <mbps>" where the key identifies the
+// server, control port, local interface, and direction. Only the most recent
+// entries of each key are kept, and entries are dropped once stale. The next
+// test starts at a percentage of the lowest remaining maximum, which decays as
+// the newest entry ages.
+//
+#define WCACHE_KEY_SIZE   (NAME_MAX + INTF_LIST_SIZE + 16) // Key string size
+#define WCACHE_ENTRIES    256                              // Max entries retained in file
+#define WCACHE_KEEP       5                                // Max entries retained per key
+#define WCACHE_STALE_TIME (7 * 86400)                      // Entry discarded after (sec)
+#define WCACHE_START_PCT  50                               // Start rate (% of cached maximum)
+#define WCACHE_DECAY_PCT  5                                // Start rate reduction per day of age
+#define WCACHE_MIN_PCT    20                               // Minimum start rate (% of maximum)
+#define WCACHE_MIN_MBPS   10.0                             // Min start rate worth using (Mbps)
+
+//----------------------------------------------------------------------------
+//
+// External function prototypes
+//
+extern int wcache_start(int);
+extern int wcache_update(void);
+
+#endif /* UDPST_WCACHE_H */